@@ -0,0 +1,442 @@
+#include "bar_aggregator.h"
+#include "state_snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int64_t TIMEFRAME_MS[BarAggregator::TIMEFRAME_COUNT] = {
+    1000,       // SECOND_1
+    60000,      // MINUTE_1
+    300000,     // MINUTE_5
+    3600000     // HOUR_1
+};
+
+int64_t periodStart(int64_t ts_ms, int64_t period_ms) {
+    int64_t remainder = ts_ms % period_ms;
+    if (remainder < 0) remainder += period_ms;
+    return ts_ms - remainder;
+}
+
+int64_t toMillis(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point fromMillis(int64_t ms) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(ms)));
+}
+
+} // namespace
+
+BarAggregator::BarAggregator() = default;
+
+std::chrono::milliseconds BarAggregator::getDuration(Timeframe timeframe) {
+    return std::chrono::milliseconds(TIMEFRAME_MS[static_cast<size_t>(timeframe)]);
+}
+
+void BarAggregator::setHistorySize(size_t bars_per_timeframe) {
+    std::lock_guard<std::mutex> lock(bars_mutex_);
+    history_size_ = std::max<size_t>(1, bars_per_timeframe);
+
+    // Existing rings were sized for the old capacity; start them over
+    for (auto& [_, state] : instruments_) {
+        for (auto& ring : state.history) {
+            ring = BarRing{};
+        }
+    }
+}
+
+void BarAggregator::onTrade(const std::string& instrument, double price, double size,
+                            std::chrono::system_clock::time_point timestamp) {
+    if (!std::isfinite(price) || !(size > 0.0)) {
+        return;
+    }
+
+    const int64_t ts_ms = toMillis(timestamp);
+    std::vector<Bar> closed;
+    {
+        std::lock_guard<std::mutex> lock(bars_mutex_);
+        advanceLocked(ts_ms, closed);
+
+        auto it = instruments_.find(instrument);
+        if (it == instruments_.end()) {
+            it = instruments_.emplace(instrument, InstrumentBars{}).first;
+            it->second.instrument = instrument;
+        }
+        auto& state = it->second;
+
+        for (size_t tf = 0; tf < TIMEFRAME_COUNT; ++tf) {
+            auto& bar = state.open[tf];
+            // A late print for a period that already closed goes to the next
+            // bar instead of reopening history behind newer bars
+            const int64_t start = std::max(periodStart(ts_ms, TIMEFRAME_MS[tf]), state.closed_until_ms[tf]);
+
+            if (bar.active && start > bar.start_ms) {
+                closeBar(state, tf, closed);
+            }
+
+            if (!bar.active) {
+                auto& slot = wheel_[tf];
+                if (!state.in_wheel[tf]) {
+                    slot.open_bars.push_back(&state);
+                    state.in_wheel[tf] = true;
+                }
+                slot.next_boundary_ms = std::min(slot.next_boundary_ms, start + TIMEFRAME_MS[tf]);
+                bar.active = true;
+                bar.start_ms = start;
+                bar.open = price;
+                bar.high = price;
+                bar.low = price;
+                bar.volume = 0.0;
+                bar.notional = 0.0;
+                bar.trade_count = 0;
+            }
+
+            // Late prints for an earlier period than the open bar's are folded
+            // into the open bar
+            bar.high = std::max(bar.high, price);
+            bar.low = std::min(bar.low, price);
+            bar.close = price;
+            bar.volume += size;
+            bar.notional += price * size;
+            bar.trade_count++;
+        }
+        enqueueLocked(closed);
+    }
+
+    deliverPending();
+}
+
+void BarAggregator::advanceTo(std::chrono::system_clock::time_point now) {
+    std::vector<Bar> closed;
+    {
+        std::lock_guard<std::mutex> lock(bars_mutex_);
+        advanceLocked(toMillis(now), closed);
+        enqueueLocked(closed);
+    }
+
+    deliverPending();
+}
+
+void BarAggregator::advanceLocked(int64_t now_ms, std::vector<Bar>& closed) {
+    for (size_t tf = 0; tf < TIMEFRAME_COUNT; ++tf) {
+        auto& slot = wheel_[tf];
+        if (now_ms < slot.next_boundary_ms) {
+            continue;
+        }
+
+        // Bars still open after the sweep end after now_ms
+        auto& open_bars = slot.open_bars;
+        int64_t next_boundary = periodStart(now_ms, TIMEFRAME_MS[tf]) + TIMEFRAME_MS[tf];
+        size_t kept = 0;
+        for (size_t i = 0; i < open_bars.size(); ++i) {
+            auto* state = open_bars[i];
+            auto& bar = state->open[tf];
+            if (bar.active && bar.start_ms + TIMEFRAME_MS[tf] <= now_ms) {
+                closeBar(*state, tf, closed);
+            }
+            if (bar.active) {
+                open_bars[kept++] = state;
+                next_boundary = std::min(next_boundary, bar.start_ms + TIMEFRAME_MS[tf]);
+            } else {
+                state->in_wheel[tf] = false;
+            }
+        }
+        open_bars.resize(kept);
+        slot.next_boundary_ms = next_boundary;
+    }
+}
+
+void BarAggregator::closeBar(InstrumentBars& state, size_t tf, std::vector<Bar>& closed) {
+    auto& open = state.open[tf];
+
+    Bar bar;
+    bar.instrument = state.instrument;
+    bar.timeframe = static_cast<Timeframe>(tf);
+    bar.open_time = fromMillis(open.start_ms);
+    bar.close_time = fromMillis(open.start_ms + TIMEFRAME_MS[tf]);
+    bar.open = open.open;
+    bar.high = open.high;
+    bar.low = open.low;
+    bar.close = open.close;
+    bar.volume = open.volume;
+    bar.vwap = open.volume > 0.0 ? open.notional / open.volume : open.close;
+    bar.trade_count = open.trade_count;
+
+    auto& ring = state.history[tf];
+    if (ring.bars.size() != history_size_) {
+        ring.bars.resize(history_size_);
+    }
+    ring.bars[ring.next] = bar;
+    ring.next = (ring.next + 1) % ring.bars.size();
+    ring.count = std::min(ring.count + 1, ring.bars.size());
+
+    open.active = false;
+    state.closed_until_ms[tf] = open.start_ms + TIMEFRAME_MS[tf];
+    closed.push_back(std::move(bar));
+}
+
+std::vector<BarAggregator::Bar> BarAggregator::getHistory(const std::string& instrument, Timeframe timeframe,
+                                                          size_t count) const {
+    std::lock_guard<std::mutex> lock(bars_mutex_);
+    std::vector<Bar> result;
+
+    auto it = instruments_.find(instrument);
+    if (it == instruments_.end()) {
+        return result;
+    }
+
+    const auto& ring = it->second.history[static_cast<size_t>(timeframe)];
+    size_t n = std::min(count, ring.count);
+    result.reserve(n);
+    for (size_t i = n; i > 0; --i) {
+        size_t index = (ring.next + ring.bars.size() - i) % ring.bars.size();
+        result.push_back(ring.bars[index]);
+    }
+    return result;
+}
+
+bool BarAggregator::getOpenBar(const std::string& instrument, Timeframe timeframe, Bar& bar) const {
+    std::lock_guard<std::mutex> lock(bars_mutex_);
+
+    auto it = instruments_.find(instrument);
+    if (it == instruments_.end()) {
+        return false;
+    }
+
+    size_t tf = static_cast<size_t>(timeframe);
+    const auto& open = it->second.open[tf];
+    if (!open.active) {
+        return false;
+    }
+
+    bar.instrument = instrument;
+    bar.timeframe = timeframe;
+    bar.open_time = fromMillis(open.start_ms);
+    bar.close_time = fromMillis(open.start_ms + TIMEFRAME_MS[tf]);
+    bar.open = open.open;
+    bar.high = open.high;
+    bar.low = open.low;
+    bar.close = open.close;
+    bar.volume = open.volume;
+    bar.vwap = open.volume > 0.0 ? open.notional / open.volume : open.close;
+    bar.trade_count = open.trade_count;
+    return true;
+}
+
+void BarAggregator::subscribeToBars(const std::string& instrument, Timeframe timeframe, BarCallback callback) {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    subscribers_[instrument].emplace_back(timeframe, std::move(callback));
+}
+
+void BarAggregator::unsubscribeFromBars(const std::string& instrument) {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    subscribers_.erase(instrument);
+}
+
+void BarAggregator::enqueueLocked(std::vector<Bar>& closed) {
+    for (auto& bar : closed) {
+        pending_bars_.push_back(std::move(bar));
+    }
+    closed.clear();
+}
+
+void BarAggregator::deliverPending() {
+    std::vector<Bar> batch;
+    {
+        std::lock_guard<std::mutex> lock(bars_mutex_);
+        // The thread already delivering picks up these bars after its own,
+        // which keeps delivery in close order, including for bars closed by
+        // a subscriber's own trades
+        if (delivering_ || pending_bars_.empty()) {
+            return;
+        }
+        delivering_ = true;
+    }
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(bars_mutex_);
+            if (pending_bars_.empty()) {
+                delivering_ = false;
+                return;
+            }
+            batch.assign(std::make_move_iterator(pending_bars_.begin()),
+                         std::make_move_iterator(pending_bars_.end()));
+            pending_bars_.clear();
+        }
+        notifySubscribers(batch);
+    }
+}
+
+void BarAggregator::notifySubscribers(const std::vector<Bar>& closed) {
+    // Copied so callbacks run unlocked and may subscribe or unsubscribe
+    std::vector<std::pair<const Bar*, BarCallback>> calls;
+    {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        if (subscribers_.empty()) {
+            return;
+        }
+        for (const auto& bar : closed) {
+            auto it = subscribers_.find(bar.instrument);
+            if (it == subscribers_.end()) {
+                continue;
+            }
+            for (const auto& [timeframe, callback] : it->second) {
+                if (timeframe == bar.timeframe) {
+                    calls.emplace_back(&bar, callback);
+                }
+            }
+        }
+    }
+
+    for (const auto& [bar, callback] : calls) {
+        try {
+            callback(*bar);
+        } catch (...) {
+            // Prevent subscriber exceptions from affecting other subscribers
+        }
+    }
+}
+
+void BarAggregator::saveSnapshot(SnapshotWriter& writer) const {
+    struct Saved {
+        std::string instrument;
+        OpenBar open[TIMEFRAME_COUNT];
+        std::vector<Bar> history[TIMEFRAME_COUNT];
+    };
+
+    std::vector<Saved> saved;
+    int64_t latest_ms = 0;
+    {
+        std::lock_guard<std::mutex> lock(bars_mutex_);
+        saved.reserve(instruments_.size());
+        for (const auto& [instrument, state] : instruments_) {
+            // The shortest timeframe's bar is within a second of the last
+            // trade, and bars only move on exchange time
+            latest_ms = std::max(latest_ms, state.open[0].active ? state.open[0].start_ms
+                                                                 : state.closed_until_ms[0]);
+            Saved entry;
+            entry.instrument = instrument;
+            for (size_t tf = 0; tf < TIMEFRAME_COUNT; ++tf) {
+                entry.open[tf] = state.open[tf];
+                const auto& ring = state.history[tf];
+                entry.history[tf].reserve(ring.count);
+                for (size_t i = ring.count; i > 0; --i) {
+                    entry.history[tf].push_back(ring.bars[(ring.next + ring.bars.size() - i) % ring.bars.size()]);
+                }
+            }
+            saved.push_back(std::move(entry));
+        }
+    }
+
+    if (latest_ms > 0) {
+        writer.noteDataTime(fromMillis(latest_ms));
+    }
+    writer.putU32(static_cast<uint32_t>(saved.size()));
+    for (const auto& entry : saved) {
+        writer.putString(entry.instrument);
+        for (size_t tf = 0; tf < TIMEFRAME_COUNT; ++tf) {
+            const auto& open = entry.open[tf];
+            writer.putBool(open.active);
+            writer.putI64(open.start_ms);
+            writer.putDouble(open.open);
+            writer.putDouble(open.high);
+            writer.putDouble(open.low);
+            writer.putDouble(open.close);
+            writer.putDouble(open.volume);
+            writer.putDouble(open.notional);
+            writer.putU32(open.trade_count);
+
+            // Oldest first
+            writer.putU32(static_cast<uint32_t>(entry.history[tf].size()));
+            for (const auto& bar : entry.history[tf]) {
+                writer.putI64(toMillis(bar.open_time));
+                writer.putDouble(bar.open);
+                writer.putDouble(bar.high);
+                writer.putDouble(bar.low);
+                writer.putDouble(bar.close);
+                writer.putDouble(bar.volume);
+                writer.putDouble(bar.vwap);
+                writer.putU32(bar.trade_count);
+            }
+        }
+    }
+}
+
+void BarAggregator::restoreSnapshot(SnapshotReader& reader) {
+    struct Loaded {
+        std::string instrument;
+        OpenBar open[TIMEFRAME_COUNT];
+        std::vector<Bar> history[TIMEFRAME_COUNT];
+    };
+
+    std::vector<Loaded> loaded(reader.getCount(4));
+    for (auto& entry : loaded) {
+        entry.instrument = reader.getString();
+        for (size_t tf = 0; tf < TIMEFRAME_COUNT; ++tf) {
+            auto& open = entry.open[tf];
+            open.active = reader.getBool();
+            open.start_ms = reader.getI64();
+            open.open = reader.getDouble();
+            open.high = reader.getDouble();
+            open.low = reader.getDouble();
+            open.close = reader.getDouble();
+            open.volume = reader.getDouble();
+            open.notional = reader.getDouble();
+            open.trade_count = reader.getU32();
+
+            entry.history[tf].resize(reader.getCount(60));
+            for (auto& bar : entry.history[tf]) {
+                const int64_t open_ms = reader.getI64();
+                bar.instrument = entry.instrument;
+                bar.timeframe = static_cast<Timeframe>(tf);
+                bar.open_time = fromMillis(open_ms);
+                bar.close_time = fromMillis(open_ms + TIMEFRAME_MS[tf]);
+                bar.open = reader.getDouble();
+                bar.high = reader.getDouble();
+                bar.low = reader.getDouble();
+                bar.close = reader.getDouble();
+                bar.volume = reader.getDouble();
+                bar.vwap = reader.getDouble();
+                bar.trade_count = reader.getU32();
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(bars_mutex_);
+    for (auto& entry : loaded) {
+        auto [it, inserted] = instruments_.try_emplace(entry.instrument);
+        if (!inserted) {
+            continue;  // Live trades already started this instrument
+        }
+        auto& state = it->second;
+        state.instrument = entry.instrument;
+
+        for (size_t tf = 0; tf < TIMEFRAME_COUNT; ++tf) {
+            state.open[tf] = entry.open[tf];
+            if (state.open[tf].active) {
+                wheel_[tf].open_bars.push_back(&state);
+                state.in_wheel[tf] = true;
+                wheel_[tf].next_boundary_ms = std::min(wheel_[tf].next_boundary_ms,
+                                                       state.open[tf].start_ms + TIMEFRAME_MS[tf]);
+            }
+
+            // Keep the newest bars that fit the current history size
+            auto& bars = entry.history[tf];
+            if (!bars.empty()) {
+                state.closed_until_ms[tf] = toMillis(bars.back().close_time);
+            }
+            const size_t keep = std::min(bars.size(), history_size_);
+            if (keep == 0) {
+                continue;
+            }
+            auto& ring = state.history[tf];
+            ring.bars.resize(history_size_);
+            std::move(bars.end() - keep, bars.end(), ring.bars.begin());
+            ring.count = keep;
+            ring.next = keep % history_size_;
+        }
+    }
+}
@@ -0,0 +1,135 @@
+#ifndef BAR_AGGREGATOR_H
+#define BAR_AGGREGATOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Incremental OHLCV+VWAP bars built from the trade stream. Each trade updates
+// the open bar of every timeframe in O(1). Bars close on exchange time, never
+// the wall clock: a trade's timestamp closes every instrument's bars whose
+// period has ended, and advanceTo() does the same for timestamps that carry
+// no trade, such as book updates. Times may arrive out of order: a trade
+// for a period that has already closed is folded into the next bar, so
+// closed bars are emitted in open_time order. Subscribers are called outside
+// every lock, one closing thread at a time, in the order bars closed.
+class BarAggregator {
+public:
+    enum class Timeframe : uint8_t {
+        SECOND_1,
+        MINUTE_1,
+        MINUTE_5,
+        HOUR_1
+    };
+
+    static constexpr size_t TIMEFRAME_COUNT = 4;
+
+    struct Bar {
+        std::string instrument;
+        Timeframe timeframe;
+        std::chrono::system_clock::time_point open_time;
+        std::chrono::system_clock::time_point close_time;
+        double open;
+        double high;
+        double low;
+        double close;
+        double volume;
+        double vwap;
+        uint32_t trade_count;
+    };
+
+    using BarCallback = std::function<void(const Bar&)>;
+
+    static BarAggregator& getInstance() {
+        static BarAggregator instance;
+        return instance;
+    }
+
+    static std::chrono::milliseconds getDuration(Timeframe timeframe);
+
+    void setHistorySize(size_t bars_per_timeframe);
+    void onTrade(const std::string& instrument, double price, double size,
+                 std::chrono::system_clock::time_point timestamp);
+    void advanceTo(std::chrono::system_clock::time_point now);
+
+    std::vector<Bar> getHistory(const std::string& instrument, Timeframe timeframe, size_t count = 100) const;
+    bool getOpenBar(const std::string& instrument, Timeframe timeframe, Bar& bar) const;
+
+    void subscribeToBars(const std::string& instrument, Timeframe timeframe, BarCallback callback);
+    void unsubscribeFromBars(const std::string& instrument);
+
+    // Open bars and bar history; instruments that already have live bars
+    // are left alone on restore
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+    void saveSnapshot(SnapshotWriter& writer) const;
+    void restoreSnapshot(SnapshotReader& reader);
+
+private:
+    BarAggregator();
+    ~BarAggregator() = default;
+    BarAggregator(const BarAggregator&) = delete;
+    BarAggregator& operator=(const BarAggregator&) = delete;
+
+    struct OpenBar {
+        int64_t start_ms{0};
+        double open{0.0};
+        double high{0.0};
+        double low{0.0};
+        double close{0.0};
+        double volume{0.0};
+        double notional{0.0};
+        uint32_t trade_count{0};
+        bool active{false};
+    };
+
+    struct BarRing {
+        std::vector<Bar> bars;
+        size_t next{0};
+        size_t count{0};
+    };
+
+    struct InstrumentBars {
+        std::string instrument;
+        OpenBar open[TIMEFRAME_COUNT];
+        BarRing history[TIMEFRAME_COUNT];
+        bool in_wheel[TIMEFRAME_COUNT]{};
+        // End of the last closed bar; later bars never start before it
+        int64_t closed_until_ms[TIMEFRAME_COUNT]{};
+    };
+
+    // One wheel slot per timeframe. next_boundary_ms is a lower bound on the
+    // end of every open bar in the slot, so times before it skip the scan.
+    struct WheelSlot {
+        int64_t next_boundary_ms{0};
+        std::vector<InstrumentBars*> open_bars;
+    };
+
+    void advanceLocked(int64_t now_ms, std::vector<Bar>& closed);
+    void closeBar(InstrumentBars& state, size_t tf, std::vector<Bar>& closed);
+    // Queues closed bars for delivery; requires bars_mutex_
+    void enqueueLocked(std::vector<Bar>& closed);
+    // Delivers queued bars unless another thread already is
+    void deliverPending();
+    void notifySubscribers(const std::vector<Bar>& closed);
+
+    mutable std::mutex bars_mutex_;
+    std::unordered_map<std::string, InstrumentBars> instruments_;
+    WheelSlot wheel_[TIMEFRAME_COUNT];
+    size_t history_size_{500};
+    std::deque<Bar> pending_bars_;
+    bool delivering_{false};
+
+    std::mutex subscribers_mutex_;
+    std::map<std::string, std::vector<std::pair<Timeframe, BarCallback>>> subscribers_;
+};
+
+#endif // BAR_AGGREGATOR_H
@@ -0,0 +1,108 @@
+#include "bar_aggregator.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Times are fixed exchange timestamps well away from the wall clock, which
+// the aggregator must never consult
+class BarAggregatorTest : public ::testing::Test {
+protected:
+    using Clock = std::chrono::system_clock;
+
+    static Clock::time_point at(int64_t ms) {
+        return base() + std::chrono::milliseconds(ms);
+    }
+
+    // An hour boundary in 2021
+    static Clock::time_point base() {
+        return Clock::time_point(std::chrono::hours(450000));
+    }
+
+    static size_t closedSeconds(const std::string& instrument) {
+        return BarAggregator::getInstance().getHistory(instrument, BarAggregator::Timeframe::SECOND_1).size();
+    }
+};
+
+TEST_F(BarAggregatorTest, TradeTimeClosesEveryInstrumentsBars) {
+    auto& bars = BarAggregator::getInstance();
+    bars.onTrade("BAR-QUIET", 100.0, 1.0, at(100));
+    bars.onTrade("BAR-QUIET", 101.0, 2.0, at(900));
+    EXPECT_EQ(closedSeconds("BAR-QUIET"), 0u);
+
+    // Another instrument's print in the next second ends the quiet one's bar
+    bars.onTrade("BAR-BUSY", 50.0, 1.0, at(1500));
+    auto closed = bars.getHistory("BAR-QUIET", BarAggregator::Timeframe::SECOND_1);
+    ASSERT_EQ(closed.size(), 1u);
+    EXPECT_EQ(closed[0].open_time, at(0));
+    EXPECT_EQ(closed[0].close_time, at(1000));
+    EXPECT_DOUBLE_EQ(closed[0].volume, 3.0);
+    EXPECT_DOUBLE_EQ(closed[0].close, 101.0);
+
+    BarAggregator::Bar minute;
+    EXPECT_TRUE(bars.getOpenBar("BAR-QUIET", BarAggregator::Timeframe::MINUTE_1, minute));
+    EXPECT_EQ(closedSeconds("BAR-BUSY"), 0u);
+}
+
+TEST_F(BarAggregatorTest, EarlierTimesStillCloseBars) {
+    auto& bars = BarAggregator::getInstance();
+
+    // A clock far ahead must not stop bars opened at earlier times closing
+    bars.advanceTo(at(7200000));
+    bars.onTrade("BAR-LATE", 10.0, 1.0, at(200));
+    EXPECT_EQ(closedSeconds("BAR-LATE"), 0u);
+
+    bars.advanceTo(at(999));
+    EXPECT_EQ(closedSeconds("BAR-LATE"), 0u);
+    bars.advanceTo(at(1000));
+    EXPECT_EQ(closedSeconds("BAR-LATE"), 1u);
+}
+
+TEST_F(BarAggregatorTest, LateTradeDoesNotReopenClosedPeriod) {
+    auto& bars = BarAggregator::getInstance();
+    const auto second = BarAggregator::Timeframe::SECOND_1;
+    std::vector<BarAggregator::Bar> emitted;
+    bars.subscribeToBars("BAR-REORDER", second, [&](const BarAggregator::Bar& bar) { emitted.push_back(bar); });
+
+    bars.onTrade("BAR-REORDER", 100.0, 1.0, at(2100));
+    bars.advanceTo(at(3000));
+    ASSERT_EQ(emitted.size(), 1u);
+
+    // A print from the closed second lands in the next bar, not a new
+    // bar behind the one already emitted
+    bars.onTrade("BAR-REORDER", 99.0, 2.0, at(2500));
+    BarAggregator::Bar open;
+    ASSERT_TRUE(bars.getOpenBar("BAR-REORDER", second, open));
+    EXPECT_EQ(open.open_time, at(3000));
+    EXPECT_DOUBLE_EQ(open.volume, 2.0);
+
+    bars.advanceTo(at(4000));
+    ASSERT_EQ(emitted.size(), 2u);
+    EXPECT_GT(emitted[1].open_time, emitted[0].open_time);
+    EXPECT_DOUBLE_EQ(emitted[0].volume + emitted[1].volume, 3.0);
+    bars.unsubscribeFromBars("BAR-REORDER");
+}
+
+TEST_F(BarAggregatorTest, SubscribersMayTradeAndSubscribe) {
+    auto& bars = BarAggregator::getInstance();
+    const auto second = BarAggregator::Timeframe::SECOND_1;
+    std::vector<int64_t> emitted;
+    bool subscribed = false;
+    bars.subscribeToBars("BAR-REENTRANT", second, [&](const BarAggregator::Bar& bar) {
+        emitted.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(bar.open_time - base()).count());
+        if (!subscribed) {
+            // Both would deadlock if callbacks ran under the aggregator's locks
+            subscribed = true;
+            bars.subscribeToBars("BAR-REENTRANT-OTHER", second, [](const BarAggregator::Bar&) {});
+            bars.onTrade("BAR-REENTRANT", 1.0, 1.0, at(6100));
+        }
+    });
+
+    bars.onTrade("BAR-REENTRANT", 1.0, 1.0, at(5100));
+    bars.advanceTo(at(6000));
+    ASSERT_TRUE(subscribed);
+    bars.advanceTo(at(7000));
+    EXPECT_EQ(emitted, (std::vector<int64_t>{5000, 6000}));
+    bars.unsubscribeFromBars("BAR-REENTRANT");
+    bars.unsubscribeFromBars("BAR-REENTRANT-OTHER");
+}
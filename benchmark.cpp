@@ -1,4 +1,5 @@
 #include "benchmark.h"
+#include "svg_plot.h"
 #include <algorithm>
 #include <numeric>
 #include <thread>
@@ -10,6 +11,50 @@
 #include <sysinfoapi.h>
 #include <psapi.h>
 
+namespace {
+
+struct LatencyWindow {
+    double start_s;
+    double throughput;  // Completions per second
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+};
+
+double sortedPercentile(const std::vector<double>& sorted, double q) {
+    return sorted.empty() ? 0.0 : sorted[static_cast<size_t>((sorted.size() - 1) * q)];
+}
+
+// Splits the run into equal time windows and summarises each non-empty one
+std::vector<LatencyWindow> windowLatencies(const std::vector<double>& latencies,
+                                           const std::vector<double>& completion_s,
+                                           size_t window_count) {
+    std::vector<LatencyWindow> windows;
+    // Results loaded from file carry no completion times
+    if (latencies.empty() || completion_s.size() != latencies.size() || window_count == 0) {
+        return windows;
+    }
+
+    auto [first, last] = std::minmax_element(completion_s.begin(), completion_s.end());
+    const double width = std::max((*last - *first) / window_count, 1e-3);
+    std::vector<std::vector<double>> buckets(window_count);
+    for (size_t i = 0; i < latencies.size(); ++i) {
+        size_t bucket = std::min(window_count - 1, static_cast<size_t>((completion_s[i] - *first) / width));
+        buckets[bucket].push_back(latencies[i]);
+    }
+
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        auto& bucket = buckets[b];
+        if (bucket.empty()) continue;
+        std::sort(bucket.begin(), bucket.end());
+        windows.push_back({*first + b * width, bucket.size() / width,
+                           sortedPercentile(bucket, 0.50), sortedPercentile(bucket, 0.99), bucket.back()});
+    }
+    return windows;
+}
+
+}  // namespace
+
 Benchmark::Benchmark() = default;
 
 Benchmark::~Benchmark() {
@@ -34,6 +79,7 @@ void Benchmark::endOperation(const std::string& name, bool success) {
             end_time - it->second.start_time).count() / 1000.0; // Convert to milliseconds
         
         it->second.latencies.push_back(duration);
+        it->second.completion_times.push_back(end_time);
         if (success) {
             it->second.success_count++;
         } else {
@@ -204,6 +250,51 @@ void Benchmark::enableRealTimeMonitoring(bool enable) {
     real_time_monitoring_ = enable;
 }
 
+// Raw latency samples are stored, not just summaries, so that runs can be
+// compared distribution against distribution (see benchmark_compare.h)
+void Benchmark::saveResults(const std::string& filename) {
+    nlohmann::json j;
+    {
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        j["timestamp"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        j["operations"] = nlohmann::json::object();
+        for (const auto& [name, operation] : operations_) {
+            j["operations"][name] = {
+                {"latencies_ms", operation.latencies},
+                {"success_count", operation.success_count},
+                {"error_count", operation.error_count}
+            };
+        }
+    }
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+    file << j.dump();
+}
+
+void Benchmark::loadResults(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open benchmark results: " + filename);
+    }
+    nlohmann::json j;
+    file >> j;
+
+    std::map<std::string, OperationData> loaded;
+    for (const auto& [name, operation] : j.at("operations").items()) {
+        auto& data = loaded[name];
+        data.latencies = operation.at("latencies_ms").get<std::vector<double>>();
+        data.success_count = operation.value("success_count", 0);
+        data.error_count = operation.value("error_count", 0);
+    }
+
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    operations_ = std::move(loaded);
+}
+
 void Benchmark::generateReport(const std::string& filename) {
     std::ofstream file(filename);
     if (!file.is_open()) {
@@ -229,11 +320,117 @@ void Benchmark::generateReport(const std::string& filename) {
     }
 }
 
+std::map<std::string, std::vector<double>> Benchmark::getLatencySamples() const {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    std::map<std::string, std::vector<double>> samples;
+    for (const auto& [name, operation] : operations_) {
+        samples[name] = operation.latencies;
+    }
+    return samples;
+}
+
 void Benchmark::plotMetrics(const std::string& output_dir) {
-    // Create output directory if it doesn't exist
+    struct Snapshot {
+        std::vector<double> latencies;
+        std::vector<double> completion_s;
+    };
+
+    // Copy under the lock, render without it
+    std::map<std::string, Snapshot> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        auto origin = std::chrono::steady_clock::time_point::max();
+        for (const auto& [_, operation] : operations_) {
+            if (!operation.completion_times.empty()) {
+                origin = std::min(origin, operation.completion_times.front());
+            }
+        }
+        for (const auto& [name, operation] : operations_) {
+            auto& copy = snapshot[name];
+            copy.latencies = operation.latencies;
+            copy.completion_s.reserve(operation.completion_times.size());
+            for (const auto& t : operation.completion_times) {
+                copy.completion_s.push_back(std::chrono::duration<double>(t - origin).count());
+            }
+        }
+    }
+
     std::filesystem::create_directories(output_dir);
-    
-    // Generate plots using a plotting library (placeholder)
-    // In a real implementation, this would use a library like gnuplot or matplotlib
-    // to create visualizations of the metrics
+
+    std::ostringstream summary;
+    summary << "<h2>Summary (ms)</h2>\n<table>\n<tr><th>Operation</th><th>Count</th><th>Min</th><th>P50</th>"
+            << "<th>P90</th><th>P99</th><th>P99.9</th><th>Max</th></tr>\n";
+
+    svg_plot::Chart spectrum;
+    spectrum.title = "Latency by percentile";
+    spectrum.x_label = "Percentile";
+    spectrum.y_label = "Latency (ms)";
+    spectrum.log_y = true;
+
+    std::vector<std::string> operation_sections;
+    for (auto& [name, data] : snapshot) {
+        if (data.latencies.empty()) continue;
+        std::vector<double> sorted = data.latencies;
+        std::sort(sorted.begin(), sorted.end());
+
+        summary << "<tr><td>" << svg_plot::escape(name) << "</td><td>" << sorted.size() << "</td>"
+                << std::fixed << std::setprecision(3)
+                << "<td>" << sorted.front() << "</td><td>" << sortedPercentile(sorted, 0.50) << "</td>"
+                << "<td>" << sortedPercentile(sorted, 0.90) << "</td><td>" << sortedPercentile(sorted, 0.99) << "</td>"
+                << "<td>" << sortedPercentile(sorted, 0.999) << "</td><td>" << sorted.back() << "</td></tr>\n"
+                << std::defaultfloat;
+
+        std::string section = "<h2>" + svg_plot::escape(name) + "</h2>\n";
+
+        svg_plot::Chart histogram;
+        histogram.title = "Latency distribution";
+        histogram.x_label = "Latency (ms, log scale)";
+        histogram.y_label = "Count";
+        section += svg_plot::renderHistogram(histogram, svg_plot::logHistogram(sorted));
+
+        auto windows = windowLatencies(data.latencies, data.completion_s, 60);
+        svg_plot::Chart over_time;
+        over_time.title = "Percentiles over time";
+        over_time.x_label = "Time since start (s)";
+        over_time.y_label = "Latency (ms)";
+        over_time.log_y = true;
+        over_time.series = {{"p50", {}, {}}, {"p99", {}, {}}, {"max", {}, {}}};
+        for (const auto& w : windows) {
+            for (auto& series : over_time.series) series.x.push_back(w.start_s);
+            over_time.series[0].y.push_back(w.p50_ms);
+            over_time.series[1].y.push_back(w.p99_ms);
+            over_time.series[2].y.push_back(w.max_ms);
+        }
+        section += svg_plot::renderLines(over_time);
+
+        std::sort(windows.begin(), windows.end(),
+                  [](const LatencyWindow& a, const LatencyWindow& b) { return a.throughput < b.throughput; });
+        svg_plot::Chart load;
+        load.title = "Throughput vs latency (per window)";
+        load.x_label = "Throughput (ops/s)";
+        load.y_label = "Latency (ms)";
+        load.log_y = true;
+        load.series = {{"p50", {}, {}}, {"p99", {}, {}}};
+        for (const auto& w : windows) {
+            load.series[0].x.push_back(w.throughput);
+            load.series[1].x.push_back(w.throughput);
+            load.series[0].y.push_back(w.p50_ms);
+            load.series[1].y.push_back(w.p99_ms);
+        }
+        section += svg_plot::renderLines(load);
+        operation_sections.push_back(section);
+
+        spectrum.series.push_back({name, {}, std::move(sorted)});
+    }
+    summary << "</table>\n";
+
+    std::vector<std::string> sections{summary.str(), svg_plot::renderPercentiles(spectrum)};
+    sections.insert(sections.end(), operation_sections.begin(), operation_sections.end());
+
+    const std::string filename = (std::filesystem::path(output_dir) / "latency_report.html").string();
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+    file << svg_plot::page("Benchmark Latency Report", sections);
 } 
\ No newline at end of file
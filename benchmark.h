@@ -67,6 +67,8 @@ public:
     
     void saveResults(const std::string& filename);
     void loadResults(const std::string& filename);
+    // Copy of the raw latency samples (ms) per operation
+    std::map<std::string, std::vector<double>> getLatencySamples() const;
     
     LatencyMetrics getLatencyMetrics(const std::string& operation_name) const;
     ResourceMetrics getCurrentResourceMetrics() const;
@@ -75,6 +77,9 @@ public:
     void enableRealTimeMonitoring(bool enable);
     
     void generateReport(const std::string& filename);
+    // Writes a self-contained latency_report.html into output_dir: latency
+    // histograms, percentile spectra, percentiles over time and throughput
+    // against latency, all rendered from a snapshot outside the lock
     void plotMetrics(const std::string& output_dir);
 
 private:
@@ -97,6 +102,7 @@ private:
 
     struct OperationData {
         std::vector<double> latencies;
+        std::vector<std::chrono::steady_clock::time_point> completion_times;  // Parallel to latencies
         int success_count{0};
         int error_count{0};
         std::chrono::steady_clock::time_point start_time;
@@ -0,0 +1,196 @@
+#include "benchmark_compare.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+double quantileOfSorted(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    return sorted[static_cast<size_t>((sorted.size() - 1) * q)];
+}
+
+// Selects in place; the order of values is not preserved
+double quantileInPlace(std::vector<double>& values, double q) {
+    auto nth = values.begin() + static_cast<std::ptrdiff_t>((values.size() - 1) * q);
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+double changePct(double baseline, double current) {
+    if (baseline == 0.0) {
+        return current == 0.0 ? 0.0 : INFINITY;
+    }
+    return 100.0 * (current - baseline) / baseline;
+}
+
+}  // namespace
+
+BenchmarkComparator::BenchmarkComparator() : BenchmarkComparator(Config()) {}
+
+BenchmarkComparator::BenchmarkComparator(const Config& config) : config_(config) {
+    if (config_.percentile < 0.0 || config_.percentile > 1.0 ||
+        config_.confidence <= 0.0 || config_.confidence >= 1.0 ||
+        config_.bootstrap_samples == 0) {
+        throw std::invalid_argument("Invalid benchmark comparison configuration");
+    }
+}
+
+BenchmarkComparator::Samples BenchmarkComparator::loadSamples(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open benchmark results: " + filename);
+    }
+    nlohmann::json j;
+    file >> j;
+
+    Samples samples;
+    for (const auto& [name, operation] : j.at("operations").items()) {
+        samples[name] = operation.at("latencies_ms").get<std::vector<double>>();
+    }
+    return samples;
+}
+
+BenchmarkComparator::MannWhitneyResult BenchmarkComparator::mannWhitney(const std::vector<double>& baseline,
+                                                                         const std::vector<double>& current) {
+    MannWhitneyResult result;
+    const size_t n1 = baseline.size();
+    const size_t n2 = current.size();
+    if (n1 == 0 || n2 == 0) {
+        return result;
+    }
+
+    // Rank the pooled samples, averaging ranks across ties
+    std::vector<std::pair<double, bool>> pooled;  // (value, is_current)
+    pooled.reserve(n1 + n2);
+    for (double v : baseline) pooled.emplace_back(v, false);
+    for (double v : current) pooled.emplace_back(v, true);
+    std::sort(pooled.begin(), pooled.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    const double n = static_cast<double>(n1 + n2);
+    double current_rank_sum = 0.0;
+    double tie_term = 0.0;
+    for (size_t i = 0; i < pooled.size();) {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) {
+            ++j;
+        }
+        const double average_rank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; ++k) {
+            if (pooled[k].second) {
+                current_rank_sum += average_rank;
+            }
+        }
+        const double t = static_cast<double>(j - i);
+        tie_term += t * t * t - t;
+        i = j;
+    }
+
+    result.u = current_rank_sum - n2 * (n2 + 1) / 2.0;
+    const double mean = n1 * n2 / 2.0;
+    const double variance = n1 * n2 / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0)));
+    if (variance <= 0.0) {
+        return result;  // Every value identical
+    }
+
+    // Continuity correction towards the mean
+    double diff = result.u - mean;
+    diff = diff > 0.0 ? std::max(0.0, diff - 0.5) : std::min(0.0, diff + 0.5);
+    result.z = diff / std::sqrt(variance);
+    result.p_value = std::erfc(std::abs(result.z) / std::sqrt(2.0));
+    return result;
+}
+
+std::pair<double, double> BenchmarkComparator::bootstrapTailChange(const std::vector<double>& baseline,
+                                                                   const std::vector<double>& current) const {
+    if (baseline.empty() || current.empty()) {
+        return {0.0, 0.0};
+    }
+
+    std::mt19937_64 rng(config_.seed);
+    std::uniform_int_distribution<size_t> pick_baseline(0, baseline.size() - 1);
+    std::uniform_int_distribution<size_t> pick_current(0, current.size() - 1);
+    std::vector<double> resample_baseline(baseline.size());
+    std::vector<double> resample_current(current.size());
+    std::vector<double> changes(config_.bootstrap_samples);
+
+    for (auto& change : changes) {
+        for (auto& v : resample_baseline) v = baseline[pick_baseline(rng)];
+        for (auto& v : resample_current) v = current[pick_current(rng)];
+        change = changePct(quantileInPlace(resample_baseline, config_.percentile),
+                           quantileInPlace(resample_current, config_.percentile));
+    }
+
+    std::sort(changes.begin(), changes.end());
+    const double tail = (1.0 - config_.confidence) / 2.0;
+    return {quantileOfSorted(changes, tail), quantileOfSorted(changes, 1.0 - tail)};
+}
+
+BenchmarkComparator::OperationComparison BenchmarkComparator::compareOperation(
+    const std::string& operation, const std::vector<double>& baseline, const std::vector<double>& current) const {
+    OperationComparison comparison;
+    comparison.operation = operation;
+    comparison.baseline_count = baseline.size();
+    comparison.current_count = current.size();
+    if (baseline.empty() || current.empty()) {
+        // A deleted or renamed benchmark must not pass silently; a new one
+        // has nothing to compare against
+        comparison.missing = true;
+        comparison.regression = !baseline.empty() && !config_.allow_missing;
+        return comparison;
+    }
+
+    std::vector<double> sorted_baseline = baseline;
+    std::vector<double> sorted_current = current;
+    std::sort(sorted_baseline.begin(), sorted_baseline.end());
+    std::sort(sorted_current.begin(), sorted_current.end());
+
+    comparison.baseline_median = quantileOfSorted(sorted_baseline, 0.5);
+    comparison.current_median = quantileOfSorted(sorted_current, 0.5);
+    comparison.baseline_tail = quantileOfSorted(sorted_baseline, config_.percentile);
+    comparison.current_tail = quantileOfSorted(sorted_current, config_.percentile);
+    comparison.median_change_pct = changePct(comparison.baseline_median, comparison.current_median);
+    comparison.tail_change_pct = changePct(comparison.baseline_tail, comparison.current_tail);
+
+    auto [ci_low, ci_high] = bootstrapTailChange(baseline, current);
+    comparison.tail_ci_low_pct = ci_low;
+    comparison.tail_ci_high_pct = ci_high;
+    comparison.mann_whitney = mannWhitney(baseline, current);
+
+    const bool shifted = comparison.mann_whitney.p_value < config_.alpha;
+    comparison.regression =
+        (shifted && comparison.mann_whitney.z > 0.0 && comparison.median_change_pct > config_.threshold_pct) ||
+        ci_low > config_.threshold_pct;
+    comparison.improvement = !comparison.regression &&
+        ((shifted && comparison.mann_whitney.z < 0.0 && comparison.median_change_pct < -config_.threshold_pct) ||
+         ci_high < -config_.threshold_pct);
+    return comparison;
+}
+
+std::vector<BenchmarkComparator::OperationComparison> BenchmarkComparator::compare(const Samples& baseline,
+                                                                                   const Samples& current) const {
+    static const std::vector<double> empty;
+    std::vector<OperationComparison> comparisons;
+
+    for (const auto& [operation, samples] : baseline) {
+        auto it = current.find(operation);
+        comparisons.push_back(compareOperation(operation, samples, it == current.end() ? empty : it->second));
+    }
+    for (const auto& [operation, samples] : current) {
+        if (!baseline.count(operation)) {
+            comparisons.push_back(compareOperation(operation, empty, samples));
+        }
+    }
+    return comparisons;
+}
+
+bool BenchmarkComparator::hasRegression(const std::vector<OperationComparison>& comparisons) {
+    return std::any_of(comparisons.begin(), comparisons.end(),
+                       [](const OperationComparison& c) { return c.regression; });
+}
@@ -0,0 +1,76 @@
+#ifndef BENCHMARK_COMPARE_H
+#define BENCHMARK_COMPARE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// Compares the latency distributions of two benchmark runs, as written by
+// Benchmark::saveResults. Each operation gets a Mann-Whitney U test on the
+// whole distribution and a bootstrapped confidence interval on the relative
+// change of a tail percentile. An operation regresses when either the body
+// shifts up significantly by more than the threshold, or the whole tail
+// confidence interval lies above the threshold. An operation the baseline
+// has but the current run lacks also fails, unless allow_missing is set.
+class BenchmarkComparator {
+public:
+    struct Config {
+        double threshold_pct{5.0};      // Smallest slowdown worth failing on
+        double alpha{0.01};             // Significance level for Mann-Whitney
+        double percentile{0.99};        // Tail percentile to bootstrap
+        double confidence{0.95};
+        size_t bootstrap_samples{2000};
+        uint64_t seed{42};
+        bool allow_missing{false};      // Baseline operations may be absent from the current run
+    };
+
+    struct MannWhitneyResult {
+        double u{0.0};        // U statistic of the second sample
+        double z{0.0};        // Positive when the second sample tends to be larger
+        double p_value{1.0};  // Two-sided, normal approximation with tie correction
+    };
+
+    struct OperationComparison {
+        std::string operation;
+        size_t baseline_count{0};
+        size_t current_count{0};
+        double baseline_median{0.0};
+        double current_median{0.0};
+        double baseline_tail{0.0};
+        double current_tail{0.0};
+        double median_change_pct{0.0};
+        double tail_change_pct{0.0};
+        double tail_ci_low_pct{0.0};
+        double tail_ci_high_pct{0.0};
+        MannWhitneyResult mann_whitney;
+        bool regression{false};
+        bool improvement{false};
+        bool missing{false};  // Present in only one of the runs; regression when only in the baseline
+    };
+
+    using Samples = std::map<std::string, std::vector<double>>;
+
+    BenchmarkComparator();
+    explicit BenchmarkComparator(const Config& config);
+
+    // Reads the latency samples per operation from a saveResults file
+    static Samples loadSamples(const std::string& filename);
+
+    static MannWhitneyResult mannWhitney(const std::vector<double>& baseline, const std::vector<double>& current);
+
+    // Percentile-bootstrap interval of 100 * (current_q - baseline_q) / baseline_q
+    std::pair<double, double> bootstrapTailChange(const std::vector<double>& baseline,
+                                                  const std::vector<double>& current) const;
+
+    OperationComparison compareOperation(const std::string& operation, const std::vector<double>& baseline,
+                                         const std::vector<double>& current) const;
+    std::vector<OperationComparison> compare(const Samples& baseline, const Samples& current) const;
+
+    static bool hasRegression(const std::vector<OperationComparison>& comparisons);
+
+private:
+    Config config_;
+};
+
+#endif // BENCHMARK_COMPARE_H
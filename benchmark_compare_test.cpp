@@ -0,0 +1,130 @@
+#include "benchmark_compare.h"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+class BenchmarkCompareTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::filesystem::remove("test_compare_results.json");
+    }
+
+    static std::vector<double> lognormal(size_t count, double median_ms, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        std::lognormal_distribution<double> dist(std::log(median_ms), 0.25);
+        std::vector<double> samples(count);
+        for (auto& v : samples) v = dist(rng);
+        return samples;
+    }
+};
+
+TEST_F(BenchmarkCompareTest, MannWhitneyIdenticalDistributions) {
+    auto a = lognormal(2000, 1.0, 1);
+    auto b = lognormal(2000, 1.0, 2);
+    auto result = BenchmarkComparator::mannWhitney(a, b);
+    EXPECT_GT(result.p_value, 0.01);
+}
+
+TEST_F(BenchmarkCompareTest, MannWhitneyDetectsShift) {
+    auto a = lognormal(2000, 1.0, 1);
+    auto b = lognormal(2000, 1.1, 2);
+    auto result = BenchmarkComparator::mannWhitney(a, b);
+    EXPECT_LT(result.p_value, 1e-6);
+    EXPECT_GT(result.z, 0.0);
+
+    auto reversed = BenchmarkComparator::mannWhitney(b, a);
+    EXPECT_LT(reversed.z, 0.0);
+}
+
+TEST_F(BenchmarkCompareTest, MannWhitneyHandlesTies) {
+    std::vector<double> a(100, 1.0);
+    std::vector<double> b(100, 1.0);
+    auto result = BenchmarkComparator::mannWhitney(a, b);
+    EXPECT_DOUBLE_EQ(result.p_value, 1.0);
+
+    // Small textbook case: U for the second sample counts pairs where it is larger
+    auto small = BenchmarkComparator::mannWhitney({1.0, 2.0, 3.0}, {2.0, 4.0, 5.0});
+    EXPECT_DOUBLE_EQ(small.u, 7.5);
+}
+
+TEST_F(BenchmarkCompareTest, FlagsRegressionAndImprovement) {
+    BenchmarkComparator::Config config;
+    config.bootstrap_samples = 500;
+    BenchmarkComparator comparator(config);
+
+    BenchmarkComparator::Samples baseline{
+        {"stable", lognormal(3000, 1.0, 1)},
+        {"slower", lognormal(3000, 1.0, 2)},
+        {"faster", lognormal(3000, 1.0, 3)}
+    };
+    BenchmarkComparator::Samples current{
+        {"stable", lognormal(3000, 1.0, 4)},
+        {"slower", lognormal(3000, 1.3, 5)},
+        {"faster", lognormal(3000, 0.7, 6)}
+    };
+
+    auto comparisons = comparator.compare(baseline, current);
+    ASSERT_EQ(comparisons.size(), 3u);
+    for (const auto& c : comparisons) {
+        if (c.operation == "slower") {
+            EXPECT_TRUE(c.regression);
+            EXPECT_GT(c.tail_ci_low_pct, 5.0);
+        } else if (c.operation == "faster") {
+            EXPECT_FALSE(c.regression);
+            EXPECT_TRUE(c.improvement);
+        } else {
+            EXPECT_FALSE(c.regression);
+            EXPECT_FALSE(c.improvement);
+            EXPECT_LT(c.tail_ci_low_pct, 0.0);
+            EXPECT_GT(c.tail_ci_high_pct, 0.0);
+        }
+    }
+    EXPECT_TRUE(BenchmarkComparator::hasRegression(comparisons));
+}
+
+TEST_F(BenchmarkCompareTest, SmallShiftBelowThresholdIsNotRegression) {
+    BenchmarkComparator::Config config;
+    config.threshold_pct = 20.0;
+    config.bootstrap_samples = 500;
+    BenchmarkComparator comparator(config);
+
+    auto comparison = comparator.compareOperation("op", lognormal(5000, 1.0, 1), lognormal(5000, 1.05, 2));
+    EXPECT_LT(comparison.mann_whitney.p_value, config.alpha);
+    EXPECT_FALSE(comparison.regression);
+}
+
+TEST_F(BenchmarkCompareTest, MissingOperations) {
+    BenchmarkComparator comparator;
+    auto comparisons = comparator.compare({{"old", {1.0, 2.0}}}, {{"new", {1.0, 2.0}}});
+    ASSERT_EQ(comparisons.size(), 2u);
+    EXPECT_TRUE(comparisons[0].missing);
+    EXPECT_TRUE(comparisons[1].missing);
+
+    // A benchmark dropped from the current run fails; a new one does not
+    EXPECT_TRUE(comparisons[0].regression);
+    EXPECT_FALSE(comparisons[1].regression);
+    EXPECT_TRUE(BenchmarkComparator::hasRegression(comparisons));
+
+    BenchmarkComparator::Config config;
+    config.allow_missing = true;
+    comparisons = BenchmarkComparator(config).compare({{"old", {1.0, 2.0}}}, {{"new", {1.0, 2.0}}});
+    EXPECT_FALSE(BenchmarkComparator::hasRegression(comparisons));
+}
+
+TEST_F(BenchmarkCompareTest, LoadsSavedResults) {
+    nlohmann::json j = {
+        {"timestamp", 0},
+        {"operations", {
+            {"place_order", {{"latencies_ms", {1.5, 2.5, 3.5}}, {"success_count", 3}, {"error_count", 0}}}
+        }}
+    };
+    std::ofstream("test_compare_results.json") << j.dump();
+
+    auto samples = BenchmarkComparator::loadSamples("test_compare_results.json");
+    ASSERT_EQ(samples.count("place_order"), 1u);
+    EXPECT_EQ(samples["place_order"], (std::vector<double>{1.5, 2.5, 3.5}));
+
+    EXPECT_THROW(BenchmarkComparator::loadSamples("does_not_exist.json"), std::runtime_error);
+}
@@ -0,0 +1,99 @@
+#include "benchmark_compare.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <baseline.json> <current.json>\n"
+              << "Options:\n"
+              << "  --threshold <pct>     Slowdown that counts as a regression, default 5\n"
+              << "  --alpha <p>           Mann-Whitney significance level, default 0.01\n"
+              << "  --percentile <q>      Tail percentile to bootstrap, default 0.99\n"
+              << "  --bootstrap <n>       Bootstrap resamples, default 2000\n"
+              << "  --allow-missing       Do not fail on baseline operations missing from the current run\n"
+              << "Exit status is 0 when no operation regressed, 1 on regression, 2 on error.\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchmarkComparator::Config config;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        try {
+            if (arg == "--threshold") {
+                config.threshold_pct = std::stod(next());
+            } else if (arg == "--alpha") {
+                config.alpha = std::stod(next());
+            } else if (arg == "--percentile") {
+                config.percentile = std::stod(next());
+            } else if (arg == "--bootstrap") {
+                config.bootstrap_samples = std::stoul(next());
+            } else if (arg == "--allow-missing") {
+                config.allow_missing = true;
+            } else if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (!arg.empty() && arg[0] == '-') {
+                throw std::invalid_argument("Unknown option " + arg);
+            } else {
+                files.push_back(arg);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (files.size() != 2) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    try {
+        BenchmarkComparator comparator(config);
+        auto comparisons = comparator.compare(BenchmarkComparator::loadSamples(files[0]),
+                                              BenchmarkComparator::loadSamples(files[1]));
+
+        const int tail_label = static_cast<int>(config.percentile * 100.0 + 0.5);
+        std::cout << std::left << std::setw(24) << "operation" << std::right
+                  << std::setw(12) << "median ms" << std::setw(10) << "change"
+                  << std::setw(11) << ("p" + std::to_string(tail_label) + " ms") << std::setw(10) << "change"
+                  << std::setw(22) << "tail CI" << std::setw(11) << "MW p" << "  verdict\n";
+
+        for (const auto& c : comparisons) {
+            std::cout << std::left << std::setw(24) << c.operation << std::right;
+            if (c.missing) {
+                std::cout << "  only in " << (c.baseline_count ? "baseline" : "current")
+                          << (c.regression ? "  REGRESSION" : "") << "\n";
+                continue;
+            }
+            std::cout << std::fixed << std::setprecision(3)
+                      << std::setw(12) << c.current_median
+                      << std::setprecision(1) << std::setw(9) << c.median_change_pct << '%'
+                      << std::setprecision(3) << std::setw(11) << c.current_tail
+                      << std::setprecision(1) << std::setw(9) << c.tail_change_pct << '%'
+                      << std::setw(10) << c.tail_ci_low_pct << "% .. " << std::setw(5) << c.tail_ci_high_pct << '%'
+                      << std::scientific << std::setprecision(2) << std::setw(11) << c.mann_whitney.p_value
+                      << std::defaultfloat << "  "
+                      << (c.regression ? "REGRESSION" : c.improvement ? "improved" : "ok") << "\n";
+        }
+
+        return BenchmarkComparator::hasRegression(comparisons) ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+}
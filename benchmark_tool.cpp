@@ -1,10 +1,23 @@
 #include "benchmark.h"
 #include "deribit_client.h"
+#include "order_template.h"
+#include "load_generator.h"
+#include "svg_plot.h"
+#include "static_strategy.h"
+#include "strategy_manager.h"
+#include "risk_manager.h"
+#include "config_manager.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <fstream>
+#include <limits>
 
 class BenchmarkRunner {
 public:
@@ -65,6 +78,228 @@ public:
         }
     }
 
+    void runStagedOrderBenchmark(int iterations = 1000000) {
+        std::cout << "Running staged order benchmark..." << std::endl;
+
+        OrderTemplate::Config config;
+        config.instrument = "BTC-PERPETUAL";
+        config.price_decimals = 1;
+        config.amount_decimals = 0;
+        config.post_only = true;
+        auto& slot = OrderTemplateManager::getInstance().stageSlot("benchmark", config);
+
+        // Decision-to-write: patch the staged frame and copy it into a buffer
+        // standing in for the socket write path. Timed in batches because a
+        // single iteration is shorter than the clock read itself.
+        const int batch_size = 1000;
+        std::vector<char> write_buffer(4096);
+        std::vector<double> batch_ns;
+        batch_ns.reserve(iterations / batch_size + 1);
+        uint64_t request_id = 1;
+        double price = 50000.0;
+
+        for (int done = 0; done < iterations; done += batch_size) {
+            auto batch_start = std::chrono::steady_clock::now();
+            for (int i = 0; i < batch_size; ++i) {
+                auto& order = (i & 1) ? slot.sell : slot.buy;
+                order.patch(request_id++, price + (i & 7) * 0.5, 10.0 + (i & 3) * 10.0);
+                std::memcpy(write_buffer.data(), order.data(), order.size());
+            }
+            auto batch_end = std::chrono::steady_clock::now();
+            batch_ns.push_back(std::chrono::duration<double, std::nano>(batch_end - batch_start).count() / batch_size);
+        }
+
+        std::sort(batch_ns.begin(), batch_ns.end());
+        double avg = std::accumulate(batch_ns.begin(), batch_ns.end(), 0.0) / batch_ns.size();
+        std::cout << "  Decision-to-write (ns/order):\n";
+        std::cout << "    Min: " << std::fixed << std::setprecision(1) << batch_ns.front() << "\n";
+        std::cout << "    Avg: " << avg << "\n";
+        std::cout << "    P99: " << batch_ns[(batch_ns.size() - 1) * 99 / 100] << "\n";
+        std::cout << "    Frame size: " << slot.buy.size() << " bytes\n";
+
+        OrderTemplateManager::getInstance().removeSlot("benchmark", config.instrument);
+    }
+
+    // Per-tick strategy overhead on the real feed path: a book update, then
+    // MarketDataManager::dispatch into StrategyManager::processMarketData,
+    // run once with the built-in evaluation and once with a composed
+    // strategy making the same decisions. Both pass the full risk check.
+    void runStrategyDispatchBenchmark(int iterations = 1000000) {
+        std::cout << "Running strategy dispatch benchmark..." << std::endl;
+
+        const std::string instrument = "BTC-PERPETUAL";
+        const double threshold = 0.0005;
+        const double size = 1.0;
+
+        // Last trade stays put while the mid moves, so some ticks trade
+        std::vector<MarketDataManager::OrderBook> books(64);
+        for (size_t i = 0; i < books.size(); ++i) {
+            auto& book = books[i];
+            const double mid = 50000.0 + (static_cast<double>(i % 9) - 4.0) * 20.0;
+            book.instrument = instrument;
+            book.bids.push_back({mid - 0.5, 1.0 + static_cast<double>(i % 3), {}});
+            book.asks.push_back({mid + 0.5, 1.0 + static_cast<double>(i % 5), {}});
+        }
+
+        auto& market_data_manager = MarketDataManager::getInstance();
+        auto& strategy_manager = StrategyManager::getInstance();
+        auto& config_manager = ConfigManager::getInstance();
+
+        // Limits wide enough that every decision reaches executeTrade
+        const auto saved_trading_config = config_manager.getTradingConfig();
+        auto trading_config = saved_trading_config;
+        trading_config.max_position_size = 1e12;
+        trading_config.max_order_size = 1e12;
+        trading_config.max_loss_per_trade = 1e12;
+        trading_config.max_daily_loss = 1e12;
+        trading_config.max_order_notional = 0.0;
+        trading_config.max_instrument_notional = 0.0;
+        trading_config.max_scenario_loss = 0.0;
+        trading_config.price_band_pct = 0.0;
+        trading_config.price_band_ticks = 0;
+        config_manager.setTradingConfig(trading_config);
+        RiskManager::getInstance().refreshLimits();
+
+        // Synchronous dispatch, as the feed pipeline runs it
+        market_data_manager.setPipelineDispatch(true);
+        MarketDataManager::MarketData seed{};
+        seed.orderbook = books[0];
+        seed.last_price = 50000.0;
+        market_data_manager.updateMarketData(seed);
+        strategy_manager.initialize();
+
+        uint64_t trades = 0;
+        strategy_manager.setTradeCallback([&trades](const std::string&, double, double, const std::string&) {
+            trades++;
+        });
+
+        StrategyManager::StrategyConfig config{};
+        config.instrument = instrument;
+        config.position_size = size;
+        config.entry_threshold = threshold;
+        config.max_trades_per_day = std::numeric_limits<int>::max();
+        config.enabled = true;
+
+        // Timed in batches: one tick is shorter than the clock read
+        const int batch_size = 1000;
+        auto measure = [&]() {
+            std::vector<double> batch_ns;
+            batch_ns.reserve(iterations / batch_size + 1);
+            size_t next = 0;
+            for (int done = 0; done < iterations; done += batch_size) {
+                auto batch_start = std::chrono::steady_clock::now();
+                for (int i = 0; i < batch_size; ++i) {
+                    market_data_manager.updateOrderBook(books[next]);
+                    market_data_manager.dispatch(instrument);
+                    next = (next + 1) & (books.size() - 1);
+                }
+                auto batch_end = std::chrono::steady_clock::now();
+                batch_ns.push_back(std::chrono::duration<double, std::nano>(batch_end - batch_start).count() / batch_size);
+            }
+            std::sort(batch_ns.begin(), batch_ns.end());
+            return batch_ns;
+        };
+        auto report = [](const char* label, const std::vector<double>& batch_ns, uint64_t trades) {
+            double avg = std::accumulate(batch_ns.begin(), batch_ns.end(), 0.0) / batch_ns.size();
+            std::cout << "  " << label << " (ns/tick):\n";
+            std::cout << "    Min: " << std::fixed << std::setprecision(1) << batch_ns.front() << "\n";
+            std::cout << "    Avg: " << avg << "\n";
+            std::cout << "    P99: " << batch_ns[(batch_ns.size() - 1) * 99 / 100] << "\n";
+            std::cout << "    Trades: " << trades << "\n";
+            return avg;
+        };
+
+        config.name = "benchmark_builtin";
+        strategy_manager.addStrategy(config);
+        auto builtin_ns = measure();
+        const uint64_t builtin_trades = trades;
+        strategy_manager.removeStrategy(config.name);
+
+        trades = 0;
+        config.name = "benchmark_composed";
+        strategy_manager.addStrategy(config, makeStrategy(threshold, size, MeanReversionSignal()));
+        auto composed_ns = measure();
+        const uint64_t composed_trades = trades;
+        strategy_manager.removeStrategy(config.name);
+
+        strategy_manager.setTradeCallback(nullptr);
+        strategy_manager.shutdown();
+        market_data_manager.setPipelineDispatch(false);
+        config_manager.setTradingConfig(saved_trading_config);
+        RiskManager::getInstance().refreshLimits();
+
+        double builtin_avg = report("Built-in strategy", builtin_ns, builtin_trades);
+        double composed_avg = report("Composed strategy", composed_ns, composed_trades);
+        std::cout << "  Speedup: " << std::setprecision(2) << builtin_avg / composed_avg << "x\n";
+        if (builtin_trades != composed_trades) {
+            std::cout << "  WARNING: paths disagree on the number of trades\n";
+        }
+    }
+
+    // Open-loop sweeps: offered load rises until the path saturates, and
+    // latency is taken from the scheduled send time so queueing is visible.
+    // The order path goes to whatever endpoint the client is connected to
+    // (no mock exchange ships with the repo), so the testnet's rate limits
+    // will saturate it early; the market data path runs in-process.
+    void runLoadSweep(const std::string& csv_file) {
+        std::cout << "Running open-loop load sweep..." << std::endl;
+
+        LoadGenerator::SweepConfig sweep;
+        sweep.base.duration = std::chrono::milliseconds(3000);
+        sweep.base.warmup = std::chrono::milliseconds(500);
+
+        DeribitClient::OrderRequest request{};
+        request.instrument = "BTC-PERPETUAL";
+        request.side = "buy";
+        request.size = 0.1;
+        request.price = 50000.0;
+        request.type = "limit";
+        request.post_only = true;
+        request.time_in_force = "good_til_cancelled";
+
+        sweep.base.rate_per_second = 10.0;
+        auto order_results = LoadGenerator::sweep([&]() {
+            std::string order_id = client_.placeOrder(request);
+            return client_.cancelOrder(order_id);
+        }, sweep);
+        LoadGenerator::writeCsv(csv_file, "place_cancel_order", order_results);
+        printSweep("place_cancel_order", order_results);
+
+        // Decode a book notification and apply it, as the feed handler does
+        const std::string frame =
+            R"({"jsonrpc":"2.0","method":"subscription","params":{"channel":"book.BTC-PERPETUAL.100ms",)"
+            R"("data":{"timestamp":1700000000000,"instrument_name":"BTC-PERPETUAL","change_id":1,)"
+            R"("bids":[[49999.5,1200.0],[49999.0,800.0],[49998.5,4300.0],[49998.0,150.0],[49997.5,900.0]],)"
+            R"("asks":[[50000.0,700.0],[50000.5,2100.0],[50001.0,380.0],[50001.5,1250.0],[50002.0,600.0]]}}})";
+        auto& market_data_manager = MarketDataManager::getInstance();
+
+        sweep.base.rate_per_second = 1000.0;
+        auto market_data_results = LoadGenerator::sweep([&]() {
+            auto message = nlohmann::json::parse(frame);
+            const auto& data = message["params"]["data"];
+
+            MarketDataManager::OrderBook orderbook;
+            orderbook.instrument = data["instrument_name"].get<std::string>();
+            orderbook.timestamp = std::chrono::system_clock::now();
+            for (const auto& bid : data["bids"]) {
+                orderbook.bids.push_back({bid[0].get<double>(), bid[1].get<double>(), orderbook.timestamp});
+            }
+            for (const auto& ask : data["asks"]) {
+                orderbook.asks.push_back({ask[0].get<double>(), ask[1].get<double>(), orderbook.timestamp});
+            }
+            market_data_manager.updateOrderBook(orderbook);
+            return true;
+        }, sweep);
+        LoadGenerator::writeCsv(csv_file, "market_data_update", market_data_results, true);
+        printSweep("market_data_update", market_data_results);
+
+        std::ofstream html("load_sweep.html");
+        html << svg_plot::page("Load Sweep", {
+            sweepChart("place_cancel_order", order_results),
+            sweepChart("market_data_update", market_data_results)
+        });
+    }
+
     void runWebSocketBenchmark(int duration_seconds = 60) {
         std::cout << "Running WebSocket benchmark..." << std::endl;
         
@@ -102,6 +337,12 @@ public:
         std::cout << "Reports generated in current directory." << std::endl;
     }
 
+    // Raw samples for benchmark_compare_tool
+    void saveResults(const std::string& filename) {
+        benchmark_.saveResults(filename);
+        std::cout << "Raw results saved to " << filename << std::endl;
+    }
+
     void printSummary() {
         std::cout << "\nBenchmark Summary:\n";
         std::cout << "=================\n\n";
@@ -129,21 +370,73 @@ public:
     }
 
 private:
+    static std::string sweepChart(const std::string& operation, const std::vector<LoadGenerator::Result>& results) {
+        svg_plot::Chart chart;
+        chart.title = operation + ": latency vs throughput";
+        chart.x_label = "Achieved throughput (ops/s)";
+        chart.y_label = "Latency from intended send (us)";
+        chart.log_y = true;
+        chart.series = {{"p50", {}, {}}, {"p99", {}, {}}, {"p99.9", {}, {}}};
+        for (const auto& r : results) {
+            for (auto& series : chart.series) series.x.push_back(r.achieved_rate);
+            chart.series[0].y.push_back(r.p50_us);
+            chart.series[1].y.push_back(r.p99_us);
+            chart.series[2].y.push_back(r.p999_us);
+        }
+        return svg_plot::renderLines(chart);
+    }
+
+    void printSweep(const std::string& operation, const std::vector<LoadGenerator::Result>& results) {
+        std::cout << "  " << operation << " (latency from intended send, us):\n";
+        std::cout << "    offered/s  achieved/s       p50       p99     p99.9  service p99\n";
+        for (const auto& r : results) {
+            std::cout << "    " << std::fixed << std::setprecision(0)
+                      << std::setw(9) << r.offered_rate << std::setw(12) << r.achieved_rate
+                      << std::setprecision(1)
+                      << std::setw(10) << r.p50_us << std::setw(10) << r.p99_us
+                      << std::setw(10) << r.p999_us << std::setw(13) << r.service_p99_us
+                      << (r.saturated ? "  saturated" : "") << "\n";
+        }
+    }
+
     Benchmark& benchmark_;
     DeribitClient& client_;
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
         BenchmarkRunner runner;
+
+        if (argc > 1 && std::strcmp(argv[1], "--load-sweep") == 0) {
+            runner.runLoadSweep(argc > 2 ? argv[2] : "load_sweep.csv");
+            return 0;
+        }
+
+        // --save <file> keeps this run as a baseline or candidate for
+        // benchmark_compare_tool
+        std::string save_path;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--save") == 0) {
+                if (i + 1 >= argc) {
+                    std::cerr << "Usage: " << argv[0] << " [--save <results.json>] | --load-sweep [file.csv]\n";
+                    return 1;
+                }
+                save_path = argv[++i];
+            }
+        }
         
         // Run benchmarks
         runner.runOrderPlacementBenchmark();
         runner.runMarketDataBenchmark();
+        runner.runStagedOrderBenchmark();
+        runner.runStrategyDispatchBenchmark();
         runner.runWebSocketBenchmark();
         
         // Generate reports
         runner.generateReport();
+        if (!save_path.empty()) {
+            runner.saveResults(save_path);
+        }
         runner.printSummary();
         
     } catch (const std::exception& e) {
@@ -0,0 +1,106 @@
+#include "book_reconstructor.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+using namespace tick_archive;
+
+BookReconstructor::BookReconstructor(const TickArchiveReader& reader)
+    : reader_(reader),
+      checkpoints_(reader.getInstruments().size()) {
+    const auto& blocks = reader_.getBlocks();
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        const auto& block = blocks[i];
+        if (block.kind == BlockKind::TICKS) {
+            tick_blocks_.push_back(i);
+        } else if (block.kind == BlockKind::CHECKPOINT && block.instrument_id < checkpoints_.size()) {
+            checkpoints_[block.instrument_id].push_back({block.first_timestamp_ns, i});
+        }
+    }
+}
+
+BookSnapshot BookReconstructor::reconstruct(const std::string& instrument, int64_t timestamp_ns,
+                                            size_t depth) const {
+    return reconstruct(reader_.findInstrument(instrument), timestamp_ns, depth);
+}
+
+BookSnapshot BookReconstructor::reconstruct(uint32_t instrument_id, int64_t timestamp_ns,
+                                            size_t depth) const {
+    if (instrument_id >= checkpoints_.size()) {
+        throw std::invalid_argument("Unknown instrument id: " + std::to_string(instrument_id));
+    }
+
+    std::map<int64_t, int64_t, std::greater<int64_t>> bids;
+    std::map<int64_t, int64_t> asks;
+
+    // Latest checkpoint at or before the requested time. Checkpoints are
+    // written in timestamp order, so the per-instrument list is sorted.
+    const auto& checkpoints = checkpoints_[instrument_id];
+    auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), timestamp_ns,
+                               [](int64_t ts, const CheckpointRef& ref) { return ts < ref.timestamp_ns; });
+
+    size_t replay_from = 0;
+    if (it != checkpoints.begin()) {
+        const auto& checkpoint = *std::prev(it);
+        auto snapshot = reader_.decodeCheckpoint(checkpoint.block);
+        for (const auto& level : snapshot.bids) bids.emplace(level.price_ticks, level.size);
+        for (const auto& level : snapshot.asks) asks.emplace(level.price_ticks, level.size);
+        replay_from = checkpoint.block + 1;
+    }
+
+    // The checkpoint reflects every tick written before it in the file, so
+    // replay resumes with the first tick block that follows it
+    const auto& blocks = reader_.getBlocks();
+    std::vector<Tick> ticks;
+    for (auto block_it = std::lower_bound(tick_blocks_.begin(), tick_blocks_.end(), replay_from);
+         block_it != tick_blocks_.end(); ++block_it) {
+        const auto& block = blocks[*block_it];
+        if (block.first_timestamp_ns > timestamp_ns) {
+            break;
+        }
+        if (!block.mayContain(instrument_id)) {
+            continue;
+        }
+
+        ticks.clear();
+        reader_.decodeTicks(*block_it, ticks);
+        for (const auto& tick : ticks) {
+            if (tick.timestamp_ns > timestamp_ns) {
+                break;
+            }
+            if (tick.instrument_id != instrument_id) {
+                continue;
+            }
+            if (tick.type == TickType::BID) {
+                if (tick.size == 0) bids.erase(tick.price_ticks); else bids[tick.price_ticks] = tick.size;
+            } else if (tick.type == TickType::ASK) {
+                if (tick.size == 0) asks.erase(tick.price_ticks); else asks[tick.price_ticks] = tick.size;
+            }
+        }
+    }
+
+    BookSnapshot result;
+    result.instrument_id = instrument_id;
+    result.timestamp_ns = timestamp_ns;
+    size_t bid_levels = depth == 0 ? bids.size() : std::min(depth, bids.size());
+    size_t ask_levels = depth == 0 ? asks.size() : std::min(depth, asks.size());
+    result.bids.reserve(bid_levels);
+    result.asks.reserve(ask_levels);
+    for (auto level = bids.begin(); result.bids.size() < bid_levels; ++level) {
+        result.bids.push_back({level->first, level->second});
+    }
+    for (auto level = asks.begin(); result.asks.size() < ask_levels; ++level) {
+        result.asks.push_back({level->first, level->second});
+    }
+    return result;
+}
+
+std::vector<BookSnapshot> BookReconstructor::reconstructBatch(const std::vector<Query>& queries,
+                                                              size_t depth, size_t threads) const {
+    std::vector<BookSnapshot> results(queries.size());
+    parallelFor(queries.size(), threads, [&](size_t i) {
+        results[i] = reconstruct(queries[i].instrument_id, queries[i].timestamp_ns, depth);
+    });
+    return results;
+}
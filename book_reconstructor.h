@@ -0,0 +1,44 @@
+#ifndef BOOK_RECONSTRUCTOR_H
+#define BOOK_RECONSTRUCTOR_H
+
+#include "tick_archive.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Point-in-time order book queries over a tick archive. A query starts from
+// the latest checkpoint of the instrument at or before the requested time and
+// replays only the tick blocks written after it, so the cost is bounded by the
+// checkpoint interval rather than by the distance from the start of the file.
+class BookReconstructor {
+public:
+    struct Query {
+        uint32_t instrument_id;
+        int64_t timestamp_ns;
+    };
+
+    explicit BookReconstructor(const TickArchiveReader& reader);
+
+    // Book as of timestamp_ns inclusive; depth 0 returns every level
+    tick_archive::BookSnapshot reconstruct(uint32_t instrument_id, int64_t timestamp_ns,
+                                           size_t depth = 0) const;
+    tick_archive::BookSnapshot reconstruct(const std::string& instrument, int64_t timestamp_ns,
+                                           size_t depth = 0) const;
+
+    // Runs independent queries across threads; results match the query order
+    std::vector<tick_archive::BookSnapshot> reconstructBatch(const std::vector<Query>& queries,
+                                                             size_t depth = 0,
+                                                             size_t threads = 0) const;
+
+private:
+    struct CheckpointRef {
+        int64_t timestamp_ns;
+        size_t block;
+    };
+
+    const TickArchiveReader& reader_;
+    std::vector<std::vector<CheckpointRef>> checkpoints_;  // Per instrument, in file order
+    std::vector<size_t> tick_blocks_;                      // Block indices of tick blocks
+};
+
+#endif // BOOK_RECONSTRUCTOR_H
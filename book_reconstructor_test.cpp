@@ -0,0 +1,239 @@
+#include "book_reconstructor.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <map>
+#include <random>
+
+using tick_archive::Tick;
+using tick_archive::TickType;
+using tick_archive::BookSnapshot;
+
+class BookReconstructorTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::remove(filename_.c_str());
+    }
+
+    void writeArchive(const std::vector<Tick>& ticks, uint32_t instruments,
+                      const TickArchiveWriter::Config& config = {}) {
+        TickArchiveWriter writer(filename_, config);
+        for (uint32_t i = 0; i < instruments; ++i) {
+            writer.addInstrument("INST-" + std::to_string(i), 0.5, 1.0);
+        }
+        for (const auto& tick : ticks) {
+            writer.append(tick);
+        }
+        writer.close();
+    }
+
+    // Book from a full replay of the raw ticks, for comparison
+    static BookSnapshot replay(const std::vector<Tick>& ticks, uint32_t id, int64_t timestamp_ns) {
+        std::map<int64_t, int64_t, std::greater<int64_t>> bids;
+        std::map<int64_t, int64_t> asks;
+        for (const auto& tick : ticks) {
+            if (tick.timestamp_ns > timestamp_ns) break;
+            if (tick.instrument_id != id) continue;
+            if (tick.type == TickType::BID) {
+                if (tick.size == 0) bids.erase(tick.price_ticks); else bids[tick.price_ticks] = tick.size;
+            } else if (tick.type == TickType::ASK) {
+                if (tick.size == 0) asks.erase(tick.price_ticks); else asks[tick.price_ticks] = tick.size;
+            }
+        }
+        BookSnapshot book{id, timestamp_ns, {}, {}};
+        for (const auto& [price, size] : bids) book.bids.push_back({price, size});
+        for (const auto& [price, size] : asks) book.asks.push_back({price, size});
+        return book;
+    }
+
+    static void expectSameBook(const BookSnapshot& actual, const BookSnapshot& expected) {
+        EXPECT_EQ(actual.instrument_id, expected.instrument_id);
+        EXPECT_EQ(actual.timestamp_ns, expected.timestamp_ns);
+        ASSERT_EQ(actual.bids.size(), expected.bids.size()) << "at " << expected.timestamp_ns;
+        ASSERT_EQ(actual.asks.size(), expected.asks.size()) << "at " << expected.timestamp_ns;
+        for (size_t i = 0; i < expected.bids.size(); ++i) {
+            EXPECT_EQ(actual.bids[i].price_ticks, expected.bids[i].price_ticks);
+            EXPECT_EQ(actual.bids[i].size, expected.bids[i].size);
+        }
+        for (size_t i = 0; i < expected.asks.size(); ++i) {
+            EXPECT_EQ(actual.asks[i].price_ticks, expected.asks[i].price_ticks);
+            EXPECT_EQ(actual.asks[i].size, expected.asks[i].size);
+        }
+    }
+
+    static Tick tick(int64_t timestamp_ns, uint32_t id, TickType type, int64_t price, int64_t size) {
+        return {timestamp_ns, id, type, price, size};
+    }
+
+    std::string filename_{"book_reconstructor_test.bin"};
+};
+
+TEST_F(BookReconstructorTest, MatchesFullReplayAcrossCheckpoints) {
+    std::mt19937_64 rng(777);
+    std::vector<Tick> ticks;
+    int64_t timestamp = 1000000;
+    for (int i = 0; i < 6000; ++i) {
+        timestamp += 1 + static_cast<int64_t>(rng() % 3);  // Includes equal timestamps
+        auto type = static_cast<TickType>(rng() % 4);
+        int64_t price = type == TickType::BID ? 1000 - static_cast<int64_t>(rng() % 8)
+                                              : 1001 + static_cast<int64_t>(rng() % 8);
+        ticks.push_back(tick(timestamp, static_cast<uint32_t>(rng() % 3), type, price,
+                             rng() % 3 == 0 ? 0 : static_cast<int64_t>(1 + rng() % 50)));
+    }
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 256;
+    config.checkpoint_interval_blocks = 3;
+    writeArchive(ticks, 3, config);
+
+    TickArchiveReader reader(filename_);
+    BookReconstructor reconstructor(reader);
+    for (int i = 0; i < 200; ++i) {
+        const auto& at = ticks[rng() % ticks.size()];
+        uint32_t id = static_cast<uint32_t>(rng() % 3);
+        expectSameBook(reconstructor.reconstruct(id, at.timestamp_ns), replay(ticks, id, at.timestamp_ns));
+    }
+}
+
+TEST_F(BookReconstructorTest, TicksSharingTheCheckpointTimeAreReplayedInOrder) {
+    // One tick per block and a checkpoint after every block, with the
+    // checkpoint's timestamp shared by the ticks that follow it
+    std::vector<Tick> ticks = {
+        tick(100, 0, TickType::BID, 50, 1),
+        tick(200, 0, TickType::BID, 50, 2),
+        tick(200, 0, TickType::BID, 50, 0),
+        tick(200, 0, TickType::BID, 49, 7),
+        tick(300, 0, TickType::ASK, 52, 4),
+    };
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 1;
+    config.checkpoint_interval_blocks = 1;
+    writeArchive(ticks, 1, config);
+
+    TickArchiveReader reader(filename_);
+    BookReconstructor reconstructor(reader);
+
+    auto book = reconstructor.reconstruct("INST-0", 200);
+    ASSERT_EQ(book.bids.size(), 1u);
+    EXPECT_EQ(book.bids[0].price_ticks, 49);
+    EXPECT_EQ(book.bids[0].size, 7);
+    EXPECT_TRUE(book.asks.empty());
+
+    expectSameBook(reconstructor.reconstruct(0, 150), replay(ticks, 0, 150));
+    expectSameBook(reconstructor.reconstruct(0, 300), replay(ticks, 0, 300));
+}
+
+TEST_F(BookReconstructorTest, GapsAndTimesOutsideTheDataHoldTheLastState) {
+    std::vector<Tick> ticks = {
+        tick(1000, 0, TickType::BID, 100, 5),
+        tick(1000, 0, TickType::ASK, 102, 6),
+        tick(1000, 1, TickType::BID, 10, 1),
+        // Instrument 0 goes quiet while 1 keeps writing blocks
+    };
+    for (int i = 0; i < 64; ++i) {
+        ticks.push_back(tick(2000 + i, 1, TickType::ASK, 11 + i % 4, 1 + i));
+    }
+    ticks.push_back(tick(1000000, 0, TickType::ASK, 101, 3));
+
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 8;
+    config.checkpoint_interval_blocks = 2;
+    writeArchive(ticks, 2, config);
+
+    TickArchiveReader reader(filename_);
+    BookReconstructor reconstructor(reader);
+
+    // Before any data the book is empty
+    auto empty = reconstructor.reconstruct(0, 999);
+    EXPECT_TRUE(empty.bids.empty());
+    EXPECT_TRUE(empty.asks.empty());
+
+    // Inside the gap the last update stands
+    for (int64_t at : {1000LL, 1500LL, 2040LL, 500000LL, 999999LL}) {
+        expectSameBook(reconstructor.reconstruct(0, at), replay(ticks, 0, at));
+    }
+    auto after = reconstructor.reconstruct(0, 5000000);
+    ASSERT_EQ(after.asks.size(), 2u);
+    EXPECT_EQ(after.asks[0].price_ticks, 101);
+    expectSameBook(after, replay(ticks, 0, 5000000));
+    expectSameBook(reconstructor.reconstruct(1, 2030), replay(ticks, 1, 2030));
+}
+
+TEST_F(BookReconstructorTest, ClearedLevelsStayCleared) {
+    // A full book reset: every level removed, then rebuilt at new prices
+    std::vector<Tick> ticks = {
+        tick(10, 0, TickType::BID, 100, 5),
+        tick(11, 0, TickType::BID, 99, 5),
+        tick(12, 0, TickType::ASK, 101, 5),
+        tick(20, 0, TickType::BID, 100, 0),
+        tick(21, 0, TickType::BID, 99, 0),
+        tick(22, 0, TickType::ASK, 101, 0),
+        tick(30, 0, TickType::BID, 90, 1),
+        tick(31, 0, TickType::ASK, 95, 2),
+    };
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 2;
+    config.checkpoint_interval_blocks = 1;
+    writeArchive(ticks, 1, config);
+
+    TickArchiveReader reader(filename_);
+    BookReconstructor reconstructor(reader);
+
+    auto cleared = reconstructor.reconstruct(0, 25);
+    EXPECT_TRUE(cleared.bids.empty());
+    EXPECT_TRUE(cleared.asks.empty());
+
+    auto rebuilt = reconstructor.reconstruct(0, 31);
+    ASSERT_EQ(rebuilt.bids.size(), 1u);
+    ASSERT_EQ(rebuilt.asks.size(), 1u);
+    EXPECT_EQ(rebuilt.bids[0].price_ticks, 90);
+    EXPECT_EQ(rebuilt.asks[0].price_ticks, 95);
+}
+
+TEST_F(BookReconstructorTest, TradesDoNotTouchTheBook) {
+    std::vector<Tick> ticks = {
+        tick(10, 0, TickType::BID, 100, 5),
+        tick(11, 0, TickType::TRADE_SELL, 100, 5),
+        tick(12, 0, TickType::TRADE_BUY, 103, 1),
+    };
+    writeArchive(ticks, 1);
+
+    TickArchiveReader reader(filename_);
+    BookReconstructor reconstructor(reader);
+    auto book = reconstructor.reconstruct(0, 12);
+    ASSERT_EQ(book.bids.size(), 1u);
+    EXPECT_EQ(book.bids[0].size, 5);
+    EXPECT_TRUE(book.asks.empty());
+}
+
+TEST_F(BookReconstructorTest, DepthAndBatchQueries) {
+    std::vector<Tick> ticks;
+    for (int i = 0; i < 20; ++i) {
+        ticks.push_back(tick(100 + i, 0, TickType::BID, 1000 - i, 1 + i));
+        ticks.push_back(tick(100 + i, 0, TickType::ASK, 1001 + i, 1 + i));
+    }
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 6;
+    config.checkpoint_interval_blocks = 2;
+    writeArchive(ticks, 1, config);
+
+    TickArchiveReader reader(filename_);
+    BookReconstructor reconstructor(reader);
+
+    auto top = reconstructor.reconstruct(0, 200, 3);
+    ASSERT_EQ(top.bids.size(), 3u);
+    ASSERT_EQ(top.asks.size(), 3u);
+    EXPECT_EQ(top.bids[0].price_ticks, 1000);
+    EXPECT_EQ(top.bids[2].price_ticks, 998);
+    EXPECT_EQ(top.asks[0].price_ticks, 1001);
+
+    std::vector<BookReconstructor::Query> queries;
+    for (int64_t at = 95; at <= 125; ++at) {
+        queries.push_back({0, at});
+    }
+    auto results = reconstructor.reconstructBatch(queries, 0, 4);
+    ASSERT_EQ(results.size(), queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        expectSameBook(results[i], reconstructor.reconstruct(0, queries[i].timestamp_ns));
+    }
+
+    EXPECT_THROW(reconstructor.reconstruct(5, 100), std::invalid_argument);
+}
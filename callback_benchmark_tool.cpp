@@ -0,0 +1,134 @@
+#include "inplace_function.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <vector>
+
+// Compares std::function with InplaceFunction for the callback registries
+// on the tick path: heap allocations per registration and per registry
+// copy, and the cost of one call through a registry of subscribers.
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+// Written after each timed loop so the callbacks cannot be optimized away
+volatile uint64_t observed = 0;
+
+// Stand-in for the market data snapshot handed to subscribers
+struct Tick {
+    double price;
+    double size;
+    uint64_t sequence;
+};
+
+// A capture of N bytes, the size of what a subscriber carries around
+template <size_t N>
+struct Payload {
+    std::array<char, N> bytes{};
+};
+
+struct Row {
+    const char* label;
+    double registration_allocs;
+    double copy_allocs;
+    double call_ns;
+    double call_allocs;
+};
+
+template <typename Callback, size_t CaptureBytes>
+Row measure(const char* label, int iterations) {
+    constexpr size_t subscribers = 8;
+    uint64_t sink = 0;
+    Payload<CaptureBytes> payload;
+    payload.bytes[0] = 1;
+
+    std::vector<Callback> registry;
+    registry.reserve(subscribers);
+    uint64_t before = allocations.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < subscribers; ++i) {
+        registry.emplace_back([&sink, payload](const Tick& tick) {
+            sink += tick.sequence + static_cast<uint64_t>(payload.bytes[0]);
+        });
+    }
+    const double registration = static_cast<double>(allocations.load(std::memory_order_relaxed) - before) /
+                                subscribers;
+
+    // Copying the registry is what a notify-outside-the-lock snapshot costs
+    before = allocations.load(std::memory_order_relaxed);
+    std::vector<Callback> snapshot(registry);
+    const double copy = static_cast<double>(allocations.load(std::memory_order_relaxed) - before - 1) /
+                        subscribers;
+
+    Tick tick{50000.0, 1.0, 0};
+    before = allocations.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < iterations; ++n) {
+        tick.sequence = static_cast<uint64_t>(n);
+        for (const auto& callback : registry) {
+            callback(tick);
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const double calls = static_cast<double>(iterations) * subscribers;
+    const double call_allocs = static_cast<double>(allocations.load(std::memory_order_relaxed) - before) / calls;
+
+    observed = sink;
+    return {label, registration, copy, std::chrono::duration<double, std::nano>(elapsed).count() / calls,
+            call_allocs};
+}
+
+template <size_t CaptureBytes>
+void runCase(int iterations) {
+    std::cout << "Capture of " << CaptureBytes + sizeof(void*) << " bytes:\n";
+    const Row rows[] = {
+        measure<std::function<void(const Tick&)>, CaptureBytes>("std::function", iterations),
+        measure<InplaceFunction<void(const Tick&)>, CaptureBytes>("InplaceFunction", iterations),
+    };
+    for (const auto& row : rows) {
+        std::cout << "  " << std::left << std::setw(16) << row.label << std::right << std::fixed
+                  << std::setprecision(2)
+                  << "  allocs/registration: " << row.registration_allocs
+                  << "  allocs/copy: " << row.copy_allocs
+                  << "  ns/call: " << row.call_ns
+                  << "  allocs/call: " << row.call_allocs << "\n";
+    }
+}
+
+} // namespace
+
+// Counts every heap allocation in this process; the tool is single-threaded
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(size ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = 1000000;
+    if (argc > 1) {
+        iterations = std::max(1, std::atoi(argv[1]));
+    }
+
+    std::cout << "Callback registry benchmark, 8 subscribers, " << iterations << " ticks\n";
+    runCase<8>(iterations);   // Fits std::function's small buffer on common implementations
+    runCase<24>(iterations);
+    runCase<40>(iterations);  // The full inline capacity
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include "channel_dispatcher.h"
+#include "instrument_registry.h"
+#include <algorithm>
+#include <atomic>
+
+ChannelDispatcher::ChannelDispatcher()
+    : table_(build({})) {
+}
+
+void ChannelDispatcher::addChannel(const std::string& channel, ChannelKind kind, const std::string& instrument) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+
+    Route route{kind, InstrumentRegistry::INVALID_ID, nullptr};
+    if (!instrument.empty()) {
+        auto& registry = InstrumentRegistry::getInstance();
+        route.instrument_id = registry.intern(instrument);
+        route.instrument = &registry.name(route.instrument_id);
+    }
+
+    auto current = std::atomic_load(&table_);
+    std::vector<Entry> entries = current->entries;
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&channel](const Entry& entry) { return entry.channel == channel; });
+    if (it != entries.end()) {
+        it->route = route;
+    } else {
+        entries.push_back({channel, route});
+    }
+
+    std::atomic_store(&table_, build(std::move(entries)));
+}
+
+void ChannelDispatcher::removeChannel(const std::string& channel) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+
+    auto current = std::atomic_load(&table_);
+    std::vector<Entry> entries = current->entries;
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&channel](const Entry& entry) { return entry.channel == channel; }),
+                  entries.end());
+
+    std::atomic_store(&table_, build(std::move(entries)));
+}
+
+void ChannelDispatcher::clear() {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    std::atomic_store(&table_, build({}));
+}
+
+bool ChannelDispatcher::find(std::string_view channel, Route& route) const {
+    auto table = std::atomic_load(&table_);
+    uint64_t h = hash(channel);
+    uint64_t displacement = table->displacements[(h >> 40) & table->bucket_mask];
+    int32_t index = table->slots[remix(h, displacement) & table->slot_mask];
+    if (index >= 0 && table->entries[index].channel == channel) {
+        route = table->entries[index].route;
+        return true;
+    }
+
+    for (size_t pattern : table->patterns) {
+        const auto& entry = table->entries[pattern];
+        if (matches(entry.channel, channel)) {
+            route = entry.route;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t ChannelDispatcher::size() const {
+    return std::atomic_load(&table_)->entries.size();
+}
+
+bool ChannelDispatcher::isPattern(std::string_view channel) {
+    size_t start = 0;
+    for (;;) {
+        size_t end = channel.find('.', start);
+        std::string_view segment = channel.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+        if (segment == "any" || (segment == "*" && end == std::string_view::npos)) {
+            return true;
+        }
+        if (end == std::string_view::npos) {
+            return false;
+        }
+        start = end + 1;
+    }
+}
+
+bool ChannelDispatcher::matches(std::string_view pattern, std::string_view channel) {
+    // Segment-wise compare on '.'
+    size_t p = 0;
+    size_t c = 0;
+    for (;;) {
+        size_t p_end = pattern.find('.', p);
+        size_t c_end = channel.find('.', c);
+        std::string_view p_segment = pattern.substr(p, p_end == std::string_view::npos ? std::string_view::npos : p_end - p);
+        std::string_view c_segment = channel.substr(c, c_end == std::string_view::npos ? std::string_view::npos : c_end - c);
+
+        if (p_segment == "*" && p_end == std::string_view::npos) {
+            return !c_segment.empty();
+        }
+        if (p_segment != "any" ? p_segment != c_segment : c_segment.empty()) {
+            return false;
+        }
+        if (p_end == std::string_view::npos || c_end == std::string_view::npos) {
+            return p_end == c_end;
+        }
+        p = p_end + 1;
+        c = c_end + 1;
+    }
+}
+
+uint64_t ChannelDispatcher::hash(std::string_view bytes) {
+    // FNV-1a over the channel bytes
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : bytes) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t ChannelDispatcher::remix(uint64_t h, uint64_t displacement) {
+    // splitmix64 finalizer, so each displacement gives an independent slot
+    uint64_t x = h + displacement * 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+std::shared_ptr<const ChannelDispatcher::Table> ChannelDispatcher::build(std::vector<Entry> entries) {
+    auto table = std::make_shared<Table>();
+    table->entries = std::move(entries);
+    const size_t count = table->entries.size();
+
+    std::vector<uint64_t> hashes(count);
+    for (size_t i = 0; i < count; ++i) {
+        hashes[i] = hash(table->entries[i].channel);
+        if (isPattern(table->entries[i].channel)) {
+            table->patterns.push_back(i);
+        }
+    }
+
+    size_t bucket_count = 1;
+    while (bucket_count * 2 < count) {
+        bucket_count <<= 1;
+    }
+    size_t capacity = 8;
+    while (capacity < count * 2) {
+        capacity <<= 1;
+    }
+
+    // Hash-and-displace: place the largest buckets first, searching for a
+    // displacement that puts every key of the bucket into a free slot. Grow
+    // the slot array in the (unlikely) case a bucket cannot be placed.
+    const uint64_t max_displacement = 1u << 16;
+    for (;;) {
+        table->bucket_mask = bucket_count - 1;
+        table->slot_mask = capacity - 1;
+        table->displacements.assign(bucket_count, 0);
+        table->slots.assign(capacity, -1);
+
+        std::vector<std::vector<size_t>> buckets(bucket_count);
+        for (size_t i = 0; i < count; ++i) {
+            buckets[(hashes[i] >> 40) & table->bucket_mask].push_back(i);
+        }
+
+        std::vector<size_t> order(bucket_count);
+        for (size_t b = 0; b < bucket_count; ++b) {
+            order[b] = b;
+        }
+        std::sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        bool placed_all = true;
+        std::vector<size_t> candidate_slots;
+        for (size_t b : order) {
+            const auto& keys = buckets[b];
+            if (keys.empty()) break;
+
+            bool placed = false;
+            for (uint64_t d = 0; d < max_displacement && !placed; ++d) {
+                candidate_slots.clear();
+                placed = true;
+                for (size_t key : keys) {
+                    size_t slot = remix(hashes[key], d) & table->slot_mask;
+                    if (table->slots[slot] >= 0 ||
+                        std::find(candidate_slots.begin(), candidate_slots.end(), slot) != candidate_slots.end()) {
+                        placed = false;
+                        break;
+                    }
+                    candidate_slots.push_back(slot);
+                }
+                if (placed) {
+                    table->displacements[b] = d;
+                    for (size_t k = 0; k < keys.size(); ++k) {
+                        table->slots[candidate_slots[k]] = static_cast<int32_t>(keys[k]);
+                    }
+                }
+            }
+
+            if (!placed) {
+                placed_all = false;
+                break;
+            }
+        }
+
+        if (placed_all) {
+            return table;
+        }
+        capacity <<= 1;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef CHANNEL_DISPATCHER_H
+#define CHANNEL_DISPATCHER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+// Routing table for inbound subscription notifications. The table is rebuilt
+// as a perfect hash (hash-and-displace) whenever a channel is added or
+// removed, so a lookup is one hash of the channel bytes, one integer remix and
+// one string compare. Readers work on an immutable snapshot and never block
+// subscribers.
+//
+// Channels may also be wildcard patterns, as used for private subscriptions:
+// an "any" segment matches one segment and a trailing "*" matches the rest of
+// the channel. Notifications arrive on concrete channels, so patterns are
+// only tried, in insertion order, when the exact lookup misses.
+class ChannelDispatcher {
+public:
+    enum class ChannelKind : uint8_t {
+        BOOK,
+        TRADES,
+        TICKER,
+        USER
+    };
+
+    struct Route {
+        ChannelKind kind;
+        uint32_t instrument_id;
+        const std::string* instrument;  // Interned name, stable for the process lifetime
+    };
+
+    ChannelDispatcher();
+
+    void addChannel(const std::string& channel, ChannelKind kind, const std::string& instrument = "");
+    void removeChannel(const std::string& channel);
+    void clear();
+
+    // Returns false for unknown channels
+    bool find(std::string_view channel, Route& route) const;
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::string channel;
+        Route route;
+    };
+
+    struct Table {
+        std::vector<Entry> entries;
+        std::vector<size_t> patterns;  // Indices of wildcard entries
+        std::vector<int32_t> slots;
+        std::vector<uint64_t> displacements;
+        uint64_t slot_mask{0};
+        uint64_t bucket_mask{0};
+    };
+
+    static bool isPattern(std::string_view channel);
+    static bool matches(std::string_view pattern, std::string_view channel);
+    static uint64_t hash(std::string_view bytes);
+    static uint64_t remix(uint64_t h, uint64_t displacement);
+    static std::shared_ptr<const Table> build(std::vector<Entry> entries);
+
+    std::mutex update_mutex_;
+    std::shared_ptr<const Table> table_;
+};
+
+#endif // CHANNEL_DISPATCHER_H
@@ -0,0 +1,93 @@
+#include "channel_dispatcher.h"
+#include "instrument_registry.h"
+#include <gtest/gtest.h>
+
+class ChannelDispatcherTest : public ::testing::Test {
+protected:
+    using Kind = ChannelDispatcher::ChannelKind;
+
+    ChannelDispatcher dispatcher_;
+    ChannelDispatcher::Route route_{};
+};
+
+TEST_F(ChannelDispatcherTest, ExactChannelsRouteToTheirInstrument) {
+    dispatcher_.addChannel("book.BTC-PERPETUAL.100ms", Kind::BOOK, "BTC-PERPETUAL");
+    dispatcher_.addChannel("trades.BTC-PERPETUAL.raw", Kind::TRADES, "BTC-PERPETUAL");
+    dispatcher_.addChannel("ticker.ETH-PERPETUAL.100ms", Kind::TICKER, "ETH-PERPETUAL");
+    EXPECT_EQ(dispatcher_.size(), 3u);
+
+    ASSERT_TRUE(dispatcher_.find("trades.BTC-PERPETUAL.raw", route_));
+    EXPECT_EQ(route_.kind, Kind::TRADES);
+    ASSERT_NE(route_.instrument, nullptr);
+    EXPECT_EQ(*route_.instrument, "BTC-PERPETUAL");
+    EXPECT_EQ(route_.instrument_id, InstrumentRegistry::getInstance().find("BTC-PERPETUAL"));
+
+    ASSERT_TRUE(dispatcher_.find("ticker.ETH-PERPETUAL.100ms", route_));
+    EXPECT_EQ(route_.kind, Kind::TICKER);
+    EXPECT_EQ(*route_.instrument, "ETH-PERPETUAL");
+}
+
+TEST_F(ChannelDispatcherTest, UnknownChannelsAreNotRouted) {
+    EXPECT_FALSE(dispatcher_.find("book.BTC-PERPETUAL.100ms", route_));
+
+    dispatcher_.addChannel("book.BTC-PERPETUAL.100ms", Kind::BOOK, "BTC-PERPETUAL");
+    EXPECT_FALSE(dispatcher_.find("book.BTC-PERPETUAL.raw", route_));
+    EXPECT_FALSE(dispatcher_.find("book.BTC-PERPETUAL", route_));
+    EXPECT_FALSE(dispatcher_.find("", route_));
+}
+
+TEST_F(ChannelDispatcherTest, AddingAgainReplacesAndRemoveDrops) {
+    dispatcher_.addChannel("book.BTC-PERPETUAL.100ms", Kind::BOOK, "BTC-PERPETUAL");
+    dispatcher_.addChannel("book.BTC-PERPETUAL.100ms", Kind::TICKER, "BTC-PERPETUAL");
+    EXPECT_EQ(dispatcher_.size(), 1u);
+    ASSERT_TRUE(dispatcher_.find("book.BTC-PERPETUAL.100ms", route_));
+    EXPECT_EQ(route_.kind, Kind::TICKER);
+
+    dispatcher_.removeChannel("book.BTC-PERPETUAL.100ms");
+    EXPECT_EQ(dispatcher_.size(), 0u);
+    EXPECT_FALSE(dispatcher_.find("book.BTC-PERPETUAL.100ms", route_));
+}
+
+TEST_F(ChannelDispatcherTest, ManyChannelsAllResolve) {
+    for (int i = 0; i < 500; ++i) {
+        std::string instrument = "TEST-" + std::to_string(i);
+        dispatcher_.addChannel("book." + instrument + ".100ms", Kind::BOOK, instrument);
+    }
+    for (int i = 0; i < 500; ++i) {
+        std::string instrument = "TEST-" + std::to_string(i);
+        ASSERT_TRUE(dispatcher_.find("book." + instrument + ".100ms", route_)) << instrument;
+        EXPECT_EQ(*route_.instrument, instrument);
+    }
+}
+
+TEST_F(ChannelDispatcherTest, WildcardUserRoutesMatchConcreteChannels) {
+    dispatcher_.addChannel("user.orders.*", Kind::USER);
+    dispatcher_.addChannel("user.portfolio.any", Kind::USER);
+    dispatcher_.addChannel("user.trades.any.any.raw", Kind::USER);
+
+    ASSERT_TRUE(dispatcher_.find("user.orders.BTC-PERPETUAL.raw", route_));
+    EXPECT_EQ(route_.kind, Kind::USER);
+    EXPECT_EQ(route_.instrument, nullptr);
+    EXPECT_TRUE(dispatcher_.find("user.orders.future.BTC.100ms", route_));
+    EXPECT_TRUE(dispatcher_.find("user.portfolio.btc", route_));
+    EXPECT_TRUE(dispatcher_.find("user.trades.future.BTC.raw", route_));
+
+    // "*" needs at least one segment and "any" exactly one
+    EXPECT_FALSE(dispatcher_.find("user.orders", route_));
+    EXPECT_FALSE(dispatcher_.find("user.portfolio.btc.raw", route_));
+    EXPECT_FALSE(dispatcher_.find("user.trades.future.BTC.100ms", route_));
+    EXPECT_FALSE(dispatcher_.find("user.changes.BTC-PERPETUAL.raw", route_));
+
+    dispatcher_.removeChannel("user.orders.*");
+    EXPECT_FALSE(dispatcher_.find("user.orders.BTC-PERPETUAL.raw", route_));
+}
+
+TEST_F(ChannelDispatcherTest, ExactRoutesWinOverPatterns) {
+    dispatcher_.addChannel("user.*", Kind::USER);
+    dispatcher_.addChannel("user.orders.BTC-PERPETUAL.raw", Kind::BOOK, "BTC-PERPETUAL");
+
+    ASSERT_TRUE(dispatcher_.find("user.orders.BTC-PERPETUAL.raw", route_));
+    EXPECT_EQ(route_.kind, Kind::BOOK);
+    ASSERT_TRUE(dispatcher_.find("user.orders.ETH-PERPETUAL.raw", route_));
+    EXPECT_EQ(route_.kind, Kind::USER);
+}
@@ -0,0 +1,712 @@
+#include "stress_harness.h"
+#include "instrument_registry.h"
+#include "channel_dispatcher.h"
+#include "market_data_manager.h"
+#include "bar_aggregator.h"
+#include "cpu_accounting.h"
+#include "latency_module.h"
+#include "error_handler.h"
+#include "order_template.h"
+#include "sequenced_pipeline.h"
+#include "margin_monitor.h"
+#include "emergency_canceller.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <set>
+
+// Each test states its own default thread counts and sizes; the STRESS_*
+// environment variables override them (see stress_harness.h). Keep the
+// defaults small enough for a ThreadSanitizer build to finish quickly.
+class ConcurrencyStressTest : public ::testing::Test {
+protected:
+    static stress::Config config(int producers, int consumers, size_t operations) {
+        return stress::Config::fromEnvironment(producers, consumers, operations);
+    }
+
+    static std::string testName() {
+        return ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    }
+
+    // The components under test are process-wide singletons, so names that
+    // carry state are unique per run to keep --gtest_repeat runs apart
+    static std::string runPrefix(const std::string& tag, const stress::Config& cfg) {
+        static int run = 0;
+        return tag + std::to_string(cfg.seed) + "-" + std::to_string(run++) + "-";
+    }
+};
+
+// Concurrent interning is linearizable: every caller sees one id per name,
+// ids are new and dense, and a lookup that starts after an intern returned
+// must find the name
+TEST_F(ConcurrencyStressTest, InstrumentRegistryInternIsLinearizable) {
+    auto cfg = config(4, 2, 5000);
+    SCOPED_TRACE(cfg.describe());
+    enum { INTERN, FIND };
+    const uint64_t names = 512;
+    const std::string prefix = runPrefix("STRESS-REG-", cfg);
+
+    auto& registry = InstrumentRegistry::getInstance();
+    const size_t size_before = registry.size();
+    stress::History history(cfg.producers + cfg.consumers);
+    stress::Runner runner(cfg);
+
+    auto result = runner.run(
+        [&](stress::Worker& worker) {
+            for (size_t i = 0; i < cfg.operations; ++i) {
+                uint64_t key = worker.below(names);
+                uint64_t invoke = history.stamp();
+                uint32_t id = registry.intern(prefix + std::to_string(key));
+                history.record(worker.index(), INTERN, key, id, invoke, history.stamp());
+                worker.perturb();
+            }
+        },
+        [&](stress::Worker& worker) {
+            while (!runner.done()) {
+                uint64_t key = worker.below(names);
+                uint64_t invoke = history.stamp();
+                uint32_t id = registry.find(prefix + std::to_string(key));
+                history.record(worker.index(), FIND, key, id, invoke, history.stamp());
+                worker.perturb();
+            }
+        });
+    stress::report(testName(), cfg, result);
+
+    auto events = history.merged();
+    std::map<uint64_t, uint32_t> ids;
+    std::map<uint64_t, uint64_t> first_response;
+    for (const auto& event : events) {
+        if (event.op != INTERN) continue;
+        auto [it, inserted] = ids.emplace(event.key, static_cast<uint32_t>(event.result));
+        ASSERT_EQ(it->second, event.result) << "two ids for key " << event.key;
+        auto response = first_response.emplace(event.key, event.response).first;
+        response->second = std::min(response->second, event.response);
+    }
+
+    std::set<uint32_t> distinct;
+    for (const auto& [key, id] : ids) {
+        EXPECT_TRUE(distinct.insert(id).second) << "id " << id << " reused";
+        EXPECT_GE(id, size_before);
+        EXPECT_LT(id, size_before + ids.size());
+        EXPECT_EQ(registry.name(id), prefix + std::to_string(key));
+    }
+    EXPECT_EQ(registry.size(), size_before + ids.size());
+
+    for (const auto& event : events) {
+        if (event.op != FIND) continue;
+        auto id = ids.find(event.key);
+        if (event.result != InstrumentRegistry::INVALID_ID) {
+            ASSERT_NE(id, ids.end());
+            EXPECT_EQ(event.result, id->second);
+        } else if (id != ids.end()) {
+            EXPECT_GT(first_response[event.key], event.invoke)
+                << "find missed key " << event.key << " after its intern completed";
+        }
+    }
+}
+
+// Lookups race with table rebuilds; a lookup must see every channel whose add
+// completed before it started and none whose remove completed before it started
+TEST_F(ConcurrencyStressTest, ChannelDispatcherSnapshotsAreConsistent) {
+    auto cfg = config(3, 3, 400);
+    SCOPED_TRACE(cfg.describe());
+
+    struct Lifetime {
+        uint64_t add_invoke{UINT64_MAX};
+        uint64_t add_response{UINT64_MAX};
+        uint64_t remove_invoke{UINT64_MAX};
+        uint64_t remove_response{UINT64_MAX};
+    };
+    struct Lookup {
+        int producer;
+        size_t index;
+        bool found;
+        bool route_ok;
+        uint64_t invoke;
+        uint64_t response;
+    };
+
+    auto channel = [](int producer, size_t index) {
+        return "book.STRESS-" + std::to_string(producer) + "-" + std::to_string(index) + ".raw";
+    };
+    auto instrument = [](int producer, size_t index) {
+        return "STRESS-CD-" + std::to_string(producer) + "-" + std::to_string(index);
+    };
+
+    ChannelDispatcher dispatcher;
+    std::vector<std::vector<Lifetime>> lifetimes(cfg.producers, std::vector<Lifetime>(cfg.operations));
+    std::vector<std::vector<Lookup>> lookups(cfg.consumers);
+    stress::History history(0);
+    stress::Runner runner(cfg);
+
+    auto result = runner.run(
+        [&](stress::Worker& worker) {
+            const int p = worker.index();
+            for (size_t i = 0; i < cfg.operations; ++i) {
+                auto& life = lifetimes[p][i];
+                life.add_invoke = history.stamp();
+                dispatcher.addChannel(channel(p, i), ChannelDispatcher::ChannelKind::BOOK, instrument(p, i));
+                life.add_response = history.stamp();
+                worker.perturb();
+                // Keep the table small so rebuilds stay cheap
+                if (i > 0) {
+                    auto& previous = lifetimes[p][i - 1];
+                    previous.remove_invoke = history.stamp();
+                    dispatcher.removeChannel(channel(p, i - 1));
+                    previous.remove_response = history.stamp();
+                }
+            }
+        },
+        [&](stress::Worker& worker) {
+            auto& log = lookups[worker.index() - cfg.producers];
+            while (!runner.done()) {
+                int p = static_cast<int>(worker.below(cfg.producers));
+                size_t i = worker.below(cfg.operations);
+                ChannelDispatcher::Route route;
+                uint64_t invoke = history.stamp();
+                bool found = dispatcher.find(channel(p, i), route);
+                uint64_t response = history.stamp();
+                bool route_ok = !found || (route.kind == ChannelDispatcher::ChannelKind::BOOK &&
+                                           route.instrument && *route.instrument == instrument(p, i));
+                log.push_back({p, i, found, route_ok, invoke, response});
+                worker.perturb();
+            }
+        });
+    stress::report(testName(), cfg, result);
+
+    size_t checked = 0;
+    for (const auto& log : lookups) {
+        for (const auto& lookup : log) {
+            const auto& life = lifetimes[lookup.producer][lookup.index];
+            EXPECT_TRUE(lookup.route_ok);
+            if (lookup.found) {
+                EXPECT_LT(life.add_invoke, lookup.response) << "found a channel before it was added";
+                EXPECT_GT(life.remove_response, lookup.invoke) << "found a channel after it was removed";
+            } else {
+                EXPECT_FALSE(life.add_response < lookup.invoke && life.remove_invoke > lookup.response)
+                    << "missed channel " << channel(lookup.producer, lookup.index);
+            }
+            ++checked;
+        }
+    }
+    EXPECT_GT(checked, 0u);
+    EXPECT_EQ(dispatcher.size(), static_cast<size_t>(cfg.producers));
+}
+
+// Updates from each producer are delivered to subscribers in the order they
+// were queued, and trade reads never observe a torn or stale copy
+TEST_F(ConcurrencyStressTest, MarketDataQueuePreservesPerInstrumentOrder) {
+    auto cfg = config(4, 2, 300);
+    SCOPED_TRACE(cfg.describe());
+
+    auto& manager = MarketDataManager::getInstance();
+    manager.initialize();
+
+    const std::string prefix = runPrefix("STRESS-MD-", cfg);
+    std::vector<std::string> instruments;
+    for (int p = 0; p < cfg.producers; ++p) {
+        instruments.push_back(prefix + std::to_string(p));
+    }
+
+    // Subscriber callbacks run on the processing thread under the data lock
+    std::vector<double> last_delivered(cfg.producers, 0.0);
+    std::atomic<size_t> delivered{0};
+    std::atomic<size_t> out_of_order{0};
+    for (int p = 0; p < cfg.producers; ++p) {
+        manager.subscribeToMarketData(instruments[p], [&, p](const MarketDataManager::MarketData& data) {
+            if (data.trades.empty()) return;
+            double price = data.trades.back().price;
+            if (price < last_delivered[p]) out_of_order++;
+            last_delivered[p] = price;
+            delivered++;
+        });
+    }
+
+    std::atomic<size_t> bad_reads{0};
+    stress::Runner runner(cfg);
+    auto result = runner.run(
+        [&](stress::Worker& worker) {
+            const auto& instrument = instruments[worker.index()];
+            for (size_t i = 1; i <= cfg.operations; ++i) {
+                MarketDataManager::Trade trade;
+                trade.price = static_cast<double>(i);
+                trade.size = 1.0;
+                trade.side = "buy";
+                trade.instrument = instrument;
+                trade.timestamp = std::chrono::system_clock::now();
+                manager.addTrade(trade);
+                worker.perturb();
+            }
+        },
+        [&](stress::Worker& worker) {
+            while (!runner.done()) {
+                const auto& instrument = instruments[worker.below(instruments.size())];
+                if (worker.below(4) == 0) {
+                    manager.pinInstrument(instrument);
+                    manager.unpinInstrument(instrument);
+                }
+                try {
+                    auto trades = manager.getRecentTrades(instrument, 5);
+                    if (trades.size() > 5) bad_reads++;
+                    for (size_t i = 1; i < trades.size(); ++i) {
+                        if (trades[i].price != trades[i - 1].price + 1.0) bad_reads++;
+                    }
+                } catch (const std::runtime_error&) {
+                    // Nothing received for this instrument yet
+                }
+                worker.perturb();
+            }
+        });
+    stress::report(testName(), cfg, result);
+
+    for (const auto& instrument : instruments) {
+        auto trades = manager.getRecentTrades(instrument, 1);
+        ASSERT_EQ(trades.size(), 1u);
+        EXPECT_EQ(trades.back().price, static_cast<double>(cfg.operations));
+    }
+
+    // The processing thread drains about one update per millisecond
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (delivered.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (const auto& instrument : instruments) {
+        manager.unsubscribeFromMarketData(instrument);
+    }
+
+    // Stops the processing thread before the singletons it uses are torn down
+    manager.shutdown();
+
+    EXPECT_GT(delivered.load(), 0u);
+    EXPECT_EQ(out_of_order.load(), 0u);
+    EXPECT_EQ(bad_reads.load(), 0u);
+}
+
+// Volume is conserved while trades and timer-driven closes race, and each
+// instrument's bars close in time order
+TEST_F(ConcurrencyStressTest, BarAggregatorConservesVolume) {
+    auto cfg = config(4, 2, 1000);
+    SCOPED_TRACE(cfg.describe());
+    const auto timeframe = BarAggregator::Timeframe::SECOND_1;
+    const auto step = std::chrono::milliseconds(7);
+    const auto base = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now());
+
+    const std::string prefix = runPrefix("STRESS-BAR-", cfg);
+
+    auto& aggregator = BarAggregator::getInstance();
+    std::vector<std::string> instruments;
+    for (int p = 0; p < cfg.producers; ++p) {
+        instruments.push_back(prefix + std::to_string(p));
+    }
+
+    std::mutex closed_mutex;
+    std::map<std::string, std::vector<BarAggregator::Bar>> closed;
+    for (const auto& instrument : instruments) {
+        aggregator.subscribeToBars(instrument, timeframe, [&](const BarAggregator::Bar& bar) {
+            std::lock_guard<std::mutex> lock(closed_mutex);
+            closed[bar.instrument].push_back(bar);
+        });
+    }
+
+    stress::Runner runner(cfg);
+    auto result = runner.run(
+        [&](stress::Worker& worker) {
+            const auto& instrument = instruments[worker.index()];
+            for (size_t i = 0; i < cfg.operations; ++i) {
+                double price = 100.0 + static_cast<double>(worker.below(1000)) / 10.0;
+                aggregator.onTrade(instrument, price, 1.0, base + step * i);
+                worker.perturb();
+            }
+        },
+        [&](stress::Worker& worker) {
+            while (!runner.done()) {
+                aggregator.advanceTo(base + step * worker.below(cfg.operations));
+                BarAggregator::Bar bar;
+                aggregator.getOpenBar(instruments[worker.below(instruments.size())], timeframe, bar);
+                worker.perturb();
+            }
+        });
+    stress::report(testName(), cfg, result);
+
+    for (const auto& instrument : instruments) {
+        aggregator.unsubscribeFromBars(instrument);
+    }
+
+    std::lock_guard<std::mutex> lock(closed_mutex);
+    for (const auto& instrument : instruments) {
+        double volume = 0.0;
+        uint64_t trades = 0;
+        const auto& bars = closed[instrument];
+        for (size_t i = 0; i < bars.size(); ++i) {
+            volume += bars[i].volume;
+            trades += bars[i].trade_count;
+            // A timer close that runs ahead of the trade timestamps pushes
+            // later prints into the next bar; a closed period never reopens
+            if (i > 0) {
+                EXPECT_GT(bars[i].open_time, bars[i - 1].open_time);
+            }
+        }
+        BarAggregator::Bar open;
+        if (aggregator.getOpenBar(instrument, timeframe, open)) {
+            volume += open.volume;
+            trades += open.trade_count;
+        }
+        EXPECT_DOUBLE_EQ(volume, static_cast<double>(cfg.operations)) << instrument;
+        EXPECT_EQ(trades, cfg.operations) << instrument;
+    }
+}
+
+// Nested scopes from many threads charge exactly one event per scope while
+// threads register, sample and exit concurrently
+TEST_F(ConcurrencyStressTest, CpuAccountingCountsEveryScope) {
+    auto cfg = config(4, 2, 5000);
+    SCOPED_TRACE(cfg.describe());
+
+    auto& accounting = CpuAccounting::getInstance();
+    auto* outer = accounting.account("stress/outer");
+    auto* inner = accounting.account("stress/inner");
+    const uint64_t outer_before = outer->events.load();
+    const uint64_t inner_before = inner->events.load();
+    const std::string thread_prefix = runPrefix("stress-cpu-", cfg);
+
+    stress::Runner runner(cfg);
+    auto result = runner.run(
+        [&](stress::Worker& worker) {
+            CpuAccounting::ThreadRegistration registration(thread_prefix + std::to_string(worker.index()));
+            for (size_t i = 0; i < cfg.operations; ++i) {
+                CpuAccounting::Scope outer_scope(outer);
+                worker.perturb();
+                CpuAccounting::Scope inner_scope(inner);
+                worker.perturb();
+            }
+        },
+        [&](stress::Worker& worker) {
+            while (!runner.done()) {
+                accounting.sampleThreads();
+                accounting.getThreadStats();
+                accounting.getAccountStats();
+                accounting.account("stress/dynamic-" + std::to_string(worker.below(16)));
+                worker.perturb();
+            }
+        });
+    stress::report(testName(), cfg, result);
+
+    const uint64_t expected = static_cast<uint64_t>(cfg.producers) * cfg.operations;
+    EXPECT_EQ(outer->events.load() - outer_before, expected);
+    EXPECT_EQ(inner->events.load() - inner_before, expected);
+
+    size_t exited = 0;
+    for (const auto& stats : accounting.getThreadStats()) {
+        if (stats.name.rfind(thread_prefix, 0) == 0) {
+            EXPECT_FALSE(stats.alive);
+            exited++;
+        }
+    }
+    EXPECT_EQ(exited, static_cast<size_t>(cfg.producers));
+}
+
+// Recording and reporting used to re-lock the module mutex; any regression
+// shows up here as a hang or a lost sample
+TEST_F(ConcurrencyStressTest, LatencyModuleRecordsEverySample) {
+    auto cfg = config(4, 2, 5000);
+    SCOPED_TRACE(cfg.describe());
+    const std::string operation = "stress_" + std::to_string(cfg.seed);
+    const std::string report_file =
+        (std::filesystem::temp_directory_path() / ("latency_stress_" + std::to_string(cfg.seed) + ".csv")).string();
+
+    auto& latency = LatencyModule::getInstance();
+    latency.setHistorySize(static_cast<size_t>(cfg.producers) * cfg.operations);
+    latency.clearStats(operation);
+
+    stress::Runner runner(cfg);
+    auto result = runner.run(
+        [&](stress::Worker& worker) {
+            for (size_t i = 0; i < cfg.operations; ++i) {
+                latency.end(operation, latency.start(operation));
+                latency.trackMarketData(LatencyModule::Duration(worker.below(100)));
+                worker.perturb();
+            }
+        },
+        [&](stress::Worker& worker) {
+            while (!runner.done()) {
+                switch (worker.below(4)) {
+                    case 0: latency.getStats(operation); break;
+                    case 1: latency.getHistoricalStats(operation); break;
+                    case 2: latency.getMarketDataStats(); break;
+                    default: latency.saveStats(report_file); break;
+                }
+                worker.perturb();
+            }
+        });
+    stress::report(testName(), cfg, result);
+
+    EXPECT_EQ(latency.getStats(operation).count, static_cast<size_t>(cfg.producers) * cfg.operations);
+    latency.clearStats(operation);
+    latency.setHistorySize(1000);
+    std::remove(report_file.c_str());
+}
+
+// Callbacks and recovery actions log from inside logError; both used to
+// self-deadlock on the handler mutex
+TEST_F(ConcurrencyStressTest, ErrorHandlerAllowsReentrantLogging) {
+    auto cfg = config(4, 2, 500);
+    SCOPED_TRACE(cfg.describe());
+    const std::string echo_request = "stress-echo-request";
+
+    auto& handler = ErrorHandler::getInstance();
+    static std::once_flag installed;
+    std::call_once(installed, [&] {
+        handler.setErrorCallback([echo_request](const ErrorHandler::ErrorInfo& error) {
+            if (error.context == echo_request) {
+                LOG_INFO("echo: " + error.message, "stress-echo");
+            }
+        });
+        handler.addRecoveryAction({"stress-recovery", [] { return true; }, 0, 1, std::chrono::milliseconds(0)});
+    });
+    handler.enableRecovery(true);
+
+    const size_t errors_before = handler.getErrorCount();
+    const size_t recoveries_before = handler.getRecoveryAttemptCount();
+    std::atomic<size_t> oversized_reads{0};
+
+    stress::Runner runner(cfg);
+    auto result = runner.run(
+        [&](stress::Worker& worker) {
+            LOG_CRITICAL("stress critical " + std::to_string(worker.index()), "stress-critical");
+            for (size_t i = 0; i < cfg.operations; ++i) {
+                LOG_WARNING("stress warning " + std::to_string(i), echo_request);
+                worker.perturb();
+            }
+        },
+        [&](stress::Worker& worker) {
+            while (!runner.done()) {
+                if (handler.getRecentErrors(10).size() > 10) oversized_reads++;
+                handler.getErrorCount();
+                worker.perturb();
+            }
+        });
+    stress::report(testName(), cfg, result);
+
+    // Each warning is echoed once; each critical adds one recovery success
+    const size_t producers = static_cast<size_t>(cfg.producers);
+    EXPECT_EQ(handler.getErrorCount() - errors_before, 2 * producers * cfg.operations + 2 * producers);
+    EXPECT_EQ(handler.getRecoveryAttemptCount() - recoveries_before, producers);
+    EXPECT_EQ(oversized_reads.load(), 0u);
+}
+
+// Slots are staged, patched and removed from many threads at once
+TEST_F(ConcurrencyStressTest, OrderTemplateSlotsSurviveChurn) {
+    auto cfg = config(4, 0, 2000);
+    SCOPED_TRACE(cfg.describe());
+    const size_t instruments = 8;
+
+    auto& manager = OrderTemplateManager::getInstance();
+    std::atomic<size_t> failures{0};
+    stress::Runner runner(cfg);
+    auto result = runner.run([&](stress::Worker& worker) {
+        const std::string strategy = "stress-ot-" + std::to_string(worker.index());
+        for (size_t i = 0; i < cfg.operations; ++i) {
+            OrderTemplate::Config config;
+            config.instrument = "STRESS-OT-" + std::to_string(i % instruments);
+            auto& slot = manager.stageSlot(strategy, config);
+            worker.perturb();
+            if (manager.getSlot(strategy, config.instrument) != &slot) failures++;
+            if (!slot.buy.patch(i, 100.0 + worker.below(100), 1.0)) failures++;
+            if (worker.below(2) == 0) {
+                manager.removeSlot(strategy, config.instrument);
+            }
+        }
+    });
+    stress::report(testName(), cfg, result);
+
+    EXPECT_EQ(failures.load(), 0u);
+    for (int p = 0; p < cfg.producers; ++p) {
+        for (size_t i = 0; i < instruments; ++i) {
+            manager.removeSlot("stress-ot-" + std::to_string(p), "STRESS-OT-" + std::to_string(i));
+            EXPECT_EQ(manager.getSlot("stress-ot-" + std::to_string(p), "STRESS-OT-" + std::to_string(i)), nullptr);
+        }
+    }
+}
+
+// Diamond of stages behind a small ring: every stage sees every event once,
+// in sequence order, with all upstream writes visible
+TEST_F(ConcurrencyStressTest, SequencedPipelineDiamondSeesUpstreamWrites) {
+    auto cfg = config(1, 0, 20000);
+    SCOPED_TRACE(cfg.describe());
+
+    struct Event {
+        uint64_t value;
+        uint64_t decoded;
+        uint64_t left;
+        uint64_t right;
+    };
+
+    SequencedPipeline<Event> pipeline(64);
+    std::atomic<uint64_t> failures{0};
+    uint64_t expected[5] = {};
+
+    auto ordered = [&](size_t stage, uint64_t sequence) {
+        if (expected[stage]++ != sequence) failures++;
+    };
+    size_t decode = pipeline.addStage("decode", [&](Event& event, uint64_t sequence, bool) {
+        ordered(0, sequence);
+        if (event.value != sequence * 7) failures++;
+        event.decoded = event.value + 1;
+    });
+    size_t left = pipeline.addStage("left", [&](Event& event, uint64_t sequence, bool) {
+        ordered(1, sequence);
+        event.left = event.decoded * 2;
+    }, {decode});
+    size_t right = pipeline.addStage("right", [&](Event& event, uint64_t sequence, bool) {
+        ordered(2, sequence);
+        event.right = event.decoded + 3;
+    }, {decode});
+    pipeline.addStage("join", [&](Event& event, uint64_t sequence, bool) {
+        ordered(3, sequence);
+        if (event.left != (sequence * 7 + 1) * 2 || event.right != sequence * 7 + 4) failures++;
+    }, {left, right});
+    pipeline.addStage("journal", [&](Event& event, uint64_t sequence, bool) {
+        ordered(4, sequence);
+        if (event.value != sequence * 7) failures++;
+    });
+    pipeline.start();
+
+    stress::Runner runner(cfg);
+    auto result = runner.run([&](stress::Worker& worker) {
+        for (size_t i = 0; i < cfg.operations; ++i) {
+            pipeline.publish([i](Event& event) {
+                event.value = i * 7;
+                event.decoded = event.left = event.right = 0;
+            });
+            worker.perturb();
+        }
+    });
+    pipeline.stop();
+    stress::report(testName(), cfg, result);
+
+    EXPECT_EQ(failures.load(), 0u);
+    for (const auto& stats : pipeline.getStageStats()) {
+        EXPECT_EQ(stats.processed, cfg.operations) << stats.name;
+    }
+}
+
+// Each producer owns its instruments, so the alerts for one instrument are
+// dispatched in order: every transition starts from the level the previous
+// one ended at, and the last one matches the stored position. Readers must
+// always see the ranking sorted by distance.
+TEST_F(ConcurrencyStressTest, MarginMonitorAlertsChainPerPosition) {
+    auto cfg = config(4, 2, 2000);
+    SCOPED_TRACE(cfg.describe());
+    const size_t per_producer = 4;
+    auto instrument = [](int producer, size_t i) {
+        return "STRESS-MM-" + std::to_string(producer) + "-" + std::to_string(i);
+    };
+
+    auto& monitor = MarginMonitor::getInstance();
+    monitor.clear();
+    monitor.setThresholds(MarginMonitor::Thresholds{});
+
+    std::mutex alerts_mutex;
+    std::map<std::string, MarginMonitor::Level> last_level;
+    std::atomic<size_t> broken_chains{0};
+    monitor.setAlertCallback([&](const MarginMonitor::Alert& alert) {
+        if (alert.instrument.empty()) return;
+        std::lock_guard<std::mutex> lock(alerts_mutex);
+        auto it = last_level.find(alert.instrument);
+        const auto previous = it == last_level.end() ? MarginMonitor::Level::OK : it->second;
+        if (alert.previous_level != previous || alert.level == alert.previous_level) broken_chains++;
+        last_level[alert.instrument] = alert.level;
+    });
+
+    std::atomic<size_t> unsorted_reads{0};
+    stress::Runner runner(cfg);
+    auto result = runner.run(
+        [&](stress::Worker& worker) {
+            for (size_t i = 0; i < cfg.operations; ++i) {
+                const std::string name = instrument(worker.index(), worker.below(per_producer));
+                // Marks between 100 and 120 against a liquidation price of 90
+                const double mark = 100.0 + static_cast<double>(worker.below(2000)) / 100.0;
+                if (worker.below(10) == 0) {
+                    monitor.updatePosition(name, 1.0, mark, 90.0, 1.0, 0.5);
+                } else {
+                    monitor.onMark(name, mark);
+                }
+                worker.perturb();
+            }
+        },
+        [&](stress::Worker& worker) {
+            while (!runner.done()) {
+                auto closest = monitor.getClosestToLiquidation(8);
+                for (size_t i = 1; i < closest.size(); ++i) {
+                    if (closest[i - 1].distance > closest[i].distance) unsorted_reads++;
+                }
+                monitor.updateAccount(100.0, static_cast<double>(worker.below(100)));
+                worker.perturb();
+            }
+        });
+    stress::report(testName(), cfg, result);
+    monitor.setAlertCallback(nullptr);
+
+    EXPECT_EQ(broken_chains.load(), 0u);
+    EXPECT_EQ(unsorted_reads.load(), 0u);
+    for (int p = 0; p < cfg.producers; ++p) {
+        for (size_t i = 0; i < per_producer; ++i) {
+            MarginMonitor::PositionMargin position;
+            if (!monitor.getPosition(instrument(p, i), position)) continue;
+            auto it = last_level.find(instrument(p, i));
+            EXPECT_EQ(it == last_level.end() ? MarginMonitor::Level::OK : it->second, position.level)
+                << instrument(p, i);
+        }
+    }
+    monitor.clear();
+}
+
+// Concurrent kill-switch calls against heartbeats: every call reaches the
+// transport, and exactly the successful writes are counted as triggers
+TEST_F(ConcurrencyStressTest, EmergencyCancellerCountsEverySuccessfulWrite) {
+    auto cfg = config(4, 2, 200);
+    SCOPED_TRACE(cfg.describe());
+
+    std::atomic<size_t> writes{0};
+    std::atomic<size_t> failed_writes{0};
+    auto& canceller = EmergencyCanceller::getInstance();
+    EmergencyCanceller::Config canceller_config;
+    canceller_config.keepalive_interval = std::chrono::hours(1);
+    canceller_config.watchdog_timeout = std::chrono::milliseconds(0);
+    ASSERT_TRUE(canceller.initialize(canceller_config, [&](std::string_view) {
+        // Every third write fails
+        if (writes.fetch_add(1) % 3 == 2) {
+            failed_writes++;
+            return false;
+        }
+        return true;
+    }));
+    const size_t triggers = canceller.getTriggerCount();
+
+    std::atomic<size_t> reported{0};
+    stress::Runner runner(cfg);
+    auto result = runner.run(
+        [&](stress::Worker& worker) {
+            for (size_t i = 0; i < cfg.operations; ++i) {
+                if (canceller.cancelAll("stress " + std::to_string(worker.index()))) reported++;
+                worker.perturb();
+            }
+        },
+        [&](stress::Worker& worker) {
+            while (!runner.done()) {
+                canceller.heartbeat();
+                canceller.isArmed();
+                worker.perturb();
+            }
+        });
+    stress::report(testName(), cfg, result);
+    canceller.shutdown();
+
+    const size_t calls = static_cast<size_t>(cfg.producers) * cfg.operations;
+    EXPECT_EQ(writes.load(), calls);
+    EXPECT_EQ(reported.load(), calls - failed_writes.load());
+    EXPECT_EQ(canceller.getTriggerCount() - triggers, reported.load());
+    EXPECT_FALSE(canceller.cancelAll("stress: after shutdown"));
+    EXPECT_EQ(writes.load(), calls);
+}
@@ -17,7 +17,12 @@ void ConfigManager::loadDefaultConfig() {
         0.001,      // slippage_tolerance
         0.0005,     // price_tolerance
         3,          // max_retries
-        1000        // retry_delay_ms
+        1000,       // retry_delay_ms
+        0.05,       // price_band_pct
+        10,         // price_band_ticks
+        1000000.0,  // max_order_notional
+        5000000.0,  // max_instrument_notional
+        0.0         // max_scenario_loss
     };
 
     // Network configuration
@@ -29,7 +34,8 @@ void ConfigManager::loadDefaultConfig() {
         3000,       // write_timeout_ms
         30000,      // heartbeat_interval_ms
         1000,       // reconnect_interval_ms
-        5           // max_reconnect_attempts
+        5,          // max_reconnect_attempts
+        0           // watchdog_timeout_ms
     };
 
     // Performance configuration
@@ -39,7 +45,9 @@ void ConfigManager::loadDefaultConfig() {
         80,         // cpu_threshold_percent
         10000,      // max_queue_size
         100,        // batch_size
-        1000        // flush_interval_ms
+        1000,       // flush_interval_ms
+        10000,      // max_tracked_instruments
+        300000      // instrument_idle_timeout_ms
     };
 }
 
@@ -67,6 +75,11 @@ bool ConfigManager::loadConfig(const std::string& config_file) {
             trading_config_.price_tolerance = trading["price_tolerance"];
             trading_config_.max_retries = trading["max_retries"];
             trading_config_.retry_delay_ms = trading["retry_delay_ms"];
+            trading_config_.price_band_pct = trading.value("price_band_pct", trading_config_.price_band_pct);
+            trading_config_.price_band_ticks = trading.value("price_band_ticks", trading_config_.price_band_ticks);
+            trading_config_.max_order_notional = trading.value("max_order_notional", trading_config_.max_order_notional);
+            trading_config_.max_instrument_notional = trading.value("max_instrument_notional", trading_config_.max_instrument_notional);
+            trading_config_.max_scenario_loss = trading.value("max_scenario_loss", trading_config_.max_scenario_loss);
         }
 
         // Load network config
@@ -80,6 +93,7 @@ bool ConfigManager::loadConfig(const std::string& config_file) {
             network_config_.heartbeat_interval_ms = network["heartbeat_interval_ms"];
             network_config_.reconnect_interval_ms = network["reconnect_interval_ms"];
             network_config_.max_reconnect_attempts = network["max_reconnect_attempts"];
+            network_config_.watchdog_timeout_ms = network.value("watchdog_timeout_ms", network_config_.watchdog_timeout_ms);
         }
 
         // Load performance config
@@ -91,6 +105,8 @@ bool ConfigManager::loadConfig(const std::string& config_file) {
             performance_config_.max_queue_size = performance["max_queue_size"];
             performance_config_.batch_size = performance["batch_size"];
             performance_config_.flush_interval_ms = performance["flush_interval_ms"];
+            performance_config_.max_tracked_instruments = performance.value("max_tracked_instruments", performance_config_.max_tracked_instruments);
+            performance_config_.instrument_idle_timeout_ms = performance.value("instrument_idle_timeout_ms", performance_config_.instrument_idle_timeout_ms);
         }
 
         validateConfig();
@@ -116,7 +132,12 @@ bool ConfigManager::saveConfig(const std::string& config_file) {
             {"slippage_tolerance", trading_config_.slippage_tolerance},
             {"price_tolerance", trading_config_.price_tolerance},
             {"max_retries", trading_config_.max_retries},
-            {"retry_delay_ms", trading_config_.retry_delay_ms}
+            {"retry_delay_ms", trading_config_.retry_delay_ms},
+            {"price_band_pct", trading_config_.price_band_pct},
+            {"price_band_ticks", trading_config_.price_band_ticks},
+            {"max_order_notional", trading_config_.max_order_notional},
+            {"max_instrument_notional", trading_config_.max_instrument_notional},
+            {"max_scenario_loss", trading_config_.max_scenario_loss}
         };
 
         // Save network config
@@ -128,7 +149,8 @@ bool ConfigManager::saveConfig(const std::string& config_file) {
             {"write_timeout_ms", network_config_.write_timeout_ms},
             {"heartbeat_interval_ms", network_config_.heartbeat_interval_ms},
             {"reconnect_interval_ms", network_config_.reconnect_interval_ms},
-            {"max_reconnect_attempts", network_config_.max_reconnect_attempts}
+            {"max_reconnect_attempts", network_config_.max_reconnect_attempts},
+            {"watchdog_timeout_ms", network_config_.watchdog_timeout_ms}
         };
 
         // Save performance config
@@ -138,7 +160,9 @@ bool ConfigManager::saveConfig(const std::string& config_file) {
             {"cpu_threshold_percent", performance_config_.cpu_threshold_percent},
             {"max_queue_size", performance_config_.max_queue_size},
             {"batch_size", performance_config_.batch_size},
-            {"flush_interval_ms", performance_config_.flush_interval_ms}
+            {"flush_interval_ms", performance_config_.flush_interval_ms},
+            {"max_tracked_instruments", performance_config_.max_tracked_instruments},
+            {"instrument_idle_timeout_ms", performance_config_.instrument_idle_timeout_ms}
         };
 
         std::ofstream file(config_file);
@@ -181,7 +205,12 @@ void ConfigManager::validateConfig() {
         trading_config_.slippage_tolerance <= 0 ||
         trading_config_.price_tolerance <= 0 ||
         trading_config_.max_retries < 0 ||
-        trading_config_.retry_delay_ms < 0) {
+        trading_config_.retry_delay_ms < 0 ||
+        trading_config_.price_band_pct < 0 ||
+        trading_config_.price_band_ticks < 0 ||
+        trading_config_.max_order_notional < 0 ||
+        trading_config_.max_instrument_notional < 0 ||
+        trading_config_.max_scenario_loss < 0) {
         throw std::invalid_argument("Invalid trading configuration");
     }
 
@@ -191,7 +220,8 @@ void ConfigManager::validateConfig() {
         network_config_.write_timeout_ms <= 0 ||
         network_config_.heartbeat_interval_ms <= 0 ||
         network_config_.reconnect_interval_ms <= 0 ||
-        network_config_.max_reconnect_attempts < 0) {
+        network_config_.max_reconnect_attempts < 0 ||
+        network_config_.watchdog_timeout_ms < 0) {
         throw std::invalid_argument("Invalid network configuration");
     }
 
@@ -201,7 +231,9 @@ void ConfigManager::validateConfig() {
         performance_config_.cpu_threshold_percent <= 0 ||
         performance_config_.max_queue_size <= 0 ||
         performance_config_.batch_size <= 0 ||
-        performance_config_.flush_interval_ms <= 0) {
+        performance_config_.flush_interval_ms <= 0 ||
+        performance_config_.max_tracked_instruments <= 0 ||
+        performance_config_.instrument_idle_timeout_ms <= 0) {
         throw std::invalid_argument("Invalid performance configuration");
     }
 } 
\ No newline at end of file
@@ -20,6 +20,11 @@ public:
         double price_tolerance;
         int max_retries;
         int retry_delay_ms;
+        double price_band_pct;           // Collar around mark/mid, 0 disables
+        int price_band_ticks;            // Minimum collar width in ticks
+        double max_order_notional;       // Per order, 0 disables
+        double max_instrument_notional;  // Per instrument position after fill, 0 disables
+        double max_scenario_loss;        // Worst options stress-grid loss after fill, 0 disables
     };
 
     struct NetworkConfig {
@@ -31,6 +36,7 @@ public:
         int heartbeat_interval_ms;
         int reconnect_interval_ms;
         int max_reconnect_attempts;
+        int watchdog_timeout_ms;         // Emergency cancel after this long without a feed heartbeat, 0 disables
     };
 
     struct PerformanceConfig {
@@ -40,6 +46,8 @@ public:
         int max_queue_size;
         int batch_size;
         int flush_interval_ms;
+        int max_tracked_instruments;     // Unpinned instrument state beyond this is evicted LRU-first
+        int instrument_idle_timeout_ms;  // Unpinned instruments idle this long are evicted
     };
 
     static ConfigManager& getInstance() {
@@ -0,0 +1,219 @@
+#include "cpu_accounting.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace {
+
+thread_local CpuAccounting::Scope* current_scope = nullptr;
+
+#ifdef _WIN32
+uint64_t filetimeNanos(const FILETIME& ft) {
+    ULARGE_INTEGER value;
+    value.LowPart = ft.dwLowDateTime;
+    value.HighPart = ft.dwHighDateTime;
+    return value.QuadPart * 100;  // 100 ns units
+}
+
+bool readThreadCpu(HANDLE thread, uint64_t& cpu_ns) {
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(thread, &creation, &exit, &kernel, &user)) {
+        return false;
+    }
+    cpu_ns = filetimeNanos(kernel) + filetimeNanos(user);
+    return true;
+}
+#else
+bool readThreadCpu(clockid_t clock, uint64_t& cpu_ns) {
+    timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return false;
+    }
+    cpu_ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    return true;
+}
+#endif
+
+}  // namespace
+
+struct CpuAccounting::ThreadEntry {
+    std::string name;
+#ifdef _WIN32
+    HANDLE handle{nullptr};
+#else
+    clockid_t clock{};
+#endif
+    uint64_t cpu_ns{0};
+    uint64_t last_sample_cpu_ns{0};
+    std::chrono::steady_clock::time_point last_sample;
+    double utilization{0.0};
+
+    bool read(uint64_t& value) const {
+#ifdef _WIN32
+        return readThreadCpu(handle, value);
+#else
+        return readThreadCpu(clock, value);
+#endif
+    }
+
+    ~ThreadEntry() {
+#ifdef _WIN32
+        if (handle) CloseHandle(handle);
+#endif
+    }
+};
+
+CpuAccounting::CpuAccounting() = default;
+CpuAccounting::~CpuAccounting() = default;
+
+uint64_t CpuAccounting::threadCpuNanos() {
+    uint64_t cpu_ns = 0;
+#ifdef _WIN32
+    readThreadCpu(GetCurrentThread(), cpu_ns);
+#else
+    readThreadCpu(CLOCK_THREAD_CPUTIME_ID, cpu_ns);
+#endif
+    return cpu_ns;
+}
+
+CpuAccounting::Scope::Scope(Account* account) : account_(account) {
+    if (!account_ || !CpuAccounting::getInstance().isEnabled()) {
+        account_ = nullptr;
+        return;
+    }
+
+    segment_start_ns_ = threadCpuNanos();
+    parent_ = current_scope;
+    if (parent_) {
+        // The parent is paused while this scope runs
+        parent_->account_->cpu_ns.fetch_add(segment_start_ns_ - parent_->segment_start_ns_,
+                                            std::memory_order_relaxed);
+    }
+    current_scope = this;
+}
+
+CpuAccounting::Scope::~Scope() {
+    if (!account_) {
+        return;
+    }
+
+    uint64_t now = threadCpuNanos();
+    account_->cpu_ns.fetch_add(now - segment_start_ns_, std::memory_order_relaxed);
+    account_->events.fetch_add(1, std::memory_order_relaxed);
+
+    current_scope = parent_;
+    if (parent_) {
+        parent_->segment_start_ns_ = now;
+    }
+}
+
+CpuAccounting::Account* CpuAccounting::account(const std::string& name) {
+    std::lock_guard<std::mutex> lock(accounts_mutex_);
+    auto& account = accounts_[name];
+    if (!account) {
+        account = std::make_unique<Account>(name);
+    }
+    return account.get();
+}
+
+void CpuAccounting::setBudget(const std::string& name, double cpu_us_per_event) {
+    account(name)->budget_us_per_event.store(cpu_us_per_event, std::memory_order_relaxed);
+}
+
+void CpuAccounting::registerThread(const std::string& name) {
+    auto entry = std::make_unique<ThreadEntry>();
+    entry->name = name;
+#ifdef _WIN32
+    if (!DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &entry->handle,
+                         THREAD_QUERY_LIMITED_INFORMATION, FALSE, 0)) {
+        return;
+    }
+#else
+    if (pthread_getcpuclockid(pthread_self(), &entry->clock) != 0) {
+        return;
+    }
+#endif
+    entry->read(entry->cpu_ns);
+    entry->last_sample_cpu_ns = entry->cpu_ns;
+    entry->last_sample = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    threads_[std::this_thread::get_id()] = std::move(entry);
+}
+
+void CpuAccounting::unregisterThread() {
+    uint64_t cpu_ns = threadCpuNanos();
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    auto it = threads_.find(std::this_thread::get_id());
+    if (it == threads_.end()) {
+        return;
+    }
+    // Keep the final figure; the clock becomes invalid once the thread exits
+    exited_threads_.push_back({it->second->name, cpu_ns, 0.0, false});
+    threads_.erase(it);
+}
+
+void CpuAccounting::sampleThreads() {
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (auto& [_, entry] : threads_) {
+        uint64_t cpu_ns = 0;
+        if (!entry->read(cpu_ns)) {
+            continue;
+        }
+        double wall_ns = std::chrono::duration<double, std::nano>(now - entry->last_sample).count();
+        if (wall_ns > 0.0) {
+            entry->utilization = (cpu_ns - entry->last_sample_cpu_ns) / wall_ns;
+        }
+        entry->cpu_ns = cpu_ns;
+        entry->last_sample_cpu_ns = cpu_ns;
+        entry->last_sample = now;
+    }
+}
+
+std::vector<CpuAccounting::AccountStats> CpuAccounting::getAccountStats() const {
+    std::lock_guard<std::mutex> lock(accounts_mutex_);
+    std::vector<AccountStats> stats;
+    stats.reserve(accounts_.size());
+    for (const auto& [name, account] : accounts_) {
+        uint64_t cpu_ns = account->cpu_ns.load(std::memory_order_relaxed);
+        uint64_t events = account->events.load(std::memory_order_relaxed);
+        double budget = account->budget_us_per_event.load(std::memory_order_relaxed);
+        double per_event = events ? cpu_ns / 1000.0 / events : 0.0;
+        stats.push_back({name, cpu_ns, events, per_event, budget, budget > 0.0 && per_event > budget});
+    }
+    // Most expensive first
+    std::sort(stats.begin(), stats.end(),
+              [](const AccountStats& a, const AccountStats& b) { return a.cpu_ns > b.cpu_ns; });
+    return stats;
+}
+
+std::vector<CpuAccounting::ThreadStats> CpuAccounting::getThreadStats() const {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    std::vector<ThreadStats> stats;
+    stats.reserve(threads_.size() + exited_threads_.size());
+    for (const auto& [_, entry] : threads_) {
+        stats.push_back({entry->name, entry->cpu_ns, entry->utilization, true});
+    }
+    stats.insert(stats.end(), exited_threads_.begin(), exited_threads_.end());
+    return stats;
+}
+
+void CpuAccounting::reset() {
+    {
+        std::lock_guard<std::mutex> lock(accounts_mutex_);
+        for (auto& [_, account] : accounts_) {
+            account->cpu_ns.store(0, std::memory_order_relaxed);
+            account->events.store(0, std::memory_order_relaxed);
+        }
+    }
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    exited_threads_.clear();
+}
@@ -0,0 +1,124 @@
+#ifndef CPU_ACCOUNTING_H
+#define CPU_ACCOUNTING_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+
+// Attributes CPU time to threads and to units of work. Registered threads are
+// sampled from their per-thread CPU clocks, giving utilization per thread.
+// Scopes charge the calling thread's CPU time to an account (a strategy, a
+// pipeline stage); nested scopes pause their parent, so each account gets
+// self time only and nothing is counted twice. A scope costs two reads of
+// the thread CPU clock and two relaxed atomic adds.
+class CpuAccounting {
+public:
+    struct Account {
+        explicit Account(std::string account_name) : name(std::move(account_name)) {}
+
+        const std::string name;
+        std::atomic<uint64_t> cpu_ns{0};
+        std::atomic<uint64_t> events{0};
+        std::atomic<double> budget_us_per_event{0.0};  // 0 = no budget
+    };
+
+    struct AccountStats {
+        std::string name;
+        uint64_t cpu_ns;
+        uint64_t events;
+        double cpu_us_per_event;
+        double budget_us_per_event;
+        bool over_budget;
+    };
+
+    struct ThreadStats {
+        std::string name;
+        uint64_t cpu_ns;       // Total since the thread started
+        double utilization;    // Fraction of one core since the previous sample
+        bool alive;
+    };
+
+    // Charges CPU used on this thread between construction and destruction
+    class Scope {
+    public:
+        explicit Scope(Account* account);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Account* account_;
+        Scope* parent_{nullptr};
+        uint64_t segment_start_ns_{0};
+    };
+
+    // Registers the current thread for its lifetime
+    class ThreadRegistration {
+    public:
+        explicit ThreadRegistration(const std::string& name) { CpuAccounting::getInstance().registerThread(name); }
+        ~ThreadRegistration() { CpuAccounting::getInstance().unregisterThread(); }
+
+        ThreadRegistration(const ThreadRegistration&) = delete;
+        ThreadRegistration& operator=(const ThreadRegistration&) = delete;
+    };
+
+    static CpuAccounting& getInstance() {
+        static CpuAccounting instance;
+        return instance;
+    }
+
+    // CPU time consumed by the calling thread
+    static uint64_t threadCpuNanos();
+
+    // Returns a pointer that stays valid for the life of the process; resolve
+    // once and keep it rather than looking it up per event
+    Account* account(const std::string& name);
+    void setBudget(const std::string& name, double cpu_us_per_event);
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void registerThread(const std::string& name);
+    void unregisterThread();
+
+    // Reads every registered thread's CPU clock and updates utilization
+    void sampleThreads();
+
+    std::vector<AccountStats> getAccountStats() const;
+    std::vector<ThreadStats> getThreadStats() const;
+    void reset();
+
+private:
+    CpuAccounting();
+    ~CpuAccounting();
+    CpuAccounting(const CpuAccounting&) = delete;
+    CpuAccounting& operator=(const CpuAccounting&) = delete;
+
+    struct ThreadEntry;
+
+    std::atomic<bool> enabled_{true};
+
+    mutable std::mutex accounts_mutex_;
+    std::map<std::string, std::unique_ptr<Account>> accounts_;
+
+    mutable std::mutex threads_mutex_;
+    std::map<std::thread::id, std::unique_ptr<ThreadEntry>> threads_;
+    std::vector<ThreadStats> exited_threads_;
+};
+
+#define CPU_SCOPE_CONCAT_INNER(a, b) a##b
+#define CPU_SCOPE_CONCAT(a, b) CPU_SCOPE_CONCAT_INNER(a, b)
+
+// Charges the rest of the enclosing block to a fixed account name
+#define CPU_SCOPE(name) \
+    static CpuAccounting::Account* const CPU_SCOPE_CONCAT(cpu_account_, __LINE__) = \
+        CpuAccounting::getInstance().account(name); \
+    CpuAccounting::Scope CPU_SCOPE_CONCAT(cpu_scope_, __LINE__)(CPU_SCOPE_CONCAT(cpu_account_, __LINE__))
+
+#endif // CPU_ACCOUNTING_H
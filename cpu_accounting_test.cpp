@@ -0,0 +1,85 @@
+#include "cpu_accounting.h"
+#include <gtest/gtest.h>
+#include <string>
+
+class CpuAccountingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CpuAccounting::getInstance().reset();
+    }
+
+    // Spins until this thread has used the given CPU time
+    static void burn(uint64_t cpu_ns) {
+        const uint64_t start = CpuAccounting::threadCpuNanos();
+        volatile uint64_t sink = 0;
+        while (CpuAccounting::threadCpuNanos() - start < cpu_ns) {
+            sink = sink + 1;
+        }
+    }
+
+    static CpuAccounting::AccountStats stats(const std::string& name) {
+        for (const auto& account : CpuAccounting::getInstance().getAccountStats()) {
+            if (account.name == name) return account;
+        }
+        ADD_FAILURE() << "No account " << name;
+        return {};
+    }
+
+    static constexpr uint64_t MS = 1000000;
+};
+
+TEST_F(CpuAccountingTest, NestedScopesChargeSelfTimeOnly) {
+    auto& cpu = CpuAccounting::getInstance();
+    auto* parent = cpu.account("test/nested-parent");
+    auto* child = cpu.account("test/nested-child");
+    ASSERT_EQ(cpu.account("test/nested-parent"), parent);
+
+    {
+        CpuAccounting::Scope outer(parent);
+        burn(10 * MS);
+        {
+            CpuAccounting::Scope inner(child);
+            burn(30 * MS);
+        }
+    }
+
+    // The child's time is not counted again in the parent
+    const auto parent_stats = stats("test/nested-parent");
+    const auto child_stats = stats("test/nested-child");
+    EXPECT_EQ(parent_stats.events, 1u);
+    EXPECT_EQ(child_stats.events, 1u);
+    EXPECT_GE(child_stats.cpu_ns, 30 * MS);
+    EXPECT_GE(parent_stats.cpu_ns, 10 * MS);
+    EXPECT_LT(parent_stats.cpu_ns, 30 * MS);
+}
+
+TEST_F(CpuAccountingTest, BudgetFlagsExpensiveAccounts) {
+    auto& cpu = CpuAccounting::getInstance();
+    cpu.setBudget("test/budget-tight", 100.0);
+    cpu.setBudget("test/budget-loose", 1e9);
+    for (const char* name : {"test/budget-tight", "test/budget-loose", "test/budget-none"}) {
+        CpuAccounting::Scope scope(cpu.account(name));
+        burn(1 * MS);
+    }
+
+    const auto tight = stats("test/budget-tight");
+    EXPECT_DOUBLE_EQ(tight.budget_us_per_event, 100.0);
+    EXPECT_GE(tight.cpu_us_per_event, 1000.0);
+    EXPECT_TRUE(tight.over_budget);
+    EXPECT_FALSE(stats("test/budget-loose").over_budget);
+    EXPECT_FALSE(stats("test/budget-none").over_budget);
+}
+
+TEST_F(CpuAccountingTest, DisabledScopesChargeNothing) {
+    auto& cpu = CpuAccounting::getInstance();
+    auto* account = cpu.account("test/disabled");
+    cpu.setEnabled(false);
+    {
+        CpuAccounting::Scope scope(account);
+        burn(1 * MS);
+    }
+    cpu.setEnabled(true);
+
+    EXPECT_EQ(account->cpu_ns.load(), 0u);
+    EXPECT_EQ(account->events.load(), 0u);
+}
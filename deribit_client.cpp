@@ -1,4 +1,9 @@
 #include "deribit_client.h"
+#include "margin_monitor.h"
+#include "emergency_canceller.h"
+#include "risk_manager.h"
+#include "cpu_accounting.h"
+#include "bar_aggregator.h"
 #include <cpprest/http_client.h>
 #include <cpprest/ws_client.h>
 #include <openssl/hmac.h>
@@ -11,6 +16,20 @@ using namespace web::http;
 using namespace web::http::client;
 using namespace web::websockets::client;
 
+namespace {
+
+// Notifications are stamped in milliseconds since the epoch; bars and book
+// times follow the exchange clock, not ours
+std::chrono::system_clock::time_point exchangeTime(const nlohmann::json& data) {
+    if (data.contains("timestamp") && data["timestamp"].is_number()) {
+        return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::milliseconds(data["timestamp"].get<int64_t>())));
+    }
+    return std::chrono::system_clock::now();
+}
+
+} // namespace
+
 DeribitClient::DeribitClient()
     : is_connected_(false),
       config_manager_(ConfigManager::getInstance()),
@@ -30,6 +49,7 @@ void DeribitClient::initialize(const std::string& api_key, const std::string& ap
     
     // Initialize WebSocket connection
     websocket_ = std::make_unique<websocket_callback_client>();
+    startFeedPipeline();
     
     websocket_->connect(network_config.websocket_endpoint).then([this]() {
         is_connected_ = true;
@@ -57,6 +77,7 @@ void DeribitClient::shutdown() {
     if (is_connected_ && websocket_) {
         websocket_->close().wait();
     }
+    stopFeedPipeline();
 }
 
 bool DeribitClient::authenticate() {
@@ -76,6 +97,18 @@ bool DeribitClient::authenticate() {
     
     // Send authentication message
     websocket_->send(auth_msg.dump()).wait();
+
+    // Requests are handled in order, so this runs on the authenticated
+    // session: resting orders are pulled if the connection drops
+    nlohmann::json cod_msg = {
+        {"jsonrpc", "2.0"},
+        {"id", 9939},
+        {"method", "private/enable_cancel_on_disconnect"},
+        {"params", {
+            {"scope", "connection"}
+        }}
+    };
+    websocket_->send(cod_msg.dump()).wait();
     return true;
 }
 
@@ -146,12 +179,15 @@ bool DeribitClient::modifyOrder(const std::string& order_id, double new_size, do
 }
 
 void DeribitClient::subscribeToOrderBook(const std::string& instrument) {
+    const std::string channel = "book." + instrument + ".100ms";
+    channel_dispatcher_.addChannel(channel, ChannelDispatcher::ChannelKind::BOOK, instrument);
+
     nlohmann::json sub_msg = {
         {"jsonrpc", "2.0"},
         {"id", 9934},
         {"method", "public/subscribe"},
         {"params", {
-            {"channels", {"book." + instrument + ".100ms"}}
+            {"channels", {channel}}
         }}
     };
     
@@ -159,19 +195,42 @@ void DeribitClient::subscribeToOrderBook(const std::string& instrument) {
 }
 
 void DeribitClient::subscribeToTrades(const std::string& instrument) {
+    const std::string channel = "trades." + instrument + ".100ms";
+    channel_dispatcher_.addChannel(channel, ChannelDispatcher::ChannelKind::TRADES, instrument);
+
     nlohmann::json sub_msg = {
         {"jsonrpc", "2.0"},
         {"id", 9935},
         {"method", "public/subscribe"},
         {"params", {
-            {"channels", {"trades." + instrument + ".100ms"}}
+            {"channels", {channel}}
         }}
     };
     
     websocket_->send(sub_msg.dump()).wait();
 }
 
+void DeribitClient::subscribeToTicker(const std::string& instrument) {
+    const std::string channel = "ticker." + instrument + ".100ms";
+    channel_dispatcher_.addChannel(channel, ChannelDispatcher::ChannelKind::TICKER, instrument);
+
+    nlohmann::json sub_msg = {
+        {"jsonrpc", "2.0"},
+        {"id", 9938},
+        {"method", "public/subscribe"},
+        {"params", {
+            {"channels", {channel}}
+        }}
+    };
+
+    websocket_->send(sub_msg.dump()).wait();
+}
+
 void DeribitClient::subscribeToUserData() {
+    for (const char* channel : {"user.orders.*", "user.trades.*", "user.portfolio.*"}) {
+        channel_dispatcher_.addChannel(channel, ChannelDispatcher::ChannelKind::USER);
+    }
+
     nlohmann::json sub_msg = {
         {"jsonrpc", "2.0"},
         {"id", 9936},
@@ -184,32 +243,114 @@ void DeribitClient::subscribeToUserData() {
     websocket_->send(sub_msg.dump()).wait();
 }
 
+void DeribitClient::unsubscribe(const std::string& channel) {
+    channel_dispatcher_.removeChannel(channel);
+
+    nlohmann::json unsub_msg = {
+        {"jsonrpc", "2.0"},
+        {"id", 9937},
+        {"method", channel.compare(0, 5, "user.") == 0 ? "private/unsubscribe" : "public/unsubscribe"},
+        {"params", {
+            {"channels", {channel}}
+        }}
+    };
+
+    websocket_->send(unsub_msg.dump()).wait();
+}
+
+void DeribitClient::configureFeedPipeline(const FeedPipelineConfig& config) {
+    std::lock_guard<std::mutex> lock(feed_publish_mutex_);
+    if (feed_pipeline_) {
+        throw std::logic_error("Feed pipeline is already running");
+    }
+    feed_config_ = config;
+}
+
+void DeribitClient::startFeedPipeline() {
+    std::lock_guard<std::mutex> lock(feed_publish_mutex_);
+    if (feed_pipeline_) {
+        return;
+    }
+
+    auto pipeline = std::make_unique<SequencedPipeline<FeedEvent>>(feed_config_.capacity);
+    // Frames are parsed in parallel; the book stage waits on every decoder,
+    // so it still applies them in the order they arrived on the connection
+    auto decoders = pipeline->addWorkerPool("decode",
+        [this](FeedEvent& event, uint64_t, bool) { decodeFeedEvent(event); },
+        std::max<size_t>(1, feed_config_.decode_workers), {}, feed_config_.decode_cpu);
+    auto book = pipeline->addStage("book",
+        [this](FeedEvent& event, uint64_t, bool) { applyFeedEvent(event); },
+        decoders, feed_config_.book_cpu);
+    // Strategies run after the bars for the same event are updated, so they
+    // can read them
+    auto features = pipeline->addStage("features",
+        [this](FeedEvent& event, uint64_t, bool) { updateFeatures(event); },
+        {book}, feed_config_.feature_cpu);
+    pipeline->addStage("strategy",
+        [this](FeedEvent& event, uint64_t, bool) { dispatchToStrategies(event); },
+        {features}, feed_config_.strategy_cpu);
+
+    if (!feed_config_.journal_path.empty()) {
+        feed_journal_.open(feed_config_.journal_path, std::ios::app);
+        if (feed_journal_.is_open()) {
+            pipeline->addStage("journal",
+                [this](FeedEvent& event, uint64_t sequence, bool end_of_batch) {
+                    journalFeedEvent(event, sequence, end_of_batch);
+                },
+                {}, feed_config_.journal_cpu);
+        } else if (error_callback_) {
+            error_callback_("Cannot open feed journal " + feed_config_.journal_path);
+        }
+    }
+
+    // The stages above replace MarketDataManager's own queue and bar feed
+    market_data_manager_.setPipelineDispatch(true);
+    pipeline->start();
+    feed_pipeline_ = std::move(pipeline);
+}
+
+void DeribitClient::stopFeedPipeline() {
+    std::lock_guard<std::mutex> lock(feed_publish_mutex_);
+    if (!feed_pipeline_) {
+        return;
+    }
+    // Drains what was already received
+    feed_pipeline_->stop();
+    feed_pipeline_.reset();
+    market_data_manager_.setPipelineDispatch(false);
+    if (feed_journal_.is_open()) {
+        feed_journal_.close();
+    }
+}
+
 void DeribitClient::handleWebSocketMessage(const std::string& message) {
+    std::lock_guard<std::mutex> lock(feed_publish_mutex_);
+    if (!feed_pipeline_) {
+        return;
+    }
+    feed_pipeline_->publish([&message](FeedEvent& event) {
+        event.message.assign(message);
+        event.received = std::chrono::system_clock::now();
+        event.routed = false;
+        event.trades.clear();
+        event.exchange_time = {};
+    });
+}
+
+void DeribitClient::decodeFeedEvent(FeedEvent& event) {
+    CPU_SCOPE("feed_decode");
     try {
-        auto json = nlohmann::json::parse(message);
+        event.json = nlohmann::json::parse(event.message);
         
-        // Handle subscription messages
-        if (json.contains("method") && json["method"] == "subscription") {
-            const auto& params = json["params"];
-            const auto& channel = params["channel"].get<std::string>();
+        // Only subscription notifications go on to the book stage
+        if (event.json.contains("method") && event.json["method"] == "subscription") {
+            const auto& channel = event.json["params"]["channel"].get_ref<const std::string&>();
             
-            if (channel.starts_with("book.")) {
-                std::string instrument = channel.substr(5, channel.find(".", 5) - 5);
-                processOrderBookUpdate(instrument, params["data"]);
-            }
-            else if (channel.starts_with("trades.")) {
-                std::string instrument = channel.substr(7, channel.find(".", 7) - 7);
-                processTradeUpdate(instrument, params["data"]);
-            }
-            else if (channel.starts_with("user.")) {
-                processUserDataUpdate(params["data"]);
-            }
-        }
-        // Handle response messages
-        else if (json.contains("id")) {
-            // Process specific responses based on the request ID
-            // This would be expanded based on the actual response handling needs
+            // User notifications arrive on concrete channels and match the
+            // wildcard USER routes we subscribed with
+            event.routed = channel_dispatcher_.find(channel, event.route);
         }
+        // Responses (messages with an id) are not handled here yet
         
     } catch (const std::exception& e) {
         if (error_callback_) {
@@ -218,10 +359,78 @@ void DeribitClient::handleWebSocketMessage(const std::string& message) {
     }
 }
 
-void DeribitClient::processOrderBookUpdate(const std::string& instrument, const nlohmann::json& data) {
+void DeribitClient::applyFeedEvent(FeedEvent& event) {
+    // Any frame reaching the book thread, subscription data or not, shows
+    // the feed and this stage are alive
+    EmergencyCanceller::getInstance().heartbeat();
+    if (!event.routed) {
+        return;
+    }
+    CPU_SCOPE("feed_apply");
+    try {
+        const auto& data = event.json["params"]["data"];
+        switch (event.route.kind) {
+            case ChannelDispatcher::ChannelKind::BOOK:
+                processOrderBookUpdate(*event.route.instrument, data, event.exchange_time);
+                break;
+            case ChannelDispatcher::ChannelKind::TRADES:
+                processTradeUpdate(*event.route.instrument, data, event.trades);
+                break;
+            case ChannelDispatcher::ChannelKind::TICKER:
+                processTickerUpdate(*event.route.instrument, event.route.instrument_id, data);
+                break;
+            case ChannelDispatcher::ChannelKind::USER:
+                processUserDataUpdate(data);
+                break;
+        }
+    } catch (const std::exception& e) {
+        if (error_callback_) {
+            error_callback_("Error processing WebSocket message: " + std::string(e.what()));
+        }
+    }
+}
+
+void DeribitClient::updateFeatures(FeedEvent& event) {
+    if (event.trades.empty() && event.exchange_time == std::chrono::system_clock::time_point{}) {
+        return;
+    }
+    CPU_SCOPE("feed_features");
+    auto& bars = BarAggregator::getInstance();
+    for (const auto& trade : event.trades) {
+        bars.onTrade(trade.instrument, trade.price, trade.size, trade.timestamp);
+    }
+    // Book updates close bars on instruments that are not trading
+    if (event.exchange_time != std::chrono::system_clock::time_point{}) {
+        bars.advanceTo(event.exchange_time);
+    }
+}
+
+void DeribitClient::dispatchToStrategies(FeedEvent& event) {
+    // Book and trade updates reach strategies; subscribers see the
+    // instrument's latest state, which may already include later events
+    if (!event.routed || (event.route.kind != ChannelDispatcher::ChannelKind::BOOK &&
+                          event.route.kind != ChannelDispatcher::ChannelKind::TRADES)) {
+        return;
+    }
+    market_data_manager_.dispatch(*event.route.instrument);
+}
+
+void DeribitClient::journalFeedEvent(const FeedEvent& event, uint64_t sequence, bool end_of_batch) {
+    // One line per message: sequence, receive time (ns since epoch), raw text
+    feed_journal_ << sequence << '\t'
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(event.received.time_since_epoch()).count()
+                  << '\t' << event.message << '\n';
+    if (end_of_batch) {
+        feed_journal_.flush();
+    }
+}
+
+void DeribitClient::processOrderBookUpdate(const std::string& instrument, const nlohmann::json& data,
+                                           std::chrono::system_clock::time_point& exchange_time) {
     MarketDataManager::OrderBook orderbook;
     orderbook.instrument = instrument;
-    orderbook.timestamp = std::chrono::system_clock::now();
+    orderbook.timestamp = exchangeTime(data);
+    exchange_time = orderbook.timestamp;
     
     // Process bids
     for (const auto& bid : data["bids"]) {
@@ -244,15 +453,96 @@ void DeribitClient::processOrderBookUpdate(const std::string& instrument, const
     market_data_manager_.updateOrderBook(orderbook);
 }
 
-void DeribitClient::processTradeUpdate(const std::string& instrument, const nlohmann::json& data) {
-    MarketDataManager::Trade trade;
-    trade.instrument = instrument;
-    trade.price = data["price"];
-    trade.size = data["amount"];
-    trade.side = data["direction"];
-    trade.timestamp = std::chrono::system_clock::now();
-    
-    market_data_manager_.addTrade(trade);
+void DeribitClient::processTradeUpdate(const std::string& instrument, const nlohmann::json& data,
+                                       std::vector<MarketDataManager::Trade>& trades) {
+    auto apply = [&](const nlohmann::json& print) {
+        MarketDataManager::Trade trade;
+        trade.instrument = instrument;
+        trade.price = print["price"];
+        trade.size = print["amount"];
+        trade.side = print["direction"];
+        trade.timestamp = exchangeTime(print);
+
+        market_data_manager_.addTrade(trade);
+        trades.push_back(std::move(trade));
+    };
+
+    if (data.is_array()) {
+        for (const auto& print : data) {
+            apply(print);
+        }
+    } else {
+        apply(data);
+    }
+}
+
+void DeribitClient::processTickerUpdate(const std::string& instrument, uint32_t instrument_id,
+                                        const nlohmann::json& data) {
+    // Deribit sends null for empty sides and omits funding on dated contracts
+    auto number = [&data](const char* key) {
+        auto it = data.find(key);
+        return (it != data.end() && it->is_number()) ? it->get<double>() : 0.0;
+    };
+
+    MarketDataManager::TopOfBook ticker;
+    ticker.instrument = instrument;
+    ticker.best_bid = number("best_bid_price");
+    ticker.best_bid_size = number("best_bid_amount");
+    ticker.best_ask = number("best_ask_price");
+    ticker.best_ask_size = number("best_ask_amount");
+    ticker.last_price = number("last_price");
+    ticker.mark_price = number("mark_price");
+    ticker.index_price = number("index_price");
+    ticker.funding_rate = number("current_funding");
+    ticker.funding_8h = number("funding_8h");
+    ticker.open_interest = number("open_interest");
+    ticker.timestamp = exchangeTime(data);
+
+    market_data_manager_.updateTicker(ticker);
+
+    // Price bands follow the mark, falling back to mid for unmarked books
+    double reference = ticker.mark_price;
+    if (!(reference > 0.0) && ticker.best_bid > 0.0 && ticker.best_ask > 0.0) {
+        reference = 0.5 * (ticker.best_bid + ticker.best_ask);
+    }
+    RiskManager::getInstance().onMarkUpdate(instrument_id, reference);
+
+    if (ticker.mark_price > 0.0) {
+        MarginMonitor::getInstance().onMark(instrument, ticker.mark_price);
+    }
+
+    // Option tickers carry the forward they are priced off and the mark vol
+    // in percent
+    auto mark_iv = data.find("mark_iv");
+    if (mark_iv != data.end() && mark_iv->is_number()) {
+        RiskManager::getInstance().getScenarioEngine().updateMark(instrument, number("underlying_price"),
+                                                                  mark_iv->get<double>() / 100.0);
+    }
+}
+
+MarketDataManager::TopOfBook DeribitClient::getTicker(const std::string& instrument) const {
+    MarketDataManager::TopOfBook top;
+    if (!market_data_manager_.getTopOfBook(instrument, top) || !top.has_ticker) {
+        throw std::runtime_error("No ticker data for instrument: " + instrument +
+                                 " (subscribe with subscribeToTicker)");
+    }
+    return top;
+}
+
+double DeribitClient::getMarkPrice(const std::string& instrument) {
+    return getTicker(instrument).mark_price;
+}
+
+double DeribitClient::getIndexPrice(const std::string& instrument) {
+    return getTicker(instrument).index_price;
+}
+
+double DeribitClient::getLastPrice(const std::string& instrument) {
+    return getTicker(instrument).last_price;
+}
+
+double DeribitClient::getFundingRate(const std::string& instrument) {
+    return getTicker(instrument).funding_rate;
 }
 
 void DeribitClient::processUserDataUpdate(const nlohmann::json& data) {
@@ -280,12 +570,29 @@ void DeribitClient::processUserDataUpdate(const nlohmann::json& data) {
         position.liquidation_price = data["position"]["estimated_liquidation_price"];
         position.unrealized_pnl = data["position"]["floating_profit_loss"];
         position.realized_pnl = data["position"]["realized_profit_loss"];
+        position.initial_margin = data["position"].value("initial_margin", 0.0);
+        position.maintenance_margin = data["position"].value("maintenance_margin", 0.0);
         position.timestamp = std::chrono::system_clock::now();
+
+        MarginMonitor::getInstance().updatePosition(position.instrument, position.size, position.mark_price,
+                                                    position.liquidation_price, position.initial_margin,
+                                                    position.maintenance_margin);
+        market_data_manager_.setPositionOpen(position.instrument, position.size != 0.0);
+        // Feeds the per-instrument notional check, exposure and /positions
+        RiskManager::getInstance().updatePosition({position.instrument, position.size, position.entry_price,
+                                                   position.unrealized_pnl, position.realized_pnl,
+                                                   position.timestamp});
+        RiskManager::getInstance().getScenarioEngine().setPosition(position.instrument, position.size);
         
         if (position_callback_) {
             position_callback_(position);
         }
     }
+    else if (data.contains("equity") && data.contains("maintenance_margin")) {
+        // user.portfolio notification
+        MarginMonitor::getInstance().updateAccount(data["equity"].get<double>(),
+                                                   data["maintenance_margin"].get<double>());
+    }
 }
 
 void DeribitClient::reconnectWebSocket() {
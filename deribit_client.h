@@ -6,8 +6,12 @@
 #include <functional>
 #include <memory>
 #include <chrono>
+#include <mutex>
+#include <fstream>
 #include "config_manager.h"
 #include "market_data_manager.h"
+#include "channel_dispatcher.h"
+#include "sequenced_pipeline.h"
 
 class DeribitClient {
 public:
@@ -81,6 +85,21 @@ public:
         double vega;
     };
 
+    // Inbound messages go through a sequenced pipeline: decode, book apply,
+    // features (bars), then strategy dispatch to MarketDataManager
+    // subscribers. The optional raw-message journal runs beside all of them
+    // so it never delays the book. Call before initialize().
+    struct FeedPipelineConfig {
+        size_t capacity{4096};       // Power of two
+        std::string journal_path;    // Empty disables the journal
+        size_t decode_workers{1};    // Parse threads; arrival order is kept
+        int decode_cpu{-1};          // < 0 leaves the stage unpinned; worker i gets decode_cpu + i
+        int book_cpu{-1};
+        int feature_cpu{-1};
+        int strategy_cpu{-1};
+        int journal_cpu{-1};
+    };
+
     static DeribitClient& getInstance() {
         static DeribitClient instance;
         return instance;
@@ -88,6 +107,7 @@ public:
 
     void initialize(const std::string& api_key, const std::string& api_secret);
     void shutdown();
+    void configureFeedPipeline(const FeedPipelineConfig& config);
 
     // Authentication
     bool authenticate();
@@ -126,6 +146,7 @@ public:
     // WebSocket Management
     void subscribeToOrderBook(const std::string& instrument);
     void subscribeToTrades(const std::string& instrument);
+    void subscribeToTicker(const std::string& instrument);
     void subscribeToUserData();
     void subscribeToInstrumentUpdates();
     void unsubscribe(const std::string& channel);
@@ -142,9 +163,33 @@ private:
     DeribitClient(const DeribitClient&) = delete;
     DeribitClient& operator=(const DeribitClient&) = delete;
 
+    // One ring slot; reused, so the string and JSON keep their capacity
+    struct FeedEvent {
+        std::string message;
+        std::chrono::system_clock::time_point received;
+        nlohmann::json json;
+        ChannelDispatcher::Route route{};
+        bool routed{false};
+        // Filled by the book stage for the feature stage
+        std::vector<MarketDataManager::Trade> trades;
+        std::chrono::system_clock::time_point exchange_time{};
+    };
+
+    void startFeedPipeline();
+    void stopFeedPipeline();
     void handleWebSocketMessage(const std::string& message);
-    void processOrderBookUpdate(const std::string& instrument, const nlohmann::json& data);
-    void processTradeUpdate(const std::string& instrument, const nlohmann::json& data);
+    void decodeFeedEvent(FeedEvent& event);
+    void applyFeedEvent(FeedEvent& event);
+    void updateFeatures(FeedEvent& event);
+    void dispatchToStrategies(FeedEvent& event);
+    void journalFeedEvent(const FeedEvent& event, uint64_t sequence, bool end_of_batch);
+    void processOrderBookUpdate(const std::string& instrument, const nlohmann::json& data,
+                                std::chrono::system_clock::time_point& exchange_time);
+    // Trade notifications carry an array of trades; each is appended
+    void processTradeUpdate(const std::string& instrument, const nlohmann::json& data,
+                            std::vector<MarketDataManager::Trade>& trades);
+    void processTickerUpdate(const std::string& instrument, uint32_t instrument_id, const nlohmann::json& data);
+    MarketDataManager::TopOfBook getTicker(const std::string& instrument) const;
     void processUserDataUpdate(const nlohmann::json& data);
     void processInstrumentUpdate(const nlohmann::json& data);
     void reconnectWebSocket();
@@ -164,8 +209,15 @@ private:
     std::function<void(const InstrumentInfo&)> instrument_callback_;
     const ConfigManager& config_manager_;
     MarketDataManager& market_data_manager_;
+    ChannelDispatcher channel_dispatcher_;
     std::map<std::string, InstrumentInfo> instrument_cache_;
     std::chrono::system_clock::time_point last_instrument_update_;
+
+    FeedPipelineConfig feed_config_;
+    std::unique_ptr<SequencedPipeline<FeedEvent>> feed_pipeline_;
+    // cpprest may deliver messages on several threads; the ring has one producer
+    std::mutex feed_publish_mutex_;
+    std::ofstream feed_journal_;
 };
 
 #endif // DERIBIT_CLIENT_H 
\ No newline at end of file
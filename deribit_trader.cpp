@@ -3,11 +3,21 @@
 #include "websocket_server.h"
 #include "trade_execution.h"
 #include "latency_module.h"
+#include "emergency_canceller.h"
+#include "state_snapshot.h"
+#include "market_data_manager.h"
+#include "bar_aggregator.h"
+#include "strategy_manager.h"
+#include "risk_manager.h"
+#include "margin_monitor.h"
+#include "error_handler.h"
+#include "http_routes.h"
 #include <iostream>
 #include <string>
 #include <exception>
 #include <memory>
 #include <unordered_map>
+#include <set>
 #include <future>
 #include <vector>
 #include <thread>
@@ -27,6 +37,10 @@ public:
 
     void start() {
         try {
+            // Warm state first; the feed then overwrites whatever has moved
+            restoreWarmState();
+            RiskManager::getInstance().initialize();
+
             // Initialize WebSocket client connection
             websocket_client_.connect();
             
@@ -38,8 +52,35 @@ public:
             LatencyModule::trackWebSocketMessage(auth_latency);
             
             std::cout << "Auth Response: " << auth_response.dump(4) << std::endl;
+
+            // Exchange-side safety net for this connection, plus a local
+            // standby connection for explicit mass cancels
+            trade_execution_.enableCancelOnDisconnect();
+
+            // Tick sizes for the price band floor; other currencies are
+            // loaded when one of their instruments is subscribed
+            load_tick_sizes("BTC");
+            load_tick_sizes("ETH");
+
+            EmergencyCanceller::Config emergency_config;
+            emergency_config.client_id = CLIENT_ID;
+            emergency_config.client_secret = CLIENT_SECRET;
+            // The watchdog is fed by DeribitClient::applyFeedEvent. This
+            // console reads the socket only in answer to its own requests,
+            // so nothing would feed it and it would cancel everything after
+            // the first idle timeout. Leave it disarmed here.
+            if (ConfigManager::getInstance().getNetworkConfig().watchdog_timeout_ms > 0) {
+                std::cerr << "Watchdog disabled: no market data feed in this process" << std::endl;
+            }
+            emergency_config.watchdog_timeout = std::chrono::milliseconds(0);
+            auto& emergency_canceller = EmergencyCanceller::getInstance();
+            if (emergency_canceller.initialize(emergency_config)) {
+                emergency_canceller.attachToErrorHandler();
+            }
+            attach_margin_alerts();
             
             // Start WebSocket server in a separate thread
+            registerHttpRoutes();
             std::thread server_thread([this]() {
                 websocket_server_.start();
             });
@@ -52,6 +93,8 @@ public:
             }
             
             // Cleanup
+            StateSnapshotManager::getInstance().stop();
+            EmergencyCanceller::getInstance().shutdown();
             websocket_client_.close();
             websocket_server_.stop();
             
@@ -64,6 +107,88 @@ public:
     }
 
 private:
+    void restoreWarmState() {
+        auto& snapshots = StateSnapshotManager::getInstance();
+        snapshots.registerSection("market_data", MarketDataManager::SNAPSHOT_VERSION,
+            [](SnapshotWriter& writer) { MarketDataManager::getInstance().saveSnapshot(writer); },
+            [](SnapshotReader& reader) { MarketDataManager::getInstance().restoreSnapshot(reader); });
+        snapshots.registerSection("bars", BarAggregator::SNAPSHOT_VERSION,
+            [](SnapshotWriter& writer) { BarAggregator::getInstance().saveSnapshot(writer); },
+            [](SnapshotReader& reader) { BarAggregator::getInstance().restoreSnapshot(reader); });
+        snapshots.registerSection("strategies", StrategyManager::SNAPSHOT_VERSION,
+            [](SnapshotWriter& writer) { StrategyManager::getInstance().saveSnapshot(writer); },
+            [](SnapshotReader& reader) { StrategyManager::getInstance().restoreSnapshot(reader); });
+
+        snapshots.configure(StateSnapshotManager::Config());
+        auto result = snapshots.restore();
+        if (result.restored) {
+            std::cout << "Restored " << result.sections.size() << " state sections ("
+                      << result.skipped.size() << " skipped), snapshot age "
+                      << result.age.count() << " ms" << std::endl;
+        } else {
+            std::cout << "Cold start: " << result.reason << std::endl;
+        }
+        snapshots.start();
+    }
+
+    // Internal tools read our view of the book from here instead of the exchange
+    void registerHttpRoutes() {
+        auto& routes = websocket_server_.http_routes();
+        registerMarketDataRoutes(routes, MarketDataManager::getInstance());
+
+        HttpRouteTable::Route positions;
+        positions.sequence = [](const HttpRouteTable::Query&) {
+            return RiskManager::getInstance().getUpdateSequence();
+        };
+        positions.render = [](const HttpRouteTable::Query&) {
+            json items = json::array();
+            for (const auto& position : RiskManager::getInstance().getPositions()) {
+                items.push_back({
+                    {"instrument", position.instrument},
+                    {"size", position.size},
+                    {"avg_price", position.avg_price},
+                    {"unrealized_pnl", position.unrealized_pnl},
+                    {"realized_pnl", position.realized_pnl}
+                });
+            }
+            return HttpResponse::json(200, json{{"positions", items}}.dump());
+        };
+        routes.addRoute("/positions", std::move(positions));
+
+        HttpRouteTable::Route metrics;
+        metrics.sequence = [](const HttpRouteTable::Query&) {
+            // Both counters only grow, so the sum moves whenever either does
+            return RiskManager::getInstance().getUpdateSequence() +
+                   StrategyManager::getInstance().getMetricsSequence();
+        };
+        metrics.render = [](const HttpRouteTable::Query&) {
+            const auto risk = RiskManager::getInstance().copyRiskMetrics();
+            json strategies = json::object();
+            for (const auto& [name, strategy_metrics] : StrategyManager::getInstance().getAllStrategyMetrics()) {
+                strategies[name] = {
+                    {"total_pnl", strategy_metrics.total_pnl},
+                    {"win_rate", strategy_metrics.win_rate},
+                    {"sharpe_ratio", strategy_metrics.sharpe_ratio},
+                    {"max_drawdown", strategy_metrics.max_drawdown},
+                    {"current_drawdown", strategy_metrics.current_drawdown},
+                    {"total_trades", strategy_metrics.total_trades}
+                };
+            }
+            json body = {
+                {"risk", {
+                    {"total_exposure", risk.total_exposure},
+                    {"daily_pnl", risk.daily_pnl},
+                    {"max_drawdown", risk.max_drawdown},
+                    {"win_rate", risk.win_rate},
+                    {"total_trades", risk.total_trades}
+                }},
+                {"strategies", strategies}
+            };
+            return HttpResponse::json(200, body.dump());
+        };
+        routes.addRoute("/metrics", std::move(metrics));
+    }
+
     void display_menu() {
         std::cout << "\n--- Trading Menu ---\n";
         std::cout << "1. Place Order\n";
@@ -74,6 +199,7 @@ private:
         std::cout << "6. Subscribe to Market Data\n";
         std::cout << "7. View Performance Stats\n";
         std::cout << "8. Exit\n";
+        std::cout << "9. Emergency Cancel All\n";
         std::cout << "Enter your choice: ";
     }
 
@@ -92,6 +218,7 @@ private:
             case 6: handle_subscribe_market_data(); break;
             case 7: handle_view_stats(); break;
             case 8: running_ = false; break;
+            case 9: EmergencyCanceller::getInstance().cancelAll("Manual kill switch"); break;
             default: std::cout << "Invalid choice. Please try again.\n"; break;
         }
         
@@ -253,11 +380,51 @@ private:
             
             websocket_client_.sendMessage(subscribe_msg);
             std::cout << "Subscribed to market data for " << instrument_name << std::endl;
+
+            // BTC-PERPETUAL is listed under BTC, BTC_USDC-PERPETUAL under USDC
+            std::string currency = instrument_name.substr(0, instrument_name.find('-'));
+            load_tick_sizes(currency.substr(currency.find('_') + 1));
         } catch (const std::exception& e) {
             std::cerr << "Error subscribing to market data: " << e.what() << std::endl;
         }
     }
 
+    // Once per currency; a failed load is retried on the next subscribe
+    void load_tick_sizes(const std::string& currency) {
+        if (currency.empty() || tick_size_currencies_.count(currency)) {
+            return;
+        }
+        try {
+            json instruments = trade_execution_.getInstruments(currency, "any", false);
+            if (RiskManager::getInstance().loadTickSizes(instruments) > 0) {
+                tick_size_currencies_.insert(currency);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error loading tick sizes for " << currency << ": " << e.what() << std::endl;
+        }
+    }
+
+    // Margin alerts go through the error handler; a CRITICAL escalation is
+    // logged as CRITICAL, which the emergency canceller turns into a cancel-all
+    void attach_margin_alerts() {
+        MarginMonitor::getInstance().setAlertCallback([](const MarginMonitor::Alert& alert) {
+            static const char* const level_names[] = {"OK", "WARNING", "CRITICAL"};
+            std::string message = (alert.instrument.empty() ? std::string("Account") : alert.instrument) +
+                " margin " + level_names[static_cast<int>(alert.previous_level)] +
+                " -> " + level_names[static_cast<int>(alert.level)] +
+                (alert.instrument.empty() ? " (utilization " + std::to_string(alert.utilization) + ")"
+                                          : " (distance " + std::to_string(alert.distance) + ")");
+
+            if (alert.level < alert.previous_level) {
+                LOG_INFO(message, "margin_monitor");
+            } else if (alert.level == MarginMonitor::Level::CRITICAL) {
+                LOG_CRITICAL(message, "margin_monitor");
+            } else {
+                LOG_WARNING(message, "margin_monitor");
+            }
+        });
+    }
+
     void handle_view_stats() {
         auto order_stats = LatencyModule::getOrderPlacementStats();
         auto market_stats = LatencyModule::getMarketDataStats();
@@ -288,6 +455,7 @@ private:
     WebSocketHandler websocket_client_;
     WebSocketServer websocket_server_;
     TradeExecution trade_execution_;
+    std::set<std::string> tick_size_currencies_;
     std::atomic<bool> running_{true};
 };
 
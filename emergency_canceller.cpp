@@ -0,0 +1,195 @@
+#include "emergency_canceller.h"
+#include "websocket_handler.h"
+#include "trade_execution.h"
+#include "error_handler.h"
+#include "latency_module.h"
+#include "cpu_accounting.h"
+#include <iostream>
+#include <algorithm>
+
+namespace {
+
+// Fixed request ids keep the frames byte-identical across triggers
+constexpr int CANCEL_ALL_REQUEST_ID = 9990;
+constexpr int KEEPALIVE_REQUEST_ID = 9991;
+
+// Context of the canceller's own CRITICAL logs, which must not re-trigger it
+const char* const EMERGENCY_CONTEXT = "EmergencyCanceller";
+
+} // namespace
+
+EmergencyCanceller::EmergencyCanceller() {
+    cancel_all_frame_ = json{
+        {"jsonrpc", "2.0"},
+        {"id", CANCEL_ALL_REQUEST_ID},
+        {"method", "private/cancel_all"},
+        {"params", json::object()}
+    }.dump();
+
+    keepalive_frame_ = json{
+        {"jsonrpc", "2.0"},
+        {"id", KEEPALIVE_REQUEST_ID},
+        {"method", "public/test"},
+        {"params", json::object()}
+    }.dump();
+}
+
+EmergencyCanceller::~EmergencyCanceller() {
+    shutdown();
+}
+
+bool EmergencyCanceller::initialize(const Config& config) {
+    shutdown();
+
+    WebSocketHandler* connection = nullptr;
+    try {
+        auto standby = std::make_unique<WebSocketHandler>(config.host, config.port, config.endpoint);
+        standby->connect();
+
+        TradeExecution session(*standby);
+        session.authenticate(config.client_id, config.client_secret);
+
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        standby_ = std::move(standby);
+        connection = standby_.get();
+    } catch (const std::exception& e) {
+        std::cerr << "Emergency canceller standby connection failed: " << e.what() << std::endl;
+        return false;
+    }
+
+    return arm(config, [connection](std::string_view frame) { return connection->sendRaw(frame); });
+}
+
+bool EmergencyCanceller::initialize(const Config& config, RawSender sender) {
+    shutdown();
+    if (!sender) {
+        return false;
+    }
+    return arm(config, std::move(sender));
+}
+
+bool EmergencyCanceller::arm(const Config& config, RawSender sender) {
+    config_ = config;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        sender_ = std::move(sender);
+    }
+
+    last_heartbeat_ns_.store(nowNanos(), std::memory_order_relaxed);
+    armed_.store(true, std::memory_order_release);
+    running_ = true;
+    monitor_thread_ = std::thread(&EmergencyCanceller::monitorLoop, this);
+    return true;
+}
+
+void EmergencyCanceller::shutdown() {
+    if (running_.exchange(false)) {
+        monitor_cv_.notify_all();
+        if (monitor_thread_.joinable()) {
+            monitor_thread_.join();
+        }
+    }
+
+    armed_.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    sender_ = nullptr;
+    if (standby_) {
+        standby_->close();
+        standby_.reset();
+    }
+}
+
+bool EmergencyCanceller::cancelAll(const std::string& reason) {
+    auto start = std::chrono::steady_clock::now();
+
+    const char* failure = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        if (!sender_) {
+            failure = "EMERGENCY CANCEL requested but standby is not armed: ";
+        } else if (!sender_(cancel_all_frame_)) {
+            failure = "EMERGENCY CANCEL write failed on the standby connection: ";
+        }
+    }
+    if (failure) {
+        // Orders may still be resting; this has to reach the operator
+        LOG_CRITICAL(failure + reason, EMERGENCY_CONTEXT);
+        return false;
+    }
+
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    last_latency_us_.store(latency.count(), std::memory_order_relaxed);
+    trigger_count_.fetch_add(1, std::memory_order_relaxed);
+    LatencyModule::getInstance().end("emergency_cancel_all", start);
+
+    // Plain stderr: this may run inside an ErrorHandler callback
+    std::cerr << "EMERGENCY CANCEL sent in " << latency.count() << " us: " << reason << std::endl;
+    return true;
+}
+
+void EmergencyCanceller::attachToErrorHandler() {
+    if (error_handler_attached_.exchange(true)) {
+        return;
+    }
+    ErrorHandler::getInstance().setErrorCallback([this](const ErrorHandler::ErrorInfo& error) {
+        if (error.severity == ErrorHandler::ErrorSeverity::CRITICAL && error.context != EMERGENCY_CONTEXT) {
+            cancelAll("CRITICAL error: " + error.message);
+        }
+    });
+}
+
+void EmergencyCanceller::heartbeat() {
+    last_heartbeat_ns_.store(nowNanos(), std::memory_order_relaxed);
+}
+
+void EmergencyCanceller::monitorLoop() {
+    using namespace std::chrono;
+    CpuAccounting::ThreadRegistration cpu_registration("emergency_canceller");
+
+    auto period = config_.keepalive_interval;
+    if (config_.watchdog_timeout.count() > 0) {
+        period = std::min(period, std::max(milliseconds(1), config_.watchdog_timeout / 4));
+    }
+
+    auto last_keepalive = steady_clock::now();
+    bool watchdog_fired = false;
+
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(monitor_mutex_);
+            monitor_cv_.wait_for(lock, period, [this] { return !running_; });
+        }
+        if (!running_) {
+            break;
+        }
+
+        if (config_.watchdog_timeout.count() > 0) {
+            const int64_t silent_ns = nowNanos() - last_heartbeat_ns_.load(std::memory_order_relaxed);
+            if (silent_ns > duration_cast<nanoseconds>(config_.watchdog_timeout).count()) {
+                // One cancel per stall; re-arms once heartbeats resume
+                if (!watchdog_fired) {
+                    cancelAll("Watchdog: no heartbeat for " + std::to_string(silent_ns / 1000000) + " ms");
+                    watchdog_fired = true;
+                }
+            } else {
+                watchdog_fired = false;
+            }
+        }
+
+        // Keep the standby socket warm so the emergency write is not the
+        // first traffic after a long idle period
+        if (steady_clock::now() - last_keepalive >= config_.keepalive_interval) {
+            std::lock_guard<std::mutex> lock(send_mutex_);
+            if (sender_) {
+                sender_(keepalive_frame_);
+            }
+            last_keepalive = steady_clock::now();
+        }
+    }
+}
+
+int64_t EmergencyCanceller::nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
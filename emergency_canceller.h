@@ -0,0 +1,89 @@
+#ifndef EMERGENCY_CANCELLER_H
+#define EMERGENCY_CANCELLER_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <string_view>
+#include "inplace_function.h"
+
+class WebSocketHandler;
+
+// Last-resort mass cancel. Holds a separately authenticated standby
+// connection and a pre-encoded private/cancel_all frame, so pulling every
+// resting order is a single socket write that does not depend on the health
+// of the trading connection. Fired by the kill switch (cancelAll), by the
+// watchdog when heartbeat() stops arriving, or by any CRITICAL error once
+// attachToErrorHandler() has been called. The market data feed calls
+// heartbeat() for every event it applies.
+class EmergencyCanceller {
+public:
+    struct Config {
+        std::string host{"test.deribit.com"};
+        std::string port{"443"};
+        std::string endpoint{"/ws/api/v2"};
+        std::string client_id;
+        std::string client_secret;
+        std::chrono::milliseconds keepalive_interval{15000};
+        std::chrono::milliseconds watchdog_timeout{0};  // 0 disables the watchdog
+    };
+
+    static EmergencyCanceller& getInstance() {
+        static EmergencyCanceller instance;
+        return instance;
+    }
+
+    // Writes one pre-encoded frame; false if the write failed
+    using RawSender = InplaceFunction<bool(std::string_view)>;
+
+    bool initialize(const Config& config);
+    // Arms on a transport that is already connected and authenticated
+    bool initialize(const Config& config, RawSender sender);
+    void shutdown();
+    bool isArmed() const { return armed_.load(std::memory_order_acquire); }
+
+    // Kill switch; safe to call from any thread
+    bool cancelAll(const std::string& reason);
+
+    void attachToErrorHandler();
+    void heartbeat();
+
+    size_t getTriggerCount() const { return trigger_count_.load(std::memory_order_relaxed); }
+    std::chrono::microseconds getLastLatency() const {
+        return std::chrono::microseconds(last_latency_us_.load(std::memory_order_relaxed));
+    }
+
+private:
+    EmergencyCanceller();
+    ~EmergencyCanceller();
+    EmergencyCanceller(const EmergencyCanceller&) = delete;
+    EmergencyCanceller& operator=(const EmergencyCanceller&) = delete;
+
+    bool arm(const Config& config, RawSender sender);
+    void monitorLoop();
+    static int64_t nowNanos();
+
+    Config config_;
+    std::unique_ptr<WebSocketHandler> standby_;  // Owned connection behind sender_, if any
+    RawSender sender_;
+    std::string cancel_all_frame_;
+    std::string keepalive_frame_;
+    std::mutex send_mutex_;
+
+    std::atomic<bool> armed_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> error_handler_attached_{false};
+    std::atomic<int64_t> last_heartbeat_ns_{0};
+    std::atomic<size_t> trigger_count_{0};
+    std::atomic<int64_t> last_latency_us_{0};
+
+    std::thread monitor_thread_;
+    std::mutex monitor_mutex_;
+    std::condition_variable monitor_cv_;
+};
+
+#endif // EMERGENCY_CANCELLER_H
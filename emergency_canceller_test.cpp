@@ -0,0 +1,92 @@
+#include "emergency_canceller.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// Arms the canceller on an in-process transport that counts the cancel_all
+// frames it is asked to write
+class EmergencyCancellerTest : public ::testing::Test {
+protected:
+    struct Transport {
+        std::atomic<int> cancels{0};
+        std::atomic<bool> fail{false};
+    };
+
+    void TearDown() override {
+        EmergencyCanceller::getInstance().shutdown();
+    }
+
+    bool arm(std::chrono::milliseconds watchdog_timeout) {
+        EmergencyCanceller::Config config;
+        config.keepalive_interval = std::chrono::hours(1);
+        config.watchdog_timeout = watchdog_timeout;
+        Transport* transport = &transport_;
+        return EmergencyCanceller::getInstance().initialize(config, [transport](std::string_view frame) {
+            if (frame.find("private/cancel_all") != std::string_view::npos) {
+                transport->cancels++;
+            }
+            return !transport->fail.load();
+        });
+    }
+
+    bool waitForCancels(int count, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (transport_.cancels.load() < count) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+
+    Transport transport_;
+};
+
+TEST_F(EmergencyCancellerTest, WatchdogFiresOnceWhenHeartbeatsStop) {
+    auto& canceller = EmergencyCanceller::getInstance();
+    ASSERT_TRUE(arm(std::chrono::milliseconds(100)));
+    const size_t triggers = canceller.getTriggerCount();
+
+    // Steady heartbeats keep it quiet
+    for (int i = 0; i < 30; ++i) {
+        canceller.heartbeat();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(transport_.cancels.load(), 0);
+
+    // One cancel per stall, however long the stall lasts
+    ASSERT_TRUE(waitForCancels(1, std::chrono::seconds(5)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(transport_.cancels.load(), 1);
+    EXPECT_EQ(canceller.getTriggerCount(), triggers + 1);
+
+    // Heartbeats re-arm it for the next stall
+    for (int i = 0; i < 10; ++i) {
+        canceller.heartbeat();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(waitForCancels(2, std::chrono::seconds(5)));
+}
+
+TEST_F(EmergencyCancellerTest, FailedWriteIsNotCountedAsSent) {
+    auto& canceller = EmergencyCanceller::getInstance();
+    ASSERT_TRUE(arm(std::chrono::milliseconds(0)));
+    const size_t triggers = canceller.getTriggerCount();
+
+    transport_.fail = true;
+    EXPECT_FALSE(canceller.cancelAll("test: write fails"));
+    EXPECT_EQ(transport_.cancels.load(), 1);
+    EXPECT_EQ(canceller.getTriggerCount(), triggers);
+
+    transport_.fail = false;
+    EXPECT_TRUE(canceller.cancelAll("test: write succeeds"));
+    EXPECT_EQ(canceller.getTriggerCount(), triggers + 1);
+
+    canceller.shutdown();
+    EXPECT_FALSE(canceller.isArmed());
+    EXPECT_FALSE(canceller.cancelAll("test: not armed"));
+    EXPECT_EQ(transport_.cancels.load(), 2);
+}
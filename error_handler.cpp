@@ -1,23 +1,15 @@
 #include "error_handler.h"
+#include <algorithm>
 #include <filesystem>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
+#include <thread>
+#ifdef _WIN32
 #include <Windows.h>
 #include <DbgHelp.h>
 #pragma comment(lib, "DbgHelp.lib")
-
-// Singleton instance
-ErrorHandler* ErrorHandler::instance_ = nullptr;
-std::mutex ErrorHandler::instance_mutex_;
-
-ErrorHandler* ErrorHandler::getInstance() {
-    std::lock_guard<std::mutex> lock(instance_mutex_);
-    if (instance_ == nullptr) {
-        instance_ = new ErrorHandler();
-    }
-    return instance_;
-}
+#endif
 
 ErrorHandler::ErrorHandler()
     : max_log_size_(10 * 1024 * 1024)  // 10MB default
@@ -48,8 +40,6 @@ void ErrorHandler::logError(ErrorSeverity severity,
                           const std::string& source_file,
                           int line_number,
                           const std::string& function_name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     ErrorInfo error;
     error.severity = severity;
     error.message = message;
@@ -60,17 +50,23 @@ void ErrorHandler::logError(ErrorSeverity severity,
     error.function_name = function_name;
     error.stack_trace = getStackTrace();
     
-    error_history_.push_back(error);
-    if (error_history_.size() > 1000) {  // Keep last 1000 errors
-        error_history_.erase(error_history_.begin());
+    bool recover = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_history_.push_back(error);
+        if (error_history_.size() > 1000) {  // Keep last 1000 errors
+            error_history_.erase(error_history_.begin());
+        }
+        
+        error_count_++;
+        writeToLog(error);
+        recover = severity == ErrorSeverity::CRITICAL && recovery_enabled_;
     }
     
-    error_count_++;
-    
-    writeToLog(error);
+    // Callbacks and recovery actions run unlocked since both may log
     notifyCallbacks(error);
     
-    if (severity == ErrorSeverity::CRITICAL && recovery_enabled_) {
+    if (recover) {
         attemptRecovery(error);
     }
 }
@@ -85,10 +81,17 @@ void ErrorHandler::addRecoveryAction(const RecoveryAction& action) {
 }
 
 bool ErrorHandler::attemptRecovery(const ErrorInfo& error) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<RecoveryAction> actions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        actions = recovery_actions_;
+    }
     
-    for (const auto& action : recovery_actions_) {
-        recovery_attempt_count_++;
+    for (const auto& action : actions) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            recovery_attempt_count_++;
+        }
         int attempts = 0;
         
         while (attempts < action.max_attempts) {
@@ -170,6 +173,9 @@ void ErrorHandler::rotateLogs() {
 }
 
 std::string ErrorHandler::getStackTrace() {
+#ifndef _WIN32
+    return "";
+#else
     std::stringstream ss;
     HANDLE process = GetCurrentProcess();
     HANDLE thread = GetCurrentThread();
@@ -231,12 +237,17 @@ std::string ErrorHandler::getStackTrace() {
     
     SymCleanup(process);
     return ss.str();
+#endif
 }
 
 std::string ErrorHandler::formatTimestamp(const std::chrono::system_clock::time_point& time) const {
     auto time_t = std::chrono::system_clock::to_time_t(time);
     std::tm tm;
+#ifdef _WIN32
     localtime_s(&tm, &time_t);
+#else
+    localtime_r(&time_t, &tm);
+#endif
     
     std::stringstream ss;
     ss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
@@ -254,7 +265,12 @@ std::string ErrorHandler::getSeverityString(ErrorSeverity severity) const {
 }
 
 void ErrorHandler::notifyCallbacks(const ErrorInfo& error) {
-    for (const auto& callback : callbacks_) {
+    std::vector<std::function<void(const ErrorInfo&)>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callbacks = callbacks_;
+    }
+    for (const auto& callback : callbacks) {
         try {
             callback(error);
         } catch (...) {
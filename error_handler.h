@@ -72,6 +72,7 @@ private:
     ErrorHandler(const ErrorHandler&) = delete;
     ErrorHandler& operator=(const ErrorHandler&) = delete;
 
+    // Requires mutex_
     void writeToLog(const ErrorInfo& error);
     void notifyCallbacks(const ErrorInfo& error);
     bool attemptRecovery(const ErrorInfo& error);
@@ -83,7 +84,7 @@ private:
     std::vector<ErrorInfo> error_history_;
     std::vector<RecoveryAction> recovery_actions_;
     std::vector<std::function<void(const ErrorInfo&)>> callbacks_;
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
     std::ofstream log_file_;
     std::string log_directory_;
     size_t max_log_size_;
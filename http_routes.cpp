@@ -0,0 +1,225 @@
+#include "http_routes.h"
+#include "market_data_manager.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t DEFAULT_BOOK_DEPTH = 10;
+constexpr size_t MAX_BOOK_DEPTH = 1000;
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string decodeComponent(const std::string& text) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '+') {
+            decoded += ' ';
+        } else if (text[i] == '%' && i + 2 < text.size() &&
+                   hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+            decoded += static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+            i += 2;
+        } else {
+            decoded += text[i];
+        }
+    }
+    return decoded;
+}
+
+int64_t toMillis(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+HttpResponse errorResponse(unsigned status, const std::string& message) {
+    return HttpResponse::json(status, nlohmann::json{{"error", message}}.dump());
+}
+
+nlohmann::json levelsToJson(const std::vector<MarketDataManager::OrderBook::Level>& levels) {
+    nlohmann::json result = nlohmann::json::array();
+    for (const auto& level : levels) {
+        result.push_back({level.price, level.size});
+    }
+    return result;
+}
+
+} // namespace
+
+HttpResponse HttpResponse::json(unsigned status, std::string body) {
+    HttpResponse response;
+    response.status = status;
+    response.body = std::make_shared<const std::string>(std::move(body));
+    return response;
+}
+
+void HttpRouteTable::addRoute(const std::string& path, Route route) {
+    if (!route.render) {
+        throw std::invalid_argument("Route " + path + " has no render function");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    routes_[path] = std::make_shared<const Route>(std::move(route));
+    cache_.clear();
+}
+
+void HttpRouteTable::removeRoute(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    routes_.erase(path);
+    cache_.clear();
+}
+
+HttpResponse HttpRouteTable::handle(const std::string& target) {
+    const size_t query_start = target.find('?');
+    const std::string path = target.substr(0, query_start);
+
+    std::shared_ptr<const Route> route;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.requests++;
+        auto it = routes_.find(path);
+        if (it == routes_.end()) {
+            stats_.not_found++;
+            return errorResponse(404, "no route for " + path);
+        }
+        route = it->second;
+    }
+
+    const Query query = query_start == std::string::npos ? Query() : parseQuery(target.substr(query_start + 1));
+    if (!route->sequence) {
+        HttpResponse response = route->render(query);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.renders++;
+        return response;
+    }
+
+    // Read the sequence before rendering: a body rendered from newer state
+    // is then filed under an older sequence and simply re-rendered next time,
+    // never served as current after the state has moved on
+    const uint64_t sequence = route->sequence(query);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = cache_.find(target);
+        if (it != cache_.end() && it->second.sequence == sequence) {
+            stats_.cache_hits++;
+            return it->second.response;
+        }
+    }
+
+    HttpResponse response = route->render(query);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.renders++;
+    if (cache_.size() >= MAX_CACHED_TARGETS && cache_.find(target) == cache_.end()) {
+        cache_.clear();
+    }
+    cache_[target] = {sequence, response};
+    return response;
+}
+
+HttpRouteTable::Stats HttpRouteTable::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+HttpRouteTable::Query HttpRouteTable::parseQuery(const std::string& query) {
+    Query result;
+    size_t start = 0;
+    while (start <= query.size()) {
+        size_t end = query.find('&', start);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        const std::string pair = query.substr(start, end - start);
+        if (!pair.empty()) {
+            const size_t equals = pair.find('=');
+            if (equals == std::string::npos) {
+                result[decodeComponent(pair)] = "";
+            } else {
+                result[decodeComponent(pair.substr(0, equals))] = decodeComponent(pair.substr(equals + 1));
+            }
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+void registerMarketDataRoutes(HttpRouteTable& routes, const MarketDataManager& market_data) {
+    HttpRouteTable::Route book;
+    book.sequence = [&market_data](const HttpRouteTable::Query& query) {
+        auto it = query.find("instrument");
+        return it != query.end() ? market_data.getUpdateSequence(it->second) : 0;
+    };
+    book.render = [&market_data](const HttpRouteTable::Query& query) {
+        auto instrument = query.find("instrument");
+        if (instrument == query.end() || instrument->second.empty()) {
+            return errorResponse(400, "instrument is required");
+        }
+
+        size_t depth = DEFAULT_BOOK_DEPTH;
+        auto depth_param = query.find("depth");
+        if (depth_param != query.end()) {
+            try {
+                size_t parsed = 0;
+                const unsigned long value = std::stoul(depth_param->second, &parsed);
+                if (parsed != depth_param->second.size() || value == 0 || value > MAX_BOOK_DEPTH) {
+                    throw std::out_of_range("depth");
+                }
+                depth = value;
+            } catch (const std::exception&) {
+                return errorResponse(400, "depth must be between 1 and " + std::to_string(MAX_BOOK_DEPTH));
+            }
+        }
+
+        MarketDataManager::OrderBook snapshot;
+        if (!market_data.copyOrderBook(instrument->second, depth, snapshot)) {
+            return errorResponse(404, "unknown instrument " + instrument->second);
+        }
+
+        nlohmann::json body = {
+            {"instrument", snapshot.instrument},
+            {"timestamp", toMillis(snapshot.timestamp)},
+            {"bids", levelsToJson(snapshot.bids)},
+            {"asks", levelsToJson(snapshot.asks)}
+        };
+        return HttpResponse::json(200, body.dump());
+    };
+    routes.addRoute("/book", std::move(book));
+
+    HttpRouteTable::Route top;
+    top.sequence = [&market_data](const HttpRouteTable::Query&) {
+        return market_data.getTopOfBookSequence();
+    };
+    top.render = [&market_data](const HttpRouteTable::Query&) {
+        auto tops = market_data.getAllTopOfBook();
+        std::sort(tops.begin(), tops.end(),
+                  [](const auto& a, const auto& b) { return a.instrument < b.instrument; });
+
+        nlohmann::json instruments = nlohmann::json::array();
+        for (const auto& entry : tops) {
+            nlohmann::json item = {
+                {"instrument", entry.instrument},
+                {"best_bid", entry.best_bid},
+                {"best_bid_size", entry.best_bid_size},
+                {"best_ask", entry.best_ask},
+                {"best_ask_size", entry.best_ask_size},
+                {"last_price", entry.last_price},
+                {"timestamp", toMillis(entry.timestamp)}
+            };
+            if (entry.has_ticker) {
+                item["mark_price"] = entry.mark_price;
+                item["index_price"] = entry.index_price;
+                item["funding_rate"] = entry.funding_rate;
+                item["open_interest"] = entry.open_interest;
+            }
+            instruments.push_back(std::move(item));
+        }
+        return HttpResponse::json(200, nlohmann::json{{"instruments", instruments}}.dump());
+    };
+    routes.addRoute("/top", std::move(top));
+}
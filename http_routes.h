@@ -0,0 +1,71 @@
+#ifndef HTTP_ROUTES_H
+#define HTTP_ROUTES_H
+
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+class MarketDataManager;
+
+struct HttpResponse {
+    unsigned status{200};
+    std::string content_type{"application/json"};
+    std::shared_ptr<const std::string> body;
+
+    static HttpResponse json(unsigned status, std::string body);
+};
+
+// GET routes served from in-memory state. A route may report a sequence
+// number for the state behind a request; while it is unchanged, repeated
+// requests for the same target reuse the cached response body instead of
+// rendering it again.
+class HttpRouteTable {
+public:
+    using Query = std::map<std::string, std::string>;
+
+    struct Route {
+        // Optional; routes without one are rendered on every request
+        std::function<uint64_t(const Query&)> sequence;
+        std::function<HttpResponse(const Query&)> render;
+    };
+
+    struct Stats {
+        uint64_t requests;
+        uint64_t cache_hits;
+        uint64_t renders;
+        uint64_t not_found;
+    };
+
+    // Cached targets per table; the cache is cleared when it grows past this
+    static constexpr size_t MAX_CACHED_TARGETS = 1024;
+
+    void addRoute(const std::string& path, Route route);
+    void removeRoute(const std::string& path);
+
+    // target is the request target, path plus optional query string
+    HttpResponse handle(const std::string& target);
+
+    Stats getStats() const;
+
+    static Query parseQuery(const std::string& query);
+
+private:
+    struct CacheEntry {
+        uint64_t sequence;
+        HttpResponse response;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const Route>> routes_;
+    std::unordered_map<std::string, CacheEntry> cache_;
+    Stats stats_{};
+};
+
+// /book?instrument=X&depth=N and /top, backed by MarketDataManager
+void registerMarketDataRoutes(HttpRouteTable& routes, const MarketDataManager& market_data);
+
+#endif // HTTP_ROUTES_H
@@ -0,0 +1,134 @@
+#include "http_routes.h"
+#include "market_data_manager.h"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+
+class HttpRoutesTest : public ::testing::Test {
+protected:
+    // Renders a counter so every render is distinguishable from a cache hit
+    HttpRouteTable::Route countingRoute(bool cached) {
+        HttpRouteTable::Route route;
+        if (cached) {
+            route.sequence = [this](const HttpRouteTable::Query&) { return sequence_.load(); };
+        }
+        route.render = [this](const HttpRouteTable::Query& query) {
+            auto it = query.find("tag");
+            std::string tag = it != query.end() ? it->second : "";
+            return HttpResponse::json(200, tag + ":" + std::to_string(++renders_));
+        };
+        return route;
+    }
+
+    std::atomic<uint64_t> sequence_{1};
+    std::atomic<int> renders_{0};
+};
+
+TEST_F(HttpRoutesTest, ReusesBodyUntilSequenceMoves) {
+    HttpRouteTable routes;
+    routes.addRoute("/state", countingRoute(true));
+
+    auto first = routes.handle("/state");
+    auto second = routes.handle("/state");
+    EXPECT_EQ(*first.body, ":1");
+    // Same shared body, not a re-render
+    EXPECT_EQ(first.body.get(), second.body.get());
+
+    sequence_++;
+    auto third = routes.handle("/state");
+    EXPECT_EQ(*third.body, ":2");
+
+    auto stats = routes.getStats();
+    EXPECT_EQ(stats.requests, 3u);
+    EXPECT_EQ(stats.cache_hits, 1u);
+    EXPECT_EQ(stats.renders, 2u);
+}
+
+TEST_F(HttpRoutesTest, CachesPerTarget) {
+    HttpRouteTable routes;
+    routes.addRoute("/state", countingRoute(true));
+
+    EXPECT_EQ(*routes.handle("/state?tag=a").body, "a:1");
+    EXPECT_EQ(*routes.handle("/state?tag=b").body, "b:2");
+    EXPECT_EQ(*routes.handle("/state?tag=a").body, "a:1");
+    EXPECT_EQ(routes.getStats().cache_hits, 1u);
+}
+
+TEST_F(HttpRoutesTest, RoutesWithoutSequenceAlwaysRender) {
+    HttpRouteTable routes;
+    routes.addRoute("/live", countingRoute(false));
+
+    EXPECT_EQ(*routes.handle("/live").body, ":1");
+    EXPECT_EQ(*routes.handle("/live").body, ":2");
+    EXPECT_EQ(routes.getStats().cache_hits, 0u);
+}
+
+TEST_F(HttpRoutesTest, UnknownPathIsNotFound) {
+    HttpRouteTable routes;
+    routes.addRoute("/state", countingRoute(true));
+
+    auto response = routes.handle("/missing?x=1");
+    EXPECT_EQ(response.status, 404u);
+    EXPECT_EQ(routes.getStats().not_found, 1u);
+    EXPECT_EQ(renders_, 0);
+}
+
+TEST_F(HttpRoutesTest, ParsesQueryString) {
+    auto query = HttpRouteTable::parseQuery("instrument=BTC-PERPETUAL&depth=5&name=a%20b+c&flag&&bad=%zz");
+    EXPECT_EQ(query["instrument"], "BTC-PERPETUAL");
+    EXPECT_EQ(query["depth"], "5");
+    EXPECT_EQ(query["name"], "a b c");
+    EXPECT_EQ(query.count("flag"), 1u);
+    EXPECT_EQ(query["bad"], "%zz");
+}
+
+TEST_F(HttpRoutesTest, ServesBookAndTopOfBook) {
+    auto& market_data = MarketDataManager::getInstance();
+    const std::string instrument = "HTTP-ROUTES-TEST-PERP";
+    const auto now = std::chrono::system_clock::now();
+
+    MarketDataManager::OrderBook book;
+    book.instrument = instrument;
+    book.timestamp = now;
+    for (int i = 0; i < 20; ++i) {
+        book.bids.push_back({100.0 - i, 1.0 + i, now});
+        book.asks.push_back({101.0 + i, 2.0 + i, now});
+    }
+    market_data.updateOrderBook(book);
+
+    HttpRouteTable routes;
+    registerMarketDataRoutes(routes, market_data);
+
+    auto response = routes.handle("/book?instrument=" + instrument + "&depth=3");
+    ASSERT_EQ(response.status, 200u);
+    auto body = nlohmann::json::parse(*response.body);
+    EXPECT_EQ(body["instrument"], instrument);
+    ASSERT_EQ(body["bids"].size(), 3u);
+    ASSERT_EQ(body["asks"].size(), 3u);
+    EXPECT_DOUBLE_EQ(body["bids"][0][0].get<double>(), 100.0);
+    EXPECT_DOUBLE_EQ(body["asks"][2][0].get<double>(), 103.0);
+
+    // Unchanged book: cached; an update invalidates it
+    auto again = routes.handle("/book?instrument=" + instrument + "&depth=3");
+    EXPECT_EQ(again.body.get(), response.body.get());
+    book.bids[0].price = 100.5;
+    market_data.updateOrderBook(book);
+    auto updated = nlohmann::json::parse(*routes.handle("/book?instrument=" + instrument + "&depth=3").body);
+    EXPECT_DOUBLE_EQ(updated["bids"][0][0].get<double>(), 100.5);
+
+    auto top = nlohmann::json::parse(*routes.handle("/top").body);
+    bool found = false;
+    for (const auto& entry : top["instruments"]) {
+        if (entry["instrument"] == instrument) {
+            found = true;
+            EXPECT_DOUBLE_EQ(entry["best_bid"].get<double>(), 100.5);
+            EXPECT_DOUBLE_EQ(entry["best_ask"].get<double>(), 101.0);
+        }
+    }
+    EXPECT_TRUE(found);
+
+    EXPECT_EQ(routes.handle("/book").status, 400u);
+    EXPECT_EQ(routes.handle("/book?instrument=" + instrument + "&depth=0").status, 400u);
+    EXPECT_EQ(routes.handle("/book?instrument=" + instrument + "&depth=abc").status, 400u);
+    EXPECT_EQ(routes.handle("/book?instrument=NO-SUCH-INSTRUMENT").status, 404u);
+}
@@ -0,0 +1,159 @@
+#ifndef INPLACE_FUNCTION_H
+#define INPLACE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// Default capture space: with the two dispatch pointers an InplaceFunction
+// is one 64-byte cache line
+constexpr size_t INPLACE_FUNCTION_DEFAULT_CAPACITY = 48;
+
+template <typename Signature, size_t Capacity = INPLACE_FUNCTION_DEFAULT_CAPACITY>
+class InplaceFunction;
+
+// Drop-in replacement for std::function on hot callback paths. The callable
+// is stored inside the object, never on the heap; one that does not fit is
+// a compile error rather than a silent allocation. Calls go through a
+// single function pointer. Like std::function it is copyable, calls a
+// const object's target as non-const, and throws std::bad_function_call
+// when empty.
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+    // True when F can be stored without raising the capacity
+    template <typename F>
+    static constexpr bool fits = sizeof(std::decay_t<F>) <= Capacity &&
+                                 alignof(std::max_align_t) % alignof(std::decay_t<F>) == 0;
+
+    InplaceFunction() noexcept = default;
+    InplaceFunction(std::nullptr_t) noexcept {}
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InplaceFunction>::value &&
+                                          std::is_invocable_r<R, std::decay_t<F>&, Args...>::value>>
+    InplaceFunction(F&& callable) {
+        using Fn = std::decay_t<F>;
+        static_assert(sizeof(Fn) <= Capacity,
+                      "Callable does not fit in InplaceFunction; capture less or raise the capacity");
+        static_assert(alignof(std::max_align_t) % alignof(Fn) == 0,
+                      "Callable is over-aligned for InplaceFunction");
+        static_assert(std::is_copy_constructible<Fn>::value, "InplaceFunction requires a copyable callable");
+
+        if constexpr (std::is_pointer<Fn>::value || std::is_member_pointer<Fn>::value) {
+            if (callable == nullptr) {
+                return;
+            }
+        }
+        ::new (static_cast<void*>(&storage_)) Fn(std::forward<F>(callable));
+        invoke_ = &invokeTarget<Fn>;
+        manage_ = &manageTarget<Fn>;
+    }
+
+    InplaceFunction(const InplaceFunction& other) {
+        if (other.manage_) {
+            other.manage_(Operation::COPY, &storage_, const_cast<Storage*>(&other.storage_));
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+        }
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept {
+        if (other.manage_) {
+            other.manage_(Operation::MOVE, &storage_, &other.storage_);
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+            other.invoke_ = nullptr;
+            other.manage_ = nullptr;
+        }
+    }
+
+    ~InplaceFunction() {
+        reset();
+    }
+
+    InplaceFunction& operator=(const InplaceFunction& other) {
+        if (this != &other) {
+            InplaceFunction copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.manage_) {
+                other.manage_(Operation::MOVE, &storage_, &other.storage_);
+                invoke_ = other.invoke_;
+                manage_ = other.manage_;
+                other.invoke_ = nullptr;
+                other.manage_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    R operator()(Args... args) const {
+        if (!invoke_) {
+            throw std::bad_function_call();
+        }
+        return invoke_(const_cast<Storage*>(&storage_), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+private:
+    enum class Operation {
+        COPY,
+        MOVE,     // Move-construct into destination, then destroy the source
+        DESTROY
+    };
+
+    using Storage = std::aligned_storage_t<Capacity, alignof(std::max_align_t)>;
+    using Invoke = R (*)(Storage*, Args&&...);
+    using Manage = void (*)(Operation, Storage*, Storage*);
+
+    template <typename Fn>
+    static R invokeTarget(Storage* storage, Args&&... args) {
+        return (*std::launder(reinterpret_cast<Fn*>(storage)))(std::forward<Args>(args)...);
+    }
+
+    template <typename Fn>
+    static void manageTarget(Operation operation, Storage* destination, Storage* source) {
+        Fn* target = std::launder(reinterpret_cast<Fn*>(source));
+        switch (operation) {
+            case Operation::COPY:
+                ::new (static_cast<void*>(destination)) Fn(*target);
+                break;
+            case Operation::MOVE:
+                ::new (static_cast<void*>(destination)) Fn(std::move(*target));
+                target->~Fn();
+                break;
+            case Operation::DESTROY:
+                target->~Fn();
+                break;
+        }
+    }
+
+    void reset() noexcept {
+        if (manage_) {
+            manage_(Operation::DESTROY, nullptr, &storage_);
+            invoke_ = nullptr;
+            manage_ = nullptr;
+        }
+    }
+
+    Storage storage_;
+    Invoke invoke_{nullptr};
+    Manage manage_{nullptr};
+};
+
+#endif // INPLACE_FUNCTION_H
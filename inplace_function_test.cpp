@@ -0,0 +1,98 @@
+#include "inplace_function.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+class InplaceFunctionTest : public ::testing::Test {
+protected:
+    // Counts live copies so leaks and double destruction show up
+    struct Tracked {
+        explicit Tracked(int* live) : live_(live) { ++*live_; }
+        Tracked(const Tracked& other) : live_(other.live_) { ++*live_; }
+        Tracked(Tracked&& other) noexcept : live_(other.live_) { ++*live_; }
+        ~Tracked() { --*live_; }
+        int operator()(int x) const { return x + 1; }
+        int* live_;
+    };
+};
+
+// One cache line with the default capacity
+static_assert(sizeof(InplaceFunction<void()>) == 64, "InplaceFunction should be one cache line");
+static_assert(InplaceFunction<void()>::fits<void (*)()>, "function pointers fit");
+static_assert(!InplaceFunction<void(), 16>::fits<std::array<char, 32>>, "oversized callables are rejected");
+
+TEST_F(InplaceFunctionTest, CallsStoredCallable) {
+    int total = 0;
+    InplaceFunction<void(int)> add = [&total](int x) { total += x; };
+    add(2);
+    add(3);
+    EXPECT_EQ(total, 5);
+
+    // Mutable state lives in the delegate and survives const calls
+    const InplaceFunction<int()> counter = [n = 0]() mutable { return ++n; };
+    EXPECT_EQ(counter(), 1);
+    EXPECT_EQ(counter(), 2);
+
+    InplaceFunction<std::string(const std::string&, double)> format =
+        [prefix = std::string("px=")](const std::string& side, double price) {
+            return prefix + side + ":" + std::to_string(static_cast<int>(price));
+        };
+    EXPECT_EQ(format("buy", 100.0), "px=buy:100");
+}
+
+TEST_F(InplaceFunctionTest, CopyAndMoveManageTheTarget) {
+    int live = 0;
+    {
+        InplaceFunction<int(int)> original = Tracked(&live);
+        EXPECT_EQ(live, 1);
+
+        InplaceFunction<int(int)> copy = original;
+        EXPECT_EQ(live, 2);
+        EXPECT_EQ(copy(1), 2);
+
+        InplaceFunction<int(int)> moved = std::move(original);
+        EXPECT_EQ(live, 2);
+        EXPECT_FALSE(original);
+        EXPECT_EQ(moved(41), 42);
+
+        copy = moved;
+        EXPECT_EQ(live, 2);
+        copy = nullptr;
+        EXPECT_EQ(live, 1);
+
+        std::vector<InplaceFunction<int(int)>> registry;
+        for (int i = 0; i < 10; ++i) {
+            registry.push_back(moved);  // Reallocation moves every element
+        }
+        EXPECT_EQ(live, 11);
+    }
+    EXPECT_EQ(live, 0);
+}
+
+TEST_F(InplaceFunctionTest, EmptyDelegateThrows) {
+    InplaceFunction<void()> empty;
+    EXPECT_FALSE(empty);
+    EXPECT_THROW(empty(), std::bad_function_call);
+
+    void (*null_pointer)() = nullptr;
+    InplaceFunction<void()> from_null = null_pointer;
+    EXPECT_FALSE(from_null);
+
+    InplaceFunction<void()> assigned = [] {};
+    EXPECT_TRUE(assigned);
+    assigned = nullptr;
+    EXPECT_FALSE(assigned);
+}
+
+TEST_F(InplaceFunctionTest, HoldsSharedOwnershipCaptures) {
+    auto resource = std::make_shared<int>(7);
+    {
+        InplaceFunction<int()> reader = [resource] { return *resource; };
+        InplaceFunction<int()> copy = reader;
+        EXPECT_EQ(resource.use_count(), 3);
+        EXPECT_EQ(copy(), 7);
+    }
+    EXPECT_EQ(resource.use_count(), 1);
+}
@@ -0,0 +1,35 @@
+#include "instrument_registry.h"
+#include <stdexcept>
+
+uint32_t InstrumentRegistry::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    // Keys view into names_, which never relocates its elements on push_back
+    uint32_t id = static_cast<uint32_t>(names_.size());
+    names_.push_back(name);
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+uint32_t InstrumentRegistry::find(std::string_view name) const {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    auto it = ids_.find(name);
+    return it == ids_.end() ? INVALID_ID : it->second;
+}
+
+const std::string& InstrumentRegistry::name(uint32_t id) const {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    if (id >= names_.size()) {
+        throw std::out_of_range("Unknown instrument id: " + std::to_string(id));
+    }
+    return names_[id];
+}
+
+size_t InstrumentRegistry::size() const {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    return names_.size();
+}
@@ -0,0 +1,39 @@
+#ifndef INSTRUMENT_REGISTRY_H
+#define INSTRUMENT_REGISTRY_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+// Process-wide interning of instrument names to dense integer ids. Ids are
+// never reused and the interned strings never move, so hot paths can hold
+// either the id or a pointer to the name without further lookups.
+class InstrumentRegistry {
+public:
+    static constexpr uint32_t INVALID_ID = 0xFFFFFFFFu;
+
+    static InstrumentRegistry& getInstance() {
+        static InstrumentRegistry instance;
+        return instance;
+    }
+
+    uint32_t intern(const std::string& name);
+    uint32_t find(std::string_view name) const;
+    const std::string& name(uint32_t id) const;
+    size_t size() const;
+
+private:
+    InstrumentRegistry() = default;
+    ~InstrumentRegistry() = default;
+    InstrumentRegistry(const InstrumentRegistry&) = delete;
+    InstrumentRegistry& operator=(const InstrumentRegistry&) = delete;
+
+    mutable std::mutex registry_mutex_;
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+};
+
+#endif // INSTRUMENT_REGISTRY_H
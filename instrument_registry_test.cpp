@@ -0,0 +1,34 @@
+#include "instrument_registry.h"
+#include <gtest/gtest.h>
+#include <string>
+
+class InstrumentRegistryTest : public ::testing::Test {
+protected:
+    InstrumentRegistry& registry_ = InstrumentRegistry::getInstance();
+};
+
+TEST_F(InstrumentRegistryTest, InternIsIdempotent) {
+    uint32_t id = registry_.intern("REGISTRY-TEST-A");
+    EXPECT_NE(id, InstrumentRegistry::INVALID_ID);
+    EXPECT_EQ(registry_.intern("REGISTRY-TEST-A"), id);
+    EXPECT_EQ(registry_.find("REGISTRY-TEST-A"), id);
+    EXPECT_NE(registry_.intern("REGISTRY-TEST-B"), id);
+}
+
+TEST_F(InstrumentRegistryTest, FindDoesNotIntern) {
+    size_t before = registry_.size();
+    EXPECT_EQ(registry_.find("REGISTRY-TEST-UNKNOWN"), InstrumentRegistry::INVALID_ID);
+    EXPECT_EQ(registry_.size(), before);
+}
+
+TEST_F(InstrumentRegistryTest, NamesStayPutAsTheRegistryGrows) {
+    uint32_t id = registry_.intern("REGISTRY-TEST-STABLE");
+    const std::string* name = &registry_.name(id);
+
+    for (int i = 0; i < 1000; ++i) {
+        registry_.intern("REGISTRY-TEST-GROW-" + std::to_string(i));
+    }
+
+    EXPECT_EQ(&registry_.name(id), name);
+    EXPECT_EQ(*name, "REGISTRY-TEST-STABLE");
+}
@@ -23,55 +23,47 @@ LatencyModule::TimePoint LatencyModule::start(const std::string& operation_id) {
 }
 
 void LatencyModule::end(const std::string& operation_id, const TimePoint& start_time) {
-    std::lock_guard<std::mutex> lock(mutex_);
     auto end_time = std::chrono::steady_clock::now();
     auto latency = std::chrono::duration_cast<Duration>(end_time - start_time);
-    
+
+    std::lock_guard<std::mutex> lock(mutex_);
     if (operation_id == "order_placement") {
-        trackOrderPlacement(latency);
+        record(order_placement_latencies_, latency);
     } else if (operation_id == "market_data") {
-        trackMarketData(latency);
+        record(market_data_latencies_, latency);
     } else if (operation_id == "websocket") {
-        trackWebSocketMessage(latency);
+        record(websocket_latencies_, latency);
     } else if (operation_id == "trading_loop") {
-        trackTradingLoop(latency);
-    }
-    
-    latency_data_[operation_id].push_back(latency);
-    if (latency_data_[operation_id].size() > max_history_size_) {
-        latency_data_[operation_id].erase(latency_data_[operation_id].begin());
+        record(trading_loop_latencies_, latency);
     }
+
+    record(latency_data_[operation_id], latency);
 }
 
 void LatencyModule::trackOrderPlacement(const Duration& latency) {
     std::lock_guard<std::mutex> lock(mutex_);
-    order_placement_latencies_.push_back(latency);
-    if (order_placement_latencies_.size() > max_history_size_) {
-        order_placement_latencies_.erase(order_placement_latencies_.begin());
-    }
+    record(order_placement_latencies_, latency);
 }
 
 void LatencyModule::trackMarketData(const Duration& latency) {
     std::lock_guard<std::mutex> lock(mutex_);
-    market_data_latencies_.push_back(latency);
-    if (market_data_latencies_.size() > max_history_size_) {
-        market_data_latencies_.erase(market_data_latencies_.begin());
-    }
+    record(market_data_latencies_, latency);
 }
 
 void LatencyModule::trackWebSocketMessage(const Duration& latency) {
     std::lock_guard<std::mutex> lock(mutex_);
-    websocket_latencies_.push_back(latency);
-    if (websocket_latencies_.size() > max_history_size_) {
-        websocket_latencies_.erase(websocket_latencies_.begin());
-    }
+    record(websocket_latencies_, latency);
 }
 
 void LatencyModule::trackTradingLoop(const Duration& latency) {
     std::lock_guard<std::mutex> lock(mutex_);
-    trading_loop_latencies_.push_back(latency);
-    if (trading_loop_latencies_.size() > max_history_size_) {
-        trading_loop_latencies_.erase(trading_loop_latencies_.begin());
+    record(trading_loop_latencies_, latency);
+}
+
+void LatencyModule::record(std::vector<Duration>& latencies, const Duration& latency) {
+    latencies.push_back(latency);
+    if (latencies.size() > max_history_size_) {
+        latencies.erase(latencies.begin(), latencies.end() - max_history_size_);
     }
 }
 
@@ -104,6 +96,7 @@ LatencyModule::LatencyStats LatencyModule::getTradingLoopStats() const {
 }
 
 void LatencyModule::calculateStats(const std::vector<Duration>& latencies, LatencyStats& stats) const {
+    stats = LatencyStats{};
     if (latencies.empty()) {
         return;
     }
@@ -155,10 +148,16 @@ void LatencyModule::saveStats(const std::string& filename) const {
              << stats.count << "\n";
     };
 
-    write_stats("Order Placement", getOrderPlacementStats());
-    write_stats("Market Data", getMarketDataStats());
-    write_stats("WebSocket", getWebSocketStats());
-    write_stats("Trading Loop", getTradingLoopStats());
+    // The getters lock mutex_ themselves, so compute directly here
+    LatencyStats stats;
+    calculateStats(order_placement_latencies_, stats);
+    write_stats("Order Placement", stats);
+    calculateStats(market_data_latencies_, stats);
+    write_stats("Market Data", stats);
+    calculateStats(websocket_latencies_, stats);
+    write_stats("WebSocket", stats);
+    calculateStats(trading_loop_latencies_, stats);
+    write_stats("Trading Loop", stats);
 
     file.close();
 }
@@ -193,7 +192,11 @@ void LatencyModule::log(const std::string& message) {
         auto now = std::chrono::system_clock::now();
         auto time_t = std::chrono::system_clock::to_time_t(now);
         std::tm tm;
+#ifdef _WIN32
         localtime_s(&tm, &time_t);
+#else
+        localtime_r(&time_t, &tm);
+#endif
         
         log_file_ << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") 
                   << " - " << message << std::endl;
@@ -222,7 +225,9 @@ std::vector<LatencyModule::LatencyStats> LatencyModule::getHistoricalStats(
     std::vector<LatencyStats> result;
     auto it = latency_data_.find(operation_id);
     if (it != latency_data_.end()) {
-        result.push_back(getStats(operation_id));
+        LatencyStats stats;
+        calculateStats(it->second, stats);
+        result.push_back(stats);
     }
     return result;
 }
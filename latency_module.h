@@ -58,6 +58,8 @@ private:
     LatencyModule(const LatencyModule&) = delete;
     LatencyModule& operator=(const LatencyModule&) = delete;
 
+    // Requires mutex_
+    void record(std::vector<Duration>& latencies, const Duration& latency);
     void calculateStats(const std::vector<Duration>& latencies, LatencyStats& stats) const;
     void ensureLogFileOpen();
 
@@ -0,0 +1,165 @@
+#include "load_generator.h"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct SenderLog {
+    std::vector<double> latency_us;
+    std::vector<double> service_us;
+    Clock::time_point last_completion;
+    size_t errors{0};
+};
+
+double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    return sorted[static_cast<size_t>((sorted.size() - 1) * q)];
+}
+
+// sleep_until alone overshoots by the scheduler quantum, which would be
+// charged to the operation; sleep most of the way and spin the rest
+void waitUntil(Clock::time_point deadline) {
+    const auto spin_window = std::chrono::microseconds(200);
+    auto now = Clock::now();
+    if (deadline - now > spin_window) {
+        std::this_thread::sleep_until(deadline - spin_window);
+    }
+    while (Clock::now() < deadline) {
+    }
+}
+
+}  // namespace
+
+LoadGenerator::Result LoadGenerator::run(const Operation& operation, const Config& config) {
+    if (!(config.rate_per_second > 0.0) || config.threads == 0) {
+        throw std::invalid_argument("Load generator needs a positive rate and at least one thread");
+    }
+
+    // The whole schedule is fixed before the first send
+    const auto period = std::chrono::duration<double>(1.0 / config.rate_per_second);
+    const size_t total = static_cast<size_t>(
+        std::chrono::duration<double>(config.duration).count() * config.rate_per_second);
+    std::vector<Clock::duration> schedule(total);
+    for (size_t i = 0; i < total; ++i) {
+        schedule[i] = std::chrono::duration_cast<Clock::duration>(period * static_cast<double>(i));
+    }
+
+    const auto start = Clock::now() + std::chrono::milliseconds(10);
+    const auto measure_from = start + config.warmup;
+
+    std::vector<SenderLog> logs(config.threads);
+    std::vector<std::thread> senders;
+    senders.reserve(config.threads);
+    for (size_t t = 0; t < config.threads; ++t) {
+        senders.emplace_back([&, t]() {
+            auto& log = logs[t];
+            log.latency_us.reserve(total / config.threads + 1);
+            log.service_us.reserve(total / config.threads + 1);
+            log.last_completion = measure_from;
+
+            for (size_t i = t; i < total; i += config.threads) {
+                const auto intended = start + schedule[i];
+                waitUntil(intended);
+
+                const auto sent = Clock::now();
+                bool ok = false;
+                try {
+                    ok = operation();
+                } catch (...) {
+                }
+                const auto done = Clock::now();
+
+                if (intended < measure_from) {
+                    continue;
+                }
+                if (!ok) {
+                    log.errors++;
+                }
+                log.latency_us.push_back(std::chrono::duration<double, std::micro>(done - intended).count());
+                log.service_us.push_back(std::chrono::duration<double, std::micro>(done - sent).count());
+                log.last_completion = done;
+            }
+        });
+    }
+    for (auto& sender : senders) {
+        sender.join();
+    }
+
+    Result result;
+    result.offered_rate = config.rate_per_second;
+
+    std::vector<double> latency;
+    std::vector<double> service;
+    auto last_completion = measure_from;
+    for (auto& log : logs) {
+        latency.insert(latency.end(), log.latency_us.begin(), log.latency_us.end());
+        service.insert(service.end(), log.service_us.begin(), log.service_us.end());
+        result.errors += log.errors;
+        last_completion = std::max(last_completion, log.last_completion);
+    }
+    result.requests = latency.size();
+    if (latency.empty()) {
+        return result;
+    }
+
+    double window = std::chrono::duration<double>(last_completion - measure_from).count();
+    result.achieved_rate = window > 0.0 ? result.requests / window : 0.0;
+
+    std::sort(latency.begin(), latency.end());
+    std::sort(service.begin(), service.end());
+    result.mean_us = std::accumulate(latency.begin(), latency.end(), 0.0) / latency.size();
+    result.p50_us = percentile(latency, 0.50);
+    result.p90_us = percentile(latency, 0.90);
+    result.p99_us = percentile(latency, 0.99);
+    result.p999_us = percentile(latency, 0.999);
+    result.max_us = latency.back();
+    result.service_p50_us = percentile(service, 0.50);
+    result.service_p99_us = percentile(service, 0.99);
+    return result;
+}
+
+std::vector<LoadGenerator::Result> LoadGenerator::sweep(const Operation& operation, const SweepConfig& config) {
+    if (!(config.rate_multiplier > 1.0)) {
+        throw std::invalid_argument("Sweep rate multiplier must be greater than 1");
+    }
+
+    std::vector<Result> results;
+    Config step = config.base;
+    for (size_t i = 0; i < config.max_steps && step.rate_per_second <= config.max_rate; ++i) {
+        Result result = run(operation, step);
+        result.saturated = result.achieved_rate < config.saturation_throughput_ratio * result.offered_rate ||
+                           (config.saturation_p99_us > 0.0 && result.p99_us > config.saturation_p99_us);
+        results.push_back(result);
+        if (result.saturated) {
+            break;
+        }
+        step.rate_per_second *= config.rate_multiplier;
+    }
+    return results;
+}
+
+void LoadGenerator::writeCsv(const std::string& filename, const std::string& operation,
+                             const std::vector<Result>& results, bool append) {
+    std::ofstream file(filename, append ? std::ios::app : std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open load report: " + filename);
+    }
+
+    if (!append || file.tellp() == 0) {
+        file << "operation,offered_rate,achieved_rate,requests,errors,mean_us,p50_us,p90_us,p99_us,p999_us,max_us,"
+                "service_p50_us,service_p99_us,saturated\n";
+    }
+    for (const auto& r : results) {
+        file << operation << ',' << r.offered_rate << ',' << r.achieved_rate << ',' << r.requests << ','
+             << r.errors << ',' << r.mean_us << ',' << r.p50_us << ',' << r.p90_us << ',' << r.p99_us << ','
+             << r.p999_us << ',' << r.max_us << ',' << r.service_p50_us << ',' << r.service_p99_us << ','
+             << (r.saturated ? 1 : 0) << '\n';
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+// Open-loop load generator. Requests are issued from a precomputed schedule
+// at a fixed target rate regardless of how long earlier requests took, and
+// latency is measured from the intended send time rather than the actual one.
+// A slow response therefore shows up as queueing delay on every request
+// scheduled behind it instead of silently lowering the offered load
+// (coordinated omission).
+class LoadGenerator {
+public:
+    // Performs one request synchronously; returns false on failure
+    using Operation = std::function<bool()>;
+
+    struct Config {
+        double rate_per_second{1000.0};
+        std::chrono::milliseconds duration{5000};
+        std::chrono::milliseconds warmup{500};  // Requests scheduled before this are not recorded
+        size_t threads{1};                      // Senders; request i goes to sender i % threads
+    };
+
+    struct SweepConfig {
+        Config base;                          // rate_per_second is the first step
+        double rate_multiplier{1.5};
+        double max_rate{1000000.0};
+        size_t max_steps{20};
+        double saturation_throughput_ratio{0.95};  // Saturated when achieved < ratio * offered
+        double saturation_p99_us{0.0};             // Also saturated when p99 exceeds this; 0 disables
+    };
+
+    struct Result {
+        double offered_rate{0.0};
+        double achieved_rate{0.0};    // Completions per second over the measured window
+        size_t requests{0};
+        size_t errors{0};
+        // From intended send time
+        double mean_us{0.0};
+        double p50_us{0.0};
+        double p90_us{0.0};
+        double p99_us{0.0};
+        double p999_us{0.0};
+        double max_us{0.0};
+        // From actual send time, the figure a closed-loop benchmark reports
+        double service_p50_us{0.0};
+        double service_p99_us{0.0};
+        bool saturated{false};
+    };
+
+    static Result run(const Operation& operation, const Config& config);
+
+    // Raises the offered rate geometrically until the operation saturates;
+    // the saturated step is included as the last result
+    static std::vector<Result> sweep(const Operation& operation, const SweepConfig& config);
+
+    // One row per result: operation name, offered/achieved rate, percentiles
+    static void writeCsv(const std::string& filename, const std::string& operation,
+                         const std::vector<Result>& results, bool append = false);
+};
+
+#endif // LOAD_GENERATOR_H
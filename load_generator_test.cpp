@@ -0,0 +1,136 @@
+#include "load_generator.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+class LoadGeneratorTest : public ::testing::Test {
+protected:
+    static LoadGenerator::Config config(double rate, int duration_ms, int warmup_ms, size_t threads = 1) {
+        LoadGenerator::Config c;
+        c.rate_per_second = rate;
+        c.duration = std::chrono::milliseconds(duration_ms);
+        c.warmup = std::chrono::milliseconds(warmup_ms);
+        c.threads = threads;
+        return c;
+    }
+
+    // Busy service time; sleeping would add the scheduler's overshoot
+    static void spinFor(std::chrono::microseconds duration) {
+        const auto until = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+};
+
+TEST_F(LoadGeneratorTest, IssuesTheWholeScheduleAndRecordsAfterWarmup) {
+    std::atomic<size_t> calls{0};
+    auto result = LoadGenerator::run([&calls]() { calls++; return true; }, config(1000.0, 200, 50));
+
+    EXPECT_EQ(calls.load(), 200u);
+    EXPECT_NEAR(static_cast<double>(result.requests), 150.0, 1.0);
+    EXPECT_EQ(result.errors, 0u);
+    EXPECT_DOUBLE_EQ(result.offered_rate, 1000.0);
+    EXPECT_NEAR(result.achieved_rate, 1000.0, 100.0);
+    EXPECT_LE(result.p50_us, result.p99_us);
+    EXPECT_LE(result.p99_us, result.max_us);
+}
+
+TEST_F(LoadGeneratorTest, RoundRobinsAcrossSenders) {
+    std::mutex mutex;
+    std::set<std::thread::id> senders;
+    std::atomic<size_t> calls{0};
+    LoadGenerator::run([&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        senders.insert(std::this_thread::get_id());
+        calls++;
+        return true;
+    }, config(2000.0, 100, 0, 4));
+
+    EXPECT_EQ(calls.load(), 200u);
+    EXPECT_EQ(senders.size(), 4u);
+}
+
+TEST_F(LoadGeneratorTest, FailuresAndExceptionsCountAsErrors) {
+    std::atomic<size_t> calls{0};
+    auto result = LoadGenerator::run([&calls]() -> bool {
+        size_t call = calls++;
+        if (call % 4 == 1) return false;
+        if (call % 4 == 3) throw std::runtime_error("rejected");
+        return true;
+    }, config(1000.0, 100, 0));
+
+    EXPECT_EQ(result.requests, 100u);
+    EXPECT_EQ(result.errors, 50u);
+}
+
+TEST_F(LoadGeneratorTest, StallIsChargedToRequestsQueuedBehindIt) {
+    // One 50 ms stall at 1000/s: a closed-loop measurement sees one slow
+    // request, while the ~50 requests scheduled during the stall all wait
+    std::atomic<size_t> calls{0};
+    auto result = LoadGenerator::run([&calls]() {
+        if (calls++ == 100) {
+            spinFor(std::chrono::milliseconds(50));
+        }
+        return true;
+    }, config(1000.0, 300, 0));
+
+    EXPECT_EQ(result.requests, 300u);
+    EXPECT_GE(result.max_us, 50000.0);
+    EXPECT_GT(result.p99_us, 30000.0);
+    EXPECT_GT(result.p90_us, 5000.0);
+    EXPECT_LT(result.service_p99_us, 10000.0);
+}
+
+TEST_F(LoadGeneratorTest, SweepStopsAtTheFirstSaturatedStep) {
+    // 2 ms of service time caps a single sender at 500/s
+    LoadGenerator::SweepConfig sweep;
+    sweep.base = config(100.0, 200, 0);
+    sweep.rate_multiplier = 10.0;
+    sweep.max_steps = 5;
+
+    auto results = LoadGenerator::sweep([]() {
+        spinFor(std::chrono::milliseconds(2));
+        return true;
+    }, sweep);
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_FALSE(results[0].saturated);
+    EXPECT_TRUE(results[1].saturated);
+    EXPECT_DOUBLE_EQ(results[1].offered_rate, 1000.0);
+    EXPECT_LT(results[1].achieved_rate, 600.0);
+}
+
+TEST_F(LoadGeneratorTest, RejectsInvalidConfigs) {
+    auto noop = []() { return true; };
+    EXPECT_THROW(LoadGenerator::run(noop, config(0.0, 10, 0)), std::invalid_argument);
+    EXPECT_THROW(LoadGenerator::run(noop, config(100.0, 10, 0, 0)), std::invalid_argument);
+
+    LoadGenerator::SweepConfig sweep;
+    sweep.rate_multiplier = 1.0;
+    EXPECT_THROW(LoadGenerator::sweep(noop, sweep), std::invalid_argument);
+}
+
+TEST_F(LoadGeneratorTest, CsvAppendWritesOneHeader) {
+    const std::string filename = "load_generator_test.csv";
+    std::vector<LoadGenerator::Result> results(2);
+    results[1].saturated = true;
+    LoadGenerator::writeCsv(filename, "first", results);
+    LoadGenerator::writeCsv(filename, "second", results, true);
+
+    std::ifstream file(filename);
+    std::string line;
+    std::vector<std::string> lines;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    std::remove(filename.c_str());
+
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_EQ(lines[0].rfind("operation,", 0), 0u);
+    EXPECT_EQ(lines[3].rfind("second,", 0), 0u);
+    EXPECT_EQ(lines[4].back(), '1');
+}
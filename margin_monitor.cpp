@@ -0,0 +1,190 @@
+#include "margin_monitor.h"
+#include <algorithm>
+#include <cmath>
+
+void MarginMonitor::setThresholds(const Thresholds& thresholds) {
+    std::vector<Alert> alerts;
+    {
+        std::lock_guard<std::mutex> lock(margin_mutex_);
+        thresholds_ = thresholds;
+
+        by_distance_.clear();
+        for (auto& [_, position] : positions_) {
+            recompute(position, alerts);
+            by_distance_.emplace(position.distance, &position);
+        }
+    }
+    dispatch(alerts);
+}
+
+void MarginMonitor::setAlertCallback(AlertCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    alert_callback_ = std::move(callback);
+}
+
+void MarginMonitor::updatePosition(const std::string& instrument, double size, double mark_price,
+                                   double liquidation_price, double initial_margin, double maintenance_margin) {
+    std::vector<Alert> alerts;
+    {
+        std::lock_guard<std::mutex> lock(margin_mutex_);
+
+        auto it = positions_.find(instrument);
+        if (it != positions_.end()) {
+            by_distance_.erase({it->second.distance, &it->second});
+        }
+
+        if (size == 0.0) {
+            if (it != positions_.end()) {
+                // A closed position is out of danger; listeners that acted
+                // on its alert need to hear that
+                if (it->second.level != Level::OK) {
+                    alerts.push_back({instrument, Level::OK, it->second.level, 1.0, utilization_});
+                }
+                positions_.erase(it);
+            }
+        } else {
+            if (it == positions_.end()) {
+                it = positions_.emplace(instrument, PositionMargin{}).first;
+                it->second.instrument = instrument;
+            }
+            auto& position = it->second;
+            position.size = size;
+            if (mark_price > 0.0) {
+                position.mark_price = mark_price;
+            }
+            position.liquidation_price = liquidation_price;
+            position.initial_margin = initial_margin;
+            position.maintenance_margin = maintenance_margin;
+
+            recompute(position, alerts);
+            by_distance_.emplace(position.distance, &position);
+        }
+    }
+    dispatch(alerts);
+}
+
+void MarginMonitor::onMark(const std::string& instrument, double mark_price) {
+    if (!(mark_price > 0.0)) {
+        return;
+    }
+
+    std::vector<Alert> alerts;
+    {
+        std::lock_guard<std::mutex> lock(margin_mutex_);
+
+        auto it = positions_.find(instrument);
+        if (it == positions_.end() || it->second.mark_price == mark_price) {
+            return;
+        }
+
+        auto& position = it->second;
+        by_distance_.erase({position.distance, &position});
+        position.mark_price = mark_price;
+        recompute(position, alerts);
+        by_distance_.emplace(position.distance, &position);
+    }
+    dispatch(alerts);
+}
+
+void MarginMonitor::updateAccount(double equity, double maintenance_margin) {
+    std::vector<Alert> alerts;
+    {
+        std::lock_guard<std::mutex> lock(margin_mutex_);
+
+        utilization_ = equity > 0.0 ? maintenance_margin / equity
+                                    : (maintenance_margin > 0.0 ? 1.0 : 0.0);
+        Level level = utilizationLevel(utilization_);
+        if (level != account_level_) {
+            alerts.push_back({"", level, account_level_, 0.0, utilization_});
+            account_level_ = level;
+        }
+    }
+    dispatch(alerts);
+}
+
+void MarginMonitor::clear() {
+    std::lock_guard<std::mutex> lock(margin_mutex_);
+    by_distance_.clear();
+    positions_.clear();
+    utilization_ = 0.0;
+    account_level_ = Level::OK;
+}
+
+bool MarginMonitor::getPosition(const std::string& instrument, PositionMargin& position) const {
+    std::lock_guard<std::mutex> lock(margin_mutex_);
+    auto it = positions_.find(instrument);
+    if (it == positions_.end()) {
+        return false;
+    }
+    position = it->second;
+    return true;
+}
+
+std::vector<MarginMonitor::PositionMargin> MarginMonitor::getClosestToLiquidation(size_t count) const {
+    std::lock_guard<std::mutex> lock(margin_mutex_);
+    std::vector<PositionMargin> result;
+    result.reserve(std::min(count, by_distance_.size()));
+    for (auto it = by_distance_.begin(); it != by_distance_.end() && result.size() < count; ++it) {
+        result.push_back(*it->second);
+    }
+    return result;
+}
+
+double MarginMonitor::getUtilization() const {
+    std::lock_guard<std::mutex> lock(margin_mutex_);
+    return utilization_;
+}
+
+MarginMonitor::Level MarginMonitor::getAccountLevel() const {
+    std::lock_guard<std::mutex> lock(margin_mutex_);
+    return account_level_;
+}
+
+void MarginMonitor::recompute(PositionMargin& position, std::vector<Alert>& alerts) {
+    // Longs liquidate below the mark, shorts above it. Without an estimate
+    // from the exchange the position is treated as far from liquidation.
+    double distance = 1.0;
+    if (position.liquidation_price > 0.0 && position.mark_price > 0.0) {
+        double gap = position.size > 0.0 ? position.mark_price - position.liquidation_price
+                                         : position.liquidation_price - position.mark_price;
+        distance = std::max(0.0, gap / position.mark_price);
+    }
+    position.distance = distance;
+    position.timestamp = std::chrono::system_clock::now();
+
+    Level level = distanceLevel(distance);
+    if (level != position.level) {
+        alerts.push_back({position.instrument, level, position.level, distance, utilization_});
+        position.level = level;
+    }
+}
+
+MarginMonitor::Level MarginMonitor::distanceLevel(double distance) const {
+    if (distance <= thresholds_.critical_distance) return Level::CRITICAL;
+    if (distance <= thresholds_.warning_distance) return Level::WARNING;
+    return Level::OK;
+}
+
+MarginMonitor::Level MarginMonitor::utilizationLevel(double utilization) const {
+    if (utilization >= thresholds_.critical_utilization) return Level::CRITICAL;
+    if (utilization >= thresholds_.warning_utilization) return Level::WARNING;
+    return Level::OK;
+}
+
+void MarginMonitor::dispatch(const std::vector<Alert>& alerts) {
+    if (alerts.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (!alert_callback_) {
+        return;
+    }
+    for (const auto& alert : alerts) {
+        try {
+            alert_callback_(alert);
+        } catch (...) {
+            // De-risking handlers must not break market data processing
+        }
+    }
+}
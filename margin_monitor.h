@@ -0,0 +1,100 @@
+#ifndef MARGIN_MONITOR_H
+#define MARGIN_MONITOR_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <mutex>
+#include <functional>
+#include <chrono>
+
+// Tracks how far each open position is from liquidation and how much of the
+// account's equity is consumed by maintenance margin. A mark update touches
+// only the position it belongs to; positions are kept ordered by distance so
+// the closest-to-liquidation list is available without a scan. Alerts fire
+// synchronously on the updating thread whenever a position or the account
+// moves between alert levels, in either direction.
+class MarginMonitor {
+public:
+    enum class Level {
+        OK,
+        WARNING,
+        CRITICAL
+    };
+
+    struct Thresholds {
+        double warning_distance{0.10};     // Fraction of mark price
+        double critical_distance{0.05};
+        double warning_utilization{0.80};  // Maintenance margin / equity
+        double critical_utilization{0.90};
+    };
+
+    struct PositionMargin {
+        std::string instrument;
+        double size{0.0};
+        double mark_price{0.0};
+        double liquidation_price{0.0};
+        double initial_margin{0.0};
+        double maintenance_margin{0.0};
+        double distance{0.0};  // (mark - liquidation) / mark in the adverse direction, floored at 0
+        Level level{Level::OK};
+        std::chrono::system_clock::time_point timestamp;
+    };
+
+    struct Alert {
+        std::string instrument;  // Empty for account-level utilization alerts
+        Level level;
+        Level previous_level;
+        double distance;
+        double utilization;
+    };
+
+    using AlertCallback = std::function<void(const Alert&)>;
+
+    static MarginMonitor& getInstance() {
+        static MarginMonitor instance;
+        return instance;
+    }
+
+    void setThresholds(const Thresholds& thresholds);
+    void setAlertCallback(AlertCallback callback);
+
+    // Full position refresh from the exchange; size 0 removes the position,
+    // with an OK alert if it was at WARNING or CRITICAL
+    void updatePosition(const std::string& instrument, double size, double mark_price,
+                        double liquidation_price, double initial_margin, double maintenance_margin);
+    void onMark(const std::string& instrument, double mark_price);
+    void updateAccount(double equity, double maintenance_margin);
+    void clear();
+
+    bool getPosition(const std::string& instrument, PositionMargin& position) const;
+    std::vector<PositionMargin> getClosestToLiquidation(size_t count) const;
+    double getUtilization() const;
+    Level getAccountLevel() const;
+
+private:
+    MarginMonitor() = default;
+    ~MarginMonitor() = default;
+    MarginMonitor(const MarginMonitor&) = delete;
+    MarginMonitor& operator=(const MarginMonitor&) = delete;
+
+    using RankKey = std::pair<double, const PositionMargin*>;
+
+    void recompute(PositionMargin& position, std::vector<Alert>& alerts);
+    Level distanceLevel(double distance) const;
+    Level utilizationLevel(double utilization) const;
+    void dispatch(const std::vector<Alert>& alerts);
+
+    mutable std::mutex margin_mutex_;
+    Thresholds thresholds_;
+    std::unordered_map<std::string, PositionMargin> positions_;
+    std::set<RankKey> by_distance_;
+    double utilization_{0.0};
+    Level account_level_{Level::OK};
+
+    std::mutex callback_mutex_;
+    AlertCallback alert_callback_;
+};
+
+#endif // MARGIN_MONITOR_H
@@ -0,0 +1,145 @@
+#include "margin_monitor.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+class MarginMonitorTest : public ::testing::Test {
+protected:
+    using Level = MarginMonitor::Level;
+
+    void SetUp() override {
+        auto& monitor = MarginMonitor::getInstance();
+        monitor.setAlertCallback(nullptr);
+        monitor.clear();
+        monitor.setThresholds(MarginMonitor::Thresholds{});
+        monitor.setAlertCallback([this](const MarginMonitor::Alert& alert) { alerts_.push_back(alert); });
+    }
+
+    void TearDown() override {
+        MarginMonitor::getInstance().setAlertCallback(nullptr);
+        MarginMonitor::getInstance().clear();
+    }
+
+    std::vector<MarginMonitor::Alert> alerts_;
+};
+
+TEST_F(MarginMonitorTest, LongPositionAlertsOnEachLevelChange) {
+    auto& monitor = MarginMonitor::getInstance();
+    // Liquidation at 90: the long starts 25% away
+    monitor.updatePosition("BTC-PERPETUAL", 1.0, 120.0, 90.0, 1.0, 0.5);
+    EXPECT_TRUE(alerts_.empty());
+
+    monitor.onMark("BTC-PERPETUAL", 98.0);  // ~8.2%
+    monitor.onMark("BTC-PERPETUAL", 97.0);  // Still WARNING, no alert
+    monitor.onMark("BTC-PERPETUAL", 93.0);  // ~3.2%
+    monitor.onMark("BTC-PERPETUAL", 110.0); // ~18.2%
+
+    ASSERT_EQ(alerts_.size(), 3u);
+    EXPECT_EQ(alerts_[0].instrument, "BTC-PERPETUAL");
+    EXPECT_EQ(alerts_[0].previous_level, Level::OK);
+    EXPECT_EQ(alerts_[0].level, Level::WARNING);
+    EXPECT_EQ(alerts_[1].previous_level, Level::WARNING);
+    EXPECT_EQ(alerts_[1].level, Level::CRITICAL);
+    EXPECT_NEAR(alerts_[1].distance, 3.0 / 93.0, 1e-12);
+    EXPECT_EQ(alerts_[2].previous_level, Level::CRITICAL);
+    EXPECT_EQ(alerts_[2].level, Level::OK);
+}
+
+TEST_F(MarginMonitorTest, ClosingAnAlertedPositionRecovers) {
+    auto& monitor = MarginMonitor::getInstance();
+    monitor.updatePosition("BTC-PERPETUAL", 1.0, 100.0, 97.0, 1.0, 0.5);
+    monitor.updatePosition("ETH-PERPETUAL", 1.0, 100.0, 50.0, 1.0, 0.5);
+    ASSERT_EQ(alerts_.size(), 1u);
+    EXPECT_EQ(alerts_[0].level, Level::CRITICAL);
+
+    monitor.updatePosition("BTC-PERPETUAL", 0.0, 0.0, 0.0, 0.0, 0.0);
+    ASSERT_EQ(alerts_.size(), 2u);
+    EXPECT_EQ(alerts_[1].instrument, "BTC-PERPETUAL");
+    EXPECT_EQ(alerts_[1].previous_level, Level::CRITICAL);
+    EXPECT_EQ(alerts_[1].level, Level::OK);
+
+    // A position that never alerted closes quietly
+    monitor.updatePosition("ETH-PERPETUAL", 0.0, 0.0, 0.0, 0.0, 0.0);
+    EXPECT_EQ(alerts_.size(), 2u);
+    MarginMonitor::PositionMargin position;
+    EXPECT_FALSE(monitor.getPosition("BTC-PERPETUAL", position));
+}
+
+TEST_F(MarginMonitorTest, ShortPositionMeasuresDistanceUpwards) {
+    auto& monitor = MarginMonitor::getInstance();
+    monitor.updatePosition("ETH-PERPETUAL", -2.0, 100.0, 104.0, 1.0, 0.5);
+
+    ASSERT_EQ(alerts_.size(), 1u);
+    EXPECT_EQ(alerts_[0].level, Level::CRITICAL);
+
+    MarginMonitor::PositionMargin position;
+    ASSERT_TRUE(monitor.getPosition("ETH-PERPETUAL", position));
+    EXPECT_NEAR(position.distance, 0.04, 1e-12);
+
+    // Past the liquidation price the distance floors at zero
+    monitor.onMark("ETH-PERPETUAL", 110.0);
+    ASSERT_TRUE(monitor.getPosition("ETH-PERPETUAL", position));
+    EXPECT_EQ(position.distance, 0.0);
+    EXPECT_EQ(alerts_.size(), 1u);
+}
+
+TEST_F(MarginMonitorTest, ThresholdsAreInclusive) {
+    auto& monitor = MarginMonitor::getInstance();
+    monitor.updatePosition("BTC-PERPETUAL", 1.0, 100.0, 90.0, 1.0, 0.5);  // Exactly 10%
+    ASSERT_EQ(alerts_.size(), 1u);
+    EXPECT_EQ(alerts_[0].level, Level::WARNING);
+
+    monitor.updateAccount(100.0, 80.0);
+    ASSERT_EQ(alerts_.size(), 2u);
+    EXPECT_TRUE(alerts_[1].instrument.empty());
+    EXPECT_EQ(alerts_[1].level, Level::WARNING);
+    EXPECT_DOUBLE_EQ(alerts_[1].utilization, 0.8);
+}
+
+TEST_F(MarginMonitorTest, AccountUtilizationTransitions) {
+    auto& monitor = MarginMonitor::getInstance();
+    monitor.updateAccount(100.0, 50.0);
+    monitor.updateAccount(100.0, 95.0);
+    monitor.updateAccount(100.0, 96.0);
+    monitor.updateAccount(0.0, 1.0);   // No equity left counts as fully used
+    monitor.updateAccount(100.0, 85.0);
+
+    ASSERT_EQ(alerts_.size(), 2u);
+    EXPECT_EQ(alerts_[0].previous_level, Level::OK);
+    EXPECT_EQ(alerts_[0].level, Level::CRITICAL);
+    EXPECT_EQ(alerts_[1].previous_level, Level::CRITICAL);
+    EXPECT_EQ(alerts_[1].level, Level::WARNING);
+    EXPECT_EQ(monitor.getAccountLevel(), Level::WARNING);
+}
+
+TEST_F(MarginMonitorTest, TighterThresholdsReclassifyOpenPositions) {
+    auto& monitor = MarginMonitor::getInstance();
+    monitor.updatePosition("BTC-PERPETUAL", 1.0, 100.0, 85.0, 1.0, 0.5);
+    EXPECT_TRUE(alerts_.empty());
+
+    MarginMonitor::Thresholds thresholds;
+    thresholds.warning_distance = 0.20;
+    thresholds.critical_distance = 0.15;
+    monitor.setThresholds(thresholds);
+
+    ASSERT_EQ(alerts_.size(), 1u);
+    EXPECT_EQ(alerts_[0].level, Level::CRITICAL);
+}
+
+TEST_F(MarginMonitorTest, ClosestToLiquidationIsOrderedByDistance) {
+    auto& monitor = MarginMonitor::getInstance();
+    monitor.updatePosition("A", 1.0, 100.0, 70.0, 1.0, 0.5);
+    monitor.updatePosition("B", 1.0, 100.0, 95.0, 1.0, 0.5);
+    monitor.updatePosition("C", -1.0, 100.0, 120.0, 1.0, 0.5);
+
+    auto closest = monitor.getClosestToLiquidation(2);
+    ASSERT_EQ(closest.size(), 2u);
+    EXPECT_EQ(closest[0].instrument, "B");
+    EXPECT_EQ(closest[1].instrument, "C");
+
+    // Closing a position drops it from the ranking
+    monitor.updatePosition("B", 0.0, 0.0, 0.0, 0.0, 0.0);
+    closest = monitor.getClosestToLiquidation(5);
+    ASSERT_EQ(closest.size(), 2u);
+    EXPECT_EQ(closest[0].instrument, "C");
+    EXPECT_EQ(closest[1].instrument, "A");
+}
@@ -1,9 +1,17 @@
 #include "market_data_manager.h"
+#include "bar_aggregator.h"
+#include "cpu_accounting.h"
+#include "state_snapshot.h"
 #include <algorithm>
 #include <chrono>
 #include <thread>
 #include <stdexcept>
 
+namespace {
+// Idle eviction runs at least this often when no data arrives
+constexpr auto PROCESSING_IDLE_WAIT = std::chrono::seconds(1);
+}
+
 MarketDataManager::MarketDataManager()
     : running_(false),
       config_manager_(ConfigManager::getInstance()) {
@@ -23,43 +31,144 @@ void MarketDataManager::initialize() {
 void MarketDataManager::shutdown() {
     if (!running_) return;
     
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        running_ = false;
+    }
+    data_cv_.notify_all();
     if (processing_thread_.joinable()) {
         processing_thread_.join();
     }
 }
 
 void MarketDataManager::updateOrderBook(const OrderBook& orderbook) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    auto& market_data = market_data_[orderbook.instrument];
-    market_data.orderbook = orderbook;
-    market_data.timestamp = std::chrono::system_clock::now();
-    
-    data_queue_.push(market_data);
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+
+        auto& market_data = touch(orderbook.instrument).data;
+        market_data.orderbook = orderbook;
+        market_data.timestamp = std::chrono::system_clock::now();
+
+        if (!pipeline_dispatch_) {
+            data_queue_.push(market_data);
+        }
+
+        // Under the data lock so eviction cannot run in between and leave
+        // a cache entry for an untracked instrument
+        std::lock_guard<std::mutex> top_lock(top_of_book_mutex_);
+        auto& top = top_of_book_[orderbook.instrument];
+        top.instrument = orderbook.instrument;
+        // An emptied side has no best level; 0 marks it invalid, as for a
+        // ticker without one
+        top.best_bid = orderbook.bids.empty() ? 0.0 : orderbook.bids.front().price;
+        top.best_bid_size = orderbook.bids.empty() ? 0.0 : orderbook.bids.front().size;
+        top.best_ask = orderbook.asks.empty() ? 0.0 : orderbook.asks.front().price;
+        top.best_ask_size = orderbook.asks.empty() ? 0.0 : orderbook.asks.front().size;
+        top.timestamp = orderbook.timestamp;
+        top_of_book_sequence_++;
+    }
+    data_cv_.notify_one();
+
+    // Book updates carry exchange time even when nothing trades, so they
+    // close bars on quiet instruments. The pipeline's feature stage does
+    // this itself.
+    if (!pipeline_dispatch_ && orderbook.timestamp != std::chrono::system_clock::time_point{}) {
+        BarAggregator::getInstance().advanceTo(orderbook.timestamp);
+    }
 }
 
 void MarketDataManager::addTrade(const Trade& trade) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    
-    auto& market_data = market_data_[trade.instrument];
-    market_data.trades.push_back(trade);
-    
-    // Keep only recent trades
-    const size_t max_trades = 1000;
-    if (market_data.trades.size() > max_trades) {
-        market_data.trades.erase(market_data.trades.begin(),
-                               market_data.trades.begin() + (market_data.trades.size() - max_trades));
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        
+        auto& market_data = touch(trade.instrument).data;
+        market_data.trades.push_back(trade);
+        
+        // Keep only recent trades
+        const size_t max_trades = 1000;
+        if (market_data.trades.size() > max_trades) {
+            market_data.trades.erase(market_data.trades.begin(),
+                                   market_data.trades.begin() + (market_data.trades.size() - max_trades));
+        }
+        
+        market_data.timestamp = std::chrono::system_clock::now();
+        if (pipeline_dispatch_) {
+            return;  // The pipeline's feature stage feeds the bars
+        }
+        data_queue_.push(market_data);
     }
+    data_cv_.notify_one();
     
-    market_data.timestamp = std::chrono::system_clock::now();
-    data_queue_.push(market_data);
+    // Outside the data lock so bar subscribers can query the book
+    BarAggregator::getInstance().onTrade(trade.instrument, trade.price, trade.size, trade.timestamp);
 }
 
 void MarketDataManager::updateMarketData(const MarketData& data) {
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        touch(data.orderbook.instrument).data = data;
+        data_queue_.push(data);
+    }
+    data_cv_.notify_one();
+}
+
+void MarketDataManager::updateTicker(const TopOfBook& ticker) {
+    // Ticker-only instruments are tracked like any other, so the LRU bounds
+    // the cache and eviction drops their entry
+    std::lock_guard<std::mutex> data_lock(data_mutex_);
+    touch(ticker.instrument);
+
+    std::lock_guard<std::mutex> lock(top_of_book_mutex_);
+    auto& top = top_of_book_[ticker.instrument];
+    top = ticker;
+    top.has_ticker = true;
+    top_of_book_sequence_++;
+}
+
+bool MarketDataManager::getTopOfBook(const std::string& instrument, TopOfBook& top) const {
+    std::lock_guard<std::mutex> lock(top_of_book_mutex_);
+    auto it = top_of_book_.find(instrument);
+    if (it == top_of_book_.end()) {
+        return false;
+    }
+    top = it->second;
+    return true;
+}
+
+std::vector<MarketDataManager::TopOfBook> MarketDataManager::getAllTopOfBook() const {
+    std::lock_guard<std::mutex> lock(top_of_book_mutex_);
+    std::vector<TopOfBook> tops;
+    tops.reserve(top_of_book_.size());
+    for (const auto& [_, top] : top_of_book_) {
+        tops.push_back(top);
+    }
+    return tops;
+}
+
+uint64_t MarketDataManager::getTopOfBookSequence() const {
+    std::lock_guard<std::mutex> lock(top_of_book_mutex_);
+    return top_of_book_sequence_;
+}
+
+bool MarketDataManager::copyOrderBook(const std::string& instrument, size_t depth, OrderBook& book) const {
     std::lock_guard<std::mutex> lock(data_mutex_);
-    market_data_[data.orderbook.instrument] = data;
-    data_queue_.push(data);
+    auto it = market_data_.find(instrument);
+    if (it == market_data_.end()) {
+        return false;
+    }
+
+    const auto& source = it->second.data.orderbook;
+    book.instrument = instrument;
+    book.timestamp = source.timestamp;
+    book.bids.assign(source.bids.begin(), source.bids.begin() + std::min(depth, source.bids.size()));
+    book.asks.assign(source.asks.begin(), source.asks.begin() + std::min(depth, source.asks.size()));
+    return true;
+}
+
+uint64_t MarketDataManager::getUpdateSequence(const std::string& instrument) const {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    auto it = market_data_.find(instrument);
+    return it != market_data_.end() ? it->second.sequence : 0;
 }
 
 const MarketDataManager::MarketData& MarketDataManager::getMarketData(const std::string& instrument) const {
@@ -68,35 +177,67 @@ const MarketDataManager::MarketData& MarketDataManager::getMarketData(const std:
     if (it == market_data_.end()) {
         throw std::runtime_error("No market data available for instrument: " + instrument);
     }
-    return it->second;
+    return it->second.data;
 }
 
 const MarketDataManager::OrderBook& MarketDataManager::getOrderBook(const std::string& instrument) const {
     return getMarketData(instrument).orderbook;
 }
 
-const std::vector<MarketDataManager::Trade>& MarketDataManager::getRecentTrades(const std::string& instrument, size_t count) const {
+std::vector<MarketDataManager::Trade> MarketDataManager::getRecentTrades(const std::string& instrument, size_t count) const {
     std::lock_guard<std::mutex> lock(data_mutex_);
     auto it = market_data_.find(instrument);
     if (it == market_data_.end()) {
         throw std::runtime_error("No market data available for instrument: " + instrument);
     }
     
-    const auto& trades = it->second.trades;
-    if (trades.size() <= count) {
-        return trades;
+    // Copied under the lock; addTrade may trim the vector at any time
+    const auto& trades = it->second.data.trades;
+    const size_t first = trades.size() > count ? trades.size() - count : 0;
+    return std::vector<Trade>(trades.begin() + first, trades.end());
+}
+
+void MarketDataManager::pinInstrument(const std::string& instrument) {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    auto& pin = pins_[instrument];
+    pin.count++;
+    updatePinned(instrument, pin);
+}
+
+void MarketDataManager::unpinInstrument(const std::string& instrument) {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    auto it = pins_.find(instrument);
+    if (it == pins_.end() || it->second.count == 0) {
+        return;
     }
-    
-    static std::vector<Trade> recent_trades;
-    recent_trades.clear();
-    recent_trades.insert(recent_trades.end(), trades.end() - count, trades.end());
-    return recent_trades;
+    it->second.count--;
+    updatePinned(instrument, it->second);
+}
+
+void MarketDataManager::setPositionOpen(const std::string& instrument, bool open) {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    auto it = pins_.find(instrument);
+    if (it == pins_.end()) {
+        if (!open) {
+            return;
+        }
+        it = pins_.emplace(instrument, PinState{}).first;
+    }
+    if (it->second.position == open) {
+        return;
+    }
+    it->second.position = open;
+    updatePinned(instrument, it->second);
 }
 
-void MarketDataManager::subscribeToMarketData(const std::string& instrument,
-                                            std::function<void(const MarketData&)> callback) {
+size_t MarketDataManager::getTrackedInstrumentCount() const {
     std::lock_guard<std::mutex> lock(data_mutex_);
-    subscribers_[instrument].push_back(callback);
+    return market_data_.size();
+}
+
+void MarketDataManager::subscribeToMarketData(const std::string& instrument, Subscriber callback) {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    subscribers_[instrument].push_back(std::move(callback));
 }
 
 void MarketDataManager::unsubscribeFromMarketData(const std::string& instrument) {
@@ -104,6 +245,34 @@ void MarketDataManager::unsubscribeFromMarketData(const std::string& instrument)
     subscribers_.erase(instrument);
 }
 
+void MarketDataManager::setPipelineDispatch(bool enabled) {
+    pipeline_dispatch_ = enabled;
+}
+
+void MarketDataManager::dispatch(const std::string& instrument) {
+    MarketData data;
+    std::vector<Subscriber> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        auto subscribed = subscribers_.find(instrument);
+        auto state = market_data_.find(instrument);
+        if (subscribed == subscribers_.end() || state == market_data_.end()) {
+            return;
+        }
+        subscribers = subscribed->second;
+        data = state->second.data;
+    }
+
+    CPU_SCOPE("market_data_dispatch");
+    for (const auto& callback : subscribers) {
+        try {
+            callback(data);
+        } catch (...) {
+            // Prevent subscriber exceptions from affecting other subscribers
+        }
+    }
+}
+
 double MarketDataManager::getBestBid(const std::string& instrument) const {
     const auto& orderbook = getOrderBook(instrument);
     if (orderbook.bids.empty()) {
@@ -129,48 +298,311 @@ double MarketDataManager::getSpread(const std::string& instrument) const {
 }
 
 void MarketDataManager::processMarketData() {
+    CpuAccounting::ThreadRegistration cpu_registration("market_data");
+    
     while (running_) {
-        MarketData data;
-        {
+        // Idle eviction only looks at the LRU tail, so this is cheap; the
+        // count limit is already enforced whenever a new instrument arrives
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_idle_check_) {
             std::lock_guard<std::mutex> lock(data_mutex_);
-            if (data_queue_.empty()) {
-                continue;
-            }
-            data = data_queue_.front();
-            data_queue_.pop();
+            evictExpired(now, nullptr);
+            next_idle_check_ = now + std::chrono::seconds(1);
         }
         
-        notifySubscribers(data.orderbook.instrument, data);
-        cleanupOldData();
+        // Take everything queued in one go; subscribers run after the lock
+        // is released, so they may read the book themselves
+        std::queue<MarketData> batch;
+        {
+            std::unique_lock<std::mutex> lock(data_mutex_);
+            data_cv_.wait_for(lock, PROCESSING_IDLE_WAIT, [this] {
+                return !running_ || !data_queue_.empty();
+            });
+            batch.swap(data_queue_);
+        }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (!batch.empty()) {
+            CPU_SCOPE("market_data_dispatch");
+            while (!batch.empty()) {
+                notifySubscribers(batch.front().orderbook.instrument, batch.front());
+                batch.pop();
+            }
+        }
     }
 }
 
 void MarketDataManager::notifySubscribers(const std::string& instrument, const MarketData& data) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    auto it = subscribers_.find(instrument);
-    if (it != subscribers_.end()) {
-        for (const auto& callback : it->second) {
-            try {
-                callback(data);
-            } catch (...) {
-                // Prevent subscriber exceptions from affecting other subscribers
-            }
+    std::vector<Subscriber> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        auto it = subscribers_.find(instrument);
+        if (it == subscribers_.end()) {
+            return;
+        }
+        subscribers = it->second;
+    }
+
+    for (const auto& callback : subscribers) {
+        try {
+            callback(data);
+        } catch (...) {
+            // Prevent subscriber exceptions from affecting other subscribers
         }
     }
 }
 
-void MarketDataManager::cleanupOldData() {
-    const auto now = std::chrono::system_clock::now();
-    const auto max_age = std::chrono::minutes(5);
-    
+MarketDataManager::InstrumentState& MarketDataManager::touch(const std::string& instrument) {
+    const auto now = std::chrono::steady_clock::now();
+    auto [it, inserted] = market_data_.try_emplace(instrument);
+    auto& state = it->second;
+
+    if (inserted) {
+        state.instrument = instrument;
+        // Subscribers are keyed on this, including for trade-only instruments
+        state.data.orderbook.instrument = instrument;
+        state.pinned = pins_.count(instrument) > 0;
+    } else if (!state.pinned) {
+        lruUnlink(state);
+    }
+    state.last_update = now;
+    // Every caller is about to modify the state
+    state.sequence = ++update_sequence_;
+    if (!state.pinned) {
+        lruPushFront(state);
+    }
+
+    if (inserted) {
+        evictExpired(now, &state);
+    }
+    return state;
+}
+
+void MarketDataManager::lruUnlink(InstrumentState& state) {
+    if (state.lru_prev) {
+        state.lru_prev->lru_next = state.lru_next;
+    } else {
+        lru_head_ = state.lru_next;
+    }
+    if (state.lru_next) {
+        state.lru_next->lru_prev = state.lru_prev;
+    } else {
+        lru_tail_ = state.lru_prev;
+    }
+    state.lru_prev = nullptr;
+    state.lru_next = nullptr;
+}
+
+void MarketDataManager::lruPushFront(InstrumentState& state) {
+    state.lru_prev = nullptr;
+    state.lru_next = lru_head_;
+    if (lru_head_) {
+        lru_head_->lru_prev = &state;
+    } else {
+        lru_tail_ = &state;
+    }
+    lru_head_ = &state;
+}
+
+void MarketDataManager::updatePinned(const std::string& instrument, const PinState& pin) {
+    const bool pinned = pin.count > 0 || pin.position;
+    if (!pinned) {
+        pins_.erase(instrument);  // Invalidates pin
+    }
+
+    auto it = market_data_.find(instrument);
+    if (it == market_data_.end() || it->second.pinned == pinned) {
+        return;
+    }
+
+    auto& state = it->second;
+    state.pinned = pinned;
+    if (pinned) {
+        lruUnlink(state);
+    } else {
+        // Released instruments get a full idle period before eviction
+        state.last_update = std::chrono::steady_clock::now();
+        lruPushFront(state);
+    }
+}
+
+void MarketDataManager::evictExpired(std::chrono::steady_clock::time_point now, const InstrumentState* keep) {
+    const auto& performance = config_manager_.getPerformanceConfig();
+    const size_t max_instruments = static_cast<size_t>(performance.max_tracked_instruments);
+    const auto idle_timeout = std::chrono::milliseconds(performance.instrument_idle_timeout_ms);
+
+    std::vector<std::string> evicted;
+    while (lru_tail_ && lru_tail_ != keep) {
+        if (market_data_.size() <= max_instruments && now - lru_tail_->last_update < idle_timeout) {
+            break;
+        }
+        auto it = market_data_.find(lru_tail_->instrument);
+        lruUnlink(it->second);
+        evicted.push_back(it->first);
+        market_data_.erase(it);
+    }
+
+    if (evicted.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(top_of_book_mutex_);
+    for (const auto& instrument : evicted) {
+        top_of_book_.erase(instrument);
+    }
+    top_of_book_sequence_++;
+}
+
+namespace {
+
+void writeLevels(SnapshotWriter& writer, const std::vector<MarketDataManager::OrderBook::Level>& levels) {
+    writer.putU32(static_cast<uint32_t>(levels.size()));
+    for (const auto& level : levels) {
+        writer.putDouble(level.price);
+        writer.putDouble(level.size);
+        writer.putTime(level.timestamp);
+    }
+}
+
+std::vector<MarketDataManager::OrderBook::Level> readLevels(SnapshotReader& reader) {
+    std::vector<MarketDataManager::OrderBook::Level> levels(reader.getCount(24));
+    for (auto& level : levels) {
+        level.price = reader.getDouble();
+        level.size = reader.getDouble();
+        level.timestamp = reader.getTime();
+    }
+    return levels;
+}
+
+} // namespace
+
+void MarketDataManager::saveSnapshot(SnapshotWriter& writer) const {
+    // Copy under the locks, encode after releasing them
+    std::vector<MarketData> data;
+    std::vector<TopOfBook> tops;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        data.reserve(market_data_.size());
+        for (const auto& [_, state] : market_data_) {
+            data.push_back(state.data);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(top_of_book_mutex_);
+        tops.reserve(top_of_book_.size());
+        for (const auto& [_, top] : top_of_book_) {
+            tops.push_back(top);
+        }
+    }
+
+    writer.putU32(static_cast<uint32_t>(data.size()));
+    for (const auto& entry : data) {
+        writer.noteDataTime(entry.timestamp);
+        writer.noteDataTime(entry.orderbook.timestamp);
+        writer.putString(entry.orderbook.instrument);
+        writer.putTime(entry.orderbook.timestamp);
+        writeLevels(writer, entry.orderbook.bids);
+        writeLevels(writer, entry.orderbook.asks);
+
+        writer.putU32(static_cast<uint32_t>(entry.trades.size()));
+        for (const auto& trade : entry.trades) {
+            writer.noteDataTime(trade.timestamp);
+            writer.putDouble(trade.price);
+            writer.putDouble(trade.size);
+            writer.putString(trade.side);
+            writer.putTime(trade.timestamp);
+        }
+
+        writer.putDouble(entry.last_price);
+        writer.putDouble(entry.volume_24h);
+        writer.putDouble(entry.high_24h);
+        writer.putDouble(entry.low_24h);
+        writer.putTime(entry.timestamp);
+    }
+
+    writer.putU32(static_cast<uint32_t>(tops.size()));
+    for (const auto& top : tops) {
+        writer.noteDataTime(top.timestamp);
+        writer.putString(top.instrument);
+        writer.putDouble(top.best_bid);
+        writer.putDouble(top.best_bid_size);
+        writer.putDouble(top.best_ask);
+        writer.putDouble(top.best_ask_size);
+        writer.putDouble(top.last_price);
+        writer.putDouble(top.mark_price);
+        writer.putDouble(top.index_price);
+        writer.putDouble(top.funding_rate);
+        writer.putDouble(top.funding_8h);
+        writer.putDouble(top.open_interest);
+        writer.putBool(top.has_ticker);
+        writer.putTime(top.timestamp);
+    }
+}
+
+void MarketDataManager::restoreSnapshot(SnapshotReader& reader) {
+    // Decode everything first so a corrupt section changes nothing
+    std::vector<MarketData> data(reader.getCount(4));
+    for (auto& entry : data) {
+        entry.orderbook.instrument = reader.getString();
+        entry.orderbook.timestamp = reader.getTime();
+        entry.orderbook.bids = readLevels(reader);
+        entry.orderbook.asks = readLevels(reader);
+
+        entry.trades.resize(reader.getCount(28));
+        for (auto& trade : entry.trades) {
+            trade.price = reader.getDouble();
+            trade.size = reader.getDouble();
+            trade.side = reader.getString();
+            trade.timestamp = reader.getTime();
+            trade.instrument = entry.orderbook.instrument;
+        }
+
+        entry.last_price = reader.getDouble();
+        entry.volume_24h = reader.getDouble();
+        entry.high_24h = reader.getDouble();
+        entry.low_24h = reader.getDouble();
+        entry.timestamp = reader.getTime();
+    }
+
+    std::vector<TopOfBook> tops(reader.getCount(4));
+    for (auto& top : tops) {
+        top.instrument = reader.getString();
+        top.best_bid = reader.getDouble();
+        top.best_bid_size = reader.getDouble();
+        top.best_ask = reader.getDouble();
+        top.best_ask_size = reader.getDouble();
+        top.last_price = reader.getDouble();
+        top.mark_price = reader.getDouble();
+        top.index_price = reader.getDouble();
+        top.funding_rate = reader.getDouble();
+        top.funding_8h = reader.getDouble();
+        top.open_interest = reader.getDouble();
+        top.has_ticker = reader.getBool();
+        top.timestamp = reader.getTime();
+    }
+
     std::lock_guard<std::mutex> lock(data_mutex_);
-    for (auto it = market_data_.begin(); it != market_data_.end();) {
-        if (now - it->second.timestamp > max_age) {
-            it = market_data_.erase(it);
-        } else {
-            ++it;
+    for (auto& entry : data) {
+        if (entry.orderbook.instrument.empty()) {
+            continue;
+        }
+        auto it = market_data_.find(entry.orderbook.instrument);
+        if (it != market_data_.end() && it->second.data.timestamp >= entry.timestamp) {
+            continue;  // The feed got there first
+        }
+        touch(entry.orderbook.instrument).data = std::move(entry);
+    }
+    // Ticker-only instruments need tracking too, or the LRU never drops them
+    for (const auto& top : tops) {
+        if (!top.instrument.empty() && !market_data_.count(top.instrument)) {
+            touch(top.instrument);
         }
     }
-} 
\ No newline at end of file
+
+    std::lock_guard<std::mutex> top_lock(top_of_book_mutex_);
+    for (auto& top : tops) {
+        // Skips anything the restore itself pushed out
+        if (!top.instrument.empty() && market_data_.count(top.instrument)) {
+            top_of_book_.emplace(top.instrument, std::move(top));
+        }
+    }
+    top_of_book_sequence_++;
+}
@@ -4,13 +4,20 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <mutex>
 #include <queue>
+#include <condition_variable>
 #include <memory>
 #include <functional>
 #include <chrono>
 #include <atomic>
+#include <thread>
 #include "config_manager.h"
+#include "inplace_function.h"
+
+class SnapshotWriter;
+class SnapshotReader;
 
 class MarketDataManager {
 public:
@@ -35,6 +42,23 @@ public:
         std::chrono::system_clock::time_point timestamp;
     };
 
+    // Latest ticker notification merged with the best levels from book updates
+    struct TopOfBook {
+        std::string instrument;
+        double best_bid{0.0};
+        double best_bid_size{0.0};
+        double best_ask{0.0};
+        double best_ask_size{0.0};
+        double last_price{0.0};
+        double mark_price{0.0};
+        double index_price{0.0};
+        double funding_rate{0.0};     // Current funding, perpetuals only
+        double funding_8h{0.0};
+        double open_interest{0.0};
+        bool has_ticker{false};       // Mark/index/funding fields are populated
+        std::chrono::system_clock::time_point timestamp;
+    };
+
     struct MarketData {
         OrderBook orderbook;
         std::vector<Trade> trades;
@@ -53,23 +77,69 @@ public:
     void initialize();
     void shutdown();
 
+    // Timestamps are exchange time; they drive bar closing
     void updateOrderBook(const OrderBook& orderbook);
     void addTrade(const Trade& trade);
     void updateMarketData(const MarketData& data);
+    void updateTicker(const TopOfBook& ticker);
 
     const MarketData& getMarketData(const std::string& instrument) const;
     const OrderBook& getOrderBook(const std::string& instrument) const;
-    const std::vector<Trade>& getRecentTrades(const std::string& instrument, size_t count = 10) const;
+    std::vector<Trade> getRecentTrades(const std::string& instrument, size_t count = 10) const;
 
-    void subscribeToMarketData(const std::string& instrument,
-                             std::function<void(const MarketData&)> callback);
+    // Subscribers are stored inline; captures beyond the delegate capacity
+    // fail to compile instead of allocating
+    using Subscriber = InplaceFunction<void(const MarketData&)>;
+    void subscribeToMarketData(const std::string& instrument, Subscriber callback);
     void unsubscribeFromMarketData(const std::string& instrument);
 
+    // For a feed pipeline that runs feature and strategy updates as its own
+    // stages. While enabled, book and trade updates are not queued for the
+    // processing thread and are not forwarded to BarAggregator; the stages
+    // do both, calling dispatch() for the subscribers.
+    void setPipelineDispatch(bool enabled);
+    // Notifies the instrument's subscribers with its latest state, on the
+    // calling thread and outside the data lock
+    void dispatch(const std::string& instrument);
+
     double getBestBid(const std::string& instrument) const;
     double getBestAsk(const std::string& instrument) const;
     double getMidPrice(const std::string& instrument) const;
     double getSpread(const std::string& instrument) const;
 
+    // Copies the cached snapshot; returns false if nothing has been received
+    bool getTopOfBook(const std::string& instrument, TopOfBook& top) const;
+    std::vector<TopOfBook> getAllTopOfBook() const;
+
+    // Copies at most depth levels per side; returns false for unknown instruments
+    bool copyOrderBook(const std::string& instrument, size_t depth, OrderBook& book) const;
+
+    // Change counters for caching readers. An instrument's sequence moves on
+    // every update to its book, trades, stats or ticker and is 0 when
+    // untracked; the top-of-book sequence moves on any change to the
+    // top-of-book cache.
+    uint64_t getUpdateSequence(const std::string& instrument) const;
+    uint64_t getTopOfBookSequence() const;
+
+    // Instrument state, including the top-of-book cache, is bounded by the
+    // performance config: unpinned instruments are evicted least-recently-
+    // updated first once the count or idle limit is exceeded. Pinned
+    // instruments are never evicted, so the references returned by
+    // getMarketData/getOrderBook stay valid for them.
+    // Pins are counted and may be taken before any data arrives.
+    void pinInstrument(const std::string& instrument);
+    void unpinInstrument(const std::string& instrument);
+    // Open positions pin their instrument until the position is flat
+    void setPositionOpen(const std::string& instrument, bool open);
+    size_t getTrackedInstrumentCount() const;
+
+    // Warm-restart state: books, trade tapes and cached tickers. Restoring
+    // never overwrites an instrument the feed has already updated and does
+    // not notify subscribers.
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+    void saveSnapshot(SnapshotWriter& writer) const;
+    void restoreSnapshot(SnapshotReader& reader);
+
 private:
     MarketDataManager();
     ~MarketDataManager();
@@ -78,15 +148,50 @@ private:
 
     void processMarketData();
     void notifySubscribers(const std::string& instrument, const MarketData& data);
-    void cleanupOldData();
+
+    // Intrusive LRU entry; map nodes never move, so the links stay valid
+    struct InstrumentState {
+        MarketData data;
+        std::string instrument;
+        std::chrono::steady_clock::time_point last_update;
+        InstrumentState* lru_prev{nullptr};
+        InstrumentState* lru_next{nullptr};
+        uint64_t sequence{0};
+        bool pinned{false};
+    };
+
+    struct PinState {
+        int count{0};
+        bool position{false};
+    };
+
+    // All require data_mutex_
+    InstrumentState& touch(const std::string& instrument);
+    void lruUnlink(InstrumentState& state);
+    void lruPushFront(InstrumentState& state);
+    void updatePinned(const std::string& instrument, const PinState& pin);
+    void evictExpired(std::chrono::steady_clock::time_point now, const InstrumentState* keep);
 
     mutable std::mutex data_mutex_;
-    std::map<std::string, MarketData> market_data_;
-    std::map<std::string, std::vector<std::function<void(const MarketData&)>>> subscribers_;
+    std::map<std::string, InstrumentState> market_data_;
+    std::unordered_map<std::string, PinState> pins_;
+    InstrumentState* lru_head_{nullptr};  // Most recently updated
+    InstrumentState* lru_tail_{nullptr};  // Next eviction candidate
+    std::chrono::steady_clock::time_point next_idle_check_;
+    uint64_t update_sequence_{0};
+    std::map<std::string, std::vector<Subscriber>> subscribers_;
     std::queue<MarketData> data_queue_;
+    std::condition_variable data_cv_;
+    std::atomic<bool> pipeline_dispatch_{false};
     std::atomic<bool> running_;
     std::thread processing_thread_;
     const ConfigManager& config_manager_;
+
+    // Separate lock so valuation reads never wait on book copies; writers
+    // take it inside data_mutex_
+    mutable std::mutex top_of_book_mutex_;
+    std::unordered_map<std::string, TopOfBook> top_of_book_;
+    uint64_t top_of_book_sequence_{0};
 };
 
 #endif // MARKET_DATA_MANAGER_H 
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "market_data_manager.h"
+#include "bar_aggregator.h"
+#include "config_manager.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+class MarketDataManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        performance_ = ConfigManager::getInstance().getPerformanceConfig();
+    }
+
+    void TearDown() override {
+        ConfigManager::getInstance().setPerformanceConfig(performance_);
+    }
+
+    void limitTracking(int max_instruments, int idle_timeout_ms) {
+        auto performance = performance_;
+        performance.max_tracked_instruments = max_instruments;
+        performance.instrument_idle_timeout_ms = idle_timeout_ms;
+        ConfigManager::getInstance().setPerformanceConfig(performance);
+    }
+
+    static void ticker(const std::string& instrument) {
+        MarketDataManager::TopOfBook top;
+        top.instrument = instrument;
+        top.mark_price = 100.0;
+        MarketDataManager::getInstance().updateTicker(top);
+    }
+
+    static bool cached(const std::string& instrument) {
+        MarketDataManager::TopOfBook top;
+        return MarketDataManager::getInstance().getTopOfBook(instrument, top);
+    }
+
+    static MarketDataManager::OrderBook book(const std::string& instrument, double bid, double ask) {
+        MarketDataManager::OrderBook orderbook;
+        orderbook.instrument = instrument;
+        if (bid > 0.0) orderbook.bids.push_back({bid, 2.0, {}});
+        if (ask > 0.0) orderbook.asks.push_back({ask, 3.0, {}});
+        return orderbook;
+    }
+
+    ConfigManager::PerformanceConfig performance_{};
+};
+
+TEST_F(MarketDataManagerTest, EmptiedBookSideClearsBestLevel) {
+    auto& manager = MarketDataManager::getInstance();
+    MarketDataManager::TopOfBook top;
+
+    manager.updateOrderBook(book("MDM-EMPTY-SIDE", 99.0, 101.0));
+    ASSERT_TRUE(manager.getTopOfBook("MDM-EMPTY-SIDE", top));
+    EXPECT_DOUBLE_EQ(top.best_bid, 99.0);
+    EXPECT_DOUBLE_EQ(top.best_ask, 101.0);
+
+    // Asks swept: the old ask must not linger as the best offer
+    manager.updateOrderBook(book("MDM-EMPTY-SIDE", 99.5, 0.0));
+    ASSERT_TRUE(manager.getTopOfBook("MDM-EMPTY-SIDE", top));
+    EXPECT_DOUBLE_EQ(top.best_bid, 99.5);
+    EXPECT_DOUBLE_EQ(top.best_bid_size, 2.0);
+    EXPECT_DOUBLE_EQ(top.best_ask, 0.0);
+    EXPECT_DOUBLE_EQ(top.best_ask_size, 0.0);
+
+    manager.updateOrderBook(book("MDM-EMPTY-SIDE", 0.0, 0.0));
+    ASSERT_TRUE(manager.getTopOfBook("MDM-EMPTY-SIDE", top));
+    EXPECT_DOUBLE_EQ(top.best_bid, 0.0);
+    EXPECT_DOUBLE_EQ(top.best_ask, 0.0);
+}
+
+TEST_F(MarketDataManagerTest, PipelineDispatchCallsSubscribersOutsideTheLock) {
+    auto& manager = MarketDataManager::getInstance();
+    manager.initialize();
+    manager.setPipelineDispatch(true);
+
+    // A subscriber reading the book back would deadlock if it ran under the
+    // data lock
+    std::atomic<int> calls{0};
+    std::atomic<double> mid{0.0};
+    manager.subscribeToMarketData("MDM-DISPATCH", [&manager, &calls, &mid](const MarketDataManager::MarketData&) {
+        mid = manager.getMidPrice("MDM-DISPATCH");
+        calls++;
+    });
+
+    // Nothing is queued for the processing thread in pipeline mode
+    manager.updateOrderBook(book("MDM-DISPATCH", 99.0, 101.0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(calls.load(), 0);
+
+    manager.dispatch("MDM-DISPATCH");
+    EXPECT_EQ(calls.load(), 1);
+    EXPECT_DOUBLE_EQ(mid.load(), 100.0);
+
+    // The processing thread path reads the book back the same way
+    manager.setPipelineDispatch(false);
+    manager.updateOrderBook(book("MDM-DISPATCH", 100.0, 102.0));
+    for (int i = 0; i < 100 && calls.load() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(calls.load(), 2);
+    EXPECT_DOUBLE_EQ(mid.load(), 101.0);
+
+    manager.unsubscribeFromMarketData("MDM-DISPATCH");
+    manager.shutdown();
+}
+
+TEST_F(MarketDataManagerTest, BookTimestampsCloseBars) {
+    auto& manager = MarketDataManager::getInstance();
+    auto& bars = BarAggregator::getInstance();
+    const auto start = std::chrono::system_clock::time_point(std::chrono::hours(460000));
+
+    bars.onTrade("MDM-BARS", 100.0, 1.0, start + std::chrono::milliseconds(10));
+    EXPECT_TRUE(bars.getHistory("MDM-BARS", BarAggregator::Timeframe::SECOND_1).empty());
+
+    // No trade, just a book stamped in the next second
+    auto update = book("MDM-BARS", 99.0, 101.0);
+    update.timestamp = start + std::chrono::milliseconds(1200);
+    manager.updateOrderBook(update);
+    EXPECT_EQ(bars.getHistory("MDM-BARS", BarAggregator::Timeframe::SECOND_1).size(), 1u);
+}
+
+TEST_F(MarketDataManagerTest, TickerOnlyInstrumentsAreEvictedLeastRecentFirst) {
+    auto& manager = MarketDataManager::getInstance();
+    limitTracking(2, 600000);
+
+    ticker("MDM-TICKER-A");
+    ticker("MDM-TICKER-B");
+    ticker("MDM-TICKER-A");  // B is now the oldest
+    ticker("MDM-TICKER-C");
+
+    EXPECT_TRUE(cached("MDM-TICKER-A"));
+    EXPECT_FALSE(cached("MDM-TICKER-B"));
+    EXPECT_TRUE(cached("MDM-TICKER-C"));
+    EXPECT_EQ(manager.getUpdateSequence("MDM-TICKER-B"), 0u);
+    EXPECT_NE(manager.getUpdateSequence("MDM-TICKER-C"), 0u);
+}
+
+TEST_F(MarketDataManagerTest, PinnedTickerOnlyInstrumentsAreKept) {
+    auto& manager = MarketDataManager::getInstance();
+    limitTracking(1, 600000);
+
+    manager.pinInstrument("MDM-PINNED");
+    ticker("MDM-PINNED");
+    ticker("MDM-UNPINNED-A");
+    ticker("MDM-UNPINNED-B");
+
+    EXPECT_TRUE(cached("MDM-PINNED"));
+    EXPECT_FALSE(cached("MDM-UNPINNED-A"));
+    EXPECT_TRUE(cached("MDM-UNPINNED-B"));
+
+    // Unpinned, it competes for the single slot again
+    manager.unpinInstrument("MDM-PINNED");
+    ticker("MDM-UNPINNED-C");
+    EXPECT_FALSE(cached("MDM-UNPINNED-B"));
+    EXPECT_FALSE(cached("MDM-PINNED"));
+    EXPECT_TRUE(cached("MDM-UNPINNED-C"));
+}
+
+TEST_F(MarketDataManagerTest, IdleTickerOnlyInstrumentsAreEvicted) {
+    limitTracking(10000, 50);
+
+    ticker("MDM-IDLE");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ticker("MDM-FRESH");  // New instruments trigger an eviction pass
+
+    EXPECT_FALSE(cached("MDM-IDLE"));
+    EXPECT_TRUE(cached("MDM-FRESH"));
+}
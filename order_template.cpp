@@ -0,0 +1,191 @@
+#include "order_template.h"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr int64_t POW10[] = {
+    1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL
+};
+constexpr int MAX_DECIMALS = 8;
+
+// Formats value with a fixed number of decimals into buf (right to left) and
+// returns the number of characters written, or 0 if it does not fit.
+size_t formatFixed(char* buf, size_t width, double value, int decimals) {
+    if (!std::isfinite(value)) return 0;
+    double scaled_value = value * static_cast<double>(POW10[decimals]);
+    if (std::fabs(scaled_value) >= 9.0e18) return 0;
+
+    int64_t scaled = std::llround(scaled_value);
+    bool negative = scaled < 0;
+    uint64_t magnitude = negative ? static_cast<uint64_t>(-scaled) : static_cast<uint64_t>(scaled);
+
+    char tmp[32];
+    size_t pos = sizeof(tmp);
+    for (int i = 0; i < decimals; ++i) {
+        tmp[--pos] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    if (decimals > 0) {
+        tmp[--pos] = '.';
+    }
+    do {
+        tmp[--pos] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative) {
+        tmp[--pos] = '-';
+    }
+
+    size_t length = sizeof(tmp) - pos;
+    if (length > width) return 0;
+    std::memcpy(buf, tmp + pos, length);
+    return length;
+}
+
+size_t formatUnsigned(char* buf, size_t width, uint64_t value) {
+    char tmp[24];
+    size_t pos = sizeof(tmp);
+    do {
+        tmp[--pos] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    size_t length = sizeof(tmp) - pos;
+    if (length > width) return 0;
+    std::memcpy(buf, tmp + pos, length);
+    return length;
+}
+
+void writeSlot(char* slot, size_t width, const char* value, size_t length) {
+    std::memcpy(slot, value, length);
+    std::memset(slot + length, ' ', width - length);
+}
+
+} // namespace
+
+OrderTemplate::OrderTemplate(Kind kind, const Config& config)
+    : kind_(kind),
+      price_decimals_(config.price_decimals),
+      amount_decimals_(config.amount_decimals) {
+    if (price_decimals_ < 0 || price_decimals_ > MAX_DECIMALS ||
+        amount_decimals_ < 0 || amount_decimals_ > MAX_DECIMALS) {
+        throw std::invalid_argument("Unsupported decimal precision for order template: " + config.instrument);
+    }
+
+    frame_.reserve(512);
+    frame_ += "{\"jsonrpc\":\"2.0\",\"id\":";
+    id_offset_ = appendSlot(ID_WIDTH);
+
+    if (kind_ == Kind::EDIT) {
+        frame_ += ",\"method\":\"private/edit\",\"params\":{\"order_id\":";
+        order_id_offset_ = appendSlot(ORDER_ID_WIDTH + 2);
+        frame_.replace(order_id_offset_, 2, "\"\"");
+    } else {
+        frame_ += kind_ == Kind::BUY ? ",\"method\":\"private/buy\"" : ",\"method\":\"private/sell\"";
+        frame_ += ",\"params\":{\"instrument_name\":\"" + config.instrument + "\"";
+        frame_ += ",\"type\":\"" + config.type + "\"";
+        frame_ += std::string(",\"post_only\":") + (config.post_only ? "true" : "false");
+        frame_ += std::string(",\"reduce_only\":") + (config.reduce_only ? "true" : "false");
+        frame_ += ",\"time_in_force\":\"" + config.time_in_force + "\"";
+    }
+
+    frame_ += ",\"price\":";
+    price_offset_ = appendSlot(NUMBER_WIDTH);
+    frame_ += ",\"amount\":";
+    amount_offset_ = appendSlot(NUMBER_WIDTH);
+    frame_ += "}}";
+}
+
+size_t OrderTemplate::appendSlot(size_t width) {
+    size_t offset = frame_.size();
+    frame_.append(width, ' ');
+    frame_[offset] = '0';
+    return offset;
+}
+
+bool OrderTemplate::patch(uint64_t request_id, double price, double amount) {
+    char id_buf[ID_WIDTH];
+    char price_buf[NUMBER_WIDTH];
+    char amount_buf[NUMBER_WIDTH];
+
+    size_t id_len = formatUnsigned(id_buf, ID_WIDTH, request_id);
+    size_t price_len = formatFixed(price_buf, NUMBER_WIDTH, price, price_decimals_);
+    size_t amount_len = formatFixed(amount_buf, NUMBER_WIDTH, amount, amount_decimals_);
+    if (id_len == 0 || price_len == 0 || amount_len == 0) {
+        return false;
+    }
+
+    char* frame = frame_.data();
+    writeSlot(frame + id_offset_, ID_WIDTH, id_buf, id_len);
+    writeSlot(frame + price_offset_, NUMBER_WIDTH, price_buf, price_len);
+    writeSlot(frame + amount_offset_, NUMBER_WIDTH, amount_buf, amount_len);
+    return true;
+}
+
+bool OrderTemplate::patchOrderId(std::string_view order_id) {
+    if (!fitsOrderId(order_id)) {
+        return false;
+    }
+
+    char* slot = frame_.data() + order_id_offset_;
+    slot[0] = '"';
+    std::memcpy(slot + 1, order_id.data(), order_id.size());
+    slot[order_id.size() + 1] = '"';
+    std::memset(slot + order_id.size() + 2, ' ', ORDER_ID_WIDTH - order_id.size());
+    return true;
+}
+
+bool OrderTemplate::patchEdit(std::string_view order_id, uint64_t request_id, double price, double amount) {
+    // patch() writes nothing when it fails, so checking the id first means
+    // a rejected edit never leaves a new order id next to stale values
+    if (!fitsOrderId(order_id) || !patch(request_id, price, amount)) {
+        return false;
+    }
+    return patchOrderId(order_id);
+}
+
+bool OrderTemplate::fitsOrderId(std::string_view order_id) const {
+    if (kind_ != Kind::EDIT || order_id.size() > ORDER_ID_WIDTH) {
+        return false;
+    }
+    // Order ids are plain alphanumerics on Deribit; refuse anything that would
+    // need escaping rather than emitting invalid JSON.
+    for (char c : order_id) {
+        if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+            return false;
+        }
+    }
+    return true;
+}
+
+OrderTemplateManager::OrderSlot::OrderSlot(const std::string& strategy_name, const OrderTemplate::Config& config)
+    : strategy(strategy_name),
+      instrument(config.instrument),
+      buy(OrderTemplate::Kind::BUY, config),
+      sell(OrderTemplate::Kind::SELL, config),
+      edit(OrderTemplate::Kind::EDIT, config) {
+}
+
+OrderTemplateManager::OrderSlot& OrderTemplateManager::stageSlot(const std::string& strategy,
+                                                                 const OrderTemplate::Config& config) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    auto& slot = slots_[{strategy, config.instrument}];
+    if (!slot) {
+        slot = std::make_unique<OrderSlot>(strategy, config);
+    }
+    return *slot;
+}
+
+OrderTemplateManager::OrderSlot* OrderTemplateManager::getSlot(const std::string& strategy,
+                                                               const std::string& instrument) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    auto it = slots_.find({strategy, instrument});
+    return it == slots_.end() ? nullptr : it->second.get();
+}
+
+void OrderTemplateManager::removeSlot(const std::string& strategy, const std::string& instrument) {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    slots_.erase({strategy, instrument});
+}
@@ -0,0 +1,98 @@
+#ifndef ORDER_TEMPLATE_H
+#define ORDER_TEMPLATE_H
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <utility>
+
+// Pre-encoded JSON-RPC order frame. All variable fields are fixed-width slots
+// padded with trailing whitespace, so patching never moves any other byte.
+class OrderTemplate {
+public:
+    enum class Kind {
+        BUY,
+        SELL,
+        EDIT
+    };
+
+    struct Config {
+        std::string instrument;
+        int price_decimals{1};
+        int amount_decimals{0};
+        std::string type{"limit"};
+        bool post_only{false};
+        bool reduce_only{false};
+        std::string time_in_force{"good_til_cancelled"};
+    };
+
+    static constexpr size_t ID_WIDTH = 20;
+    static constexpr size_t NUMBER_WIDTH = 24;
+    static constexpr size_t ORDER_ID_WIDTH = 48;
+
+    OrderTemplate(Kind kind, const Config& config);
+
+    // Patch request id, price and amount in place. Returns false if a value
+    // does not fit its slot; the frame is left unchanged in that case.
+    bool patch(uint64_t request_id, double price, double amount);
+    bool patchOrderId(std::string_view order_id);
+    // Edit frames: order id and values together, all or nothing
+    bool patchEdit(std::string_view order_id, uint64_t request_id, double price, double amount);
+
+    Kind kind() const { return kind_; }
+    const char* data() const { return frame_.data(); }
+    size_t size() const { return frame_.size(); }
+    std::string_view view() const { return std::string_view(frame_.data(), frame_.size()); }
+
+private:
+    size_t appendSlot(size_t width);
+    bool fitsOrderId(std::string_view order_id) const;
+
+    Kind kind_;
+    int price_decimals_;
+    int amount_decimals_;
+    std::string frame_;
+    size_t id_offset_{0};
+    size_t price_offset_{0};
+    size_t amount_offset_{0};
+    size_t order_id_offset_{0};
+};
+
+class OrderTemplateManager {
+public:
+    struct OrderSlot {
+        std::string strategy;
+        std::string instrument;
+        OrderTemplate buy;
+        OrderTemplate sell;
+        OrderTemplate edit;
+
+        OrderSlot(const std::string& strategy_name, const OrderTemplate::Config& config);
+        OrderTemplate& forSide(const std::string& side) { return side == "sell" ? sell : buy; }
+    };
+
+    static OrderTemplateManager& getInstance() {
+        static OrderTemplateManager instance;
+        return instance;
+    }
+
+    // Slots are created off the hot path; the returned reference stays valid
+    // until removeSlot is called for the same strategy and instrument.
+    OrderSlot& stageSlot(const std::string& strategy, const OrderTemplate::Config& config);
+    OrderSlot* getSlot(const std::string& strategy, const std::string& instrument);
+    void removeSlot(const std::string& strategy, const std::string& instrument);
+
+private:
+    OrderTemplateManager() = default;
+    ~OrderTemplateManager() = default;
+    OrderTemplateManager(const OrderTemplateManager&) = delete;
+    OrderTemplateManager& operator=(const OrderTemplateManager&) = delete;
+
+    std::mutex slots_mutex_;
+    std::map<std::pair<std::string, std::string>, std::unique_ptr<OrderSlot>> slots_;
+};
+
+#endif // ORDER_TEMPLATE_H
@@ -0,0 +1,133 @@
+#include "order_template.h"
+#include "trade_execution.h"
+#include "websocket_handler.h"
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <limits>
+
+class OrderTemplateTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config_.instrument = "BTC-PERPETUAL";
+        config_.price_decimals = 1;
+        config_.amount_decimals = 0;
+        config_.post_only = true;
+    }
+
+    OrderTemplate::Config config_;
+};
+
+TEST_F(OrderTemplateTest, BuyFrameIsValidJson) {
+    OrderTemplate order(OrderTemplate::Kind::BUY, config_);
+    ASSERT_TRUE(order.patch(42, 50000.5, 100.0));
+
+    auto json = nlohmann::json::parse(order.view());
+    EXPECT_EQ(json["id"], 42);
+    EXPECT_EQ(json["method"], "private/buy");
+    EXPECT_EQ(json["params"]["instrument_name"], "BTC-PERPETUAL");
+    EXPECT_DOUBLE_EQ(json["params"]["price"].get<double>(), 50000.5);
+    EXPECT_DOUBLE_EQ(json["params"]["amount"].get<double>(), 100.0);
+    EXPECT_EQ(json["params"]["post_only"], true);
+}
+
+TEST_F(OrderTemplateTest, PatchKeepsFrameSize) {
+    OrderTemplate order(OrderTemplate::Kind::SELL, config_);
+    size_t size = order.size();
+
+    ASSERT_TRUE(order.patch(1, 1.0, 1.0));
+    EXPECT_EQ(order.size(), size);
+    ASSERT_TRUE(order.patch(18446744073709551615ULL, 123456789.9, 99999999.0));
+    EXPECT_EQ(order.size(), size);
+
+    auto json = nlohmann::json::parse(order.view());
+    EXPECT_EQ(json["method"], "private/sell");
+    EXPECT_EQ(json["id"].get<uint64_t>(), 18446744073709551615ULL);
+    EXPECT_DOUBLE_EQ(json["params"]["price"].get<double>(), 123456789.9);
+}
+
+TEST_F(OrderTemplateTest, RepatchOverwritesPreviousValues) {
+    OrderTemplate order(OrderTemplate::Kind::BUY, config_);
+    ASSERT_TRUE(order.patch(123456789, 65432.1, 5000.0));
+    ASSERT_TRUE(order.patch(7, 1.5, 10.0));
+
+    auto json = nlohmann::json::parse(order.view());
+    EXPECT_EQ(json["id"], 7);
+    EXPECT_DOUBLE_EQ(json["params"]["price"].get<double>(), 1.5);
+    EXPECT_DOUBLE_EQ(json["params"]["amount"].get<double>(), 10.0);
+}
+
+TEST_F(OrderTemplateTest, RejectsValuesThatDoNotFit) {
+    OrderTemplate order(OrderTemplate::Kind::BUY, config_);
+    ASSERT_TRUE(order.patch(1, 100.0, 1.0));
+    std::string before(order.view());
+
+    EXPECT_FALSE(order.patch(2, 1e30, 1.0));
+    EXPECT_FALSE(order.patch(2, std::numeric_limits<double>::quiet_NaN(), 1.0));
+    EXPECT_EQ(std::string(order.view()), before);
+}
+
+TEST_F(OrderTemplateTest, EditFrameCarriesOrderId) {
+    config_.price_decimals = 4;
+    config_.amount_decimals = 1;
+    OrderTemplate edit(OrderTemplate::Kind::EDIT, config_);
+    ASSERT_TRUE(edit.patchOrderId("ETH-584830574"));
+    ASSERT_TRUE(edit.patch(9, 0.0125, 2.5));
+
+    auto json = nlohmann::json::parse(edit.view());
+    EXPECT_EQ(json["method"], "private/edit");
+    EXPECT_EQ(json["params"]["order_id"], "ETH-584830574");
+    EXPECT_DOUBLE_EQ(json["params"]["price"].get<double>(), 0.0125);
+    EXPECT_DOUBLE_EQ(json["params"]["amount"].get<double>(), 2.5);
+
+    ASSERT_TRUE(edit.patchOrderId("1"));
+    json = nlohmann::json::parse(edit.view());
+    EXPECT_EQ(json["params"]["order_id"], "1");
+    EXPECT_FALSE(edit.patchOrderId("bad\"id"));
+}
+
+TEST_F(OrderTemplateTest, RejectedEditLeavesFrameUnchanged) {
+    OrderTemplate edit(OrderTemplate::Kind::EDIT, config_);
+    ASSERT_TRUE(edit.patchEdit("BTC-1", 1, 100.0, 1.0));
+    std::string before(edit.view());
+
+    // A valid id with a value that does not fit must not swap the id in
+    EXPECT_FALSE(edit.patchEdit("BTC-2", 2, 1e30, 1.0));
+    EXPECT_EQ(std::string(edit.view()), before);
+    EXPECT_FALSE(edit.patchEdit("bad\"id", 2, 101.0, 1.0));
+    EXPECT_EQ(std::string(edit.view()), before);
+
+    ASSERT_TRUE(edit.patchEdit("BTC-2", 2, 101.0, 3.0));
+    auto json = nlohmann::json::parse(edit.view());
+    EXPECT_EQ(json["id"], 2);
+    EXPECT_EQ(json["params"]["order_id"], "BTC-2");
+    EXPECT_DOUBLE_EQ(json["params"]["price"].get<double>(), 101.0);
+
+    OrderTemplate buy(OrderTemplate::Kind::BUY, config_);
+    EXPECT_FALSE(buy.patchEdit("BTC-3", 3, 100.0, 1.0));
+}
+
+TEST_F(OrderTemplateTest, ManagerStagesSlotsPerStrategyAndInstrument) {
+    auto& manager = OrderTemplateManager::getInstance();
+    auto& slot = manager.stageSlot("mean_reversion", config_);
+    EXPECT_EQ(&slot, manager.getSlot("mean_reversion", "BTC-PERPETUAL"));
+    EXPECT_EQ(&slot, &manager.stageSlot("mean_reversion", config_));
+    EXPECT_EQ(manager.getSlot("other", "BTC-PERPETUAL"), nullptr);
+    EXPECT_EQ(&slot.forSide("sell"), &slot.sell);
+
+    manager.removeSlot("mean_reversion", "BTC-PERPETUAL");
+    EXPECT_EQ(manager.getSlot("mean_reversion", "BTC-PERPETUAL"), nullptr);
+}
+
+TEST_F(OrderTemplateTest, StagedSendReportsFailedWrite) {
+    // Never connected, so every socket write fails
+    WebSocketHandler websocket("localhost", "443", "/ws/api/v2");
+    TradeExecution execution(websocket);
+    OrderTemplate order(OrderTemplate::Kind::BUY, config_);
+    OrderTemplate edit(OrderTemplate::Kind::EDIT, config_);
+    // The values fit, so a false can only come from the write
+    ASSERT_TRUE(order.patch(1, 50000.5, 100.0));
+    ASSERT_TRUE(edit.patchEdit("ETH-123456", 1, 50000.5, 100.0));
+
+    EXPECT_FALSE(execution.sendStagedOrder(order, 50000.5, 100.0));
+    EXPECT_FALSE(execution.sendStagedEdit(edit, "ETH-123456", 50000.5, 100.0));
+}
@@ -0,0 +1,70 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <algorithm>
+
+// Runs fn(task_index) for every index in [0, task_count) on up to
+// thread_count threads (0 = hardware concurrency). Tasks are handed out
+// dynamically, so uneven tasks balance across workers. The first exception
+// thrown by a task is rethrown on the calling thread after all workers join.
+template <typename Fn>
+void parallelFor(size_t task_count, size_t thread_count, Fn&& fn) {
+    if (task_count == 0) {
+        return;
+    }
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = std::min(thread_count, task_count);
+
+    if (thread_count == 1) {
+        for (size_t i = 0; i < task_count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next_task{0};
+    std::exception_ptr first_error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        for (;;) {
+            size_t task = next_task.fetch_add(1, std::memory_order_relaxed);
+            if (task >= task_count) {
+                return;
+            }
+            try {
+                fn(task);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!first_error) {
+                    first_error = std::current_exception();
+                }
+                next_task.store(task_count, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (first_error) {
+        std::rethrow_exception(first_error);
+    }
+}
+
+#endif // PARALLEL_FOR_H
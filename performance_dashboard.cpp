@@ -1,4 +1,6 @@
 #include "performance_dashboard.h"
+#include "svg_plot.h"
+#include "cpu_accounting.h"
 #include <fstream>
 #include <sstream>
 #include <iomanip>
@@ -25,6 +27,7 @@ void PerformanceDashboard::start() {
     
     running_ = true;
     update_thread_ = std::thread([this]() {
+        CpuAccounting::ThreadRegistration cpu_registration("dashboard");
         while (running_) {
             update();
             std::this_thread::sleep_for(
@@ -43,32 +46,42 @@ void PerformanceDashboard::stop() {
 }
 
 void PerformanceDashboard::update() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     // Get metrics from both benchmark and latency module
     auto benchmark_metrics = benchmark_.getAllMetrics();
-    metrics_history_.insert(metrics_history_.end(), 
-                          benchmark_metrics.begin(), 
-                          benchmark_metrics.end());
-    
-    // Trim history if needed
-    if (metrics_history_.size() > static_cast<size_t>(config_.max_history_points)) {
-        metrics_history_.erase(
-            metrics_history_.begin(),
-            metrics_history_.begin() + 
-                (metrics_history_.size() - config_.max_history_points));
+    CpuAccounting::getInstance().sampleThreads();
+
+    bool render_plots = false;
+    std::function<void()> callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        metrics_history_.insert(metrics_history_.end(),
+                              benchmark_metrics.begin(),
+                              benchmark_metrics.end());
+
+        // Trim history if needed
+        if (metrics_history_.size() > static_cast<size_t>(config_.max_history_points)) {
+            metrics_history_.erase(
+                metrics_history_.begin(),
+                metrics_history_.begin() +
+                    (metrics_history_.size() - config_.max_history_points));
+        }
+
+        if (config_.enable_json_export || config_.enable_csv_export) {
+            saveMetrics();
+        }
+
+        render_plots = config_.enable_html_reports;
+        callback = update_callback_;
     }
-    
-    if (config_.enable_html_reports) {
+
+    // Plots take their own snapshot and render without the lock
+    if (render_plots) {
         generatePlots();
     }
-    
-    if (config_.enable_json_export || config_.enable_csv_export) {
-        saveMetrics();
-    }
-    
-    if (update_callback_) {
-        update_callback_();
+
+    if (callback) {
+        callback();
     }
 }
 
@@ -104,8 +117,102 @@ void PerformanceDashboard::setUpdateCallback(std::function<void()> callback) {
 }
 
 void PerformanceDashboard::generatePlots() const {
-    // Implementation using a plotting library (e.g., gnuplot or matplotlib)
-    // This is a placeholder for the actual implementation
+    std::vector<Benchmark::OperationMetrics> history;
+    std::string output_directory;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        history = metrics_history_;
+        output_directory = config_.output_directory;
+    }
+    auto samples = benchmark_.getLatencySamples();
+
+    std::map<std::string, std::vector<const Benchmark::OperationMetrics*>> by_operation;
+    for (const auto& metric : history) {
+        by_operation[metric.operation_name].push_back(&metric);
+    }
+    const auto origin = history.empty() ? std::chrono::system_clock::now() : history.front().timestamp;
+
+    std::vector<std::string> sections;
+
+    svg_plot::Chart spectrum;
+    spectrum.title = "Latency by percentile";
+    spectrum.x_label = "Percentile";
+    spectrum.y_label = "Latency (ms)";
+    spectrum.log_y = true;
+    for (auto& [name, latencies] : samples) {
+        std::sort(latencies.begin(), latencies.end());
+        spectrum.series.push_back({name, {}, latencies});
+    }
+    if (!spectrum.series.empty()) {
+        sections.push_back(svg_plot::renderPercentiles(spectrum));
+    }
+
+    for (const auto& [name, points] : by_operation) {
+        std::string section = "<h2>" + svg_plot::escape(name) + "</h2>\n";
+
+        auto sample_it = samples.find(name);
+        if (sample_it != samples.end() && !sample_it->second.empty()) {
+            svg_plot::Chart histogram;
+            histogram.title = "Latency distribution";
+            histogram.x_label = "Latency (ms, log scale)";
+            histogram.y_label = "Count";
+            section += svg_plot::renderHistogram(histogram, svg_plot::logHistogram(sample_it->second));
+        }
+
+        svg_plot::Chart over_time;
+        over_time.title = "Percentiles over time";
+        over_time.x_label = "Time since first snapshot (s)";
+        over_time.y_label = "Latency (ms)";
+        over_time.log_y = true;
+        over_time.series = {{"avg", {}, {}}, {"p95", {}, {}}, {"p99", {}, {}}};
+
+        // Throughput comes from the change in completed operations between
+        // consecutive snapshots
+        svg_plot::Chart load;
+        load.title = "Throughput vs latency (per snapshot)";
+        load.x_label = "Throughput (ops/s)";
+        load.y_label = "p99 latency (ms)";
+        load.log_y = true;
+        std::vector<std::pair<double, double>> load_points;
+
+        for (size_t i = 0; i < points.size(); ++i) {
+            const auto& metric = *points[i];
+            double t = std::chrono::duration<double>(metric.timestamp - origin).count();
+            for (auto& series : over_time.series) series.x.push_back(t);
+            over_time.series[0].y.push_back(metric.average_latency_ms);
+            over_time.series[1].y.push_back(metric.p95_latency_ms);
+            over_time.series[2].y.push_back(metric.p99_latency_ms);
+
+            if (i > 0) {
+                const auto& previous = *points[i - 1];
+                double dt = std::chrono::duration<double>(metric.timestamp - previous.timestamp).count();
+                int completed = (metric.success_count + metric.error_count) -
+                                (previous.success_count + previous.error_count);
+                if (dt > 0.0 && completed > 0) {
+                    load_points.emplace_back(completed / dt, metric.p99_latency_ms);
+                }
+            }
+        }
+        section += svg_plot::renderLines(over_time);
+
+        if (!load_points.empty()) {
+            std::sort(load_points.begin(), load_points.end());
+            load.series = {{"p99", {}, {}}};
+            for (const auto& [throughput, p99] : load_points) {
+                load.series[0].x.push_back(throughput);
+                load.series[0].y.push_back(p99);
+            }
+            section += svg_plot::renderLines(load);
+        }
+        sections.push_back(section);
+    }
+
+    const std::string filename = output_directory + "/plots.html";
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + filename);
+    }
+    file << svg_plot::page("Performance Dashboard Plots", sections);
 }
 
 void PerformanceDashboard::saveMetrics() const {
@@ -222,6 +329,11 @@ std::string PerformanceDashboard::generateHTMLBody() const {
            << generateCustomMetricsTable()
            << "</div>\n";
     }
+
+    ss << "<div class='metric-container'>\n"
+       << "<h2>CPU Accounting</h2>\n"
+       << generateCpuTable()
+       << "</div>\n";
     
     return ss.str();
 }
@@ -244,10 +356,39 @@ std::string PerformanceDashboard::generateCustomMetricsTable() const {
        << "<tr><th>Metric</th><th>Value</th></tr>\n";
     
     for (const auto& [name, value] : custom_metrics_) {
-        ss << "<tr><td>" << name << "</td><td>" 
+        ss << "<tr><td>" << svg_plot::escape(name) << "</td><td>" 
            << std::fixed << std::setprecision(2) << value << "</td></tr>\n";
     }
     
     ss << "</table>\n";
     return ss.str();
-} 
\ No newline at end of file
+} 
+
+std::string PerformanceDashboard::generateCpuTable() const {
+    auto& cpu_accounting = CpuAccounting::getInstance();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+
+    ss << "<table>\n"
+       << "<tr><th>Account</th><th>CPU (ms)</th><th>Events</th><th>CPU-&micro;s / event</th>"
+       << "<th>Budget (&micro;s)</th></tr>\n";
+    for (const auto& account : cpu_accounting.getAccountStats()) {
+        ss << "<tr" << (account.over_budget ? " style='color:#c00'" : "") << "><td>" << svg_plot::escape(account.name)
+           << "</td><td>" << account.cpu_ns / 1e6 << "</td><td>" << account.events
+           << "</td><td>" << account.cpu_us_per_event << "</td><td>";
+        if (account.budget_us_per_event > 0.0) {
+            ss << account.budget_us_per_event;
+        }
+        ss << "</td></tr>\n";
+    }
+    ss << "</table>\n";
+
+    ss << "<table>\n"
+       << "<tr><th>Thread</th><th>CPU (ms)</th><th>Utilization (%)</th></tr>\n";
+    for (const auto& thread : cpu_accounting.getThreadStats()) {
+        ss << "<tr><td>" << svg_plot::escape(thread.name) << (thread.alive ? "" : " (exited)") << "</td><td>"
+           << thread.cpu_ns / 1e6 << "</td><td>" << thread.utilization * 100.0 << "</td></tr>\n";
+    }
+    ss << "</table>\n";
+    return ss.str();
+}
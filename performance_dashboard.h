@@ -49,6 +49,7 @@ private:
     std::string generateHTMLHeader() const;
     std::string generateHTMLBody() const;
     std::string generateHTMLFooter() const;
+    std::string generateCpuTable() const;
 
     DashboardConfig config_;
     std::vector<Benchmark::OperationMetrics> metrics_history_;
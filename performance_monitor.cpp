@@ -128,9 +128,9 @@ const PerformanceMonitor::PerformanceStats& PerformanceMonitor::getStats(const s
     return operation_stats_[operation_name];
 }
 
-void PerformanceMonitor::setMetricsCallback(std::function<void(const std::string&, const OperationMetrics&)> callback) {
+void PerformanceMonitor::setMetricsCallback(MetricsCallback callback) {
     std::lock_guard<std::mutex> lock(stats_mutex_);
-    callbacks_.push_back(callback);
+    callbacks_.push_back(std::move(callback));
 }
 
 void PerformanceMonitor::enableDetailedTracking(bool enable) {
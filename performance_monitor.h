@@ -9,6 +9,7 @@
 #include <atomic>
 #include <map>
 #include <functional>
+#include "inplace_function.h"
 
 class PerformanceMonitor {
 public:
@@ -47,7 +48,8 @@ public:
     void saveStatsToFile();
     const PerformanceStats& getStats(const std::string& operation_name);
     
-    void setMetricsCallback(std::function<void(const std::string&, const OperationMetrics&)> callback);
+    using MetricsCallback = InplaceFunction<void(const std::string&, const OperationMetrics&)>;
+    void setMetricsCallback(MetricsCallback callback);
     void enableDetailedTracking(bool enable);
     void setSamplingInterval(Duration interval);
 
@@ -63,7 +65,7 @@ private:
     std::mutex stats_mutex_;
     std::map<std::string, std::vector<OperationMetrics>> operation_metrics_;
     std::map<std::string, PerformanceStats> operation_stats_;
-    std::vector<std::function<void(const std::string&, const OperationMetrics&)>> callbacks_;
+    std::vector<MetricsCallback> callbacks_;
     bool detailed_tracking_enabled_;
     Duration sampling_interval_;
     std::atomic<size_t> total_memory_usage_;
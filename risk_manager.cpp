@@ -1,11 +1,15 @@
 #include "risk_manager.h"
+#include "instrument_registry.h"
 #include <algorithm>
 #include <cmath>
 #include <stdexcept>
 
 RiskManager::RiskManager()
     : config_manager_(ConfigManager::getInstance()),
-      market_data_manager_(MarketDataManager::getInstance()) {
+      market_data_manager_(MarketDataManager::getInstance()),
+      limits_(new InstrumentLimits[MAX_BAND_INSTRUMENTS]) {
+    refreshLimits();
+
     risk_metrics_ = {
         0.0,    // total_exposure
         0.0,    // daily_pnl
@@ -34,13 +38,21 @@ void RiskManager::initialize() {
         0,      // winning_trades
         std::chrono::system_clock::now()  // timestamp
     };
+    refreshLimits();
+    scenario_engine_.start();
 }
 
 void RiskManager::shutdown() {
-    // Clean up resources if needed
+    scenario_engine_.stop();
 }
 
 bool RiskManager::checkOrderRisk(const std::string& instrument, double size, double price, const std::string& side) {
+    uint32_t instrument_id = InstrumentRegistry::getInstance().find(instrument);
+    return checkOrderRisk(instrument, size, price, side == "buy", bandPosition(instrument_id));
+}
+
+bool RiskManager::checkOrderRisk(const std::string& instrument, double size, double price, bool is_buy,
+                                 double position) {
     std::lock_guard<std::mutex> lock(risk_mutex_);
     
     // Check position limit
@@ -50,12 +62,7 @@ bool RiskManager::checkOrderRisk(const std::string& instrument, double size, dou
     }
     
     // Calculate potential loss
-    double potential_loss = 0.0;
-    if (side == "buy") {
-        potential_loss = size * price;
-    } else if (side == "sell") {
-        potential_loss = size * price;
-    }
+    double potential_loss = size * price;
     
     // Check loss limits
     if (!checkLossLimit(potential_loss)) {
@@ -75,12 +82,167 @@ bool RiskManager::checkOrderRisk(const std::string& instrument, double size, dou
         return false;
     }
     
+    uint32_t instrument_id = InstrumentRegistry::getInstance().find(instrument);
+    if (const char* violation = checkBands(instrument_id, size, price, is_buy, position)) {
+        notifyRiskViolation(instrument, violation);
+        return false;
+    }
+
+    // Orders that shrink the stress loss stay allowed, so a book already
+    // over the limit can still be hedged back under it
+    const double max_scenario_loss = max_scenario_loss_.load(std::memory_order_relaxed);
+    if (max_scenario_loss > 0.0) {
+        // Reads the grid the refresher last published; never revalues here
+        const double change = is_buy ? std::abs(size) : -std::abs(size);
+        const auto loss = scenario_engine_.worstLossWith(instrument, change);
+        if (loss.after > max_scenario_loss && loss.after > loss.before) {
+            notifyRiskViolation(instrument, "Scenario loss limit exceeded");
+            return false;
+        }
+    }
     return true;
 }
 
+bool RiskManager::checkOrderRisk(uint32_t instrument_id, double size, double price, bool is_buy) {
+    return checkOrderRisk(instrument_id, size, price, is_buy, bandPosition(instrument_id));
+}
+
+bool RiskManager::checkOrderRisk(uint32_t instrument_id, double size, double price, bool is_buy, double position) {
+    const char* violation = checkBands(instrument_id, size, price, is_buy, position);
+    if (violation == nullptr) {
+        return true;
+    }
+
+    // Slow path only: resolve the name and report under the risk lock. An
+    // id the registry never issued is still rejected, not thrown on
+    const auto& registry = InstrumentRegistry::getInstance();
+    const std::string instrument = instrument_id < registry.size()
+        ? registry.name(instrument_id) : "#" + std::to_string(instrument_id);
+    std::lock_guard<std::mutex> lock(risk_mutex_);
+    notifyRiskViolation(instrument, violation);
+    return false;
+}
+
+double RiskManager::bandPosition(uint32_t instrument_id) const {
+    return instrument_id < MAX_BAND_INSTRUMENTS
+        ? limits_[instrument_id].position_size.load(std::memory_order_relaxed) : 0.0;
+}
+
+const char* RiskManager::checkBands(uint32_t instrument_id, double size, double price, bool is_buy,
+                                    double position) const {
+    // Every comparison below is written so that a NaN fails it
+    if (!std::isfinite(size) || !std::isfinite(price)) {
+        return "Invalid order price or size";
+    }
+
+    const double notional = std::abs(size * price);
+    const double max_order_notional = max_order_notional_.load(std::memory_order_relaxed);
+    if (max_order_notional > 0.0 && !(notional <= max_order_notional)) {
+        return "Order notional limit exceeded";
+    }
+
+    // INVALID_ID is an instrument never seen on any feed or position, so it
+    // has no reference price; any other id must have its limits in the table
+    const bool band_enabled = band_pct_.load(std::memory_order_relaxed) > 0.0 ||
+                              band_ticks_.load(std::memory_order_relaxed) > 0.0;
+    if (instrument_id == InstrumentRegistry::INVALID_ID) {
+        return band_enabled ? "No reference price for band" : nullptr;
+    }
+    if (instrument_id >= MAX_BAND_INSTRUMENTS) {
+        return "Instrument outside risk limit table";
+    }
+
+    const auto& limits = limits_[instrument_id];
+    if (band_enabled && !limits.has_reference.load(std::memory_order_acquire)) {
+        return "No reference price for band";
+    }
+    if (!(price >= limits.lower_price.load(std::memory_order_relaxed) &&
+          price <= limits.upper_price.load(std::memory_order_relaxed))) {
+        return "Price outside band";
+    }
+
+    const double max_instrument_notional = max_instrument_notional_.load(std::memory_order_relaxed);
+    if (max_instrument_notional > 0.0) {
+        double after = position + (is_buy ? std::abs(size) : -std::abs(size));
+        if (!(std::abs(after) * price <= max_instrument_notional)) {
+            return "Instrument notional limit exceeded";
+        }
+    }
+
+    return nullptr;
+}
+
+void RiskManager::onMarkUpdate(uint32_t instrument_id, double reference_price) {
+    if (instrument_id >= MAX_BAND_INSTRUMENTS || !(reference_price > 0.0)) {
+        return;
+    }
+
+    auto& limits = limits_[instrument_id];
+    const double band_pct = band_pct_.load(std::memory_order_relaxed);
+    const double band_ticks = band_ticks_.load(std::memory_order_relaxed);
+    // The tick floor keeps the collar usable on low-priced instruments; it
+    // only applies once the instrument's tick size is known
+    const double tick_floor = band_ticks * limits.tick_size.load(std::memory_order_relaxed);
+    if (band_pct <= 0.0 && !(tick_floor > 0.0)) {
+        limits.lower_price.store(0.0, std::memory_order_relaxed);
+        limits.upper_price.store(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+        limits.has_reference.store(true, std::memory_order_release);
+        return;
+    }
+
+    const double half_width = std::max(reference_price * band_pct, tick_floor);
+    limits.lower_price.store(reference_price - half_width, std::memory_order_relaxed);
+    limits.upper_price.store(reference_price + half_width, std::memory_order_relaxed);
+    // Published after the bounds so a reader never takes the default band
+    limits.has_reference.store(true, std::memory_order_release);
+}
+
+void RiskManager::onMarkUpdate(const std::string& instrument, double reference_price) {
+    onMarkUpdate(InstrumentRegistry::getInstance().intern(instrument), reference_price);
+}
+
+void RiskManager::setTickSize(const std::string& instrument, double tick_size) {
+    uint32_t instrument_id = InstrumentRegistry::getInstance().intern(instrument);
+    if (instrument_id < MAX_BAND_INSTRUMENTS) {
+        limits_[instrument_id].tick_size.store(tick_size, std::memory_order_relaxed);
+    }
+}
+
+size_t RiskManager::loadTickSizes(const nlohmann::json& instruments) {
+    const nlohmann::json& list = instruments.contains("result") ? instruments["result"] : instruments;
+    if (!list.is_array()) {
+        return 0;
+    }
+
+    size_t loaded = 0;
+    for (const auto& instrument : list) {
+        if (!instrument.contains("instrument_name") || !instrument.contains("tick_size")) {
+            continue;
+        }
+        setTickSize(instrument["instrument_name"].get<std::string>(), instrument["tick_size"].get<double>());
+        loaded++;
+    }
+    return loaded;
+}
+
+void RiskManager::refreshLimits() {
+    const auto& trading_config = config_manager_.getTradingConfig();
+    band_pct_.store(trading_config.price_band_pct, std::memory_order_relaxed);
+    band_ticks_.store(static_cast<double>(trading_config.price_band_ticks), std::memory_order_relaxed);
+    max_order_notional_.store(trading_config.max_order_notional, std::memory_order_relaxed);
+    max_instrument_notional_.store(trading_config.max_instrument_notional, std::memory_order_relaxed);
+    max_scenario_loss_.store(trading_config.max_scenario_loss, std::memory_order_relaxed);
+}
+
 void RiskManager::updatePosition(const Position& position) {
     std::lock_guard<std::mutex> lock(risk_mutex_);
     positions_[position.instrument] = position;
+    update_sequence_++;
+
+    uint32_t instrument_id = InstrumentRegistry::getInstance().intern(position.instrument);
+    if (instrument_id < MAX_BAND_INSTRUMENTS) {
+        limits_[instrument_id].position_size.store(position.size, std::memory_order_relaxed);
+    }
     
     // Update total exposure
     double total_exposure = 0.0;
@@ -98,6 +260,7 @@ void RiskManager::updatePosition(const Position& position) {
 void RiskManager::updateRiskMetrics(const RiskMetrics& metrics) {
     std::lock_guard<std::mutex> lock(risk_mutex_);
     risk_metrics_ = metrics;
+    update_sequence_++;
     
     // Update win rate
     if (metrics.total_trades > 0) {
@@ -124,6 +287,26 @@ const RiskManager::RiskMetrics& RiskManager::getRiskMetrics() const {
     return risk_metrics_;
 }
 
+std::vector<RiskManager::Position> RiskManager::getPositions() const {
+    std::lock_guard<std::mutex> lock(risk_mutex_);
+    std::vector<Position> positions;
+    positions.reserve(positions_.size());
+    for (const auto& [_, position] : positions_) {
+        positions.push_back(position);
+    }
+    return positions;
+}
+
+RiskManager::RiskMetrics RiskManager::copyRiskMetrics() const {
+    std::lock_guard<std::mutex> lock(risk_mutex_);
+    return risk_metrics_;
+}
+
+uint64_t RiskManager::getUpdateSequence() const {
+    std::lock_guard<std::mutex> lock(risk_mutex_);
+    return update_sequence_;
+}
+
 double RiskManager::getTotalExposure() const {
     std::lock_guard<std::mutex> lock(risk_mutex_);
     return risk_metrics_.total_exposure;
@@ -139,19 +322,19 @@ double RiskManager::getMaxDrawdown() const {
     return risk_metrics_.max_drawdown;
 }
 
-void RiskManager::setRiskCallback(std::function<void(const std::string&, const std::string&)> callback) {
+void RiskManager::setRiskCallback(RiskCallback callback) {
     std::lock_guard<std::mutex> lock(risk_mutex_);
-    risk_callback_ = callback;
+    risk_callback_ = std::move(callback);
 }
 
-void RiskManager::setPositionCallback(std::function<void(const Position&)> callback) {
+void RiskManager::setPositionCallback(PositionCallback callback) {
     std::lock_guard<std::mutex> lock(risk_mutex_);
-    position_callback_ = callback;
+    position_callback_ = std::move(callback);
 }
 
-void RiskManager::setMetricsCallback(std::function<void(const RiskMetrics&)> callback) {
+void RiskManager::setMetricsCallback(MetricsCallback callback) {
     std::lock_guard<std::mutex> lock(risk_mutex_);
-    metrics_callback_ = callback;
+    metrics_callback_ = std::move(callback);
 }
 
 bool RiskManager::checkPositionLimit(const std::string& instrument, double size) {
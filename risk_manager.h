@@ -3,12 +3,18 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <mutex>
 #include <memory>
 #include <functional>
 #include <chrono>
+#include <atomic>
+#include <limits>
+#include <cstdint>
 #include "config_manager.h"
 #include "market_data_manager.h"
+#include "scenario_risk.h"
+#include "inplace_function.h"
 
 class RiskManager {
 public:
@@ -40,19 +46,60 @@ public:
     void initialize();
     void shutdown();
 
+    // Size of the per-instrument limit table. Orders on interned ids past
+    // it are rejected, since no band or notional state can be kept for them
+    static constexpr size_t MAX_BAND_INSTRUMENTS = 4096;
+
     bool checkOrderRisk(const std::string& instrument, double size, double price, const std::string& side);
+    // Same full check with the instrument notional taken against the
+    // caller's own position; position, loss, exposure and scenario limits
+    // stay process-wide
+    bool checkOrderRisk(const std::string& instrument, double size, double price, bool is_buy, double position);
+
+    // Hot-path collar and notional check keyed by InstrumentRegistry id. Reads
+    // only the precomputed per-instrument limits; no locks, maps or config.
+    bool checkOrderRisk(uint32_t instrument_id, double size, double price, bool is_buy);
+    // Same checks with the instrument notional taken against the caller's
+    // own position, for sessions that trade a separate account
+    bool checkOrderRisk(uint32_t instrument_id, double size, double price, bool is_buy, double position);
+
+    // Recomputes the price band around a new mark (or mid when no mark).
+    // While a band is configured, orders on an instrument that has never had
+    // a reference price are rejected.
+    void onMarkUpdate(uint32_t instrument_id, double reference_price);
+    void onMarkUpdate(const std::string& instrument, double reference_price);
+    // A tick size of 0 (unknown) means no tick floor on the band
+    void setTickSize(const std::string& instrument, double tick_size);
+    // Takes tick sizes from a public/get_instruments response or its result
+    // array; returns how many instruments were updated
+    size_t loadTickSizes(const nlohmann::json& instruments);
+    void refreshLimits();
     void updatePosition(const Position& position);
     void updateRiskMetrics(const RiskMetrics& metrics);
 
     const Position& getPosition(const std::string& instrument) const;
     const RiskMetrics& getRiskMetrics() const;
+    // Copies taken under the lock, for readers on other threads
+    std::vector<Position> getPositions() const;
+    RiskMetrics copyRiskMetrics() const;
+    // Moves on every position or metrics update
+    uint64_t getUpdateSequence() const;
     double getTotalExposure() const;
     double getDailyPnL() const;
     double getMaxDrawdown() const;
 
-    void setRiskCallback(std::function<void(const std::string&, const std::string&)> callback);
-    void setPositionCallback(std::function<void(const Position&)> callback);
-    void setMetricsCallback(std::function<void(const RiskMetrics&)> callback);
+    // Options stress grid behind the max_scenario_loss check; feeds push
+    // option marks and positions into it, and initialize() starts its
+    // background refresher
+    ScenarioRiskEngine& getScenarioEngine() { return scenario_engine_; }
+
+    using RiskCallback = InplaceFunction<void(const std::string&, const std::string&)>;
+    using PositionCallback = InplaceFunction<void(const Position&)>;
+    using MetricsCallback = InplaceFunction<void(const RiskMetrics&)>;
+
+    void setRiskCallback(RiskCallback callback);
+    void setPositionCallback(PositionCallback callback);
+    void setMetricsCallback(MetricsCallback callback);
 
 private:
     RiskManager();
@@ -65,15 +112,40 @@ private:
     bool checkDailyLossLimit(double potential_loss);
     bool checkExposureLimit(double exposure);
     void notifyRiskViolation(const std::string& instrument, const std::string& reason);
+    // Returns the violated limit, or nullptr when the order passes
+    const char* checkBands(uint32_t instrument_id, double size, double price, bool is_buy, double position) const;
+    double bandPosition(uint32_t instrument_id) const;
+
+    // Written by the market data thread, read by order threads. Each field
+    // is independently valid, so a reader racing a refresh sees either the
+    // old or the new value of a bound, never a torn one.
+    struct InstrumentLimits {
+        std::atomic<double> tick_size{0.0};
+        std::atomic<double> lower_price{0.0};
+        std::atomic<double> upper_price{std::numeric_limits<double>::infinity()};
+        std::atomic<double> position_size{0.0};
+        // Set by the first mark; until then a configured band rejects
+        std::atomic<bool> has_reference{false};
+    };
 
     mutable std::mutex risk_mutex_;
     std::map<std::string, Position> positions_;
     RiskMetrics risk_metrics_;
-    std::function<void(const std::string&, const std::string&)> risk_callback_;
-    std::function<void(const Position&)> position_callback_;
-    std::function<void(const RiskMetrics&)> metrics_callback_;
+    uint64_t update_sequence_{0};
+    RiskCallback risk_callback_;
+    PositionCallback position_callback_;
+    MetricsCallback metrics_callback_;
     const ConfigManager& config_manager_;
     const MarketDataManager& market_data_manager_;
+
+    std::unique_ptr<InstrumentLimits[]> limits_;
+    std::atomic<double> band_pct_{0.0};
+    std::atomic<double> band_ticks_{0.0};
+    std::atomic<double> max_order_notional_{0.0};
+    std::atomic<double> max_instrument_notional_{0.0};
+    std::atomic<double> max_scenario_loss_{0.0};
+
+    ScenarioRiskEngine scenario_engine_;
 };
 
 #endif // RISK_MANAGER_H 
\ No newline at end of file
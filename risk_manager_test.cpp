@@ -0,0 +1,156 @@
+#include "risk_manager.h"
+#include "config_manager.h"
+#include "instrument_registry.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <limits>
+
+// Exercises the price band collar. Only the band settings are set; every
+// other limit is disabled so checks fail only on the band.
+class RiskManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        saved_config_ = ConfigManager::getInstance().getTradingConfig();
+    }
+
+    void TearDown() override {
+        ConfigManager::getInstance().setTradingConfig(saved_config_);
+        RiskManager::getInstance().refreshLimits();
+    }
+
+    static void setBand(double pct, int ticks) {
+        auto config = ConfigManager::getInstance().getTradingConfig();
+        config.price_band_pct = pct;
+        config.price_band_ticks = ticks;
+        config.max_order_notional = 0.0;
+        config.max_instrument_notional = 0.0;
+        ConfigManager::getInstance().setTradingConfig(config);
+        RiskManager::getInstance().refreshLimits();
+    }
+
+    static bool accepts(const std::string& instrument, double price) {
+        return RiskManager::getInstance().checkOrderRisk(InstrumentRegistry::getInstance().intern(instrument),
+                                                         1.0, price, true);
+    }
+
+    ConfigManager::TradingConfig saved_config_;
+};
+
+TEST_F(RiskManagerTest, TickFloorWidensNarrowPercentBand) {
+    auto& risk = RiskManager::getInstance();
+    setBand(0.001, 5);
+    risk.setTickSize("RM-TICK-FLOOR", 0.5);
+    risk.onMarkUpdate("RM-TICK-FLOOR", 10.0);
+
+    // 0.1% of 10 is 0.01; five ticks of 0.5 give +-2.5
+    EXPECT_TRUE(accepts("RM-TICK-FLOOR", 12.5));
+    EXPECT_TRUE(accepts("RM-TICK-FLOOR", 7.5));
+    EXPECT_FALSE(accepts("RM-TICK-FLOOR", 12.6));
+    EXPECT_FALSE(accepts("RM-TICK-FLOOR", 7.4));
+}
+
+TEST_F(RiskManagerTest, UnknownTickSizeIsNoFloor) {
+    auto& risk = RiskManager::getInstance();
+
+    // Ticks only and no tick size yet: no band rather than a zero-width one
+    setBand(0.0, 5);
+    risk.setTickSize("RM-NO-TICK", 0.0);
+    risk.onMarkUpdate("RM-NO-TICK", 100.0);
+    EXPECT_TRUE(accepts("RM-NO-TICK", 100.5));
+    EXPECT_TRUE(accepts("RM-NO-TICK", 50.0));
+
+    // With a percentage the band is just the percentage
+    setBand(0.01, 5);
+    risk.onMarkUpdate("RM-NO-TICK", 100.0);
+    EXPECT_TRUE(accepts("RM-NO-TICK", 101.0));
+    EXPECT_FALSE(accepts("RM-NO-TICK", 101.5));
+}
+
+TEST_F(RiskManagerTest, LoadsTickSizesFromInstrumentMetadata) {
+    auto& risk = RiskManager::getInstance();
+    const auto response = nlohmann::json::parse(R"({
+        "jsonrpc": "2.0",
+        "result": [
+            {"instrument_name": "RM-META-A", "tick_size": 0.5, "kind": "future"},
+            {"instrument_name": "RM-META-B", "tick_size": 0.0005, "kind": "option"},
+            {"kind": "future"}
+        ]
+    })");
+    EXPECT_EQ(risk.loadTickSizes(response), 2u);
+    EXPECT_EQ(risk.loadTickSizes(response["result"]), 2u);
+    EXPECT_EQ(risk.loadTickSizes(nlohmann::json::object()), 0u);
+
+    setBand(0.0, 4);
+    risk.onMarkUpdate("RM-META-A", 100.0);
+    EXPECT_TRUE(accepts("RM-META-A", 102.0));
+    EXPECT_FALSE(accepts("RM-META-A", 102.5));
+}
+
+TEST_F(RiskManagerTest, InstrumentNotionalUsesCallersPosition) {
+    auto& risk = RiskManager::getInstance();
+    setBand(0.0, 0);
+    auto config = ConfigManager::getInstance().getTradingConfig();
+    config.max_instrument_notional = 1000.0;
+    ConfigManager::getInstance().setTradingConfig(config);
+    risk.refreshLimits();
+
+    const uint32_t id = InstrumentRegistry::getInstance().intern("RM-ACCOUNT-POSITION");
+    risk.onMarkUpdate(id, 100.0);
+
+    // A flat account may open 10 at 100 whatever the process holds; one
+    // already long 8 may not add 5, but may sell them
+    EXPECT_TRUE(risk.checkOrderRisk(id, 10.0, 100.0, true, 0.0));
+    EXPECT_FALSE(risk.checkOrderRisk(id, 5.0, 100.0, true, 8.0));
+    EXPECT_TRUE(risk.checkOrderRisk(id, 5.0, 100.0, false, 8.0));
+}
+
+TEST_F(RiskManagerTest, RejectsNanPriceAndSize) {
+    auto& risk = RiskManager::getInstance();
+    setBand(0.01, 0);
+    auto config = ConfigManager::getInstance().getTradingConfig();
+    config.max_order_notional = 1e6;
+    config.max_instrument_notional = 1e6;
+    ConfigManager::getInstance().setTradingConfig(config);
+    risk.refreshLimits();
+
+    const uint32_t id = InstrumentRegistry::getInstance().intern("RM-NAN");
+    risk.onMarkUpdate(id, 100.0);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    EXPECT_TRUE(risk.checkOrderRisk(id, 1.0, 100.0, true));
+    EXPECT_FALSE(risk.checkOrderRisk(id, 1.0, nan, true));
+    EXPECT_FALSE(risk.checkOrderRisk(id, nan, 100.0, true));
+    EXPECT_FALSE(risk.checkOrderRisk(id, 1.0, std::numeric_limits<double>::infinity(), true));
+}
+
+TEST_F(RiskManagerTest, RejectsInstrumentsPastTheLimitTable) {
+    auto& risk = RiskManager::getInstance();
+    setBand(0.0, 0);
+
+    // No band is configured, so only the missing table slot can reject it
+    const uint32_t id = static_cast<uint32_t>(RiskManager::MAX_BAND_INSTRUMENTS) + 7;
+    risk.onMarkUpdate(id, 100.0);
+    EXPECT_FALSE(risk.checkOrderRisk(id, 1.0, 100.0, true));
+    EXPECT_TRUE(risk.checkOrderRisk(InstrumentRegistry::getInstance().intern("RM-IN-TABLE"), 1.0, 100.0, true));
+}
+
+TEST_F(RiskManagerTest, BandWithoutReferencePriceRejects) {
+    auto& risk = RiskManager::getInstance();
+    auto& registry = InstrumentRegistry::getInstance();
+    const uint32_t id = registry.intern("RM-NO-MARK");
+
+    // With no band configured there is nothing to check against
+    setBand(0.0, 0);
+    EXPECT_TRUE(risk.checkOrderRisk(id, 1.0, 100.0, true));
+
+    // A configured band needs a reference price, interned or not
+    setBand(0.01, 0);
+    EXPECT_FALSE(risk.checkOrderRisk(id, 1.0, 100.0, true));
+    EXPECT_FALSE(risk.checkOrderRisk(InstrumentRegistry::INVALID_ID, 1.0, 100.0, true));
+    setBand(0.0, 5);
+    EXPECT_FALSE(risk.checkOrderRisk(id, 1.0, 100.0, true));
+
+    setBand(0.01, 0);
+    risk.onMarkUpdate(id, 100.0);
+    EXPECT_TRUE(risk.checkOrderRisk(id, 1.0, 100.0, true));
+}
@@ -0,0 +1,534 @@
+#include "scenario_risk.h"
+#include "parallel_for.h"
+#include "cpu_accounting.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr double SECONDS_PER_YEAR = 365.0 * 24 * 3600;
+constexpr double MIN_YEARS = 1e-6;   // Keeps expiring options finite; they price at intrinsic
+constexpr double MIN_VOL = 1e-4;     // A large negative vol shock floors here
+constexpr double SQRT1_2 = 0.7071067811865476;
+// Below this many option valuations a refresh stays on the calling thread;
+// starting workers would cost more than the work
+constexpr size_t PARALLEL_MIN_VALUATIONS = 20000;
+
+double normalCdf(double x) {
+    return 0.5 * std::erfc(-x * SQRT1_2);
+}
+
+// Black-76 on the forward; sign is +1 for calls and -1 for puts
+double blackValue(double sign, double forward, double strike, double years, double vol, double rate) {
+    if (!(forward > 0.0) || !(strike > 0.0)) {
+        return std::max(sign * (forward - strike), 0.0);
+    }
+    years = std::max(years, MIN_YEARS);
+    vol = std::max(vol, MIN_VOL);
+    const double deviation = vol * std::sqrt(years);
+    const double d1 = (std::log(forward / strike) + 0.5 * vol * vol * years) / deviation;
+    const double d2 = d1 - deviation;
+    return std::exp(-rate * years) * sign * (forward * normalCdf(sign * d1) - strike * normalCdf(sign * d2));
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+int64_t daysFromCivil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t year_of_era = year - era * 400;
+    const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+} // namespace
+
+ScenarioRiskEngine::GridConfig ScenarioRiskEngine::defaultGrid() {
+    GridConfig grid;
+    for (int percent = -20; percent <= 20; ++percent) {
+        grid.spot_shocks.push_back(percent / 100.0);
+    }
+    grid.vol_shocks = {-0.05, 0.0, 0.05};
+    return grid;
+}
+
+bool ScenarioRiskEngine::parseDeribitOption(const std::string& instrument, OptionSpec& spec) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    for (;;) {
+        size_t dash = instrument.find('-', start);
+        parts.push_back(instrument.substr(start, dash - start));
+        if (dash == std::string::npos) {
+            break;
+        }
+        start = dash + 1;
+    }
+    if (parts.size() != 4 || parts[0].empty() || (parts[3] != "C" && parts[3] != "P")) {
+        return false;
+    }
+
+    // Expiry: 1-2 digit day, three-letter month, two-digit year, e.g. 7MAR25
+    const std::string& date = parts[1];
+    if (date.size() < 6 || date.size() > 7) {
+        return false;
+    }
+    const size_t day_digits = date.size() - 5;
+    static const char* MONTHS[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+                                   "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+    int month = 0;
+    for (int i = 0; i < 12; ++i) {
+        if (date.compare(day_digits, 3, MONTHS[i]) == 0) {
+            month = i + 1;
+        }
+    }
+    const std::string day_text = date.substr(0, day_digits);
+    const std::string year_text = date.substr(day_digits + 3);
+    auto all_digits = [](const std::string& text) {
+        return std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+    };
+    if (month == 0 || !all_digits(day_text) || !all_digits(year_text)) {
+        return false;
+    }
+    const int day = std::stoi(day_text);
+    if (day < 1 || day > 31) {
+        return false;
+    }
+
+    // Fractional strikes write the decimal point as 'd' (0d625)
+    std::string strike_text = parts[2];
+    std::replace(strike_text.begin(), strike_text.end(), 'd', '.');
+    char* end = nullptr;
+    const double strike = std::strtod(strike_text.c_str(), &end);
+    if (strike_text.empty() || end != strike_text.c_str() + strike_text.size() || !(strike > 0.0)) {
+        return false;
+    }
+
+    // Deribit options expire at 08:00 UTC
+    const int64_t days = daysFromCivil(2000 + std::stoi(year_text), month, day);
+    spec.underlying = parts[0] + "-" + parts[1];
+    spec.type = parts[3] == "C" ? OptionType::CALL : OptionType::PUT;
+    spec.strike = strike;
+    spec.expiry = std::chrono::system_clock::time_point(std::chrono::hours(days * 24 + 8));
+    return true;
+}
+
+double ScenarioRiskEngine::optionValue(OptionType type, double spot, double strike, double years,
+                                       double vol, double rate) {
+    return blackValue(type == OptionType::CALL ? 1.0 : -1.0, spot, strike, years, vol, rate);
+}
+
+ScenarioRiskEngine::ScenarioRiskEngine(GridConfig grid)
+    : grid_(std::move(grid)) {
+    if (grid_.spot_shocks.empty() || grid_.vol_shocks.empty()) {
+        throw std::invalid_argument("Scenario grid needs at least one spot and one vol shock");
+    }
+    for (double spot_shock : grid_.spot_shocks) {
+        if (!(spot_shock > -1.0)) {
+            throw std::invalid_argument("Spot shocks must stay above -100%");
+        }
+        for (double vol_shock : grid_.vol_shocks) {
+            scenario_spot_.push_back(spot_shock);
+            scenario_vol_.push_back(vol_shock);
+        }
+    }
+    totals_.assign(scenario_spot_.size(), 0.0);
+    valuation_time_ = std::chrono::system_clock::now();
+    publishResult();
+}
+
+ScenarioRiskEngine::~ScenarioRiskEngine() {
+    stop();
+}
+
+void ScenarioRiskEngine::setPosition(const std::string& instrument, const OptionSpec& spec, double quantity) {
+    std::lock_guard<std::mutex> lock(input_mutex_);
+    auto it = slot_index_.find(instrument);
+
+    if (quantity == 0.0) {
+        if (it == slot_index_.end()) {
+            return;
+        }
+        // The slot is revalued to zero on the next refresh, then reused
+        const size_t index = it->second;
+        Slot& slot = slots_[index];
+        auto& peers = underlying_slots_[slot.underlying];
+        peers.erase(std::remove(peers.begin(), peers.end(), index), peers.end());
+        slot.instrument.clear();
+        slot.quantity = 0.0;
+        markDirty(index);
+        slot_index_.erase(it);
+        free_slots_.push_back(index);
+        return;
+    }
+
+    if (it != slot_index_.end()) {
+        slots_[it->second].quantity = quantity;
+        markDirty(it->second);
+        return;
+    }
+
+    if (!(spec.strike > 0.0) || spec.underlying.empty()) {
+        throw std::invalid_argument("Invalid option spec for " + instrument);
+    }
+    size_t index;
+    if (!free_slots_.empty()) {
+        index = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        index = slots_.size();
+        slots_.emplace_back();
+    }
+
+    Slot& slot = slots_[index];
+    slot.instrument = instrument;
+    slot.spec = spec;
+    slot.underlying = underlyingIndex(spec.underlying);
+    slot.quantity = quantity;
+    auto vol = vols_.find(instrument);
+    slot.vol = vol != vols_.end() ? vol->second : 0.0;
+    underlying_slots_[slot.underlying].push_back(index);
+    slot_index_[instrument] = index;
+    markDirty(index);
+}
+
+bool ScenarioRiskEngine::setPosition(const std::string& instrument, double quantity) {
+    OptionSpec spec;
+    if (!parseDeribitOption(instrument, spec)) {
+        return false;
+    }
+    setPosition(instrument, spec, quantity);
+    return true;
+}
+
+void ScenarioRiskEngine::updateMark(const std::string& instrument, double underlying_price, double implied_vol) {
+    std::lock_guard<std::mutex> lock(input_mutex_);
+    size_t underlying;
+    auto it = slot_index_.find(instrument);
+    if (it != slot_index_.end()) {
+        Slot& slot = slots_[it->second];
+        underlying = slot.underlying;
+        if (implied_vol > 0.0 && implied_vol != slot.vol) {
+            slot.vol = implied_vol;
+            markDirty(it->second);
+        }
+    } else {
+        // Not held: remember the mark so a pre-trade check can price it
+        OptionSpec spec;
+        if (!parseDeribitOption(instrument, spec)) {
+            return;
+        }
+        underlying = underlyingIndex(spec.underlying);
+    }
+
+    if (implied_vol > 0.0) {
+        vols_[instrument] = implied_vol;
+    }
+    if (underlying_price > 0.0 && underlying_price != underlying_prices_[underlying]) {
+        underlying_prices_[underlying] = underlying_price;
+        for (size_t index : underlying_slots_[underlying]) {
+            markDirty(index);
+        }
+    }
+}
+
+void ScenarioRiskEngine::clear() {
+    std::lock_guard<std::mutex> compute_lock(compute_mutex_);
+    std::lock_guard<std::mutex> lock(input_mutex_);
+    slots_.clear();
+    free_slots_.clear();
+    slot_index_.clear();
+    dirty_.clear();
+    underlying_index_.clear();
+    underlying_prices_.clear();
+    underlying_slots_.clear();
+    vols_.clear();
+    needs_full_ = true;
+
+    capacity_ = 0;
+    for (auto* values : {&sign_, &spot_, &strike_, &years_, &vol_, &quantity_, &base_value_, &pnl_}) {
+        values->clear();
+    }
+    expiry_.clear();
+    totals_.assign(scenario_spot_.size(), 0.0);
+    full_revaluations_ = 0;
+    incremental_revaluations_ = 0;
+    publishResult();
+    refresh_cv_.notify_one();
+}
+
+void ScenarioRiskEngine::start() {
+    std::lock_guard<std::mutex> lock(input_mutex_);
+    if (refreshing_) {
+        return;
+    }
+    refreshing_ = true;
+    refresher_ = std::thread(&ScenarioRiskEngine::refreshLoop, this);
+}
+
+void ScenarioRiskEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(input_mutex_);
+        if (!refreshing_) {
+            return;
+        }
+        refreshing_ = false;
+    }
+    refresh_cv_.notify_all();
+    if (refresher_.joinable()) {
+        refresher_.join();
+    }
+}
+
+void ScenarioRiskEngine::refreshLoop() {
+    CpuAccounting::ThreadRegistration cpu_registration("scenario_risk");
+    std::unique_lock<std::mutex> lock(input_mutex_);
+    while (refreshing_) {
+        // The timeout covers retiming a book whose inputs are quiet
+        refresh_cv_.wait_for(lock, grid_.retime_interval,
+                             [this] { return !refreshing_ || needs_full_ || !dirty_.empty(); });
+        if (!refreshing_) {
+            break;
+        }
+        lock.unlock();
+        refresh(std::chrono::system_clock::now());
+        lock.lock();
+    }
+}
+
+void ScenarioRiskEngine::refresh(std::chrono::system_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(compute_mutex_);
+    refreshLocked(now);
+}
+
+void ScenarioRiskEngine::refreshLocked(std::chrono::system_clock::time_point now) {
+    const auto started = std::chrono::steady_clock::now();
+    const size_t scenario_count = scenario_spot_.size();
+    size_t slot_count;
+    bool full;
+
+    // Copy what changed into the valuation arrays, then let feed threads
+    // carry on while the grid is computed
+    {
+        std::lock_guard<std::mutex> lock(input_mutex_);
+        slot_count = slots_.size();
+        const bool stale = now - valuation_time_ >= grid_.retime_interval;
+        if (!needs_full_ && !stale && dirty_.empty()) {
+            return;
+        }
+        // Once most slots are dirty a plain sweep beats the gather
+        full = needs_full_ || stale || dirty_.size() * 4 >= slot_count;
+
+        if (slot_count > capacity_) {
+            const size_t capacity = std::max({slot_count, capacity_ * 2, size_t(64)});
+            for (auto* values : {&sign_, &spot_, &strike_, &years_, &vol_, &quantity_, &base_value_}) {
+                values->resize(capacity, 0.0);
+            }
+            expiry_.resize(capacity);
+            std::vector<double> pnl(scenario_count * capacity, 0.0);
+            for (size_t s = 0; s < scenario_count && capacity_ > 0; ++s) {
+                std::copy_n(pnl_.begin() + s * capacity_, capacity_, pnl.begin() + s * capacity);
+            }
+            pnl_.swap(pnl);
+            capacity_ = capacity;
+        }
+
+        auto load = [this](size_t index) {
+            Slot& slot = slots_[index];
+            const double price = slot.instrument.empty() ? 0.0 : underlying_prices_[slot.underlying];
+            const bool priced = price > 0.0 && slot.vol > 0.0;
+            sign_[index] = slot.spec.type == OptionType::CALL ? 1.0 : -1.0;
+            spot_[index] = price;
+            strike_[index] = slot.spec.strike;
+            expiry_[index] = slot.spec.expiry;
+            vol_[index] = slot.vol;
+            quantity_[index] = priced ? slot.quantity : 0.0;
+            slot.dirty = false;
+        };
+
+        if (full) {
+            for (size_t index = 0; index < slot_count; ++index) {
+                load(index);
+            }
+        } else {
+            updated_.assign(dirty_.begin(), dirty_.end());
+            for (size_t index : updated_) {
+                load(index);
+            }
+        }
+        dirty_.clear();
+        needs_full_ = false;
+    }
+
+    if (full) {
+        valuation_time_ = now;
+    }
+    auto value_base = [this](size_t index) {
+        years_[index] = yearsTo(expiry_[index], valuation_time_);
+        base_value_[index] = blackValue(sign_[index], spot_[index], strike_[index], years_[index],
+                                        vol_[index], grid_.rate);
+    };
+    if (full) {
+        for (size_t index = 0; index < slot_count; ++index) {
+            value_base(index);
+        }
+    } else {
+        for (size_t index : updated_) {
+            value_base(index);
+        }
+    }
+
+    const size_t valuations = scenario_count * (full ? slot_count : updated_.size());
+    const size_t threads = valuations < PARALLEL_MIN_VALUATIONS ? 1 : grid_.threads;
+    parallelFor(scenario_count, threads, [&](size_t s) {
+        const double spot_factor = 1.0 + scenario_spot_[s];
+        const double vol_shift = scenario_vol_[s];
+        const double rate = grid_.rate;
+        double* row = pnl_.data() + s * capacity_;
+
+        auto revalue = [&](size_t i) {
+            return quantity_[i] * (blackValue(sign_[i], spot_[i] * spot_factor, strike_[i], years_[i],
+                                              vol_[i] + vol_shift, rate) - base_value_[i]);
+        };
+        if (full) {
+            double total = 0.0;
+            for (size_t i = 0; i < slot_count; ++i) {
+                row[i] = revalue(i);
+                total += row[i];
+            }
+            totals_[s] = total;
+        } else {
+            // Rounding from the running total is bounded: every retime
+            // rebuilds the totals from scratch
+            double change = 0.0;
+            for (size_t i : updated_) {
+                const double pnl = revalue(i);
+                change += pnl - row[i];
+                row[i] = pnl;
+            }
+            totals_[s] += change;
+        }
+    });
+
+    if (full) {
+        full_revaluations_++;
+    } else {
+        incremental_revaluations_++;
+    }
+    last_refresh_us_ = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count();
+    publishResult();
+}
+
+void ScenarioRiskEngine::publishResult() {
+    size_t worst = 0;
+    for (size_t s = 1; s < totals_.size(); ++s) {
+        if (totals_[s] < totals_[worst]) {
+            worst = s;
+        }
+    }
+    auto grid = std::make_shared<PublishedGrid>();
+    grid->totals = totals_;
+    grid->worst_loss = std::max(0.0, -totals_[worst]);
+    grid->valuation_time = valuation_time_;
+
+    worst_scenario_ = worst;
+    worst_loss_.store(grid->worst_loss, std::memory_order_release);
+    std::atomic_store(&published_, std::shared_ptr<const PublishedGrid>(std::move(grid)));
+}
+
+ScenarioRiskEngine::PreTradeLoss ScenarioRiskEngine::worstLossWith(const std::string& instrument,
+                                                                   double quantity_change) const {
+    const auto grid = std::atomic_load(&published_);
+    PreTradeLoss loss{grid->worst_loss, grid->worst_loss};
+
+    OptionSpec spec;
+    double price = 0.0;
+    double vol = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(input_mutex_);
+        auto slot = slot_index_.find(instrument);
+        if (slot != slot_index_.end()) {
+            spec = slots_[slot->second].spec;
+            vol = slots_[slot->second].vol;
+        } else if (parseDeribitOption(instrument, spec)) {
+            auto mark = vols_.find(instrument);
+            vol = mark != vols_.end() ? mark->second : 0.0;
+        }
+        auto underlying = underlying_index_.find(spec.underlying);
+        if (underlying != underlying_index_.end()) {
+            price = underlying_prices_[underlying->second];
+        }
+    }
+    if (quantity_change == 0.0 || !(price > 0.0) || !(vol > 0.0)) {
+        return loss;
+    }
+
+    const double sign = spec.type == OptionType::CALL ? 1.0 : -1.0;
+    const double years = yearsTo(spec.expiry, grid->valuation_time);
+    const double base = blackValue(sign, price, spec.strike, years, vol, grid_.rate);
+    double worst_pnl = std::numeric_limits<double>::infinity();
+    for (size_t s = 0; s < grid->totals.size(); ++s) {
+        const double value = blackValue(sign, price * (1.0 + scenario_spot_[s]), spec.strike, years,
+                                         vol + scenario_vol_[s], grid_.rate);
+        worst_pnl = std::min(worst_pnl, grid->totals[s] + quantity_change * (value - base));
+    }
+    loss.after = std::max(0.0, -worst_pnl);
+    return loss;
+}
+
+ScenarioRiskEngine::Result ScenarioRiskEngine::getResult() {
+    std::lock_guard<std::mutex> compute_lock(compute_mutex_);
+    refreshLocked(std::chrono::system_clock::now());
+
+    Result result;
+    result.scenarios.reserve(totals_.size());
+    for (size_t s = 0; s < totals_.size(); ++s) {
+        result.scenarios.push_back({scenario_spot_[s], scenario_vol_[s], totals_[s]});
+    }
+    result.worst_loss = worst_loss_.load(std::memory_order_acquire);
+    result.worst_scenario = worst_scenario_;
+    result.full_revaluations = full_revaluations_;
+    result.incremental_revaluations = incremental_revaluations_;
+    result.last_refresh_us = last_refresh_us_;
+    result.valuation_time = valuation_time_;
+
+    std::lock_guard<std::mutex> lock(input_mutex_);
+    result.positions = slot_index_.size();
+    for (const auto& [_, index] : slot_index_) {
+        const Slot& slot = slots_[index];
+        if (!(underlying_prices_[slot.underlying] > 0.0) || !(slot.vol > 0.0)) {
+            result.unpriced++;
+        }
+    }
+    return result;
+}
+
+void ScenarioRiskEngine::markDirty(size_t slot) {
+    if (!slots_[slot].dirty) {
+        slots_[slot].dirty = true;
+        dirty_.push_back(slot);
+        // The refresher only sleeps while nothing is dirty
+        if (dirty_.size() == 1) {
+            refresh_cv_.notify_one();
+        }
+    }
+}
+
+size_t ScenarioRiskEngine::underlyingIndex(const std::string& underlying) {
+    auto it = underlying_index_.find(underlying);
+    if (it != underlying_index_.end()) {
+        return it->second;
+    }
+    const size_t index = underlying_prices_.size();
+    underlying_index_[underlying] = index;
+    underlying_prices_.push_back(0.0);
+    underlying_slots_.emplace_back();
+    return index;
+}
+
+double ScenarioRiskEngine::yearsTo(std::chrono::system_clock::time_point expiry,
+                                   std::chrono::system_clock::time_point valuation_time) {
+    return std::max(0.0, std::chrono::duration<double>(expiry - valuation_time).count() / SECONDS_PER_YEAR);
+}
@@ -0,0 +1,192 @@
+#ifndef SCENARIO_RISK_H
+#define SCENARIO_RISK_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Stress grid for the options book: every option position is revalued with
+// Black-76 under each combination of a relative spot shock and an absolute
+// implied-vol shock, and the worst scenario PnL becomes a pre-trade limit
+// input. Positions live in flat arrays so one scenario is a straight loop
+// over positions; scenarios are spread over threads. Only positions whose
+// quantity, vol or underlying price moved since the last refresh are
+// revalued, and the whole grid is rebuilt once the valuation time is stale.
+//
+// Once started, a background refresher revalues as soon as a mark or
+// position changes and publishes an immutable copy of the scenario totals.
+// The pre-trade check reads only that copy plus the order's own delta, so
+// it never waits on a refresh.
+//
+// Underlyings are the per-expiry forwards Deribit quotes options against,
+// so no rate is needed by default. PnL is in the strike currency and
+// quantities are in units of the underlying.
+class ScenarioRiskEngine {
+public:
+    enum class OptionType : uint8_t {
+        CALL,
+        PUT
+    };
+
+    struct OptionSpec {
+        std::string underlying;  // e.g. BTC-27DEC24
+        OptionType type{OptionType::CALL};
+        double strike{0.0};
+        std::chrono::system_clock::time_point expiry;
+    };
+
+    struct GridConfig {
+        std::vector<double> spot_shocks;  // Relative, -0.2 is a 20% drop
+        std::vector<double> vol_shocks;   // Absolute, 0.05 is +5 vol points
+        double rate{0.0};
+        size_t threads{0};                // 0 = hardware concurrency
+        std::chrono::seconds retime_interval{60};
+    };
+
+    struct Scenario {
+        double spot_shock;
+        double vol_shock;
+        double pnl;
+    };
+
+    struct Result {
+        std::vector<Scenario> scenarios;
+        double worst_loss{0.0};  // Positive loss of the worst scenario, 0 if none loses
+        size_t worst_scenario{0};
+        size_t positions{0};
+        size_t unpriced{0};      // Held but missing an underlying price or vol
+        uint64_t full_revaluations{0};
+        uint64_t incremental_revaluations{0};
+        double last_refresh_us{0.0};
+        std::chrono::system_clock::time_point valuation_time;
+    };
+
+    // Spot -20% to +20% in 1% steps against vol -5, 0 and +5 points
+    static GridConfig defaultGrid();
+
+    // BTC-27DEC24-60000-C style names; false for anything that is not an option
+    static bool parseDeribitOption(const std::string& instrument, OptionSpec& spec);
+
+    static double optionValue(OptionType type, double spot, double strike, double years,
+                              double vol, double rate);
+
+    // The grid loss before and after a hypothetical fill, from one published grid
+    struct PreTradeLoss {
+        double before{0.0};
+        double after{0.0};
+    };
+
+    explicit ScenarioRiskEngine(GridConfig grid = defaultGrid());
+    ~ScenarioRiskEngine();
+
+    ScenarioRiskEngine(const ScenarioRiskEngine&) = delete;
+    ScenarioRiskEngine& operator=(const ScenarioRiskEngine&) = delete;
+
+    // Quantity 0 removes the position
+    void setPosition(const std::string& instrument, const OptionSpec& spec, double quantity);
+    // Parses the instrument name; false if it is not an option
+    bool setPosition(const std::string& instrument, double quantity);
+    // Underlying price of the option's forward and its implied vol (0.65 = 65%)
+    void updateMark(const std::string& instrument, double underlying_price, double implied_vol);
+    void clear();
+
+    // Background refresher: wakes on every input change and at least once per
+    // retime interval. Without it the grid only moves on refresh().
+    void start();
+    void stop();
+
+    // Revalues whatever changed since the last refresh and publishes the grid
+    void refresh(std::chrono::system_clock::time_point now = std::chrono::system_clock::now());
+
+    // Worst loss of the published grid; lock-free. With the refresher running
+    // it trails an input change by one refresh at most.
+    double getWorstLoss() const { return worst_loss_.load(std::memory_order_acquire); }
+
+    // Adds quantity_change of instrument to the published grid without
+    // refreshing it. Instruments that cannot be priced yet leave the book's
+    // loss unchanged.
+    PreTradeLoss worstLossWith(const std::string& instrument, double quantity_change) const;
+
+    // Refreshes first; for reporting, not for the order path
+    Result getResult();
+    size_t getScenarioCount() const { return scenario_spot_.size(); }
+
+private:
+    struct Slot {
+        std::string instrument;
+        OptionSpec spec;
+        size_t underlying{0};
+        double quantity{0.0};
+        double vol{0.0};
+        bool dirty{false};
+    };
+
+    // What the order path reads; replaced whole on every refresh
+    struct PublishedGrid {
+        std::vector<double> totals;
+        double worst_loss{0.0};
+        std::chrono::system_clock::time_point valuation_time;
+    };
+
+    void refreshLocked(std::chrono::system_clock::time_point now);
+    void refreshLoop();
+    void markDirty(size_t slot);
+    size_t underlyingIndex(const std::string& underlying);
+    static double yearsTo(std::chrono::system_clock::time_point expiry,
+                          std::chrono::system_clock::time_point valuation_time);
+    void publishResult();
+
+    const GridConfig grid_;
+    // Scenario s shocks spot by scenario_spot_[s] and vol by scenario_vol_[s]
+    std::vector<double> scenario_spot_;
+    std::vector<double> scenario_vol_;
+
+    // Inputs, written by feed and position threads
+    mutable std::mutex input_mutex_;
+    std::vector<Slot> slots_;
+    std::vector<size_t> free_slots_;
+    std::unordered_map<std::string, size_t> slot_index_;
+    std::vector<size_t> dirty_;
+    std::unordered_map<std::string, size_t> underlying_index_;
+    std::vector<double> underlying_prices_;
+    std::vector<std::vector<size_t>> underlying_slots_;
+    std::unordered_map<std::string, double> vols_;  // Last vol of every marked option
+    bool needs_full_{true};
+    bool refreshing_{false};
+    std::condition_variable refresh_cv_;  // Signalled when dirty_ or needs_full_ is set
+    std::thread refresher_;
+
+    // Valuation state, owned by whoever holds compute_mutex_. Per-slot
+    // arrays are laid out for the inner loop; pnl_ is scenario-major with
+    // capacity_ columns per row.
+    std::mutex compute_mutex_;
+    std::chrono::system_clock::time_point valuation_time_;
+    size_t capacity_{0};
+    std::vector<double> sign_;      // +1 call, -1 put
+    std::vector<double> spot_;
+    std::vector<double> strike_;
+    std::vector<double> years_;
+    std::vector<double> vol_;
+    std::vector<double> quantity_;  // 0 for empty or unpriced slots
+    std::vector<double> base_value_;
+    std::vector<std::chrono::system_clock::time_point> expiry_;
+    std::vector<double> pnl_;
+    std::vector<double> totals_;
+    std::vector<size_t> updated_;   // Slots revalued by an incremental refresh
+    uint64_t full_revaluations_{0};
+    uint64_t incremental_revaluations_{0};
+    double last_refresh_us_{0.0};
+    size_t worst_scenario_{0};
+
+    std::shared_ptr<const PublishedGrid> published_;  // std::atomic_load/store only
+    std::atomic<double> worst_loss_{0.0};
+};
+
+#endif // SCENARIO_RISK_H
@@ -0,0 +1,275 @@
+#include "scenario_risk.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <thread>
+
+class ScenarioRiskTest : public ::testing::Test {
+protected:
+    using Clock = std::chrono::system_clock;
+    using Type = ScenarioRiskEngine::OptionType;
+
+    static ScenarioRiskEngine::OptionSpec spec(const std::string& underlying, Type type, double strike, int days) {
+        ScenarioRiskEngine::OptionSpec spec;
+        spec.underlying = underlying;
+        spec.type = type;
+        spec.strike = strike;
+        spec.expiry = now_ + std::chrono::hours(24 * days);
+        return spec;
+    }
+
+    static ScenarioRiskEngine::GridConfig smallGrid() {
+        ScenarioRiskEngine::GridConfig grid;
+        grid.spot_shocks = {-0.1, 0.0, 0.1};
+        grid.vol_shocks = {-0.05, 0.05};
+        return grid;
+    }
+
+    static double years(const ScenarioRiskEngine::OptionSpec& spec, Clock::time_point valuation) {
+        return std::chrono::duration<double>(spec.expiry - valuation).count() / (365.0 * 24 * 3600);
+    }
+
+    static const Clock::time_point now_;
+};
+
+const ScenarioRiskTest::Clock::time_point ScenarioRiskTest::now_ = ScenarioRiskTest::Clock::now();
+
+TEST_F(ScenarioRiskTest, ParsesDeribitOptionNames) {
+    ScenarioRiskEngine::OptionSpec parsed;
+    ASSERT_TRUE(ScenarioRiskEngine::parseDeribitOption("BTC-27DEC24-60000-C", parsed));
+    EXPECT_EQ(parsed.underlying, "BTC-27DEC24");
+    EXPECT_EQ(parsed.type, Type::CALL);
+    EXPECT_DOUBLE_EQ(parsed.strike, 60000.0);
+    // 2024-12-27 08:00 UTC
+    EXPECT_EQ(Clock::to_time_t(parsed.expiry), 1735286400);
+
+    ASSERT_TRUE(ScenarioRiskEngine::parseDeribitOption("ETH-7MAR25-2200-P", parsed));
+    EXPECT_EQ(parsed.type, Type::PUT);
+    EXPECT_EQ(Clock::to_time_t(parsed.expiry), 1741334400);
+
+    ASSERT_TRUE(ScenarioRiskEngine::parseDeribitOption("XRP_USDC-30MAY25-0d625-C", parsed));
+    EXPECT_DOUBLE_EQ(parsed.strike, 0.625);
+
+    EXPECT_FALSE(ScenarioRiskEngine::parseDeribitOption("BTC-PERPETUAL", parsed));
+    EXPECT_FALSE(ScenarioRiskEngine::parseDeribitOption("BTC-27DEC24", parsed));
+    EXPECT_FALSE(ScenarioRiskEngine::parseDeribitOption("BTC-27XYZ24-60000-C", parsed));
+    EXPECT_FALSE(ScenarioRiskEngine::parseDeribitOption("BTC-27DEC24-abc-C", parsed));
+}
+
+TEST_F(ScenarioRiskTest, OptionValueMatchesClosedForm) {
+    // At the money, one year, 20% vol: the textbook 7.9656
+    EXPECT_NEAR(ScenarioRiskEngine::optionValue(Type::CALL, 100.0, 100.0, 1.0, 0.2, 0.0), 7.9656, 1e-4);
+
+    // Put-call parity on the forward: C - P = (F - K) * exp(-rT)
+    const double call = ScenarioRiskEngine::optionValue(Type::CALL, 105.0, 95.0, 0.5, 0.6, 0.03);
+    const double put = ScenarioRiskEngine::optionValue(Type::PUT, 105.0, 95.0, 0.5, 0.6, 0.03);
+    EXPECT_NEAR(call - put, 10.0 * std::exp(-0.03 * 0.5), 1e-9);
+
+    // Expired options are worth intrinsic
+    EXPECT_NEAR(ScenarioRiskEngine::optionValue(Type::PUT, 90.0, 100.0, 0.0, 0.5, 0.0), 10.0, 1e-9);
+}
+
+TEST_F(ScenarioRiskTest, GridMatchesDirectRevaluation) {
+    ScenarioRiskEngine engine(smallGrid());
+    const auto call = spec("BTC-A", Type::CALL, 100.0, 30);
+    const auto put = spec("BTC-A", Type::PUT, 90.0, 60);
+    engine.setPosition("call", call, 2.0);
+    engine.setPosition("put", put, -3.0);
+    engine.updateMark("call", 100.0, 0.6);
+    engine.updateMark("put", 100.0, 0.7);
+    engine.refresh(now_);
+
+    auto result = engine.getResult();
+    ASSERT_EQ(result.scenarios.size(), 6u);
+    EXPECT_EQ(result.positions, 2u);
+    EXPECT_EQ(result.unpriced, 0u);
+
+    double worst = 0.0;
+    for (const auto& scenario : result.scenarios) {
+        const double spot = 100.0 * (1.0 + scenario.spot_shock);
+        auto pnl = [&](const ScenarioRiskEngine::OptionSpec& option, double vol, double quantity) {
+            const double t = years(option, result.valuation_time);
+            return quantity * (ScenarioRiskEngine::optionValue(option.type, spot, option.strike, t,
+                                                               vol + scenario.vol_shock, 0.0) -
+                               ScenarioRiskEngine::optionValue(option.type, 100.0, option.strike, t, vol, 0.0));
+        };
+        const double expected = pnl(call, 0.6, 2.0) + pnl(put, 0.7, -3.0);
+        EXPECT_NEAR(scenario.pnl, expected, 1e-9);
+        worst = std::max(worst, -expected);
+    }
+    EXPECT_NEAR(result.worst_loss, worst, 1e-9);
+    EXPECT_NEAR(engine.getWorstLoss(), worst, 1e-9);
+}
+
+TEST_F(ScenarioRiskTest, IncrementalRefreshMatchesFullRevaluation) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> strike(60.0, 140.0);
+    std::uniform_real_distribution<double> quantity(-5.0, 5.0);
+    std::uniform_real_distribution<double> vol(0.3, 1.2);
+    std::uniform_int_distribution<int> days(1, 365);
+
+    struct Held {
+        std::string name;
+        ScenarioRiskEngine::OptionSpec spec;
+        double quantity;
+        double vol;
+    };
+    std::vector<Held> book;
+    for (int i = 0; i < 300; ++i) {
+        book.push_back({"opt" + std::to_string(i),
+                        spec(i % 2 ? "ETH-A" : "BTC-A", i % 3 ? Type::CALL : Type::PUT, strike(rng), days(rng)),
+                        quantity(rng), vol(rng)});
+    }
+
+    auto load = [&book](ScenarioRiskEngine& engine) {
+        for (const auto& held : book) {
+            engine.setPosition(held.name, held.spec, held.quantity);
+            engine.updateMark(held.name, held.spec.underlying == "BTC-A" ? 100.0 : 95.0, held.vol);
+        }
+    };
+
+    ScenarioRiskEngine incremental;
+    load(incremental);
+    incremental.refresh(now_);
+
+    // A few fills and vol moves, then one position closed
+    for (int i : {3, 50, 51, 200, 299}) {
+        book[i].quantity += 1.5;
+        incremental.setPosition(book[i].name, book[i].spec, book[i].quantity);
+    }
+    for (int i : {10, 11, 120}) {
+        book[i].vol += 0.1;
+        incremental.updateMark(book[i].name, 0.0, book[i].vol);
+    }
+    incremental.setPosition(book[42].name, book[42].spec, 0.0);
+    book.erase(book.begin() + 42);
+    incremental.refresh(now_);
+
+    ScenarioRiskEngine full;
+    load(full);
+    full.refresh(now_);
+
+    auto updated = incremental.getResult();
+    auto expected = full.getResult();
+    EXPECT_EQ(updated.full_revaluations, 1u);
+    EXPECT_EQ(updated.incremental_revaluations, 1u);
+    EXPECT_EQ(updated.positions, 299u);
+    ASSERT_EQ(updated.scenarios.size(), expected.scenarios.size());
+    for (size_t s = 0; s < expected.scenarios.size(); ++s) {
+        EXPECT_NEAR(updated.scenarios[s].pnl, expected.scenarios[s].pnl, 1e-6) << s;
+    }
+    EXPECT_NEAR(updated.worst_loss, expected.worst_loss, 1e-6);
+}
+
+TEST_F(ScenarioRiskTest, LongCallIsWorstOnSpotAndVolDown) {
+    ScenarioRiskEngine engine;
+    engine.setPosition("call", spec("BTC-A", Type::CALL, 100.0, 30), 1.0);
+    engine.updateMark("call", 100.0, 0.5);
+
+    auto result = engine.getResult();
+    ASSERT_EQ(result.scenarios.size(), 41u * 3u);
+    const auto& worst = result.scenarios[result.worst_scenario];
+    EXPECT_DOUBLE_EQ(worst.spot_shock, -0.2);
+    EXPECT_DOUBLE_EQ(worst.vol_shock, -0.05);
+    EXPECT_GT(result.worst_loss, 0.0);
+}
+
+TEST_F(ScenarioRiskTest, PreTradeCheckMatchesBookAfterFill) {
+    const std::string held = "BTC-27DEC30-100-C";
+    const std::string other = "BTC-27DEC30-90-P";
+
+    auto build = [&](double held_quantity, double other_quantity) {
+        auto engine = std::make_unique<ScenarioRiskEngine>(smallGrid());
+        engine->setPosition(held, held_quantity);
+        engine->setPosition(other, other_quantity);
+        engine->updateMark(held, 100.0, 0.6);
+        engine->updateMark(other, 100.0, 0.7);
+        engine->refresh(now_);
+        return engine;
+    };
+    auto after = [&](double held_quantity, double other_quantity) {
+        return build(held_quantity, other_quantity)->getWorstLoss();
+    };
+
+    auto book = build(-2.0, 0.0);
+    // Selling more of the held call, and buying a put the book never held
+    EXPECT_NEAR(book->worstLossWith(held, -3.0).after, after(-5.0, 0.0), 1e-6);
+    EXPECT_NEAR(book->worstLossWith(other, 4.0).after, after(-2.0, 4.0), 1e-6);
+
+    // Nothing to price: the book's own loss
+    const double current = book->getWorstLoss();
+    EXPECT_GT(current, 0.0);
+    EXPECT_DOUBLE_EQ(book->worstLossWith("BTC-PERPETUAL", 10.0).after, current);
+    EXPECT_DOUBLE_EQ(book->worstLossWith("BTC-27DEC30-80-C", 10.0).after, current);
+
+    // The check never refreshes: an unpublished change is invisible to it
+    book->setPosition(held, -50.0);
+    const auto loss = book->worstLossWith(other, 4.0);
+    EXPECT_DOUBLE_EQ(loss.before, current);
+    EXPECT_NEAR(loss.after, after(-2.0, 4.0), 1e-6);
+}
+
+TEST_F(ScenarioRiskTest, RefresherPublishesInputChanges) {
+    ScenarioRiskEngine engine(smallGrid());
+    engine.start();
+
+    auto waitForLoss = [&](double expected) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        // Valuation times differ by the refresh delay, hence the tolerance
+        while (std::abs(engine.getWorstLoss() - expected) > 1e-4) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    };
+    auto expected = [&](double quantity, double vol) {
+        ScenarioRiskEngine reference(smallGrid());
+        reference.setPosition("BTC-27DEC30-100-P", quantity);
+        reference.updateMark("BTC-27DEC30-100-P", 100.0, vol);
+        reference.refresh();
+        return reference.getWorstLoss();
+    };
+
+    // A position, then a mark, then a resize each reach the published grid
+    // with no caller refreshing
+    engine.setPosition("BTC-27DEC30-100-P", -1.0);
+    engine.updateMark("BTC-27DEC30-100-P", 100.0, 0.8);
+    EXPECT_TRUE(waitForLoss(expected(-1.0, 0.8)));
+    engine.updateMark("BTC-27DEC30-100-P", 100.0, 0.9);
+    EXPECT_TRUE(waitForLoss(expected(-1.0, 0.9)));
+    engine.setPosition("BTC-27DEC30-100-P", -3.0);
+    EXPECT_TRUE(waitForLoss(expected(-3.0, 0.9)));
+
+    engine.stop();
+    engine.setPosition("BTC-27DEC30-100-P", 0.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_GT(engine.getWorstLoss(), 0.0);
+}
+
+TEST_F(ScenarioRiskTest, UnpricedAndClosedPositionsCarryNoRisk) {
+    ScenarioRiskEngine engine(smallGrid());
+    EXPECT_FALSE(engine.setPosition("BTC-PERPETUAL", 1.0));
+    ASSERT_TRUE(engine.setPosition("BTC-27DEC30-100-P", -1.0));
+
+    auto result = engine.getResult();
+    EXPECT_EQ(result.unpriced, 1u);
+    EXPECT_EQ(result.worst_loss, 0.0);
+
+    engine.updateMark("BTC-27DEC30-100-P", 100.0, 0.8);
+    EXPECT_GT(engine.getResult().worst_loss, 0.0);
+
+    engine.setPosition("BTC-27DEC30-100-P", 0.0);
+    result = engine.getResult();
+    EXPECT_EQ(result.positions, 0u);
+    EXPECT_EQ(result.worst_loss, 0.0);
+}
+
+TEST_F(ScenarioRiskTest, RejectsInvalidGrid) {
+    ScenarioRiskEngine::GridConfig grid;
+    EXPECT_THROW(ScenarioRiskEngine engine(grid), std::invalid_argument);
+    grid.spot_shocks = {-1.0};
+    grid.vol_shocks = {0.0};
+    EXPECT_THROW(ScenarioRiskEngine engine(grid), std::invalid_argument);
+}
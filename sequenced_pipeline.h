@@ -0,0 +1,286 @@
+#ifndef SEQUENCED_PIPELINE_H
+#define SEQUENCED_PIPELINE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <exception>
+#include <cstdint>
+#include "cpu_accounting.h"
+#include "error_handler.h"
+
+// Pins the calling thread to one logical CPU; false where unsupported or
+// the CPU does not exist
+bool pinCurrentThread(int cpu);
+
+// Disruptor-style pipeline: one preallocated ring of event slots, a single
+// producer, and consumer stages that each run on their own thread. A stage
+// sees event n only after every stage it depends on has finished with it,
+// so stages without a path between them (journaling next to book apply, say)
+// run in parallel and never delay each other. Stages drain everything that
+// is available in one batch and publish their progress once per batch. The
+// producer waits only when the slowest stage is a full ring behind.
+//
+// Every event carries its global sequence number, starting at 0. Slots are
+// reused, so handlers must treat an event as valid only for the call.
+template <typename Event>
+class SequencedPipeline {
+public:
+    // end_of_batch is true for the last event of the batch being drained,
+    // the place to flush buffered output
+    using Handler = std::function<void(Event& event, uint64_t sequence, bool end_of_batch)>;
+
+    struct StageStats {
+        std::string name;
+        uint64_t processed;
+        uint64_t batches;
+        uint64_t max_batch;
+        uint64_t errors;
+    };
+
+    // capacity must be a power of two
+    explicit SequencedPipeline(size_t capacity)
+        : slots_(capacity), mask_(capacity - 1) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("Pipeline capacity must be a power of two");
+        }
+    }
+
+    ~SequencedPipeline() {
+        stop();
+    }
+
+    SequencedPipeline(const SequencedPipeline&) = delete;
+    SequencedPipeline& operator=(const SequencedPipeline&) = delete;
+
+    // Stages are added before start(); dependencies must name earlier stages,
+    // which keeps the graph acyclic. cpu < 0 leaves the thread unpinned.
+    size_t addStage(const std::string& name, Handler handler,
+                    const std::vector<size_t>& depends_on = {}, int cpu = -1) {
+        if (started_) {
+            throw std::logic_error("Stages must be added before the pipeline starts");
+        }
+        for (size_t dependency : depends_on) {
+            if (dependency >= stages_.size()) {
+                throw std::invalid_argument("Stage " + name + " depends on an unknown stage");
+            }
+        }
+        auto stage = std::make_unique<Stage>();
+        stage->name = name;
+        stage->handler = std::move(handler);
+        stage->depends_on = depends_on;
+        stage->cpu = cpu;
+        stages_.push_back(std::move(stage));
+        return stages_.size() - 1;
+    }
+
+    // Spreads one stage over several threads: worker i handles the events
+    // whose sequence is i modulo workers and steps over the rest. A stage
+    // that depends on every returned index sees the results in sequence
+    // order, so parallel work is reassembled without a reorder buffer.
+    // Workers are pinned to first_cpu, first_cpu + 1, ... when first_cpu >= 0.
+    std::vector<size_t> addWorkerPool(const std::string& name, Handler handler, size_t workers,
+                                      const std::vector<size_t>& depends_on = {}, int first_cpu = -1) {
+        if (workers == 0) {
+            throw std::invalid_argument("Worker pool " + name + " needs at least one worker");
+        }
+        auto shared = std::make_shared<Handler>(std::move(handler));
+        std::vector<size_t> indices;
+        indices.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            indices.push_back(addStage(name + "/" + std::to_string(i),
+                [shared, i, workers](Event& event, uint64_t sequence, bool end_of_batch) {
+                    if (sequence % workers == i) {
+                        (*shared)(event, sequence, end_of_batch);
+                    }
+                },
+                depends_on, first_cpu < 0 ? -1 : first_cpu + static_cast<int>(i)));
+        }
+        return indices;
+    }
+
+    void start() {
+        if (started_) {
+            return;
+        }
+        if (stages_.empty()) {
+            throw std::logic_error("Pipeline has no stages");
+        }
+        started_ = true;
+        running_.store(true, std::memory_order_release);
+        for (auto& stage : stages_) {
+            Stage* raw = stage.get();
+            stage->thread = std::thread([this, raw] { runStage(*raw); });
+        }
+    }
+
+    // Returns once every stage has consumed everything already published.
+    // Must not run concurrently with publish().
+    void stop() {
+        if (!running_.exchange(false, std::memory_order_acq_rel)) {
+            return;
+        }
+        for (auto& stage : stages_) {
+            if (stage->thread.joinable()) {
+                stage->thread.join();
+            }
+        }
+    }
+
+    // Single producer. fill(Event&) writes the claimed slot in place; the
+    // event becomes visible to stages when it returns.
+    template <typename Fill>
+    uint64_t publish(Fill&& fill) {
+        const uint64_t sequence = next_sequence_;
+        // The slot is free once every stage has moved past its previous use
+        if (sequence >= cached_gate_ + slots_.size()) {
+            Backoff backoff;
+            while (sequence >= (cached_gate_ = minimumCursor()) + slots_.size()) {
+                backoff.pause();
+            }
+        }
+
+        fill(slots_[sequence & mask_]);
+        next_sequence_ = sequence + 1;
+        published_.value.store(next_sequence_, std::memory_order_release);
+        return sequence;
+    }
+
+    uint64_t getPublished() const {
+        return published_.value.load(std::memory_order_acquire);
+    }
+
+    // Events stage has finished with
+    uint64_t getProcessed(size_t stage) const {
+        return stages_.at(stage)->cursor.value.load(std::memory_order_acquire);
+    }
+
+    size_t getCapacity() const { return slots_.size(); }
+
+    std::vector<StageStats> getStageStats() const {
+        std::vector<StageStats> stats;
+        stats.reserve(stages_.size());
+        for (const auto& stage : stages_) {
+            stats.push_back({stage->name,
+                             stage->cursor.value.load(std::memory_order_acquire),
+                             stage->batches.load(std::memory_order_relaxed),
+                             stage->max_batch.load(std::memory_order_relaxed),
+                             stage->errors.load(std::memory_order_relaxed)});
+        }
+        return stats;
+    }
+
+private:
+    // Own cache line each, so a stage publishing progress does not slow
+    // down its neighbours' reads
+    struct alignas(64) Cursor {
+        std::atomic<uint64_t> value{0};
+    };
+
+    struct Stage {
+        std::string name;
+        Handler handler;
+        std::vector<size_t> depends_on;
+        int cpu{-1};
+        Cursor cursor;  // Events [0, cursor) are done
+        std::atomic<uint64_t> batches{0};
+        std::atomic<uint64_t> max_batch{0};
+        std::atomic<uint64_t> errors{0};
+        std::thread thread;
+    };
+
+    // Spin, then yield, then sleep: low wake-up latency under load without
+    // burning a core on an idle feed
+    class Backoff {
+    public:
+        void pause() {
+            if (spins_ < 128) {
+                spins_++;
+            } else if (spins_ < 1024) {
+                spins_++;
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+
+        void reset() { spins_ = 0; }
+
+    private:
+        uint32_t spins_{0};
+    };
+
+    uint64_t minimumCursor() const {
+        uint64_t minimum = next_sequence_;
+        for (const auto& stage : stages_) {
+            minimum = std::min(minimum, stage->cursor.value.load(std::memory_order_acquire));
+        }
+        return minimum;
+    }
+
+    void runStage(Stage& stage) {
+        CpuAccounting::ThreadRegistration registration("pipeline/" + stage.name);
+        if (stage.cpu >= 0 && !pinCurrentThread(stage.cpu)) {
+            LOG_WARNING("Could not pin stage " + stage.name + " to CPU " + std::to_string(stage.cpu),
+                        "SequencedPipeline");
+        }
+
+        uint64_t next = 0;
+        Backoff backoff;
+        for (;;) {
+            // Read the stop flag first: a producer stores its last event
+            // before stopping, so the bound read below then includes it
+            const bool stopping = !running_.load(std::memory_order_acquire);
+
+            uint64_t available = published_.value.load(std::memory_order_acquire);
+            for (size_t dependency : stage.depends_on) {
+                available = std::min(available, stages_[dependency]->cursor.value.load(std::memory_order_acquire));
+            }
+
+            if (available > next) {
+                for (uint64_t sequence = next; sequence < available; ++sequence) {
+                    try {
+                        stage.handler(slots_[sequence & mask_], sequence, sequence + 1 == available);
+                    } catch (const std::exception& e) {
+                        // One bad event must not stall every stage behind this one
+                        stage.errors.fetch_add(1, std::memory_order_relaxed);
+                        LOG_WARNING("Stage " + stage.name + " failed on event " + std::to_string(sequence) + ": " +
+                                    e.what(), "SequencedPipeline");
+                    }
+                }
+                const uint64_t batch = available - next;
+                stage.batches.fetch_add(1, std::memory_order_relaxed);
+                if (batch > stage.max_batch.load(std::memory_order_relaxed)) {
+                    stage.max_batch.store(batch, std::memory_order_relaxed);
+                }
+                next = available;
+                stage.cursor.value.store(next, std::memory_order_release);
+                backoff.reset();
+                continue;
+            }
+
+            if (stopping && next == published_.value.load(std::memory_order_acquire)) {
+                return;
+            }
+            backoff.pause();
+        }
+    }
+
+    std::vector<Event> slots_;
+    const uint64_t mask_;
+    std::vector<std::unique_ptr<Stage>> stages_;
+    bool started_{false};
+    std::atomic<bool> running_{false};
+
+    Cursor published_;             // Events [0, published) are visible
+    uint64_t next_sequence_{0};    // Producer only
+    uint64_t cached_gate_{0};      // Producer only: last seen slowest cursor
+};
+
+#endif // SEQUENCED_PIPELINE_H
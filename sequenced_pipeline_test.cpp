@@ -0,0 +1,178 @@
+#include "sequenced_pipeline.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class SequencedPipelineTest : public ::testing::Test {
+protected:
+    struct Event {
+        uint64_t value{0};
+        uint64_t decoded{0};
+    };
+};
+
+TEST_F(SequencedPipelineTest, EveryStageSeesEveryEventInOrder) {
+    SequencedPipeline<Event> pipeline(16);
+    std::vector<uint64_t> decode_seen;
+    std::vector<uint64_t> apply_seen;
+    std::vector<uint64_t> journal_seen;
+    std::atomic<uint64_t> mismatches{0};
+
+    size_t decode = pipeline.addStage("decode", [&](Event& event, uint64_t sequence, bool) {
+        decode_seen.push_back(sequence);
+        event.decoded = event.value * 2;
+    });
+    pipeline.addStage("apply", [&](Event& event, uint64_t sequence, bool) {
+        apply_seen.push_back(sequence);
+        // Runs behind decode, so its write is visible
+        if (event.decoded != event.value * 2) mismatches++;
+    }, {decode});
+    pipeline.addStage("journal", [&](Event& event, uint64_t sequence, bool) {
+        journal_seen.push_back(sequence);
+        if (event.value != sequence + 100) mismatches++;
+    });
+    pipeline.start();
+
+    const uint64_t count = 1000;  // Wraps the ring many times
+    for (uint64_t i = 0; i < count; ++i) {
+        EXPECT_EQ(pipeline.publish([i](Event& event) { event.value = i + 100; }), i);
+    }
+    pipeline.stop();
+
+    EXPECT_EQ(mismatches.load(), 0u);
+    for (const auto* seen : {&decode_seen, &apply_seen, &journal_seen}) {
+        ASSERT_EQ(seen->size(), count);
+        for (uint64_t i = 0; i < count; ++i) {
+            ASSERT_EQ((*seen)[i], i);
+        }
+    }
+    for (const auto& stats : pipeline.getStageStats()) {
+        EXPECT_EQ(stats.processed, count) << stats.name;
+        EXPECT_LE(stats.max_batch, pipeline.getCapacity()) << stats.name;
+    }
+}
+
+TEST_F(SequencedPipelineTest, EndOfBatchClosesEveryBatch) {
+    SequencedPipeline<Event> pipeline(64);
+    uint64_t ends = 0;
+    bool last_was_end = false;
+    pipeline.addStage("journal", [&](Event&, uint64_t, bool end_of_batch) {
+        if (end_of_batch) ends++;
+        last_was_end = end_of_batch;
+    });
+    pipeline.start();
+    for (int i = 0; i < 5000; ++i) {
+        pipeline.publish([](Event&) {});
+    }
+    pipeline.stop();
+
+    EXPECT_TRUE(last_was_end);
+    EXPECT_EQ(ends, pipeline.getStageStats()[0].batches);
+}
+
+TEST_F(SequencedPipelineTest, SlowStageHoldsBackTheProducer) {
+    SequencedPipeline<Event> pipeline(4);
+    std::atomic<bool> release{false};
+    pipeline.addStage("slow", [&](Event&, uint64_t, bool) {
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    pipeline.start();
+
+    std::thread producer([&] {
+        for (int i = 0; i < 10; ++i) {
+            pipeline.publish([i](Event& event) { event.value = i; });
+        }
+    });
+
+    // The first event is stuck in the handler, so the ring fills and stays full
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(pipeline.getPublished(), pipeline.getCapacity());
+    EXPECT_EQ(pipeline.getProcessed(0), 0u);
+
+    release = true;
+    producer.join();
+    pipeline.stop();
+    EXPECT_EQ(pipeline.getProcessed(0), 10u);
+}
+
+TEST_F(SequencedPipelineTest, FailedEventIsCountedAndSkipped) {
+    SequencedPipeline<Event> pipeline(8);
+    std::vector<uint64_t> applied;
+    size_t decode = pipeline.addStage("decode", [](Event& event, uint64_t, bool) {
+        if (event.value == 3) {
+            throw std::runtime_error("bad message");
+        }
+    });
+    pipeline.addStage("apply", [&](Event&, uint64_t sequence, bool) { applied.push_back(sequence); }, {decode});
+    pipeline.start();
+    for (uint64_t i = 0; i < 6; ++i) {
+        pipeline.publish([i](Event& event) { event.value = i; });
+    }
+    pipeline.stop();
+
+    auto stats = pipeline.getStageStats();
+    EXPECT_EQ(stats[0].errors, 1u);
+    // Downstream still gets every sequence; it is the stage's job to ignore
+    // what its upstream could not handle
+    EXPECT_EQ(applied.size(), 6u);
+}
+
+TEST_F(SequencedPipelineTest, WorkerPoolReassemblesInSequenceOrder) {
+    SequencedPipeline<Event> pipeline(64);
+    const size_t workers = 4;
+    std::vector<std::atomic<uint64_t>> per_worker(workers);
+    std::atomic<uint64_t> violations{0};
+
+    auto decoders = pipeline.addWorkerPool("decode", [&](Event& event, uint64_t sequence, bool) {
+        per_worker[sequence % workers]++;
+        event.decoded = event.value * 2;
+    }, workers);
+    ASSERT_EQ(decoders.size(), workers);
+
+    // Per-instrument order: the apply stage checks each instrument's events
+    // arrive with increasing values, the way book updates must
+    std::vector<uint64_t> last_value(8, 0);
+    std::vector<uint64_t> applied;
+    pipeline.addStage("apply", [&](Event& event, uint64_t sequence, bool) {
+        if (event.decoded != event.value * 2) violations++;
+        uint64_t& last = last_value[sequence % last_value.size()];
+        if (event.value <= last) violations++;
+        last = event.value;
+        applied.push_back(sequence);
+    }, decoders);
+    pipeline.start();
+
+    const uint64_t count = 4000;
+    for (uint64_t i = 0; i < count; ++i) {
+        pipeline.publish([i](Event& event) { event.value = i + 1; });
+    }
+    pipeline.stop();
+
+    EXPECT_EQ(violations.load(), 0u);
+    ASSERT_EQ(applied.size(), count);
+    for (uint64_t i = 0; i < count; ++i) {
+        ASSERT_EQ(applied[i], i);
+    }
+    for (size_t i = 0; i < workers; ++i) {
+        EXPECT_EQ(per_worker[i].load(), count / workers);
+    }
+    EXPECT_THROW(SequencedPipeline<Event>(8).addWorkerPool("none", [](Event&, uint64_t, bool) {}, 0),
+                 std::invalid_argument);
+}
+
+TEST_F(SequencedPipelineTest, RejectsInvalidConfiguration) {
+    EXPECT_THROW(SequencedPipeline<Event>(0), std::invalid_argument);
+    EXPECT_THROW(SequencedPipeline<Event>(12), std::invalid_argument);
+
+    SequencedPipeline<Event> pipeline(8);
+    EXPECT_THROW(pipeline.start(), std::logic_error);
+    EXPECT_THROW(pipeline.addStage("apply", [](Event&, uint64_t, bool) {}, {0}), std::invalid_argument);
+
+    pipeline.addStage("decode", [](Event&, uint64_t, bool) {});
+    pipeline.start();
+    EXPECT_THROW(pipeline.addStage("late", [](Event&, uint64_t, bool) {}), std::logic_error);
+    pipeline.stop();
+}
@@ -0,0 +1,376 @@
+#include "session_manager.h"
+#include "websocket_handler.h"
+#include "trade_execution.h"
+#include "risk_manager.h"
+#include "cpu_accounting.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// ---------------------------------------------------------------------------
+// AccountSession
+// ---------------------------------------------------------------------------
+
+AccountSession::AccountSession(const Config& config)
+    : config_(config) {
+    auto now = std::chrono::steady_clock::now();
+    order_bucket_ = {config_.order_rate.capacity, now};
+    request_bucket_ = {config_.request_rate.capacity, now};
+}
+
+AccountSession::~AccountSession() {
+    stop();
+}
+
+bool AccountSession::start() {
+    if (running_) {
+        return true;
+    }
+
+    try {
+        websocket_ = std::make_unique<WebSocketHandler>(config_.host, config_.port, config_.endpoint);
+        websocket_->connect();
+        execution_ = std::make_unique<TradeExecution>(*websocket_);
+
+        scheduleRefresh(execution_->authenticate(config_.client_id, config_.client_secret));
+        if (config_.cancel_on_disconnect) {
+            execution_->enableCancelOnDisconnect();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Account " << config_.name << " failed to start: " << e.what() << std::endl;
+        execution_.reset();
+        websocket_.reset();
+        return false;
+    }
+
+    running_ = true;
+    worker_thread_ = std::thread(&AccountSession::workerLoop, this);
+    return true;
+}
+
+void AccountSession::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    queue_cv_.notify_all();
+    if (worker_thread_.joinable()) {
+        worker_thread_.join();
+    }
+
+    if (websocket_) {
+        websocket_->close();
+    }
+    execution_.reset();
+    websocket_.reset();
+}
+
+bool AccountSession::placeOrder(const std::string& instrument, const std::string& side, double amount,
+                                double price, ResponseCallback callback) {
+    const bool is_buy = side == "buy";
+    if (!is_buy && side != "sell") {
+        risk_rejected_++;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(limits_mutex_);
+        if (!checkOrderLocked(instrument, is_buy, amount, price)) {
+            risk_rejected_++;
+            return false;
+        }
+    }
+
+    return enqueue([this, instrument, is_buy, amount, price, callback]() {
+        auto response = is_buy ? execution_->placeBuyOrder(instrument, amount, price)
+                               : execution_->placeSellOrder(instrument, amount, price);
+        onOrderResponse(response);
+        if (callback) callback(response);
+    }, true);
+}
+
+bool AccountSession::cancelOrder(const std::string& order_id, ResponseCallback callback) {
+    return enqueue([this, order_id, callback]() {
+        auto response = execution_->cancelOrder(order_id);
+        onOrderResponse(response);
+        if (callback) callback(response);
+    }, true);
+}
+
+bool AccountSession::modifyOrder(const std::string& order_id, double new_price, double new_amount,
+                                 ResponseCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(limits_mutex_);
+        auto it = open_orders_.find(order_id);
+        if (it == open_orders_.end() ||
+            !checkOrderLocked(it->second.instrument, it->second.is_buy, new_amount, new_price)) {
+            risk_rejected_++;
+            return false;
+        }
+    }
+
+    return enqueue([this, order_id, new_price, new_amount, callback]() {
+        auto response = execution_->modifyOrder(order_id, new_price, new_amount);
+        onOrderResponse(response);
+        if (callback) callback(response);
+    }, true);
+}
+
+bool AccountSession::getPositions(ResponseCallback callback) {
+    return enqueue([this, callback]() {
+        auto response = execution_->getPositions();
+        if (response.contains("result") && response["result"].is_array()) {
+            for (const auto& position : response["result"]) {
+                if (position.contains("instrument_name") && position.contains("size")) {
+                    updatePosition(position["instrument_name"].get<std::string>(), position["size"].get<double>());
+                }
+            }
+        }
+        if (callback) callback(response);
+    }, false);
+}
+
+void AccountSession::setRiskLimits(const RiskLimits& limits) {
+    std::lock_guard<std::mutex> lock(limits_mutex_);
+    config_.risk = limits;
+}
+
+void AccountSession::updatePosition(const std::string& instrument, double size) {
+    std::lock_guard<std::mutex> lock(limits_mutex_);
+    if (size == 0.0) {
+        positions_.erase(instrument);
+    } else {
+        positions_[instrument] = size;
+    }
+}
+
+void AccountSession::trackOrder(const std::string& order_id, const std::string& instrument, bool is_buy) {
+    std::lock_guard<std::mutex> lock(limits_mutex_);
+    open_orders_[order_id] = {instrument, is_buy};
+}
+
+AccountSession::Stats AccountSession::getStats() const {
+    return {
+        requests_sent_.load(),
+        rate_limited_.load(),
+        risk_rejected_.load(),
+        token_refreshes_.load(),
+        errors_.load()
+    };
+}
+
+bool AccountSession::TokenBucket::tryAcquire(const RateLimit& limit, std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - last_refill).count();
+    tokens = std::min(limit.capacity, tokens + elapsed * limit.refill_per_second);
+    last_refill = now;
+
+    if (tokens < 1.0) {
+        return false;
+    }
+    tokens -= 1.0;
+    return true;
+}
+
+void AccountSession::TokenBucket::refund(const RateLimit& limit) {
+    tokens = std::min(limit.capacity, tokens + 1.0);
+}
+
+bool AccountSession::checkOrderLocked(const std::string& instrument, bool is_buy, double amount, double price) {
+    // Written so that a NaN amount or price fails
+    if (!(amount > 0.0 && amount <= config_.risk.max_order_size &&
+          std::abs(amount * price) <= config_.risk.max_order_notional)) {
+        return false;
+    }
+
+    auto it = positions_.find(instrument);
+    const double position = it != positions_.end() ? it->second : 0.0;
+
+    // The full process-wide check still applies on top of the account
+    // limits: collar, position, loss, exposure and scenario limits. Only
+    // the instrument notional is this account's own.
+    return RiskManager::getInstance().checkOrderRisk(instrument, amount, price, is_buy, position);
+}
+
+void AccountSession::onOrderResponse(const nlohmann::json& response) {
+    if (!response.contains("result") || !response["result"].is_object()) {
+        return;
+    }
+    // buy, sell and edit wrap the order; cancel returns it bare
+    const auto& result = response["result"];
+    const auto& order = result.contains("order") ? result["order"] : result;
+    if (!order.contains("order_id") || !order["order_id"].is_string()) {
+        return;
+    }
+
+    const std::string order_id = order["order_id"].get<std::string>();
+    const std::string state = order.value("order_state", "");
+    if ((state == "open" || state == "untriggered") && order.contains("instrument_name")) {
+        trackOrder(order_id, order["instrument_name"].get<std::string>(), order.value("direction", "") == "buy");
+    } else {
+        std::lock_guard<std::mutex> lock(limits_mutex_);
+        open_orders_.erase(order_id);
+    }
+}
+
+bool AccountSession::enqueue(std::function<void()> task, bool is_order) {
+    // A stopped session must not drain the rate budget
+    if (!running_) {
+        return false;
+    }
+
+    size_t max_queued;
+    {
+        std::lock_guard<std::mutex> lock(limits_mutex_);
+        auto now = std::chrono::steady_clock::now();
+        bool allowed = is_order ? order_bucket_.tryAcquire(config_.order_rate, now)
+                                : request_bucket_.tryAcquire(config_.request_rate, now);
+        if (!allowed) {
+            rate_limited_++;
+            return false;
+        }
+        max_queued = config_.risk.max_queued_requests;
+    }
+
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (running_ && queue_.size() < max_queued) {
+            queue_.push_back(std::move(task));
+            queued = true;
+        }
+    }
+    if (!queued) {
+        // Nothing was sent, so give the token back
+        std::lock_guard<std::mutex> lock(limits_mutex_);
+        if (is_order) {
+            order_bucket_.refund(config_.order_rate);
+        } else {
+            request_bucket_.refund(config_.request_rate);
+        }
+        return false;
+    }
+    queue_cv_.notify_one();
+    return true;
+}
+
+void AccountSession::workerLoop() {
+    CpuAccounting::ThreadRegistration cpu_registration("session/" + config_.name);
+    while (true) {
+        std::function<void()> task;
+        bool refresh_due = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait_until(lock, refresh_due_, [this] {
+                return !running_ || !queue_.empty();
+            });
+            if (!running_) {
+                break;
+            }
+
+            // The token refresh shares the socket, so it is just another
+            // step of this loop rather than a separate thread
+            refresh_due = std::chrono::steady_clock::now() >= refresh_due_;
+            if (!refresh_due && !queue_.empty()) {
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+        }
+
+        try {
+            if (refresh_due) {
+                refreshToken();
+            } else if (task) {
+                task();
+                requests_sent_++;
+            }
+        } catch (const std::exception& e) {
+            errors_++;
+            std::cerr << "Account " << config_.name << " request failed: " << e.what() << std::endl;
+        }
+    }
+}
+
+void AccountSession::scheduleRefresh(const nlohmann::json& auth_result) {
+    refresh_token_ = auth_result.value("refresh_token", refresh_token_);
+    double expires_in = auth_result.value("expires_in", 900.0);
+    auto lifetime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(expires_in * config_.token_refresh_fraction));
+    refresh_due_ = std::chrono::steady_clock::now() + lifetime;
+}
+
+void AccountSession::refreshToken() {
+    try {
+        scheduleRefresh(execution_->refreshToken(refresh_token_));
+        token_refreshes_++;
+    } catch (...) {
+        // Retry shortly rather than spinning on a failing refresh
+        refresh_due_ = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        throw;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SessionManager
+// ---------------------------------------------------------------------------
+
+SessionManager::~SessionManager() {
+    stopAll();
+}
+
+bool SessionManager::addAccount(const AccountSession::Config& config) {
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        if (sessions_.count(config.name)) {
+            return false;
+        }
+    }
+
+    // Connect outside the lock so accounts can be brought up concurrently
+    auto session = std::make_unique<AccountSession>(config);
+    if (!session->start()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    return sessions_.emplace(config.name, std::move(session)).second;
+}
+
+void SessionManager::removeAccount(const std::string& name) {
+    std::unique_ptr<AccountSession> session;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        auto it = sessions_.find(name);
+        if (it == sessions_.end()) {
+            return;
+        }
+        session = std::move(it->second);
+        sessions_.erase(it);
+    }
+    session->stop();
+}
+
+void SessionManager::stopAll() {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    for (auto& [_, session] : sessions_) {
+        session->stop();
+    }
+}
+
+AccountSession* SessionManager::getSession(const std::string& name) {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    auto it = sessions_.find(name);
+    return it == sessions_.end() ? nullptr : it->second.get();
+}
+
+std::vector<std::string> SessionManager::getAccountNames() const {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    std::vector<std::string> names;
+    names.reserve(sessions_.size());
+    for (const auto& [name, _] : sessions_) {
+        names.push_back(name);
+    }
+    return names;
+}
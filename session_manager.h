@@ -0,0 +1,172 @@
+#ifndef SESSION_MANAGER_H
+#define SESSION_MANAGER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include <nlohmann/json.hpp>
+
+class WebSocketHandler;
+class TradeExecution;
+
+// One authenticated trading connection for one (sub-)account. Every socket
+// operation for the account runs on its own worker thread, so accounts trade
+// in parallel while each connection still sees strictly ordered requests.
+// Rate limits and risk limits are checked on the caller's thread before a
+// request is queued. Market data is not handled here; all accounts share the
+// process-wide DeribitClient / MarketDataManager pipeline.
+class AccountSession {
+public:
+    struct RateLimit {
+        double capacity{20.0};        // Burst size in requests
+        double refill_per_second{5.0};
+    };
+
+    struct RiskLimits {
+        double max_order_size{10.0};
+        double max_order_notional{1000000.0};
+        size_t max_queued_requests{1000};
+    };
+
+    struct Config {
+        std::string name;
+        std::string client_id;
+        std::string client_secret;
+        std::string host{"test.deribit.com"};
+        std::string port{"443"};
+        std::string endpoint{"/ws/api/v2"};
+        RateLimit order_rate;         // Matching-engine requests: buy, sell, edit, cancel
+        RateLimit request_rate;       // Everything else
+        RiskLimits risk;
+        double token_refresh_fraction{0.8};  // Refresh after this share of the token lifetime
+        bool cancel_on_disconnect{true};
+    };
+
+    // Refills continuously up to the burst capacity; one token per request
+    struct TokenBucket {
+        double tokens{0.0};
+        std::chrono::steady_clock::time_point last_refill;
+
+        bool tryAcquire(const RateLimit& limit, std::chrono::steady_clock::time_point now);
+        void refund(const RateLimit& limit);
+    };
+
+    struct Stats {
+        uint64_t requests_sent;
+        uint64_t rate_limited;
+        uint64_t risk_rejected;
+        uint64_t token_refreshes;
+        uint64_t errors;
+    };
+
+    using ResponseCallback = std::function<void(const nlohmann::json&)>;
+
+    explicit AccountSession(const Config& config);
+    ~AccountSession();
+
+    AccountSession(const AccountSession&) = delete;
+    AccountSession& operator=(const AccountSession&) = delete;
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running_.load(); }
+    const std::string& getName() const { return config_.name; }
+
+    // Return false when rejected locally (bad side, rate limit, risk limit,
+    // queue full or session stopped); the callback then never runs
+    bool placeOrder(const std::string& instrument, const std::string& side, double amount, double price,
+                    ResponseCallback callback = nullptr);
+    bool cancelOrder(const std::string& order_id, ResponseCallback callback = nullptr);
+    // Only orders this session knows the instrument of can be edited, so the
+    // process-wide collar can run on the new price
+    bool modifyOrder(const std::string& order_id, double new_price, double new_amount,
+                     ResponseCallback callback = nullptr);
+    bool getPositions(ResponseCallback callback);
+
+    void setRiskLimits(const RiskLimits& limits);
+    // This account's position, used for the instrument notional limit in
+    // place of the process-wide one. getPositions responses update it too.
+    void updatePosition(const std::string& instrument, double size);
+    // Records an open order for modifyOrder. placeOrder responses do this
+    // automatically; orders placed elsewhere can be registered here.
+    void trackOrder(const std::string& order_id, const std::string& instrument, bool is_buy);
+    Stats getStats() const;
+
+private:
+    struct OpenOrder {
+        std::string instrument;
+        bool is_buy;
+    };
+
+    // Runs the account limits and the process-wide collar; caller holds
+    // limits_mutex_
+    bool checkOrderLocked(const std::string& instrument, bool is_buy, double amount, double price);
+    // Tracks or forgets the order in a buy, sell, edit or cancel response
+    void onOrderResponse(const nlohmann::json& response);
+    bool enqueue(std::function<void()> task, bool is_order);
+    void workerLoop();
+    void scheduleRefresh(const nlohmann::json& auth_result);
+    void refreshToken();
+
+    Config config_;
+    std::unique_ptr<WebSocketHandler> websocket_;
+    std::unique_ptr<TradeExecution> execution_;
+
+    std::string refresh_token_;
+    std::chrono::steady_clock::time_point refresh_due_;
+
+    std::mutex limits_mutex_;
+    TokenBucket order_bucket_;
+    TokenBucket request_bucket_;
+    std::map<std::string, double> positions_;
+    std::map<std::string, OpenOrder> open_orders_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<std::function<void()>> queue_;
+    std::atomic<bool> running_{false};
+    std::thread worker_thread_;
+
+    std::atomic<uint64_t> requests_sent_{0};
+    std::atomic<uint64_t> rate_limited_{0};
+    std::atomic<uint64_t> risk_rejected_{0};
+    std::atomic<uint64_t> token_refreshes_{0};
+    std::atomic<uint64_t> errors_{0};
+};
+
+class SessionManager {
+public:
+    static SessionManager& getInstance() {
+        static SessionManager instance;
+        return instance;
+    }
+
+    // Starts the session immediately; returns false if the name is taken or
+    // the connection cannot be authenticated
+    bool addAccount(const AccountSession::Config& config);
+    void removeAccount(const std::string& name);
+    void stopAll();
+
+    // Sessions stay valid until removed
+    AccountSession* getSession(const std::string& name);
+    std::vector<std::string> getAccountNames() const;
+
+private:
+    SessionManager() = default;
+    ~SessionManager();
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    mutable std::mutex sessions_mutex_;
+    std::map<std::string, std::unique_ptr<AccountSession>> sessions_;
+};
+
+#endif // SESSION_MANAGER_H
@@ -0,0 +1,140 @@
+#include "session_manager.h"
+#include "risk_manager.h"
+#include "config_manager.h"
+#include <gtest/gtest.h>
+#include <chrono>
+
+// Sessions here are never started, so nothing touches the network. The local
+// risk checks run before a request is queued, and a request that passes them
+// is then refused only because the session is stopped.
+class SessionManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        saved_config_ = ConfigManager::getInstance().getTradingConfig();
+        auto config = saved_config_;
+        config.price_band_pct = 0.01;
+        config.price_band_ticks = 0;
+        config.max_order_notional = 0.0;
+        config.max_instrument_notional = 0.0;
+        // Process-wide limits wide enough that only the account limits and
+        // the collar decide, unless a test tightens them
+        config.max_position_size = 1e6;
+        config.max_order_size = 1e6;
+        config.max_loss_per_trade = 1e6;
+        config.max_daily_loss = 1e6;
+        ConfigManager::getInstance().setTradingConfig(config);
+        RiskManager::getInstance().refreshLimits();
+
+        config_.name = "test-account";
+        config_.risk.max_order_size = 10.0;
+        config_.risk.max_order_notional = 5000.0;
+    }
+
+    void TearDown() override {
+        ConfigManager::getInstance().setTradingConfig(saved_config_);
+        RiskManager::getInstance().refreshLimits();
+    }
+
+    ConfigManager::TradingConfig saved_config_;
+    AccountSession::Config config_;
+};
+
+TEST_F(SessionManagerTest, TokenBucketRefillsUpToCapacity) {
+    AccountSession::RateLimit limit{2.0, 4.0};
+    auto start = std::chrono::steady_clock::now();
+    AccountSession::TokenBucket bucket{limit.capacity, start};
+
+    EXPECT_TRUE(bucket.tryAcquire(limit, start));
+    EXPECT_TRUE(bucket.tryAcquire(limit, start));
+    EXPECT_FALSE(bucket.tryAcquire(limit, start));
+
+    // A quarter second at 4/s is one token
+    EXPECT_TRUE(bucket.tryAcquire(limit, start + std::chrono::milliseconds(250)));
+    EXPECT_FALSE(bucket.tryAcquire(limit, start + std::chrono::milliseconds(250)));
+
+    // A long idle period refills only to the burst size
+    auto later = start + std::chrono::seconds(10);
+    EXPECT_TRUE(bucket.tryAcquire(limit, later));
+    EXPECT_TRUE(bucket.tryAcquire(limit, later));
+    EXPECT_FALSE(bucket.tryAcquire(limit, later));
+
+    bucket.refund(limit);
+    bucket.refund(limit);
+    bucket.refund(limit);
+    EXPECT_DOUBLE_EQ(bucket.tokens, limit.capacity);
+}
+
+TEST_F(SessionManagerTest, BadSideIsRejectedNotThrown) {
+    AccountSession session(config_);
+    EXPECT_FALSE(session.placeOrder("SM-SIDE", "hold", 1.0, 100.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 1u);
+}
+
+TEST_F(SessionManagerTest, AccountLimitsRejectBeforeQueueing) {
+    AccountSession session(config_);
+    RiskManager::getInstance().onMarkUpdate("SM-LIMITS", 100.0);
+
+    EXPECT_FALSE(session.placeOrder("SM-LIMITS", "buy", 11.0, 100.0));   // size
+    EXPECT_FALSE(session.placeOrder("SM-LIMITS", "buy", 10.0, 600.0));   // notional
+    EXPECT_FALSE(session.placeOrder("SM-LIMITS", "sell", 0.0, 100.0));   // empty
+    EXPECT_EQ(session.getStats().risk_rejected, 3u);
+
+    // Within limits: refused only because the session is stopped
+    EXPECT_FALSE(session.placeOrder("SM-LIMITS", "buy", 10.0, 100.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 3u);
+    EXPECT_EQ(session.getStats().rate_limited, 0u);
+
+    // Tightened limits apply to the next order
+    AccountSession::RiskLimits limits = config_.risk;
+    limits.max_order_size = 5.0;
+    session.setRiskLimits(limits);
+    EXPECT_FALSE(session.placeOrder("SM-LIMITS", "buy", 10.0, 100.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 4u);
+}
+
+TEST_F(SessionManagerTest, ProcessWideLimitsStillApply) {
+    AccountSession session(config_);
+    RiskManager::getInstance().onMarkUpdate("SM-GLOBAL", 100.0);
+
+    // Within the account limits, but over the process-wide loss limit
+    auto config = ConfigManager::getInstance().getTradingConfig();
+    config.max_loss_per_trade = 500.0;
+    ConfigManager::getInstance().setTradingConfig(config);
+
+    EXPECT_FALSE(session.placeOrder("SM-GLOBAL", "buy", 10.0, 100.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 1u);
+    EXPECT_FALSE(session.placeOrder("SM-GLOBAL", "buy", 4.0, 100.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 1u);
+}
+
+TEST_F(SessionManagerTest, PlaceOrderRunsTheCollar) {
+    AccountSession session(config_);
+    RiskManager::getInstance().onMarkUpdate("SM-COLLAR", 100.0);
+
+    EXPECT_FALSE(session.placeOrder("SM-COLLAR", "buy", 1.0, 102.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 1u);
+    EXPECT_FALSE(session.placeOrder("SM-COLLAR", "buy", 1.0, 100.5));
+    EXPECT_EQ(session.getStats().risk_rejected, 1u);
+
+    // No mark yet, so the collar has nothing to check against
+    EXPECT_FALSE(session.placeOrder("SM-COLLAR-UNMARKED", "buy", 1.0, 100.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 2u);
+}
+
+TEST_F(SessionManagerTest, ModifyOrderRunsTheCollar) {
+    AccountSession session(config_);
+    RiskManager::getInstance().onMarkUpdate("SM-EDIT", 100.0);
+
+    // Unknown orders cannot be checked, so they are not edited
+    EXPECT_FALSE(session.modifyOrder("SM-UNKNOWN", 100.0, 1.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 1u);
+
+    session.trackOrder("SM-ORDER-1", "SM-EDIT", true);
+    EXPECT_FALSE(session.modifyOrder("SM-ORDER-1", 102.0, 1.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 2u);
+    EXPECT_FALSE(session.modifyOrder("SM-ORDER-1", 100.5, 11.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 3u);
+
+    EXPECT_FALSE(session.modifyOrder("SM-ORDER-1", 100.5, 1.0));
+    EXPECT_EQ(session.getStats().risk_rejected, 3u);
+}
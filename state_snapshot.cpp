@@ -0,0 +1,293 @@
+#include "state_snapshot.h"
+#include "error_handler.h"
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'H', 'F', 'T', 'S', 'N', 'A', 'P', '1'};
+constexpr size_t HEADER_SIZE = 8 + 4 + 4 + 8 + 4;
+
+uint32_t crc32(const char* data, size_t length) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> entries{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+        return entries;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+StateSnapshotManager::~StateSnapshotManager() {
+    bool was_running;
+    {
+        // Under the wake lock, so the writer cannot miss the notify
+        // between checking running_ and starting to wait
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        was_running = running_.exchange(false);
+    }
+    if (was_running) {
+        wake_.notify_all();
+        if (writer_thread_.joinable()) {
+            writer_thread_.join();
+        }
+    }
+}
+
+void StateSnapshotManager::registerSection(const std::string& name, uint32_t version,
+                                           Capture capture, Restore restore) {
+    std::lock_guard<std::mutex> lock(sections_mutex_);
+    auto it = std::find_if(sections_.begin(), sections_.end(),
+                           [&name](const Section& section) { return section.name == name; });
+    if (it != sections_.end()) {
+        *it = {name, version, std::move(capture), std::move(restore)};
+    } else {
+        sections_.push_back({name, version, std::move(capture), std::move(restore)});
+    }
+}
+
+void StateSnapshotManager::unregisterSection(const std::string& name) {
+    std::lock_guard<std::mutex> lock(sections_mutex_);
+    sections_.erase(std::remove_if(sections_.begin(), sections_.end(),
+                                   [&name](const Section& section) { return section.name == name; }),
+                    sections_.end());
+}
+
+void StateSnapshotManager::configure(const Config& config) {
+    if (config.path.empty()) {
+        throw std::invalid_argument("Snapshot path must not be empty");
+    }
+    if (config.interval.count() <= 0) {
+        throw std::invalid_argument("Snapshot interval must be positive");
+    }
+    std::lock_guard<std::mutex> lock(sections_mutex_);
+    config_ = config;
+}
+
+bool StateSnapshotManager::writeSnapshot() {
+    std::vector<Section> sections;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(sections_mutex_);
+        sections = sections_;
+        path = config_.path;
+    }
+
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    const auto capture_start = std::chrono::steady_clock::now();
+
+    SnapshotWriter body;
+    uint32_t written = 0;
+    for (const auto& section : sections) {
+        SnapshotWriter payload;
+        try {
+            section.capture(payload);
+        } catch (const std::exception& e) {
+            LOG_WARNING("Snapshot section '" + section.name + "' failed: " + e.what(), "StateSnapshotManager");
+            continue;
+        }
+        body.putString(section.name);
+        body.putU32(section.version);
+        body.putTime(payload.dataTime());
+        body.putU64(payload.data().size());
+        body.putRaw(payload.data().data(), payload.data().size());
+        written++;
+    }
+
+    const auto capture_end = std::chrono::steady_clock::now();
+
+    SnapshotWriter header;
+    header.putRaw(FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.putU32(FORMAT_VERSION);
+    header.putU32(written);
+    header.putI64(nowNanos());
+    header.putU32(crc32(body.data().data(), body.data().size()));
+
+    // Write aside and rename so readers never see a partial file
+    const std::string temp_path = path + ".tmp";
+    bool ok = false;
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (file.is_open()) {
+            file.write(header.data().data(), header.data().size());
+            file.write(body.data().data(), body.data().size());
+            file.flush();
+            ok = file.good();
+        }
+    }
+    if (ok) {
+        std::error_code ec;
+        std::filesystem::rename(temp_path, path, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        std::error_code ec;
+        std::filesystem::remove(temp_path, ec);
+        LOG_WARNING("Failed to write state snapshot to " + path, "StateSnapshotManager");
+    }
+
+    const auto write_end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    if (ok) {
+        stats_.snapshots_written++;
+        stats_.last_bytes = header.data().size() + body.data().size();
+        stats_.last_capture_time = std::chrono::duration_cast<std::chrono::microseconds>(capture_end - capture_start);
+        stats_.last_write_time = std::chrono::duration_cast<std::chrono::microseconds>(write_end - capture_end);
+    } else {
+        stats_.write_failures++;
+    }
+    return ok;
+}
+
+StateSnapshotManager::RestoreResult StateSnapshotManager::restore() {
+    RestoreResult result;
+    std::vector<Section> sections;
+    Config config;
+    {
+        std::lock_guard<std::mutex> lock(sections_mutex_);
+        sections = sections_;
+        config = config_;
+    }
+
+    std::ifstream file(config.path, std::ios::binary);
+    if (!file.is_open()) {
+        result.reason = "no snapshot at " + config.path;
+        return result;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        result.reason = "not a snapshot file";
+        return result;
+    }
+
+    SnapshotReader header(data.data() + sizeof(FILE_MAGIC), data.data() + HEADER_SIZE);
+    const uint32_t version = header.getU32();
+    const uint32_t section_count = header.getU32();
+    const int64_t created_ns = header.getI64();
+    const uint32_t checksum = header.getU32();
+
+    if (version != FORMAT_VERSION) {
+        result.reason = "unsupported format version " + std::to_string(version);
+        return result;
+    }
+    if (crc32(data.data() + HEADER_SIZE, data.size() - HEADER_SIZE) != checksum) {
+        result.reason = "checksum mismatch";
+        return result;
+    }
+
+    const auto age = std::chrono::nanoseconds(nowNanos() - created_ns);
+    result.age = std::chrono::duration_cast<std::chrono::milliseconds>(age);
+    if (age < std::chrono::nanoseconds(0) || age > config.max_age) {
+        result.reason = "stale snapshot (age " + std::to_string(result.age.count()) + " ms)";
+        return result;
+    }
+
+    SnapshotReader body(data.data() + HEADER_SIZE, data.data() + data.size());
+    try {
+        for (uint32_t i = 0; i < section_count; ++i) {
+            const std::string name = body.getString();
+            const uint32_t section_version = body.getU32();
+            const int64_t data_ns = body.getI64();
+            const uint64_t length = body.getU64();
+            if (length > body.remaining()) {
+                throw std::runtime_error("Corrupt snapshot: section '" + name + "' overruns the file");
+            }
+            const char* payload = body.skip(static_cast<size_t>(length));
+
+            auto it = std::find_if(sections.begin(), sections.end(),
+                                   [&name](const Section& section) { return section.name == name; });
+            if (it == sections.end() || it->version != section_version) {
+                result.skipped.push_back(name);
+                continue;
+            }
+            if (data_ns != 0 && std::chrono::nanoseconds(nowNanos() - data_ns) > config.max_age) {
+                LOG_WARNING("Snapshot section '" + name + "' not restored: data is older than max_age",
+                            "StateSnapshotManager");
+                result.skipped.push_back(name);
+                continue;
+            }
+
+            SnapshotReader reader(payload, payload + length);
+            try {
+                it->restore(reader);
+                result.sections.push_back(name);
+            } catch (const std::exception& e) {
+                LOG_WARNING("Snapshot section '" + name + "' not restored: " + e.what(), "StateSnapshotManager");
+                result.skipped.push_back(name);
+            }
+        }
+    } catch (const std::exception& e) {
+        result.reason = e.what();
+        result.restored = !result.sections.empty();
+        return result;
+    }
+
+    result.restored = true;
+    return result;
+}
+
+void StateSnapshotManager::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    writer_thread_ = std::thread(&StateSnapshotManager::writerLoop, this);
+}
+
+void StateSnapshotManager::stop() {
+    {
+        // See the destructor: cleared under the wake lock
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        if (!running_.exchange(false)) {
+            return;
+        }
+    }
+    wake_.notify_all();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+    writeSnapshot();
+}
+
+void StateSnapshotManager::writerLoop() {
+    while (running_) {
+        std::chrono::milliseconds interval;
+        {
+            std::lock_guard<std::mutex> lock(sections_mutex_);
+            interval = config_.interval;
+        }
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait_for(lock, interval, [this] { return !running_; });
+        }
+        if (!running_) {
+            break;
+        }
+        writeSnapshot();
+    }
+}
+
+StateSnapshotManager::Stats StateSnapshotManager::getStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
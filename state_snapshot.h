@@ -0,0 +1,229 @@
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// Little-endian, length-prefixed encoding used by snapshot sections
+class SnapshotWriter {
+public:
+    void putU8(uint8_t value) { buffer_.push_back(static_cast<char>(value)); }
+    void putU32(uint32_t value) { putFixed(value); }
+    void putU64(uint64_t value) { putFixed(value); }
+    void putI64(int64_t value) { putFixed(value); }
+    void putDouble(double value) { putFixed(value); }
+    void putBool(bool value) { putU8(value ? 1 : 0); }
+
+    void putString(const std::string& value) {
+        putU32(static_cast<uint32_t>(value.size()));
+        buffer_.append(value);
+    }
+
+    // Unprefixed bytes
+    void putRaw(const char* data, size_t length) { buffer_.append(data, length); }
+
+    void putTime(std::chrono::system_clock::time_point value) {
+        putI64(std::chrono::duration_cast<std::chrono::nanoseconds>(value.time_since_epoch()).count());
+    }
+
+    // Records the time of the data being written; the section keeps the
+    // newest. Restore checks max_age against it rather than the file time.
+    void noteDataTime(std::chrono::system_clock::time_point value) {
+        if (value > data_time_) {
+            data_time_ = value;
+        }
+    }
+    std::chrono::system_clock::time_point dataTime() const { return data_time_; }
+
+    const std::string& data() const { return buffer_; }
+    std::string release() { return std::move(buffer_); }
+
+private:
+    template <typename T>
+    void putFixed(T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        buffer_.append(bytes, sizeof(T));
+    }
+
+    std::string buffer_;
+    std::chrono::system_clock::time_point data_time_{};
+};
+
+// Bounds-checked reader; throws std::runtime_error on truncated input
+class SnapshotReader {
+public:
+    SnapshotReader(const char* begin, const char* end) : pos_(begin), end_(end) {}
+
+    uint8_t getU8() { return getFixed<uint8_t>(); }
+    uint32_t getU32() { return getFixed<uint32_t>(); }
+    uint64_t getU64() { return getFixed<uint64_t>(); }
+    int64_t getI64() { return getFixed<int64_t>(); }
+    double getDouble() { return getFixed<double>(); }
+    bool getBool() { return getU8() != 0; }
+
+    std::string getString() {
+        uint32_t length = getU32();
+        require(length);
+        std::string value(pos_, length);
+        pos_ += length;
+        return value;
+    }
+
+    std::chrono::system_clock::time_point getTime() {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(getI64())));
+    }
+
+    // Returns the start of the next length bytes and moves past them
+    const char* skip(size_t length) {
+        require(length);
+        const char* start = pos_;
+        pos_ += length;
+        return start;
+    }
+
+    // Element counts are checked against the bytes left so corrupt input
+    // cannot trigger huge allocations
+    uint32_t getCount(size_t min_element_size) {
+        uint32_t count = getU32();
+        if (min_element_size && count > remaining() / min_element_size) {
+            throw std::runtime_error("Corrupt snapshot: element count exceeds section size");
+        }
+        return count;
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end_ - pos_); }
+    bool atEnd() const { return pos_ == end_; }
+
+private:
+    void require(size_t length) const {
+        if (remaining() < length) {
+            throw std::runtime_error("Corrupt snapshot: truncated section");
+        }
+    }
+
+    template <typename T>
+    T getFixed() {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    const char* pos_;
+    const char* end_;
+};
+
+// Periodically writes warm in-memory state to one binary file so that a
+// restart can trade before the feed has rebuilt books, tapes and rolling
+// statistics. Each component registers a named, versioned section. Capture
+// callbacks copy their state under the component's own lock and encode the
+// copy after releasing it, so the hot path is blocked only for the copy. The
+// file is written to a temporary name and renamed over the previous one, so
+// a crash mid-write always leaves the last complete snapshot in place.
+//
+// File layout:
+//   header   "HFTSNAP1", u32 format version, u32 section count,
+//            i64 created (ns since epoch), u32 crc32 of everything after it
+//   sections string name, u32 section version, i64 data time (ns since
+//            epoch, 0 if none), u64 payload length, payload
+//
+// Restore rejects the whole file on a bad magic, format version, checksum or
+// an age beyond max_age. Sections are skipped and left to rebuild from the
+// feed when their version differs from the registered one or their data time
+// is older than max_age. The file is rewritten every interval even when no
+// data arrives, so only the data time says how old a section's contents are;
+// sections without one (cumulative statistics) are bound by the file age.
+class StateSnapshotManager {
+public:
+    using Capture = std::function<void(SnapshotWriter&)>;
+    using Restore = std::function<void(SnapshotReader&)>;
+
+    static constexpr uint32_t FORMAT_VERSION = 2;
+
+    struct Config {
+        std::string path{"state.snapshot"};
+        std::chrono::milliseconds interval{std::chrono::seconds(30)};
+        std::chrono::milliseconds max_age{std::chrono::minutes(10)};
+    };
+
+    struct RestoreResult {
+        bool restored{false};
+        std::string reason;                     // Why the file was rejected
+        std::vector<std::string> sections;      // Restored
+        std::vector<std::string> skipped;       // Version mismatch, stale data or decode error
+        std::chrono::milliseconds age{0};
+    };
+
+    struct Stats {
+        uint64_t snapshots_written;
+        uint64_t write_failures;
+        uint64_t last_bytes;
+        std::chrono::microseconds last_capture_time;  // Time spent in capture callbacks
+        std::chrono::microseconds last_write_time;
+    };
+
+    static StateSnapshotManager& getInstance() {
+        static StateSnapshotManager instance;
+        return instance;
+    }
+
+    // Sections are written in registration order; registering a name again
+    // replaces the previous callbacks
+    void registerSection(const std::string& name, uint32_t version, Capture capture, Restore restore);
+    void unregisterSection(const std::string& name);
+
+    void configure(const Config& config);
+    // Restores from the configured path; call before the feed starts
+    RestoreResult restore();
+    // Writes immediately on the calling thread
+    bool writeSnapshot();
+
+    // Background writes every interval; stop() writes one final snapshot
+    void start();
+    void stop();
+
+    Stats getStats() const;
+
+private:
+    StateSnapshotManager() = default;
+    ~StateSnapshotManager();
+    StateSnapshotManager(const StateSnapshotManager&) = delete;
+    StateSnapshotManager& operator=(const StateSnapshotManager&) = delete;
+
+    struct Section {
+        std::string name;
+        uint32_t version;
+        Capture capture;
+        Restore restore;
+    };
+
+    void writerLoop();
+
+    mutable std::mutex sections_mutex_;
+    std::vector<Section> sections_;
+    Config config_;
+
+    std::mutex write_mutex_;  // Serializes writers of the snapshot file
+
+    std::thread writer_thread_;
+    std::atomic<bool> running_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+
+    mutable std::mutex stats_mutex_;
+    Stats stats_{};
+};
+
+#endif // STATE_SNAPSHOT_H
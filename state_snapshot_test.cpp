@@ -0,0 +1,238 @@
+#include "state_snapshot.h"
+#include "strategy_statistics.h"
+#include "market_data_manager.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+class StateSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        StateSnapshotManager::Config config;
+        config.path = path_;
+        manager().configure(config);
+    }
+
+    void TearDown() override {
+        for (const char* name : {"alpha", "beta", "market_data"}) {
+            manager().unregisterSection(name);
+        }
+        manager().configure(StateSnapshotManager::Config());
+        std::remove(path_.c_str());
+    }
+
+    static StateSnapshotManager& manager() {
+        return StateSnapshotManager::getInstance();
+    }
+
+    const std::string path_{"state_snapshot_test.bin"};
+};
+
+TEST_F(StateSnapshotTest, RoundTripsSections) {
+    manager().registerSection("alpha", 1,
+        [](SnapshotWriter& writer) {
+            writer.putString("BTC-PERPETUAL");
+            writer.putDouble(42000.5);
+            writer.putU64(7);
+        },
+        [](SnapshotReader&) {});
+    manager().registerSection("beta", 3,
+        [](SnapshotWriter& writer) { writer.putBool(true); },
+        [](SnapshotReader&) {});
+    ASSERT_TRUE(manager().writeSnapshot());
+    EXPECT_GT(manager().getStats().snapshots_written, 0u);
+
+    std::string instrument;
+    double price = 0.0;
+    uint64_t count = 0;
+    bool flag = false;
+    manager().registerSection("alpha", 1, nullptr, [&](SnapshotReader& reader) {
+        instrument = reader.getString();
+        price = reader.getDouble();
+        count = reader.getU64();
+    });
+    manager().registerSection("beta", 3, nullptr, [&](SnapshotReader& reader) { flag = reader.getBool(); });
+
+    auto result = manager().restore();
+    ASSERT_TRUE(result.restored) << result.reason;
+    EXPECT_EQ(result.sections, (std::vector<std::string>{"alpha", "beta"}));
+    EXPECT_TRUE(result.skipped.empty());
+    EXPECT_EQ(instrument, "BTC-PERPETUAL");
+    EXPECT_DOUBLE_EQ(price, 42000.5);
+    EXPECT_EQ(count, 7u);
+    EXPECT_TRUE(flag);
+}
+
+TEST_F(StateSnapshotTest, SkipsSectionsWithOtherVersions) {
+    manager().registerSection("alpha", 1, [](SnapshotWriter& writer) { writer.putU32(1); }, nullptr);
+    manager().registerSection("beta", 1, [](SnapshotWriter& writer) { writer.putU32(2); }, nullptr);
+    ASSERT_TRUE(manager().writeSnapshot());
+
+    bool alpha_restored = false;
+    bool beta_restored = false;
+    manager().registerSection("alpha", 2, nullptr, [&](SnapshotReader&) { alpha_restored = true; });
+    manager().registerSection("beta", 1, nullptr, [&](SnapshotReader&) { beta_restored = true; });
+
+    auto result = manager().restore();
+    ASSERT_TRUE(result.restored);
+    EXPECT_FALSE(alpha_restored);
+    EXPECT_TRUE(beta_restored);
+    EXPECT_EQ(result.skipped, (std::vector<std::string>{"alpha"}));
+}
+
+TEST_F(StateSnapshotTest, TruncatedSectionIsSkipped) {
+    manager().registerSection("alpha", 1, [](SnapshotWriter& writer) { writer.putU32(5); }, nullptr);
+    manager().registerSection("beta", 1, [](SnapshotWriter& writer) { writer.putU32(6); }, nullptr);
+    ASSERT_TRUE(manager().writeSnapshot());
+
+    uint32_t beta = 0;
+    manager().registerSection("alpha", 1, nullptr, [](SnapshotReader& reader) { reader.getU64(); });
+    manager().registerSection("beta", 1, nullptr, [&](SnapshotReader& reader) { beta = reader.getU32(); });
+
+    auto result = manager().restore();
+    ASSERT_TRUE(result.restored);
+    EXPECT_EQ(result.skipped, (std::vector<std::string>{"alpha"}));
+    EXPECT_EQ(beta, 6u);
+}
+
+TEST_F(StateSnapshotTest, RejectsStaleSnapshot) {
+    StateSnapshotManager::Config config;
+    config.path = path_;
+    config.max_age = std::chrono::milliseconds(1);
+    manager().configure(config);
+
+    bool restored = false;
+    manager().registerSection("alpha", 1, [](SnapshotWriter& writer) { writer.putU32(1); },
+                              [&](SnapshotReader&) { restored = true; });
+    ASSERT_TRUE(manager().writeSnapshot());
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto result = manager().restore();
+    EXPECT_FALSE(result.restored);
+    EXPECT_FALSE(restored);
+    EXPECT_NE(result.reason.find("stale"), std::string::npos);
+}
+
+TEST_F(StateSnapshotTest, SkipsSectionsWithStaleDataInAFreshFile) {
+    // The file is rewritten while no data arrives, so only the data time
+    // tells how old a section is
+    const auto old_data = std::chrono::system_clock::now() - std::chrono::hours(1);
+    manager().registerSection("alpha", 1, [&](SnapshotWriter& writer) {
+        writer.noteDataTime(old_data);
+        writer.putU32(1);
+    }, nullptr);
+    manager().registerSection("beta", 1, [](SnapshotWriter& writer) {
+        writer.noteDataTime(std::chrono::system_clock::now());
+        writer.putU32(2);
+    }, nullptr);
+    ASSERT_TRUE(manager().writeSnapshot());
+    ASSERT_TRUE(manager().writeSnapshot());
+
+    bool alpha_restored = false;
+    uint32_t beta = 0;
+    manager().registerSection("alpha", 1, nullptr, [&](SnapshotReader&) { alpha_restored = true; });
+    manager().registerSection("beta", 1, nullptr, [&](SnapshotReader& reader) { beta = reader.getU32(); });
+
+    auto result = manager().restore();
+    ASSERT_TRUE(result.restored) << result.reason;
+    EXPECT_FALSE(alpha_restored);
+    EXPECT_EQ(beta, 2u);
+    EXPECT_EQ(result.skipped, (std::vector<std::string>{"alpha"}));
+}
+
+TEST_F(StateSnapshotTest, RejectsCorruptFile) {
+    bool restored = false;
+    manager().registerSection("alpha", 1, [](SnapshotWriter& writer) { writer.putDouble(1.5); },
+                              [&](SnapshotReader&) { restored = true; });
+    ASSERT_TRUE(manager().writeSnapshot());
+
+    {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('\x7f');
+    }
+
+    auto result = manager().restore();
+    EXPECT_FALSE(result.restored);
+    EXPECT_FALSE(restored);
+    EXPECT_EQ(result.reason, "checksum mismatch");
+}
+
+TEST_F(StateSnapshotTest, MissingFileIsAColdStart) {
+    std::remove(path_.c_str());
+    auto result = manager().restore();
+    EXPECT_FALSE(result.restored);
+    EXPECT_NE(result.reason.find(path_), std::string::npos);
+}
+
+TEST_F(StateSnapshotTest, RestoredStatisticsContinueIdentically) {
+    using Clock = std::chrono::system_clock;
+    auto at = [](int64_t ms) { return Clock::time_point(std::chrono::milliseconds(1700000000000LL + ms)); };
+
+    StrategyStatistics::Config config;
+    config.bucket = std::chrono::milliseconds(1000);
+    config.max_curve_points = 16;
+
+    StrategyStatistics original(config);
+    for (int i = 0; i < 500; ++i) {
+        original.onFill(at(i * 137), (i % 7) - 2.5);
+    }
+
+    SnapshotWriter writer;
+    original.save(writer);
+    StrategyStatistics restored(config);
+    SnapshotReader reader(writer.data().data(), writer.data().data() + writer.data().size());
+    restored.restore(reader);
+    EXPECT_TRUE(reader.atEnd());
+
+    for (int i = 500; i < 1000; ++i) {
+        original.onFill(at(i * 137), (i % 5) - 1.5);
+        restored.onFill(at(i * 137), (i % 5) - 1.5);
+    }
+
+    auto a = original.snapshot();
+    auto b = restored.snapshot();
+    EXPECT_DOUBLE_EQ(a.equity, b.equity);
+    EXPECT_DOUBLE_EQ(a.max_drawdown, b.max_drawdown);
+    EXPECT_DOUBLE_EQ(a.mean_return, b.mean_return);
+    EXPECT_DOUBLE_EQ(a.stddev_return, b.stddev_return);
+    EXPECT_EQ(a.return_samples, b.return_samples);
+    EXPECT_EQ(a.fills, b.fills);
+    EXPECT_EQ(original.equityCurve().size(), restored.equityCurve().size());
+
+    // A different bucket size cannot be continued
+    config.bucket = std::chrono::milliseconds(2000);
+    StrategyStatistics other(config);
+    SnapshotReader again(writer.data().data(), writer.data().data() + writer.data().size());
+    EXPECT_THROW(other.restore(again), std::runtime_error);
+}
+
+TEST_F(StateSnapshotTest, MarketDataRestoreKeepsNewerFeedData) {
+    auto& market_data = MarketDataManager::getInstance();
+    const std::string instrument = "SNAPSHOT-TEST-PERP";
+
+    MarketDataManager::OrderBook stale;
+    stale.instrument = instrument;
+    stale.bids = {{100.0, 1.0, std::chrono::system_clock::now()}};
+    stale.asks = {{101.0, 1.0, std::chrono::system_clock::now()}};
+    market_data.updateOrderBook(stale);
+
+    manager().registerSection("market_data", MarketDataManager::SNAPSHOT_VERSION,
+        [](SnapshotWriter& writer) { MarketDataManager::getInstance().saveSnapshot(writer); },
+        [](SnapshotReader& reader) { MarketDataManager::getInstance().restoreSnapshot(reader); });
+    ASSERT_TRUE(manager().writeSnapshot());
+
+    // The feed moves on after the snapshot was taken
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    MarketDataManager::OrderBook fresh = stale;
+    fresh.bids = {{200.0, 2.0, std::chrono::system_clock::now()}};
+    fresh.asks = {{201.0, 2.0, std::chrono::system_clock::now()}};
+    market_data.updateOrderBook(fresh);
+
+    auto result = manager().restore();
+    ASSERT_TRUE(result.restored) << result.reason;
+    EXPECT_EQ(result.sections, (std::vector<std::string>{"market_data"}));
+    EXPECT_DOUBLE_EQ(market_data.getBestBid(instrument), 200.0);
+    EXPECT_DOUBLE_EQ(market_data.getBestAsk(instrument), 201.0);
+}
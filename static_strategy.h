@@ -0,0 +1,181 @@
+#ifndef STATIC_STRATEGY_H
+#define STATIC_STRATEGY_H
+
+#include <array>
+#include <tuple>
+#include <memory>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include "market_data_manager.h"
+#include "risk_manager.h"
+
+// Compile-time strategy composition. A signal and any number of filters are
+// combined into one ComposedStrategy type, so evaluating a tick is a single
+// inlinable function with no std::function or virtual call between the
+// parts. The only indirect call left is StrategyTickHandler::onTick, the
+// boundary through which StrategyManager runs a composed strategy from its
+// runtime registry.
+//
+// Signals are callables double(const StrategyTick&): positive means buy,
+// and the magnitude is compared with the entry threshold. Filters are
+// callables bool(const StrategyTick&, const StrategyDecision&) and run in
+// order until one rejects.
+
+// One tick as a strategy sees it, with the top of book derived once
+struct StrategyTick {
+    const MarketDataManager::MarketData& data;
+    double best_bid;
+    double best_ask;
+    double mid;
+    double spread;
+};
+
+struct StrategyDecision {
+    double size{0.0};
+    double price{0.0};
+    bool is_buy{false};
+};
+
+class StrategyTickHandler {
+public:
+    virtual ~StrategyTickHandler() = default;
+    // True when the strategy wants to trade; decision is filled in then
+    virtual bool onTick(const MarketDataManager::MarketData& data, StrategyDecision& decision) = 0;
+};
+
+// CRTP base: Derived provides bool decide(const StrategyTick&, StrategyDecision&)
+template <typename Derived>
+class StaticStrategy : public StrategyTickHandler {
+public:
+    // Direct entry for callers that hold the concrete type; fully inlinable
+    bool process(const MarketDataManager::MarketData& data, StrategyDecision& decision) {
+        const auto& book = data.orderbook;
+        if (book.bids.empty() || book.asks.empty()) {
+            return false;
+        }
+        const double best_bid = book.bids.front().price;
+        const double best_ask = book.asks.front().price;
+        const StrategyTick tick{data, best_bid, best_ask, 0.5 * (best_bid + best_ask), best_ask - best_bid};
+        return static_cast<Derived*>(this)->decide(tick, decision);
+    }
+
+    bool onTick(const MarketDataManager::MarketData& data, StrategyDecision& decision) final {
+        return process(data, decision);
+    }
+};
+
+template <typename Signal, typename... Filters>
+class ComposedStrategy : public StaticStrategy<ComposedStrategy<Signal, Filters...>> {
+public:
+    ComposedStrategy(double entry_threshold, double size, Signal signal, Filters... filters)
+        : entry_threshold_(entry_threshold), size_(size),
+          signal_(std::move(signal)), filters_(std::move(filters)...) {}
+
+    bool decide(const StrategyTick& tick, StrategyDecision& decision) {
+        const double score = signal_(tick);
+        if (!(std::abs(score) > entry_threshold_)) {
+            return false;
+        }
+        decision.is_buy = score > 0.0;
+        decision.size = size_;
+        decision.price = tick.data.last_price;
+        return std::apply([&](auto&... filter) { return (filter(tick, decision) && ...); }, filters_);
+    }
+
+    Signal& signal() { return signal_; }
+
+    template <size_t I>
+    auto& filter() { return std::get<I>(filters_); }
+
+private:
+    double entry_threshold_;
+    double size_;
+    Signal signal_;
+    std::tuple<Filters...> filters_;
+};
+
+template <typename Signal, typename... Filters>
+std::unique_ptr<ComposedStrategy<Signal, Filters...>> makeStrategy(double entry_threshold, double size,
+                                                                   Signal signal, Filters... filters) {
+    return std::make_unique<ComposedStrategy<Signal, Filters...>>(entry_threshold, size, std::move(signal),
+                                                                   std::move(filters)...);
+}
+
+// Signals
+
+// Last trade against mid: buys below mid, sells above, like the built-in
+// StrategyManager evaluation
+struct MeanReversionSignal {
+    double operator()(const StrategyTick& tick) const {
+        return tick.mid > 0.0 ? (tick.mid - tick.data.last_price) / tick.mid : 0.0;
+    }
+};
+
+// Size imbalance of the best levels, in [-1, 1]
+struct BookImbalanceSignal {
+    double operator()(const StrategyTick& tick) const {
+        const double bid_size = tick.data.orderbook.bids.front().size;
+        const double ask_size = tick.data.orderbook.asks.front().size;
+        const double total = bid_size + ask_size;
+        return total > 0.0 ? (bid_size - ask_size) / total : 0.0;
+    }
+};
+
+// Weighted sum of several signals, unrolled at compile time
+template <typename... Signals>
+class WeightedSignal {
+public:
+    WeightedSignal(std::array<double, sizeof...(Signals)> weights, Signals... signals)
+        : weights_(weights), signals_(std::move(signals)...) {}
+
+    double operator()(const StrategyTick& tick) const {
+        return sum(tick, std::index_sequence_for<Signals...>());
+    }
+
+private:
+    template <size_t... I>
+    double sum(const StrategyTick& tick, std::index_sequence<I...>) const {
+        return ((weights_[I] * std::get<I>(signals_)(tick)) + ... + 0.0);
+    }
+
+    std::array<double, sizeof...(Signals)> weights_;
+    std::tuple<Signals...> signals_;
+};
+
+// Filters
+
+// Skips wide markets; the limit is a fraction of mid
+struct MaxSpreadFilter {
+    double max_spread;
+
+    bool operator()(const StrategyTick& tick, const StrategyDecision&) const {
+        return tick.spread <= max_spread * tick.mid;
+    }
+};
+
+// Counts the decisions it lets through, so place it last
+struct TradeLimitFilter {
+    int max_trades;
+    int trades{0};
+
+    bool operator()(const StrategyTick&, const StrategyDecision&) {
+        if (trades >= max_trades) {
+            return false;
+        }
+        trades++;
+        return true;
+    }
+};
+
+// RiskManager's lock-free collar and notional check by instrument id
+struct RiskFilter {
+    uint32_t instrument_id;
+
+    bool operator()(const StrategyTick&, const StrategyDecision& decision) const {
+        return RiskManager::getInstance().checkOrderRisk(instrument_id, decision.size, decision.price,
+                                                         decision.is_buy);
+    }
+};
+
+#endif // STATIC_STRATEGY_H
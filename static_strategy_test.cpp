@@ -0,0 +1,78 @@
+#include "static_strategy.h"
+#include <gtest/gtest.h>
+
+class StaticStrategyTest : public ::testing::Test {
+protected:
+    static MarketDataManager::MarketData tick(double bid, double ask, double last,
+                                              double bid_size = 1.0, double ask_size = 1.0) {
+        MarketDataManager::MarketData data;
+        data.orderbook.bids.push_back({bid, bid_size, {}});
+        data.orderbook.asks.push_back({ask, ask_size, {}});
+        data.last_price = last;
+        return data;
+    }
+};
+
+TEST_F(StaticStrategyTest, MeanReversionTradesAgainstTheMove) {
+    auto strategy = makeStrategy(0.001, 2.0, MeanReversionSignal());
+    StrategyDecision decision;
+
+    // Last trade 0.5% above mid: sell it
+    ASSERT_TRUE(strategy->process(tick(99.9, 100.1, 100.5), decision));
+    EXPECT_FALSE(decision.is_buy);
+    EXPECT_DOUBLE_EQ(decision.size, 2.0);
+    EXPECT_DOUBLE_EQ(decision.price, 100.5);
+
+    ASSERT_TRUE(strategy->process(tick(99.9, 100.1, 99.5), decision));
+    EXPECT_TRUE(decision.is_buy);
+
+    // Inside the threshold, or no book to price against
+    EXPECT_FALSE(strategy->process(tick(99.9, 100.1, 100.05), decision));
+    MarketDataManager::MarketData empty;
+    empty.last_price = 50.0;
+    EXPECT_FALSE(strategy->process(empty, decision));
+}
+
+TEST_F(StaticStrategyTest, FiltersRunInOrderUntilOneRejects) {
+    auto strategy = makeStrategy(0.001, 1.0, MeanReversionSignal(), MaxSpreadFilter{0.01}, TradeLimitFilter{2});
+    StrategyDecision decision;
+
+    // 5% wide: rejected by the spread filter before the limit counts it
+    EXPECT_FALSE(strategy->process(tick(97.5, 102.5, 105.0), decision));
+    EXPECT_EQ(strategy->filter<1>().trades, 0);
+
+    EXPECT_TRUE(strategy->process(tick(99.9, 100.1, 100.5), decision));
+    EXPECT_TRUE(strategy->process(tick(99.9, 100.1, 100.5), decision));
+    EXPECT_FALSE(strategy->process(tick(99.9, 100.1, 100.5), decision));
+    EXPECT_EQ(strategy->filter<1>().trades, 2);
+}
+
+TEST_F(StaticStrategyTest, WeightedSignalCombinesComponents) {
+    WeightedSignal<MeanReversionSignal, BookImbalanceSignal> signal({1.0, 0.01},
+                                                                    MeanReversionSignal(), BookImbalanceSignal());
+    auto strategy = makeStrategy(0.004, 1.0, signal);
+    StrategyDecision decision;
+
+    // Last at mid, bids three times the asks: imbalance 0.5 * 0.01 alone crosses
+    ASSERT_TRUE(strategy->process(tick(99.9, 100.1, 100.0, 3.0, 1.0), decision));
+    EXPECT_TRUE(decision.is_buy);
+
+    // Mean reversion says sell 0.3%, imbalance says buy 0.5%: net buy 0.2%, below threshold
+    EXPECT_FALSE(strategy->process(tick(99.9, 100.1, 100.3, 3.0, 1.0), decision));
+}
+
+TEST_F(StaticStrategyTest, RuntimeHandlerMatchesDirectCall) {
+    auto direct = makeStrategy(0.001, 1.0, MeanReversionSignal(), MaxSpreadFilter{0.01});
+    std::unique_ptr<StrategyTickHandler> handler = makeStrategy(0.001, 1.0, MeanReversionSignal(),
+                                                                MaxSpreadFilter{0.01});
+
+    const double lasts[] = {100.5, 99.5, 100.02, 103.0, 97.0};
+    for (double last : lasts) {
+        StrategyDecision a;
+        StrategyDecision b;
+        auto data = tick(99.9, 100.1, last);
+        EXPECT_EQ(direct->process(data, a), handler->onTick(data, b)) << last;
+        EXPECT_EQ(a.is_buy, b.is_buy);
+        EXPECT_DOUBLE_EQ(a.price, b.price);
+    }
+}
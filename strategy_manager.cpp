@@ -2,6 +2,8 @@
 #include "config_manager.h"
 #include "market_data_manager.h"
 #include "risk_manager.h"
+#include "state_snapshot.h"
+#include "static_strategy.h"
 #include <algorithm>
 #include <cmath>
 #include <stdexcept>
@@ -33,41 +35,101 @@ void StrategyManager::initialize() {
 void StrategyManager::shutdown() {
     // Unsubscribe from market data updates
     market_data_manager_.unsubscribeFromMarketData("BTC-PERPETUAL");
+
+    Notifications notifications;
+    {
+        boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+        flushPendingMetricsLocked(true, notifications);
+        takeCallbacksLocked(notifications);
+    }
+    notify(notifications);
 }
 
 void StrategyManager::addStrategy(const StrategyConfig& config) {
-    boost::lock_guard<boost::mutex> lock(strategy_mutex_);
-    
-    if (strategies_.find(config.name) != strategies_.end()) {
-        throw std::runtime_error("Strategy already exists: " + config.name);
+    addStrategy(config, nullptr);
+}
+
+void StrategyManager::addStrategy(const StrategyConfig& config, std::unique_ptr<StrategyTickHandler> handler) {
+    {
+        boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+
+        if (strategies_.find(config.name) != strategies_.end()) {
+            throw std::runtime_error("Strategy already exists: " + config.name);
+        }
+
+        strategies_[config.name] = config;
+        strategy_metrics_[config.name] = {
+            0.0,    // total_pnl
+            0.0,    // win_rate
+            0.0,    // sharpe_ratio
+            0.0,    // max_drawdown
+            0.0,    // current_drawdown
+            0,      // total_trades
+            0,      // winning_trades
+            std::chrono::system_clock::now()  // timestamp
+        };
+        strategy_statistics_.erase(config.name);
+        strategy_statistics_.emplace(config.name, StrategyStatistics());
+        strategy_positions_[config.name] = StrategyPosition{};
+        auto saved = pending_restores_.find(config.name);
+        if (saved != pending_restores_.end()) {
+            applySavedLocked(config.name, std::move(saved->second));
+            pending_restores_.erase(saved);
+        }
+        if (handler) {
+            handlers_[config.name] = std::move(handler);
+        }
+        metrics_reported_.erase(config.name);
+        metrics_sequence_++;
+        cpu_accounts_[config.name] = CpuAccounting::getInstance().account("strategy/" + config.name);
     }
-    
-    strategies_[config.name] = config;
-    strategy_metrics_[config.name] = {
-        0.0,    // total_pnl
-        0.0,    // win_rate
-        0.0,    // sharpe_ratio
-        0.0,    // max_drawdown
-        0,      // total_trades
-        0,      // winning_trades
-        std::chrono::system_clock::now()  // timestamp
-    };
+
+    // Pin outside the strategy lock so the market data and strategy locks
+    // are never nested
+    MarketDataManager::getInstance().pinInstrument(config.instrument);
 }
 
 void StrategyManager::removeStrategy(const std::string& name) {
-    boost::lock_guard<boost::mutex> lock(strategy_mutex_);
-    strategies_.erase(name);
-    strategy_metrics_.erase(name);
+    std::string instrument;
+    {
+        boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+        auto it = strategies_.find(name);
+        if (it == strategies_.end()) {
+            return;
+        }
+        instrument = it->second.instrument;
+        strategies_.erase(it);
+        strategy_metrics_.erase(name);
+        strategy_statistics_.erase(name);
+        strategy_positions_.erase(name);
+        handlers_.erase(name);
+        metrics_reported_.erase(name);
+        cpu_accounts_.erase(name);
+        metrics_sequence_++;
+    }
+
+    MarketDataManager::getInstance().unpinInstrument(instrument);
 }
 
 void StrategyManager::updateStrategy(const StrategyConfig& config) {
-    boost::lock_guard<boost::mutex> lock(strategy_mutex_);
-    
-    if (strategies_.find(config.name) == strategies_.end()) {
-        throw std::runtime_error("Strategy not found: " + config.name);
+    std::string previous_instrument;
+    {
+        boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+
+        auto it = strategies_.find(config.name);
+        if (it == strategies_.end()) {
+            throw std::runtime_error("Strategy not found: " + config.name);
+        }
+
+        previous_instrument = it->second.instrument;
+        it->second = config;
+    }
+
+    if (previous_instrument != config.instrument) {
+        auto& market_data_manager = MarketDataManager::getInstance();
+        market_data_manager.pinInstrument(config.instrument);
+        market_data_manager.unpinInstrument(previous_instrument);
     }
-    
-    strategies_[config.name] = config;
 }
 
 void StrategyManager::enableStrategy(const std::string& name, bool enable) {
@@ -116,27 +178,61 @@ std::vector<std::string> StrategyManager::getActiveStrategies() const {
     return active_strategies;
 }
 
-void StrategyManager::setStrategyCallback(std::function<void(const std::string&, const StrategyMetrics&)> callback) {
+std::vector<StrategyStatistics::CurvePoint> StrategyManager::getEquityCurve(const std::string& name) const {
     boost::lock_guard<boost::mutex> lock(strategy_mutex_);
-    strategy_callback_ = callback;
+    
+    auto it = strategy_statistics_.find(name);
+    if (it == strategy_statistics_.end()) {
+        throw std::runtime_error("Strategy metrics not found: " + name);
+    }
+    
+    return it->second.equityCurve();
 }
 
-void StrategyManager::setTradeCallback(std::function<void(const std::string&, double, double, const std::string&)> callback) {
+std::map<std::string, StrategyManager::StrategyMetrics> StrategyManager::getAllStrategyMetrics() const {
     boost::lock_guard<boost::mutex> lock(strategy_mutex_);
-    trade_callback_ = callback;
+    return strategy_metrics_;
 }
 
-void StrategyManager::processMarketData(const std::string& instrument, const MarketDataManager::MarketData& data) {
+uint64_t StrategyManager::getMetricsSequence() const {
     boost::lock_guard<boost::mutex> lock(strategy_mutex_);
-    
-    for (const auto& [name, config] : strategies_) {
-        if (config.enabled && config.instrument == instrument) {
-            evaluateStrategy(name, data);
+    return metrics_sequence_;
+}
+
+void StrategyManager::setStrategyCallback(StrategyCallback callback) {
+    boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+    strategy_callback_ = std::move(callback);
+}
+
+void StrategyManager::setTradeCallback(TradeCallback callback) {
+    boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+    trade_callback_ = std::move(callback);
+}
+
+void StrategyManager::setMetricsReportInterval(std::chrono::milliseconds interval) {
+    boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+    metrics_report_interval_ = interval;
+}
+
+void StrategyManager::processMarketData(const std::string& instrument, const MarketDataManager::MarketData& data) {
+    Notifications notifications;
+    {
+        boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+        flushPendingMetricsLocked(false, notifications);
+
+        for (const auto& [name, config] : strategies_) {
+            if (config.enabled && config.instrument == instrument) {
+                evaluateStrategy(name, data, notifications);
+            }
         }
+        takeCallbacksLocked(notifications);
     }
+    notify(notifications);
 }
 
-void StrategyManager::evaluateStrategy(const std::string& name, const MarketDataManager::MarketData& data) {
+void StrategyManager::evaluateStrategy(const std::string& name, const MarketDataManager::MarketData& data,
+                                       Notifications& notifications) {
+    CpuAccounting::Scope cpu_scope(cpu_accounts_[name]);
     const auto& config = strategies_[name];
     const auto& metrics = strategy_metrics_[name];
     
@@ -144,6 +240,21 @@ void StrategyManager::evaluateStrategy(const std::string& name, const MarketData
     if (metrics.total_trades >= config.max_trades_per_day) {
         return;
     }
+
+    // Composed strategies decide in one statically dispatched call. A
+    // RiskFilter inside the strategy is only the lock-free collar, so the
+    // decision still goes through the full check like the built-in path.
+    auto handler = handlers_.find(name);
+    if (handler != handlers_.end()) {
+        StrategyDecision decision;
+        if (handler->second->onTick(data, decision)) {
+            const std::string side = decision.is_buy ? "buy" : "sell";
+            if (risk_manager_.checkOrderRisk(config.instrument, decision.size, decision.price, side)) {
+                executeTrade(name, decision.size, decision.price, side, notifications);
+            }
+        }
+        return;
+    }
     
     double mid_price = market_data_manager_.getMidPrice(config.instrument);
     double spread = market_data_manager_.getSpread(config.instrument);
@@ -156,43 +267,196 @@ void StrategyManager::evaluateStrategy(const std::string& name, const MarketData
         std::string side = price_deviation > 0 ? "sell" : "buy";
         
         if (risk_manager_.checkOrderRisk(config.instrument, size, data.last_price, side)) {
-            executeTrade(name, size, data.last_price, side);
+            executeTrade(name, size, data.last_price, side, notifications);
         }
     }
 }
 
-void StrategyManager::executeTrade(const std::string& strategy_name, double size, double price, const std::string& side) {
+void StrategyManager::executeTrade(const std::string& strategy_name, double size, double price, const std::string& side,
+                                   Notifications& notifications) {
     // Here you would implement the actual trade execution logic
     // For now, we'll just update the metrics and notify callbacks
-    
-    double pnl = 0.0;  // This would be calculated based on the actual trade execution
+
+    // Opening fills realize nothing; reducing fills realize against the
+    // strategy's average entry
+    double pnl = applyFill(strategy_positions_[strategy_name], size, price, side == "buy");
     bool is_winning_trade = pnl > 0;
     
-    updateStrategyMetrics(strategy_name, pnl, is_winning_trade);
+    updateStrategyMetrics(strategy_name, pnl, is_winning_trade, notifications);
     
-    if (trade_callback_) {
-        trade_callback_(strategy_name, size, price, side);
+    notifications.trades.push_back({strategy_name, size, price, side});
+}
+
+double StrategyManager::applyFill(StrategyPosition& position, double size, double price, bool is_buy) {
+    const double signed_size = is_buy ? size : -size;
+    double realized = 0.0;
+
+    if (position.size != 0.0 && (position.size > 0.0) != (signed_size > 0.0)) {
+        const double closed = std::min(std::abs(signed_size), std::abs(position.size));
+        realized = closed * (price - position.avg_price) * (position.size > 0.0 ? 1.0 : -1.0);
     }
+
+    const double new_size = position.size + signed_size;
+    if (std::abs(new_size) < 1e-12) {
+        position.avg_price = 0.0;
+        position.size = 0.0;
+        return realized;
+    }
+    if (position.size == 0.0 || (position.size > 0.0) != (new_size > 0.0)) {
+        // Opened, or flipped through flat: the remainder opens at this price
+        position.avg_price = price;
+    } else if ((position.size > 0.0) == (signed_size > 0.0)) {
+        position.avg_price = (position.avg_price * std::abs(position.size) + price * size) / std::abs(new_size);
+    }
+    position.size = new_size;
+    return realized;
 }
 
-void StrategyManager::updateStrategyMetrics(const std::string& name, double pnl, bool is_winning_trade) {
+void StrategyManager::updateStrategyMetrics(const std::string& name, double pnl, bool is_winning_trade,
+                                            Notifications& notifications) {
     auto& metrics = strategy_metrics_[name];
+    auto& statistics = strategy_statistics_[name];
     
-    metrics.total_pnl += pnl;
+    statistics.onFill(std::chrono::system_clock::now(), pnl);
+    const auto stats = statistics.snapshot();
+    
+    metrics.total_pnl = stats.equity;
     metrics.total_trades++;
     if (is_winning_trade) {
         metrics.winning_trades++;
     }
     
     metrics.win_rate = static_cast<double>(metrics.winning_trades) / metrics.total_trades;
+    metrics.sharpe_ratio = stats.sharpe_ratio;
+    metrics.max_drawdown = stats.max_drawdown;
+    metrics.current_drawdown = stats.drawdown;
     metrics.timestamp = std::chrono::system_clock::now();
+    metrics_sequence_++;
     
-    // Update max drawdown
-    if (pnl < 0) {
-        metrics.max_drawdown = std::min(metrics.max_drawdown, pnl);
+    // Throttled per strategy so a burst of fills does not flood listeners;
+    // the last throttled update still goes out from a later tick
+    const auto now = std::chrono::steady_clock::now();
+    auto [report, first_report] = metrics_reported_.try_emplace(name);
+    report->second.pending = true;
+    if (first_report || now - report->second.last >= metrics_report_interval_) {
+        reportMetricsLocked(name, report->second, now, notifications);
     }
-    
-    if (strategy_callback_) {
-        strategy_callback_(name, metrics);
+}
+
+void StrategyManager::reportMetricsLocked(const std::string& name, MetricsReport& report,
+                                          std::chrono::steady_clock::time_point now,
+                                          Notifications& notifications) {
+    if (!strategy_callback_) {
+        return;
+    }
+    report.last = now;
+    report.pending = false;
+    notifications.metrics.emplace_back(name, strategy_metrics_[name]);
+}
+
+void StrategyManager::flushPendingMetricsLocked(bool force, Notifications& notifications) {
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& [name, report] : metrics_reported_) {
+        if (report.pending && (force || now - report.last >= metrics_report_interval_)) {
+            reportMetricsLocked(name, report, now, notifications);
+        }
     }
-} 
\ No newline at end of file
+}
+
+void StrategyManager::takeCallbacksLocked(Notifications& notifications) const {
+    if (!notifications.metrics.empty()) {
+        notifications.strategy_callback = strategy_callback_;
+    }
+    if (!notifications.trades.empty()) {
+        notifications.trade_callback = trade_callback_;
+    }
+}
+
+void StrategyManager::notify(Notifications& notifications) {
+    if (notifications.strategy_callback) {
+        for (const auto& [name, metrics] : notifications.metrics) {
+            notifications.strategy_callback(name, metrics);
+        }
+    }
+    if (notifications.trade_callback) {
+        for (const auto& trade : notifications.trades) {
+            notifications.trade_callback(trade.strategy, trade.size, trade.price, trade.side);
+        }
+    }
+}
+
+void StrategyManager::saveSnapshot(SnapshotWriter& writer) const {
+    // Copy under the lock, encode after releasing it. Saved entries whose
+    // strategy was never added are carried over to the next snapshot.
+    std::vector<std::pair<std::string, SavedStrategy>> saved;
+    {
+        boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+        saved.reserve(strategy_statistics_.size() + pending_restores_.size());
+        for (const auto& [name, statistics] : strategy_statistics_) {
+            auto metrics = strategy_metrics_.find(name);
+            const bool known = metrics != strategy_metrics_.end();
+            auto position = strategy_positions_.find(name);
+            saved.push_back({name, {known ? metrics->second.total_trades : 0,
+                                    known ? metrics->second.winning_trades : 0,
+                                    position != strategy_positions_.end() ? position->second : StrategyPosition{},
+                                    statistics}});
+        }
+        for (const auto& entry : pending_restores_) {
+            saved.push_back(entry);
+        }
+    }
+
+    writer.putU32(static_cast<uint32_t>(saved.size()));
+    for (const auto& [name, entry] : saved) {
+        writer.putString(name);
+        writer.putU32(static_cast<uint32_t>(entry.total_trades));
+        writer.putU32(static_cast<uint32_t>(entry.winning_trades));
+        writer.putDouble(entry.position.size);
+        writer.putDouble(entry.position.avg_price);
+        entry.statistics.save(writer);
+    }
+}
+
+void StrategyManager::restoreSnapshot(SnapshotReader& reader) {
+    // Decode everything before taking the lock
+    std::vector<std::pair<std::string, SavedStrategy>> saved;
+    uint32_t count = reader.getCount(8);
+    saved.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string name = reader.getString();
+        const int total_trades = static_cast<int>(reader.getU32());
+        const int winning_trades = static_cast<int>(reader.getU32());
+        StrategyPosition position;
+        position.size = reader.getDouble();
+        position.avg_price = reader.getDouble();
+        StrategyStatistics statistics;
+        statistics.restore(reader);
+        saved.push_back({std::move(name), {total_trades, winning_trades, position, std::move(statistics)}});
+    }
+
+    boost::lock_guard<boost::mutex> lock(strategy_mutex_);
+    for (auto& [name, entry] : saved) {
+        if (strategies_.find(name) == strategies_.end()) {
+            pending_restores_[name] = std::move(entry);
+        } else {
+            applySavedLocked(name, std::move(entry));
+        }
+    }
+}
+
+void StrategyManager::applySavedLocked(const std::string& name, SavedStrategy saved) {
+    const auto stats = saved.statistics.snapshot();
+    auto& metrics = strategy_metrics_[name];
+    metrics.total_pnl = stats.equity;
+    metrics.total_trades = saved.total_trades;
+    metrics.winning_trades = saved.winning_trades;
+    metrics.win_rate = saved.total_trades > 0
+        ? static_cast<double>(saved.winning_trades) / saved.total_trades : 0.0;
+    metrics.sharpe_ratio = stats.sharpe_ratio;
+    metrics.max_drawdown = stats.max_drawdown;
+    metrics.current_drawdown = stats.drawdown;
+    metrics.timestamp = std::chrono::system_clock::now();
+    strategy_statistics_[name] = std::move(saved.statistics);
+    strategy_positions_[name] = saved.position;
+    metrics_sequence_++;
+}
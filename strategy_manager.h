@@ -15,12 +15,17 @@
 #include <boost/thread/mutex.hpp>
 
 // Project includes
-#include "market_data_types.h"
+#include "market_data_manager.h"
+#include "cpu_accounting.h"
+#include "strategy_statistics.h"
+#include "inplace_function.h"
 
 // Forward declarations
+class SnapshotWriter;
+class SnapshotReader;
 class ConfigManager;
-class MarketDataManager;
 class RiskManager;
+class StrategyTickHandler;
 
 class StrategyManager {
 public:
@@ -39,8 +44,9 @@ public:
     struct StrategyMetrics {
         double total_pnl;
         double win_rate;
-        double sharpe_ratio;
-        double max_drawdown;
+        double sharpe_ratio;        // Annualized, from per-bucket returns
+        double max_drawdown;        // Largest peak-to-trough decline in PnL, >= 0
+        double current_drawdown;
         int total_trades;
         int winning_trades;
         std::chrono::system_clock::time_point timestamp;
@@ -55,6 +61,10 @@ public:
     void shutdown();
 
     void addStrategy(const StrategyConfig& config);
+    // Runs handler (see static_strategy.h) instead of the built-in evaluation;
+    // config still supplies the instrument, trade limit and enabled flag, and
+    // every decision passes RiskManager::checkOrderRisk before it trades
+    void addStrategy(const StrategyConfig& config, std::unique_ptr<StrategyTickHandler> handler);
     void removeStrategy(const std::string& name);
     void updateStrategy(const StrategyConfig& config);
     void enableStrategy(const std::string& name, bool enable);
@@ -62,9 +72,29 @@ public:
     const StrategyConfig& getStrategy(const std::string& name) const;
     const StrategyMetrics& getStrategyMetrics(const std::string& name) const;
     std::vector<std::string> getActiveStrategies() const;
+    std::vector<StrategyStatistics::CurvePoint> getEquityCurve(const std::string& name) const;
+    // Copy of every strategy's metrics, and a counter that moves whenever any of them changes
+    std::map<std::string, StrategyMetrics> getAllStrategyMetrics() const;
+    uint64_t getMetricsSequence() const;
 
-    void setStrategyCallback(std::function<void(const std::string&, const StrategyMetrics&)> callback);
-    void setTradeCallback(std::function<void(const std::string&, double, double, const std::string&)> callback);
+    using StrategyCallback = InplaceFunction<void(const std::string&, const StrategyMetrics&)>;
+    using TradeCallback = InplaceFunction<void(const std::string&, double, double, const std::string&)>;
+
+    // Callbacks run after strategy_mutex_ is released, so they may call
+    // back into the manager
+    void setStrategyCallback(StrategyCallback callback);
+    void setTradeCallback(TradeCallback callback);
+    // Minimum time between metric callbacks for one strategy; metrics are
+    // still updated on every fill. A throttled update is reported on the
+    // first tick after the interval has passed, and at shutdown.
+    void setMetricsReportInterval(std::chrono::milliseconds interval);
+
+    // Metrics, statistics and position per strategy. Saved entries for
+    // strategies not added yet are held and applied when addStrategy
+    // creates them.
+    static constexpr uint32_t SNAPSHOT_VERSION = 2;
+    void saveSnapshot(SnapshotWriter& writer) const;
+    void restoreSnapshot(SnapshotReader& reader);
 
 private:
     StrategyManager();
@@ -72,19 +102,75 @@ private:
     StrategyManager(const StrategyManager&) = delete;
     StrategyManager& operator=(const StrategyManager&) = delete;
 
-    void processMarketData(const std::string& instrument, const market_data::MarketData& data);
-    void evaluateStrategy(const std::string& name, const market_data::MarketData& data);
-    void executeTrade(const std::string& strategy_name, double size, double price, const std::string& side);
-    void updateStrategyMetrics(const std::string& name, double pnl, bool is_winning_trade);
+    // Callbacks collected under strategy_mutex_ and made after releasing it
+    struct Notifications {
+        struct Trade {
+            std::string strategy;
+            double size;
+            double price;
+            std::string side;
+        };
+        std::vector<std::pair<std::string, StrategyMetrics>> metrics;
+        std::vector<Trade> trades;
+        StrategyCallback strategy_callback;
+        TradeCallback trade_callback;
+    };
+
+    // Net position of the strategy's own fills
+    struct StrategyPosition {
+        double size{0.0};       // Positive long, negative short
+        double avg_price{0.0};
+    };
+    // Applies a fill and returns the P&L it realizes against the average price
+    static double applyFill(StrategyPosition& position, double size, double price, bool is_buy);
+
+    void processMarketData(const std::string& instrument, const MarketDataManager::MarketData& data);
+    // The next four require strategy_mutex_
+    void evaluateStrategy(const std::string& name, const MarketDataManager::MarketData& data,
+                          Notifications& notifications);
+    void executeTrade(const std::string& strategy_name, double size, double price, const std::string& side,
+                      Notifications& notifications);
+    void updateStrategyMetrics(const std::string& name, double pnl, bool is_winning_trade,
+                               Notifications& notifications);
+    // Copies the callbacks the collected notifications need
+    void takeCallbacksLocked(Notifications& notifications) const;
+    // Runs without strategy_mutex_
+    static void notify(Notifications& notifications);
+
+    struct MetricsReport {
+        std::chrono::steady_clock::time_point last;
+        bool pending{false};  // Metrics changed since the last callback
+    };
+    // Both require strategy_mutex_
+    void reportMetricsLocked(const std::string& name, MetricsReport& report,
+                             std::chrono::steady_clock::time_point now, Notifications& notifications);
+    void flushPendingMetricsLocked(bool force, Notifications& notifications);
+
+    struct SavedStrategy {
+        int total_trades;
+        int winning_trades;
+        StrategyPosition position;
+        StrategyStatistics statistics;
+    };
+    // Requires strategy_mutex_
+    void applySavedLocked(const std::string& name, SavedStrategy saved);
 
     mutable boost::mutex strategy_mutex_;
     std::map<std::string, StrategyConfig> strategies_;
     std::map<std::string, StrategyMetrics> strategy_metrics_;
-    std::function<void(const std::string&, const StrategyMetrics&)> strategy_callback_;
-    std::function<void(const std::string&, double, double, const std::string&)> trade_callback_;
+    std::map<std::string, StrategyStatistics> strategy_statistics_;
+    std::map<std::string, StrategyPosition> strategy_positions_;
+    std::map<std::string, std::unique_ptr<StrategyTickHandler>> handlers_;
+    std::map<std::string, SavedStrategy> pending_restores_;  // Restored before the strategy was added
+    std::map<std::string, MetricsReport> metrics_reported_;
+    std::chrono::milliseconds metrics_report_interval_{1000};
+    uint64_t metrics_sequence_{0};
+    std::map<std::string, CpuAccounting::Account*> cpu_accounts_;  // "strategy/<name>"
+    StrategyCallback strategy_callback_;
+    TradeCallback trade_callback_;
     const ConfigManager& config_manager_;
-    const MarketDataManager& market_data_manager_;
-    const RiskManager& risk_manager_;
+    MarketDataManager& market_data_manager_;
+    RiskManager& risk_manager_;
 };
 
 #endif // STRATEGY_MANAGER_H 
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include "strategy_manager.h"
+#include "static_strategy.h"
+#include "config_manager.h"
+#include "market_data_manager.h"
+#include "risk_manager.h"
+#include "state_snapshot.h"
+#include "strategy_statistics.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Drives StrategyManager through the market data processing thread, the
+// same path the feed takes. StrategyManager only subscribes to
+// BTC-PERPETUAL, so every test uses that instrument.
+class StrategyManagerTest : public ::testing::Test {
+protected:
+    // Trades the size carried in volume_24h at the last price, selling when
+    // it is negative, so each tick says exactly what decision to make
+    class ScriptedHandler : public StrategyTickHandler {
+    public:
+        bool onTick(const MarketDataManager::MarketData& data, StrategyDecision& decision) override {
+            decision.size = std::abs(data.volume_24h);
+            decision.price = data.last_price;
+            decision.is_buy = data.volume_24h >= 0.0;
+            return true;
+        }
+    };
+
+    struct Fill {
+        std::string strategy;
+        double size;
+        double price;
+    };
+
+    void SetUp() override {
+        saved_config_ = ConfigManager::getInstance().getTradingConfig();
+        auto config = saved_config_;
+        config.max_position_size = 100.0;
+        config.max_order_size = 200.0;
+        config.max_loss_per_trade = 1e9;
+        config.max_daily_loss = 1e9;
+        config.price_band_pct = 0.0;
+        config.price_band_ticks = 0;
+        config.max_order_notional = 0.0;
+        config.max_instrument_notional = 0.0;
+        config.max_scenario_loss = 0.0;
+        ConfigManager::getInstance().setTradingConfig(config);
+        RiskManager::getInstance().refreshLimits();
+        RiskManager::getInstance().setRiskCallback([this](const std::string&, const std::string& reason) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            violations_.push_back(reason);
+        });
+
+        auto& strategies = StrategyManager::getInstance();
+        strategies.setTradeCallback([this](const std::string& strategy, double size, double price,
+                                           const std::string&) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            fills_.push_back({strategy, size, price});
+            filled_.notify_all();
+        });
+        strategies.initialize();
+        MarketDataManager::getInstance().initialize();
+    }
+
+    void TearDown() override {
+        auto& strategies = StrategyManager::getInstance();
+        strategies.shutdown();
+        for (const auto& name : added_) {
+            strategies.removeStrategy(name);
+        }
+        strategies.setTradeCallback(nullptr);
+        strategies.setStrategyCallback(nullptr);
+        strategies.setMetricsReportInterval(std::chrono::milliseconds(1000));
+        RiskManager::getInstance().setRiskCallback(nullptr);
+        ConfigManager::getInstance().setTradingConfig(saved_config_);
+        RiskManager::getInstance().refreshLimits();
+    }
+
+    void addScripted(const std::string& name) {
+        StrategyManager::StrategyConfig config{name, "BTC-PERPETUAL", 1.0, 0.001, 0.0, 0.0, 0.0, 1000, true};
+        StrategyManager::getInstance().addStrategy(config, std::make_unique<ScriptedHandler>());
+        added_.push_back(name);
+    }
+
+    static void publish(double size, double price) {
+        MarketDataManager::MarketData data{};
+        data.orderbook.instrument = "BTC-PERPETUAL";
+        data.orderbook.bids.push_back({price - 0.5, 1.0, {}});
+        data.orderbook.asks.push_back({price + 0.5, 1.0, {}});
+        data.last_price = price;
+        data.volume_24h = size;
+        MarketDataManager::getInstance().updateMarketData(data);
+    }
+
+    bool waitForFills(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return filled_.wait_for(lock, std::chrono::seconds(5), [&] { return fills_.size() >= count; });
+    }
+
+    bool waitForViolations(size_t count) {
+        for (int i = 0; i < 500; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (violations_.size() >= count) return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    ConfigManager::TradingConfig saved_config_;
+    std::vector<std::string> added_;
+    std::mutex mutex_;
+    std::condition_variable filled_;
+    std::vector<Fill> fills_;
+    std::vector<std::string> violations_;
+};
+
+TEST_F(StrategyManagerTest, HandlerDecisionOverPositionLimitIsRejected) {
+    addScripted("scripted");
+
+    // Ticks are dispatched in order, so once the second fill arrives the
+    // oversized decision has been evaluated
+    publish(150.0, 10.0);
+    publish(5.0, 10.0);
+    ASSERT_TRUE(waitForFills(1));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ASSERT_EQ(fills_.size(), 1u);
+    EXPECT_DOUBLE_EQ(fills_[0].size, 5.0);
+    ASSERT_EQ(violations_.size(), 1u);
+    EXPECT_EQ(violations_[0], "Position limit exceeded");
+}
+
+TEST_F(StrategyManagerTest, RestoredStateAppliesToStrategyAddedLater) {
+    StrategyStatistics statistics;
+    const auto now = std::chrono::system_clock::now();
+    statistics.onFill(now, 12.5);
+    statistics.onFill(now, -2.5);
+    SnapshotWriter writer;
+    writer.putU32(1);
+    writer.putString("late");
+    writer.putU32(7);
+    writer.putU32(4);
+    writer.putDouble(2.0);     // position size
+    writer.putDouble(100.0);   // average price
+    statistics.save(writer);
+
+    auto& strategies = StrategyManager::getInstance();
+    SnapshotReader reader(writer.data().data(), writer.data().data() + writer.data().size());
+    strategies.restoreSnapshot(reader);
+    addScripted("late");
+
+    const auto& metrics = strategies.getStrategyMetrics("late");
+    EXPECT_EQ(metrics.total_trades, 7);
+    EXPECT_EQ(metrics.winning_trades, 4);
+    EXPECT_DOUBLE_EQ(metrics.total_pnl, 10.0);
+
+    // Saving again carries the restored state through unchanged
+    SnapshotWriter resaved;
+    strategies.saveSnapshot(resaved);
+    SnapshotReader check(resaved.data().data(), resaved.data().data() + resaved.data().size());
+    ASSERT_EQ(check.getCount(8), 1u);
+    EXPECT_EQ(check.getString(), "late");
+    EXPECT_EQ(check.getU32(), 7u);
+    EXPECT_EQ(check.getU32(), 4u);
+    EXPECT_DOUBLE_EQ(check.getDouble(), 2.0);
+    EXPECT_DOUBLE_EQ(check.getDouble(), 100.0);
+}
+
+TEST_F(StrategyManagerTest, FillsRecordRealizedPnl) {
+    auto& strategies = StrategyManager::getInstance();
+    addScripted("realized");
+
+    publish(2.0, 10.0);    // Opens long 2 at 10
+    publish(2.0, 12.0);    // Adds 2 at 12, average 11
+    publish(-3.0, 15.0);   // Realizes 3 * (15 - 11)
+    publish(-3.0, 9.0);    // Realizes 1 * (9 - 11), opens short 2 at 9
+    publish(2.0, 8.0);     // Realizes 2 * (9 - 8)
+    ASSERT_TRUE(waitForFills(5));
+
+    const auto metrics = strategies.getAllStrategyMetrics().at("realized");
+    EXPECT_EQ(metrics.total_trades, 5);
+    EXPECT_EQ(metrics.winning_trades, 2);
+    EXPECT_DOUBLE_EQ(metrics.total_pnl, 12.0 - 2.0 + 2.0);
+    EXPECT_DOUBLE_EQ(metrics.max_drawdown, 2.0);
+}
+
+TEST_F(StrategyManagerTest, CallbacksMayCallBackIntoTheManager) {
+    auto& strategies = StrategyManager::getInstance();
+    std::vector<uint64_t> sequences;
+    strategies.setStrategyCallback([&](const std::string& name, const StrategyManager::StrategyMetrics&) {
+        if (name != "reentrant") return;
+        // Would deadlock if called under the strategy lock
+        const auto sequence = StrategyManager::getInstance().getMetricsSequence();
+        std::lock_guard<std::mutex> lock(mutex_);
+        sequences.push_back(sequence);
+    });
+    addScripted("reentrant");
+
+    publish(1.0, 10.0);
+    ASSERT_TRUE(waitForFills(1));
+    std::lock_guard<std::mutex> lock(mutex_);
+    EXPECT_EQ(sequences.size(), 1u);
+}
+
+TEST_F(StrategyManagerTest, ThrottledMetricsAreReportedOnALaterTick) {
+    auto& strategies = StrategyManager::getInstance();
+    std::vector<int> reported_trades;
+    strategies.setMetricsReportInterval(std::chrono::milliseconds(50));
+    strategies.setStrategyCallback([this, &reported_trades](const std::string& name,
+                                                            const StrategyManager::StrategyMetrics& metrics) {
+        if (name != "throttled") return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        reported_trades.push_back(metrics.total_trades);
+    });
+    addScripted("throttled");
+
+    // A burst of fills: the first is reported, the rest are held back
+    publish(1.0, 10.0);
+    publish(1.0, 10.0);
+    publish(1.0, 10.0);
+    ASSERT_TRUE(waitForFills(3));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        EXPECT_EQ(reported_trades, std::vector<int>({1}));
+    }
+
+    // A later tick that does not trade still delivers the held update,
+    // after the tick has been evaluated
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    publish(150.0, 10.0);
+    ASSERT_TRUE(waitForViolations(1));
+    for (int i = 0; i < 500; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (reported_trades.size() >= 2) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    EXPECT_EQ(reported_trades, std::vector<int>({1, 3}));
+}
@@ -0,0 +1,187 @@
+#include "strategy_statistics.h"
+#include "state_snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+constexpr double MS_PER_YEAR = 365.0 * 24.0 * 3600.0 * 1000.0;
+
+int64_t floorDiv(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) {
+        --quotient;
+    }
+    return quotient;
+}
+
+} // namespace
+
+StrategyStatistics::StrategyStatistics()
+    : StrategyStatistics(Config()) {
+}
+
+StrategyStatistics::StrategyStatistics(const Config& config)
+    : config_(config),
+      bucket_ms_(config.bucket.count()) {
+    if (bucket_ms_ <= 0) {
+        throw std::invalid_argument("Statistics bucket must be positive");
+    }
+    if (config_.max_curve_points < 2) {
+        throw std::invalid_argument("Equity curve needs at least two points");
+    }
+    curve_.reserve(config_.max_curve_points);
+}
+
+void StrategyStatistics::Moments::add(double value) {
+    count++;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+}
+
+void StrategyStatistics::Moments::addZeros(uint64_t zeros) {
+    if (zeros == 0) {
+        return;
+    }
+    // Parallel merge with a batch of identical zero samples (mean 0, M2 0)
+    const double n = static_cast<double>(count);
+    const double k = static_cast<double>(zeros);
+    const double total = n + k;
+    m2 += mean * mean * n * k / total;
+    mean = mean * n / total;
+    count += zeros;
+}
+
+int64_t StrategyStatistics::bucketIndex(TimePoint timestamp) const {
+    const int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(timestamp.time_since_epoch()).count();
+    return floorDiv(ms, bucket_ms_);
+}
+
+void StrategyStatistics::onFill(TimePoint timestamp, double pnl) {
+    if (!std::isfinite(pnl)) {
+        return;
+    }
+
+    const int64_t bucket = bucketIndex(timestamp);
+    if (!started_) {
+        started_ = true;
+        current_bucket_ = bucket;
+        bucket_start_equity_ = equity_;
+    } else if (bucket > current_bucket_) {
+        // Close the open bucket, then count the empty ones in between
+        returns_.add(equity_ - bucket_start_equity_);
+        returns_.addZeros(static_cast<uint64_t>(bucket - current_bucket_ - 1));
+        current_bucket_ = bucket;
+        bucket_start_equity_ = equity_;
+    }
+    // Out-of-order fills land in the open bucket
+
+    equity_ += pnl;
+    peak_equity_ = std::max(peak_equity_, equity_);
+    max_drawdown_ = std::max(max_drawdown_, peak_equity_ - equity_);
+    fills_++;
+    last_fill_ = std::max(last_fill_, timestamp);
+
+    if (++since_sample_ >= curve_stride_) {
+        since_sample_ = 0;
+        sampleCurve(last_fill_);
+    }
+}
+
+void StrategyStatistics::sampleCurve(TimePoint timestamp) {
+    if (curve_.size() == config_.max_curve_points) {
+        // Halve the resolution: keep every other point, sample half as often
+        size_t kept = 0;
+        for (size_t i = 0; i < curve_.size(); i += 2) {
+            curve_[kept++] = curve_[i];
+        }
+        curve_.resize(kept);
+        curve_stride_ *= 2;
+    }
+    curve_.push_back({timestamp, equity_});
+}
+
+StrategyStatistics::Snapshot StrategyStatistics::snapshot() const {
+    Snapshot snapshot{};
+    snapshot.equity = equity_;
+    snapshot.peak_equity = peak_equity_;
+    snapshot.drawdown = peak_equity_ - equity_;
+    snapshot.max_drawdown = max_drawdown_;
+    snapshot.mean_return = returns_.mean;
+    snapshot.return_samples = returns_.count;
+    snapshot.fills = fills_;
+
+    if (returns_.count > 1) {
+        snapshot.stddev_return = std::sqrt(returns_.m2 / (returns_.count - 1));
+        if (snapshot.stddev_return > 0.0) {
+            const double buckets_per_year = MS_PER_YEAR / static_cast<double>(bucket_ms_);
+            snapshot.sharpe_ratio = snapshot.mean_return / snapshot.stddev_return * std::sqrt(buckets_per_year);
+        }
+    }
+    return snapshot;
+}
+
+std::vector<StrategyStatistics::CurvePoint> StrategyStatistics::equityCurve() const {
+    std::vector<CurvePoint> curve = curve_;
+    if (fills_ > 0 && (curve.empty() || since_sample_ > 0)) {
+        curve.push_back({last_fill_, equity_});
+    }
+    return curve;
+}
+
+void StrategyStatistics::save(SnapshotWriter& writer) const {
+    writer.putI64(bucket_ms_);
+    writer.putU64(returns_.count);
+    writer.putDouble(returns_.mean);
+    writer.putDouble(returns_.m2);
+    writer.putI64(current_bucket_);
+    writer.putDouble(bucket_start_equity_);
+    writer.putBool(started_);
+    writer.putDouble(equity_);
+    writer.putDouble(peak_equity_);
+    writer.putDouble(max_drawdown_);
+    writer.putU64(fills_);
+    writer.putTime(last_fill_);
+    writer.putU64(curve_stride_);
+    writer.putU64(since_sample_);
+    writer.putU32(static_cast<uint32_t>(curve_.size()));
+    for (const auto& point : curve_) {
+        writer.putTime(point.timestamp);
+        writer.putDouble(point.equity);
+    }
+}
+
+void StrategyStatistics::restore(SnapshotReader& reader) {
+    if (reader.getI64() != bucket_ms_) {
+        throw std::runtime_error("Strategy statistics snapshot uses a different bucket size");
+    }
+
+    StrategyStatistics restored(config_);
+    restored.returns_.count = reader.getU64();
+    restored.returns_.mean = reader.getDouble();
+    restored.returns_.m2 = reader.getDouble();
+    restored.current_bucket_ = reader.getI64();
+    restored.bucket_start_equity_ = reader.getDouble();
+    restored.started_ = reader.getBool();
+    restored.equity_ = reader.getDouble();
+    restored.peak_equity_ = reader.getDouble();
+    restored.max_drawdown_ = reader.getDouble();
+    restored.fills_ = reader.getU64();
+    restored.last_fill_ = reader.getTime();
+    restored.curve_stride_ = std::max<uint64_t>(1, reader.getU64());
+    restored.since_sample_ = reader.getU64();
+
+    uint32_t points = reader.getCount(16);
+    // Keep the newest points if the configured bound shrank
+    const uint32_t skip = points > config_.max_curve_points ? points - static_cast<uint32_t>(config_.max_curve_points) : 0;
+    for (uint32_t i = 0; i < points; ++i) {
+        CurvePoint point{reader.getTime(), reader.getDouble()};
+        if (i >= skip) {
+            restored.curve_.push_back(point);
+        }
+    }
+
+    *this = std::move(restored);
+}
@@ -0,0 +1,90 @@
+#ifndef STRATEGY_STATISTICS_H
+#define STRATEGY_STATISTICS_H
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Online performance statistics for one strategy, updated in O(1) per fill.
+// Realized PnL is bucketed in fixed time buckets; each closed bucket is one
+// return sample fed to Welford's mean/variance, and buckets with no fills
+// count as zero returns (merged in one step however many were skipped).
+// Drawdown is peak-to-trough on the cumulative PnL curve, and the curve is
+// kept at a bounded size by halving its resolution whenever it fills up.
+class StrategyStatistics {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    struct Config {
+        std::chrono::milliseconds bucket{std::chrono::minutes(1)};
+        size_t max_curve_points{512};
+    };
+
+    struct CurvePoint {
+        TimePoint timestamp;
+        double equity;
+    };
+
+    struct Snapshot {
+        double equity;           // Cumulative realized PnL
+        double peak_equity;
+        double drawdown;         // Current distance below the peak, >= 0
+        double max_drawdown;     // Largest peak-to-trough decline, >= 0
+        double mean_return;      // Per bucket
+        double stddev_return;    // Per bucket, sample standard deviation
+        double sharpe_ratio;     // Annualized over a 24/7 calendar
+        uint64_t return_samples;
+        uint64_t fills;
+    };
+
+    StrategyStatistics();
+    explicit StrategyStatistics(const Config& config);
+
+    void onFill(TimePoint timestamp, double pnl);
+
+    Snapshot snapshot() const;
+    // Ends with the latest equity even if it has not been sampled yet
+    std::vector<CurvePoint> equityCurve() const;
+
+    // Full internal state, so a restored instance continues exactly where
+    // the saved one stopped. Throws if the bucket size differs.
+    void save(SnapshotWriter& writer) const;
+    void restore(SnapshotReader& reader);
+
+private:
+    struct Moments {
+        uint64_t count{0};
+        double mean{0.0};
+        double m2{0.0};
+
+        void add(double value);
+        void addZeros(uint64_t zeros);
+    };
+
+    int64_t bucketIndex(TimePoint timestamp) const;
+    void sampleCurve(TimePoint timestamp);
+
+    Config config_;
+    int64_t bucket_ms_;
+
+    Moments returns_;
+    int64_t current_bucket_{0};
+    double bucket_start_equity_{0.0};
+    bool started_{false};
+
+    double equity_{0.0};
+    double peak_equity_{0.0};
+    double max_drawdown_{0.0};
+    uint64_t fills_{0};
+    TimePoint last_fill_;
+
+    std::vector<CurvePoint> curve_;
+    uint64_t curve_stride_{1};   // Fills per kept point
+    uint64_t since_sample_{0};
+};
+
+#endif // STRATEGY_STATISTICS_H
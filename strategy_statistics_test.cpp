@@ -0,0 +1,113 @@
+#include "strategy_statistics.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+
+class StrategyStatisticsTest : public ::testing::Test {
+protected:
+    using Clock = std::chrono::system_clock;
+
+    static Clock::time_point at(int64_t ms) {
+        return Clock::time_point(std::chrono::milliseconds(1700000000000LL + ms));
+    }
+
+    static StrategyStatistics::Config config(int64_t bucket_ms, size_t max_points = 512) {
+        StrategyStatistics::Config config;
+        config.bucket = std::chrono::milliseconds(bucket_ms);
+        config.max_curve_points = max_points;
+        return config;
+    }
+};
+
+TEST_F(StrategyStatisticsTest, DrawdownIsPeakToTrough) {
+    StrategyStatistics stats(config(1000));
+    const double pnls[] = {10.0, 5.0, -8.0, -4.0, 3.0, 20.0, -6.0};
+    int64_t t = 0;
+    for (double pnl : pnls) {
+        stats.onFill(at(t += 10), pnl);
+    }
+
+    auto snapshot = stats.snapshot();
+    EXPECT_DOUBLE_EQ(snapshot.equity, 20.0);
+    EXPECT_DOUBLE_EQ(snapshot.peak_equity, 26.0);
+    EXPECT_DOUBLE_EQ(snapshot.drawdown, 6.0);
+    // 15 -> 3 is the deepest decline, larger than any single losing fill
+    EXPECT_DOUBLE_EQ(snapshot.max_drawdown, 12.0);
+    EXPECT_EQ(snapshot.fills, 7u);
+}
+
+TEST_F(StrategyStatisticsTest, ReturnMomentsMatchTwoPass) {
+    StrategyStatistics stats(config(1000));
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> pnl(0.5, 3.0);
+
+    // Several fills per bucket with random gaps, including skipped buckets
+    std::vector<double> bucket_returns;
+    int64_t bucket = 0;
+    double open_return = 0.0;
+    for (int i = 0; i < 5000; ++i) {
+        int64_t next = bucket + static_cast<int64_t>(rng() % 4 == 0 ? rng() % 5 : 0);
+        if (next != bucket) {
+            bucket_returns.push_back(open_return);
+            for (int64_t gap = bucket + 1; gap < next; ++gap) {
+                bucket_returns.push_back(0.0);
+            }
+            open_return = 0.0;
+            bucket = next;
+        }
+        double value = pnl(rng);
+        open_return += value;
+        stats.onFill(at(bucket * 1000 + static_cast<int64_t>(rng() % 1000)), value);
+    }
+
+    double mean = 0.0;
+    for (double r : bucket_returns) mean += r;
+    mean /= bucket_returns.size();
+    double ss = 0.0;
+    for (double r : bucket_returns) ss += (r - mean) * (r - mean);
+    double stddev = std::sqrt(ss / (bucket_returns.size() - 1));
+
+    auto snapshot = stats.snapshot();
+    ASSERT_EQ(snapshot.return_samples, bucket_returns.size());
+    EXPECT_NEAR(snapshot.mean_return, mean, 1e-9);
+    EXPECT_NEAR(snapshot.stddev_return, stddev, 1e-9);
+
+    const double buckets_per_year = 365.0 * 24.0 * 3600.0;
+    EXPECT_NEAR(snapshot.sharpe_ratio, mean / stddev * std::sqrt(buckets_per_year), 1e-6);
+}
+
+TEST_F(StrategyStatisticsTest, OpenBucketIsNotASample) {
+    StrategyStatistics stats(config(1000));
+    stats.onFill(at(0), 1.0);
+    stats.onFill(at(500), 1.0);
+    EXPECT_EQ(stats.snapshot().return_samples, 0u);
+    EXPECT_DOUBLE_EQ(stats.snapshot().sharpe_ratio, 0.0);
+
+    stats.onFill(at(1500), 1.0);
+    EXPECT_EQ(stats.snapshot().return_samples, 1u);
+    EXPECT_DOUBLE_EQ(stats.snapshot().mean_return, 2.0);
+}
+
+TEST_F(StrategyStatisticsTest, EquityCurveStaysBounded) {
+    const size_t max_points = 64;
+    StrategyStatistics stats(config(1000, max_points));
+    for (int i = 1; i <= 100000; ++i) {
+        stats.onFill(at(i), 1.0);
+        ASSERT_LE(stats.equityCurve().size(), max_points + 1);
+    }
+
+    auto curve = stats.equityCurve();
+    EXPECT_GE(curve.size(), max_points / 2);
+    EXPECT_DOUBLE_EQ(curve.front().equity, 1.0);
+    EXPECT_DOUBLE_EQ(curve.back().equity, 100000.0);
+    EXPECT_EQ(curve.back().timestamp, at(100000));
+    for (size_t i = 1; i < curve.size(); ++i) {
+        EXPECT_LT(curve[i - 1].timestamp, curve[i].timestamp);
+        EXPECT_LT(curve[i - 1].equity, curve[i].equity);
+    }
+}
+
+TEST_F(StrategyStatisticsTest, RejectsInvalidConfig) {
+    EXPECT_THROW(StrategyStatistics(config(0)), std::invalid_argument);
+    EXPECT_THROW(StrategyStatistics(config(1000, 1)), std::invalid_argument);
+}
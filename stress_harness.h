@@ -0,0 +1,207 @@
+#ifndef STRESS_HARNESS_H
+#define STRESS_HARNESS_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+// Support code for the concurrency stress tests. Every worker gets its own
+// deterministic random stream derived from the run seed, so a failing seed
+// reproduces the same operation mix and the same perturbation points; the
+// interleaving itself still comes from the OS scheduler. All sizes can be
+// overridden from the environment:
+//   STRESS_PRODUCERS, STRESS_CONSUMERS, STRESS_OPERATIONS, STRESS_SEED,
+//   STRESS_PERTURB (percentage of operations followed by a yield or spin)
+namespace stress {
+
+struct Config {
+    int producers{4};
+    int consumers{2};
+    size_t operations{10000};  // Per producer
+    uint64_t seed{1};
+    int perturb_percent{5};
+
+    // Defaults for a test, overridden by any STRESS_* variables that are set
+    static Config fromEnvironment(int producers, int consumers, size_t operations) {
+        Config config;
+        config.producers = producers;
+        config.consumers = consumers;
+        config.operations = operations;
+        if (const char* value = std::getenv("STRESS_PRODUCERS")) config.producers = std::max(1, std::atoi(value));
+        if (const char* value = std::getenv("STRESS_CONSUMERS")) config.consumers = std::max(0, std::atoi(value));
+        if (const char* value = std::getenv("STRESS_OPERATIONS")) config.operations = std::strtoull(value, nullptr, 10);
+        if (const char* value = std::getenv("STRESS_SEED")) config.seed = std::strtoull(value, nullptr, 10);
+        if (const char* value = std::getenv("STRESS_PERTURB")) config.perturb_percent = std::atoi(value);
+        return config;
+    }
+
+    std::string describe() const {
+        return "producers=" + std::to_string(producers) + " consumers=" + std::to_string(consumers) +
+               " operations=" + std::to_string(operations) + " seed=" + std::to_string(seed) +
+               " perturb=" + std::to_string(perturb_percent) + "%";
+    }
+};
+
+// Per-thread random stream (splitmix64) that also injects scheduling noise
+class Worker {
+public:
+    Worker(int index, uint64_t seed, int perturb_percent)
+        : index_(index), state_(seed ^ (0x9E3779B97F4A7C15ull * (index + 1))),
+          perturb_percent_(perturb_percent) {}
+
+    int index() const { return index_; }
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t below(uint64_t bound) { return bound ? next() % bound : 0; }
+
+    // Occasionally gives up the CPU or spins so that threads overlap at
+    // different points on every run
+    void perturb() {
+        if (static_cast<int>(below(100)) >= perturb_percent_) {
+            return;
+        }
+        switch (below(3)) {
+            case 0:
+                std::this_thread::yield();
+                break;
+            case 1: {
+                volatile uint64_t sink = 0;
+                for (uint64_t i = below(256); i > 0; --i) sink = sink + i;
+                break;
+            }
+            default:
+                std::this_thread::sleep_for(std::chrono::microseconds(below(50)));
+                break;
+        }
+    }
+
+private:
+    int index_;
+    uint64_t state_;
+    int perturb_percent_;
+};
+
+struct Result {
+    double seconds{0.0};
+    uint64_t operations{0};
+
+    double opsPerSecond() const { return seconds > 0.0 ? operations / seconds : 0.0; }
+};
+
+using Body = std::function<void(Worker&)>;
+
+// Starts every producer and consumer behind a common gate so they contend
+// from the first operation. Consumers run until all producers have returned
+// and then see done() == true; a consumer must keep polling until then.
+class Runner {
+public:
+    explicit Runner(const Config& config) : config_(config) {}
+
+    bool done() const { return producers_done_.load(std::memory_order_acquire); }
+
+    Result run(const Body& producer, const Body& consumer = Body()) {
+        std::atomic<int> ready{0};
+        std::atomic<bool> go{false};
+        const int consumers = consumer ? config_.consumers : 0;
+        const int total = config_.producers + consumers;
+        producers_done_.store(false, std::memory_order_release);
+
+        auto launch = [&](int index, const Body& body) {
+            return std::thread([&, index] {
+                Worker worker(index, config_.seed, config_.perturb_percent);
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                body(worker);
+            });
+        };
+
+        std::vector<std::thread> producers;
+        std::vector<std::thread> consumer_threads;
+        for (int i = 0; i < config_.producers; ++i) producers.push_back(launch(i, producer));
+        for (int i = 0; i < consumers; ++i) consumer_threads.push_back(launch(config_.producers + i, consumer));
+
+        while (ready.load() < total) {
+            std::this_thread::yield();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+
+        for (auto& thread : producers) thread.join();
+        const auto end = std::chrono::steady_clock::now();
+        producers_done_.store(true, std::memory_order_release);
+        for (auto& thread : consumer_threads) thread.join();
+
+        Result result;
+        result.seconds = std::chrono::duration<double>(end - start).count();
+        result.operations = static_cast<uint64_t>(config_.producers) * config_.operations;
+        return result;
+    }
+
+private:
+    Config config_;
+    std::atomic<bool> producers_done_{false};
+};
+
+inline void report(const std::string& name, const Config& config, const Result& result) {
+    std::cout << "[ STRESS   ] " << name << ": " << result.operations << " ops in "
+              << std::fixed << std::setprecision(3) << result.seconds * 1000.0 << " ms ("
+              << std::setprecision(0) << result.opsPerSecond() << " ops/s) " << config.describe()
+              << std::defaultfloat << std::endl;
+}
+
+// Operation history for linearizability checks. Invocation and response
+// stamps come from one global counter, so "a completed before b started" is
+// exactly a.response < b.invoke.
+struct Event {
+    int thread;
+    int op;
+    uint64_t key;
+    uint64_t result;
+    uint64_t invoke;
+    uint64_t response;
+};
+
+class History {
+public:
+    explicit History(int threads) : events_(threads) {}
+
+    uint64_t stamp() { return clock_.fetch_add(1, std::memory_order_acq_rel); }
+
+    // Only the owning thread appends to its own log
+    void record(int thread, int op, uint64_t key, uint64_t result, uint64_t invoke, uint64_t response) {
+        events_[thread].push_back({thread, op, key, result, invoke, response});
+    }
+
+    // All events ordered by invocation
+    std::vector<Event> merged() const {
+        std::vector<Event> all;
+        for (const auto& log : events_) all.insert(all.end(), log.begin(), log.end());
+        std::sort(all.begin(), all.end(), [](const Event& a, const Event& b) { return a.invoke < b.invoke; });
+        return all;
+    }
+
+private:
+    std::atomic<uint64_t> clock_{0};
+    std::vector<std::vector<Event>> events_;
+};
+
+}  // namespace stress
+
+#endif // STRESS_HARNESS_H
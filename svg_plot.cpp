@@ -0,0 +1,319 @@
+#include "svg_plot.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace svg_plot {
+
+namespace {
+
+const char* const PALETTE[] = {
+    "#1f77b4", "#d62728", "#2ca02c", "#ff7f0e", "#9467bd", "#8c564b", "#e377c2", "#17becf"
+};
+const size_t PALETTE_SIZE = sizeof(PALETTE) / sizeof(PALETTE[0]);
+
+const int MARGIN_LEFT = 72;
+const int MARGIN_RIGHT = 24;
+const int MARGIN_TOP = 36;
+const int MARGIN_BOTTOM = 52;
+
+struct Scale {
+    double lo{0.0};
+    double hi{1.0};
+    bool log{false};
+    double px_lo{0.0};  // Pixel coordinate of lo
+    double px_hi{1.0};
+
+    double map(double v) const {
+        double t = log ? (std::log10(v) - std::log10(lo)) / (std::log10(hi) - std::log10(lo))
+                       : (v - lo) / (hi - lo);
+        return px_lo + t * (px_hi - px_lo);
+    }
+
+    bool contains(double v) const {
+        return std::isfinite(v) && (!log || v > 0.0);
+    }
+};
+
+std::string formatNumber(double v) {
+    std::ostringstream ss;
+    ss.precision(4);
+    ss << v;
+    return ss.str();
+}
+
+// Picks a padded range; log ranges snap to whole decades
+Scale makeScale(const std::vector<double>& values, bool log, bool include_zero) {
+    Scale scale;
+    scale.log = log;
+
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -std::numeric_limits<double>::infinity();
+    for (double v : values) {
+        if (!std::isfinite(v) || (log && v <= 0.0)) continue;
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    if (!std::isfinite(lo)) {
+        lo = log ? 1.0 : 0.0;
+        hi = log ? 10.0 : 1.0;
+    }
+
+    if (log) {
+        scale.lo = std::pow(10.0, std::floor(std::log10(lo)));
+        scale.hi = std::pow(10.0, std::ceil(std::log10(hi)));
+        if (scale.hi <= scale.lo) scale.hi = scale.lo * 10.0;
+    } else {
+        if (include_zero) lo = std::min(lo, 0.0);
+        if (hi <= lo) hi = lo + 1.0;
+        scale.lo = lo;
+        scale.hi = hi + (hi - lo) * 0.05;
+    }
+    return scale;
+}
+
+std::vector<std::pair<double, std::string>> makeTicks(const Scale& scale) {
+    std::vector<std::pair<double, std::string>> ticks;
+    if (scale.log) {
+        for (double v = scale.lo; v <= scale.hi * 1.0001; v *= 10.0) {
+            ticks.emplace_back(v, formatNumber(v));
+        }
+        return ticks;
+    }
+
+    double raw_step = (scale.hi - scale.lo) / 6.0;
+    double magnitude = std::pow(10.0, std::floor(std::log10(raw_step)));
+    double step = magnitude;
+    for (double m : {1.0, 2.0, 5.0, 10.0}) {
+        step = m * magnitude;
+        if (step >= raw_step) break;
+    }
+    for (double v = std::ceil(scale.lo / step) * step; v <= scale.hi + step * 1e-9; v += step) {
+        ticks.emplace_back(v, formatNumber(std::abs(v) < step * 1e-9 ? 0.0 : v));
+    }
+    return ticks;
+}
+
+void openChart(std::ostringstream& ss, const Chart& chart) {
+    ss << "<svg xmlns='http://www.w3.org/2000/svg' width='" << chart.width << "' height='" << chart.height
+       << "' viewBox='0 0 " << chart.width << ' ' << chart.height << "' font-family='sans-serif' font-size='11'>\n"
+       << "<rect width='100%' height='100%' fill='white'/>\n"
+       << "<text x='" << chart.width / 2 << "' y='20' text-anchor='middle' font-size='14'>"
+       << escape(chart.title) << "</text>\n";
+}
+
+void drawAxes(std::ostringstream& ss, const Chart& chart, const Scale& x, const Scale& y,
+              const std::vector<std::pair<double, std::string>>& x_ticks) {
+    const int plot_bottom = chart.height - MARGIN_BOTTOM;
+    const int plot_right = chart.width - MARGIN_RIGHT;
+
+    for (const auto& [v, label] : x_ticks) {
+        if (!x.contains(v) || v < x.lo || v > x.hi * 1.0001) continue;
+        double px = x.map(v);
+        ss << "<line x1='" << px << "' y1='" << MARGIN_TOP << "' x2='" << px << "' y2='" << plot_bottom
+           << "' stroke='#eee'/>\n"
+           << "<text x='" << px << "' y='" << plot_bottom + 16 << "' text-anchor='middle'>" << escape(label)
+           << "</text>\n";
+    }
+    for (const auto& [v, label] : makeTicks(y)) {
+        double py = y.map(v);
+        ss << "<line x1='" << MARGIN_LEFT << "' y1='" << py << "' x2='" << plot_right << "' y2='" << py
+           << "' stroke='#eee'/>\n"
+           << "<text x='" << MARGIN_LEFT - 6 << "' y='" << py + 4 << "' text-anchor='end'>" << escape(label)
+           << "</text>\n";
+    }
+
+    ss << "<rect x='" << MARGIN_LEFT << "' y='" << MARGIN_TOP << "' width='" << plot_right - MARGIN_LEFT
+       << "' height='" << plot_bottom - MARGIN_TOP << "' fill='none' stroke='#444'/>\n"
+       << "<text x='" << (MARGIN_LEFT + plot_right) / 2 << "' y='" << chart.height - 12
+       << "' text-anchor='middle'>" << escape(chart.x_label) << "</text>\n"
+       << "<text x='16' y='" << (MARGIN_TOP + plot_bottom) / 2 << "' text-anchor='middle' transform='rotate(-90 16 "
+       << (MARGIN_TOP + plot_bottom) / 2 << ")'>" << escape(chart.y_label) << "</text>\n";
+}
+
+void drawLegend(std::ostringstream& ss, const Chart& chart) {
+    if (chart.series.size() < 2) return;
+    int y = MARGIN_TOP + 8;
+    const int x = chart.width - MARGIN_RIGHT - 150;
+    for (size_t i = 0; i < chart.series.size(); ++i, y += 15) {
+        ss << "<rect x='" << x << "' y='" << y - 8 << "' width='10' height='10' fill='"
+           << PALETTE[i % PALETTE_SIZE] << "'/>\n"
+           << "<text x='" << x + 14 << "' y='" << y + 1 << "'>" << escape(chart.series[i].name) << "</text>\n";
+    }
+}
+
+void placeScales(const Chart& chart, Scale& x, Scale& y) {
+    x.px_lo = MARGIN_LEFT;
+    x.px_hi = chart.width - MARGIN_RIGHT;
+    y.px_lo = chart.height - MARGIN_BOTTOM;
+    y.px_hi = MARGIN_TOP;
+}
+
+}  // namespace
+
+Histogram logHistogram(const std::vector<double>& samples, int bins_per_decade) {
+    Histogram histogram;
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = 0.0;
+    for (double v : samples) {
+        if (v > 0.0 && std::isfinite(v)) {
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+    }
+    if (!std::isfinite(lo) || bins_per_decade <= 0) {
+        return histogram;
+    }
+
+    const double first = std::floor(std::log10(lo) * bins_per_decade);
+    const size_t bins = static_cast<size_t>(std::floor(std::log10(hi) * bins_per_decade) - first) + 1;
+    histogram.edges.resize(bins + 1);
+    for (size_t i = 0; i <= bins; ++i) {
+        histogram.edges[i] = std::pow(10.0, (first + i) / bins_per_decade);
+    }
+    histogram.counts.assign(bins, 0);
+
+    for (double v : samples) {
+        if (!(v > 0.0) || !std::isfinite(v)) continue;
+        auto bin = static_cast<long>(std::floor(std::log10(v) * bins_per_decade) - first);
+        bin = std::max(0L, std::min(static_cast<long>(bins) - 1, bin));
+        histogram.counts[bin]++;
+    }
+    return histogram;
+}
+
+std::string renderLines(const Chart& chart) {
+    std::vector<double> xs;
+    std::vector<double> ys;
+    for (const auto& series : chart.series) {
+        xs.insert(xs.end(), series.x.begin(), series.x.end());
+        ys.insert(ys.end(), series.y.begin(), series.y.end());
+    }
+    Scale x = makeScale(xs, chart.log_x, false);
+    Scale y = makeScale(ys, chart.log_y, true);
+    placeScales(chart, x, y);
+
+    std::ostringstream ss;
+    openChart(ss, chart);
+    drawAxes(ss, chart, x, y, chart.x_ticks.empty() ? makeTicks(x) : chart.x_ticks);
+
+    for (size_t s = 0; s < chart.series.size(); ++s) {
+        const auto& series = chart.series[s];
+        const char* color = PALETTE[s % PALETTE_SIZE];
+        std::ostringstream points;
+        std::ostringstream markers;
+        const size_t n = std::min(series.x.size(), series.y.size());
+        for (size_t i = 0; i < n; ++i) {
+            if (!x.contains(series.x[i]) || !y.contains(series.y[i])) continue;
+            double px = x.map(series.x[i]);
+            double py = y.map(series.y[i]);
+            points << px << ',' << py << ' ';
+            if (n <= 200) {
+                markers << "<circle cx='" << px << "' cy='" << py << "' r='2.5' fill='" << color << "'/>\n";
+            }
+        }
+        ss << "<polyline fill='none' stroke='" << color << "' stroke-width='1.5' points='" << points.str()
+           << "'/>\n" << markers.str();
+    }
+
+    drawLegend(ss, chart);
+    ss << "</svg>\n";
+    return ss.str();
+}
+
+std::string renderHistogram(const Chart& chart, const Histogram& histogram) {
+    std::vector<double> counts(histogram.counts.begin(), histogram.counts.end());
+    Scale x = makeScale(histogram.edges, true, false);
+    Scale y = makeScale(counts, chart.log_y, true);
+    placeScales(chart, x, y);
+
+    std::ostringstream ss;
+    openChart(ss, chart);
+    drawAxes(ss, chart, x, y, chart.x_ticks.empty() ? makeTicks(x) : chart.x_ticks);
+
+    for (size_t i = 0; i < histogram.counts.size(); ++i) {
+        if (histogram.counts[i] == 0) continue;
+        double left = x.map(histogram.edges[i]);
+        double right = x.map(histogram.edges[i + 1]);
+        double top = y.map(static_cast<double>(histogram.counts[i]));
+        ss << "<rect x='" << left << "' y='" << top << "' width='" << std::max(0.5, right - left - 0.5)
+           << "' height='" << y.px_lo - top << "' fill='" << PALETTE[0] << "'><title>"
+           << formatNumber(histogram.edges[i]) << " - " << formatNumber(histogram.edges[i + 1]) << ": "
+           << histogram.counts[i] << "</title></rect>\n";
+    }
+
+    ss << "</svg>\n";
+    return ss.str();
+}
+
+std::string renderPercentiles(const Chart& chart) {
+    // x = 1 / (1 - q), so each extra nine takes the same width
+    Chart spectrum = chart;
+    spectrum.log_x = true;
+    spectrum.x_ticks.clear();
+    size_t max_count = 0;
+
+    for (auto& series : spectrum.series) {
+        const auto sorted = std::move(series.y);
+        series.x.clear();
+        series.y.clear();
+        if (sorted.empty()) continue;
+        max_count = std::max(max_count, sorted.size());
+
+        const double max_x = static_cast<double>(sorted.size());
+        const int points = 120;
+        for (int i = 0; i <= points; ++i) {
+            double inv = std::pow(max_x, static_cast<double>(i) / points);
+            double q = 1.0 - 1.0 / inv;
+            series.x.push_back(inv);
+            series.y.push_back(sorted[static_cast<size_t>((sorted.size() - 1) * q)]);
+        }
+    }
+
+    spectrum.x_ticks.emplace_back(1.0, "0%");
+    spectrum.x_ticks.emplace_back(2.0, "50%");
+    int nines = 1;
+    for (double inv = 10.0; inv <= static_cast<double>(max_count) * 1.0001; inv *= 10.0, ++nines) {
+        std::ostringstream label;
+        label.precision(nines + 1);
+        label << 100.0 * (1.0 - 1.0 / inv) << '%';
+        spectrum.x_ticks.emplace_back(inv, label.str());
+    }
+    return renderLines(spectrum);
+}
+
+std::string escape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '&': escaped += "&amp;"; break;
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            case '\'': escaped += "&#39;"; break;
+            case '"': escaped += "&quot;"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string page(const std::string& title, const std::vector<std::string>& sections) {
+    std::ostringstream ss;
+    ss << "<!DOCTYPE html>\n<html>\n<head>\n<meta charset='utf-8'>\n<title>" << escape(title) << "</title>\n"
+       << "<style>\n"
+       << "  body { font-family: Arial, sans-serif; margin: 20px; }\n"
+       << "  svg { margin: 8px 8px 8px 0; border: 1px solid #ddd; }\n"
+       << "  table { border-collapse: collapse; }\n"
+       << "  th, td { border: 1px solid #ddd; padding: 4px 8px; text-align: right; }\n"
+       << "  th { background-color: #f2f2f2; }\n"
+       << "</style>\n</head>\n<body>\n<h1>" << escape(title) << "</h1>\n";
+    for (const auto& section : sections) {
+        ss << section;
+    }
+    ss << "</body>\n</html>\n";
+    return ss.str();
+}
+
+}  // namespace svg_plot
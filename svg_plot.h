@@ -0,0 +1,60 @@
+#ifndef SVG_PLOT_H
+#define SVG_PLOT_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// Minimal chart rendering to inline SVG so that reports are single,
+// self-contained HTML files with no scripts or external assets. Rendering
+// works on copies of the data and is meant to run off the hot path.
+namespace svg_plot {
+
+struct Series {
+    std::string name;
+    std::vector<double> x;
+    std::vector<double> y;
+};
+
+struct Chart {
+    std::string title;
+    std::string x_label;
+    std::string y_label;
+    bool log_x{false};
+    bool log_y{false};
+    int width{720};
+    int height{360};
+    std::vector<Series> series;
+    // Replaces the generated x ticks, e.g. percentile labels
+    std::vector<std::pair<double, std::string>> x_ticks;
+};
+
+// Bins are contiguous: bin i spans [edges[i], edges[i + 1])
+struct Histogram {
+    std::vector<double> edges;
+    std::vector<size_t> counts;
+};
+
+// Log-spaced bins covering the positive samples; non-positive values are
+// dropped since they cannot be placed on a log axis
+Histogram logHistogram(const std::vector<double>& samples, int bins_per_decade = 10);
+
+// Line chart with point markers and a legend when there is more than one series
+std::string renderLines(const Chart& chart);
+
+// Bars on a log x axis; the chart's series are ignored
+std::string renderHistogram(const Chart& chart, const Histogram& histogram);
+
+// Latency at each percentile on an axis stretched towards the tail
+// (50, 90, 99, 99.9, ...). Each series' y holds its sorted samples.
+std::string renderPercentiles(const Chart& chart);
+
+std::string escape(const std::string& text);
+
+// Wraps rendered sections in a complete HTML document
+std::string page(const std::string& title, const std::vector<std::string>& sections);
+
+}  // namespace svg_plot
+
+#endif // SVG_PLOT_H
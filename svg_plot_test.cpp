@@ -0,0 +1,126 @@
+#include "svg_plot.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <string>
+
+class SvgPlotTest : public ::testing::Test {
+protected:
+    static size_t count(const std::string& text, const std::string& needle) {
+        size_t n = 0;
+        for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+            ++n;
+        }
+        return n;
+    }
+
+    // Coordinates derived from empty ranges or log(0) print as nan/inf
+    static void expectFiniteCoordinates(const std::string& svg) {
+        EXPECT_EQ(svg.find("nan"), std::string::npos) << svg;
+        EXPECT_EQ(svg.find("inf"), std::string::npos) << svg;
+    }
+
+    static svg_plot::Chart chart(std::vector<svg_plot::Series> series) {
+        svg_plot::Chart c;
+        c.title = "Latency";
+        c.series = std::move(series);
+        return c;
+    }
+};
+
+TEST_F(SvgPlotTest, EscapeCoversMarkupAndQuotes) {
+    EXPECT_EQ(svg_plot::escape("a<b>&'c'\"d\""), "a&lt;b&gt;&amp;&#39;c&#39;&quot;d&quot;");
+    EXPECT_EQ(svg_plot::escape("plain text 123"), "plain text 123");
+    EXPECT_EQ(svg_plot::escape(""), "");
+}
+
+TEST_F(SvgPlotTest, LabelsAndSeriesNamesAreEscaped) {
+    auto c = chart({{"<script>", {1, 2}, {3, 4}}, {"a&b", {1, 2}, {5, 6}}});
+    c.title = "p99 < 5ms";
+    c.x_label = "rate 'req/s'";
+    c.y_label = "\"us\"";
+    auto svg = svg_plot::renderLines(c);
+
+    EXPECT_EQ(svg.find("<script>"), std::string::npos);
+    EXPECT_NE(svg.find("&lt;script&gt;"), std::string::npos);
+    EXPECT_NE(svg.find("a&amp;b"), std::string::npos);
+    EXPECT_NE(svg.find("p99 &lt; 5ms"), std::string::npos);
+    EXPECT_NE(svg.find("rate &#39;req/s&#39;"), std::string::npos);
+    EXPECT_NE(svg.find("&quot;us&quot;"), std::string::npos);
+
+    auto html = svg_plot::page("A & B", {svg});
+    EXPECT_EQ(count(html, "A &amp; B"), 2u);
+}
+
+TEST_F(SvgPlotTest, EmptySeriesRenderAnEmptyChart) {
+    for (bool log : {false, true}) {
+        auto c = chart({{"empty", {}, {}}});
+        c.log_x = c.log_y = log;
+        auto svg = svg_plot::renderLines(c);
+        EXPECT_EQ(svg.rfind("<svg", 0), 0u);
+        EXPECT_NE(svg.find("</svg>"), std::string::npos);
+        EXPECT_NE(svg.find("points=''"), std::string::npos);
+        EXPECT_EQ(count(svg, "<circle"), 0u);
+        expectFiniteCoordinates(svg);
+    }
+
+    expectFiniteCoordinates(svg_plot::renderLines(chart({})));
+    expectFiniteCoordinates(svg_plot::renderPercentiles(chart({{"empty", {}, {}}})));
+    expectFiniteCoordinates(svg_plot::renderHistogram(chart({}), svg_plot::logHistogram({})));
+}
+
+TEST_F(SvgPlotTest, SinglePointAndFlatSeriesStayFinite) {
+    expectFiniteCoordinates(svg_plot::renderLines(chart({{"one", {5}, {5}}})));
+    expectFiniteCoordinates(svg_plot::renderLines(chart({{"flat", {1, 2, 3}, {7, 7, 7}}})));
+
+    auto c = chart({{"decade", {100, 100}, {100, 100}}});
+    c.log_x = c.log_y = true;
+    expectFiniteCoordinates(svg_plot::renderLines(c));
+    expectFiniteCoordinates(svg_plot::renderPercentiles(chart({{"one", {}, {42}}})));
+}
+
+TEST_F(SvgPlotTest, LogAxisDropsNonPositiveAndNonFiniteValues) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    auto c = chart({{"mixed", {-1, 0, 1, 10, 100, nan}, {5, 5, 5, 50, 500, 5}}});
+    c.log_x = true;
+    auto svg = svg_plot::renderLines(c);
+
+    EXPECT_EQ(count(svg, "<circle"), 3u);
+    expectFiniteCoordinates(svg);
+    // Decade ticks from 1 to 100
+    for (const char* tick : {">1</text>", ">10</text>", ">100</text>"}) {
+        EXPECT_NE(svg.find(tick), std::string::npos) << tick;
+    }
+}
+
+TEST_F(SvgPlotTest, LogHistogramBinsByDecadeFraction) {
+    auto histogram = svg_plot::logHistogram({0.0, -3.0, 1.0, 1.5, 9.9, 10.0, 55.0}, 1);
+    ASSERT_EQ(histogram.edges.size(), 3u);
+    EXPECT_DOUBLE_EQ(histogram.edges[0], 1.0);
+    EXPECT_DOUBLE_EQ(histogram.edges[1], 10.0);
+    EXPECT_DOUBLE_EQ(histogram.edges[2], 100.0);
+    ASSERT_EQ(histogram.counts.size(), 2u);
+    EXPECT_EQ(histogram.counts[0], 3u);
+    EXPECT_EQ(histogram.counts[1], 2u);
+
+    EXPECT_TRUE(svg_plot::logHistogram({0.0, -1.0}).counts.empty());
+    EXPECT_TRUE(svg_plot::logHistogram({1.0}, 0).counts.empty());
+
+    auto svg = svg_plot::renderHistogram(chart({}), histogram);
+    EXPECT_EQ(count(svg, "<title>"), 2u);
+    expectFiniteCoordinates(svg);
+}
+
+TEST_F(SvgPlotTest, PercentileAxisLabelsEachNine) {
+    std::vector<double> sorted(1000);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        sorted[i] = static_cast<double>(i + 1);
+    }
+    auto svg = svg_plot::renderPercentiles(chart({{"p", {}, sorted}}));
+
+    for (const char* label : {">0%<", ">50%<", ">90%<", ">99%<", ">99.9%<"}) {
+        EXPECT_NE(svg.find(label), std::string::npos) << label;
+    }
+    EXPECT_EQ(svg.find(">99.99%<"), std::string::npos);
+    expectFiniteCoordinates(svg);
+}
@@ -0,0 +1,550 @@
+#include "tick_archive.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace tick_archive;
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'H', 'F', 'T', 'T', 'I', 'C', 'K', '1'};
+constexpr char INDEX_MAGIC[8] = {'H', 'F', 'T', 'T', 'I', 'D', 'X', '1'};
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t FOOTER_SIZE = 24;
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline void putSigned(std::string& out, int64_t value) {
+    putVarint(out, zigzagEncode(value));
+}
+
+template <typename T>
+void putFixed(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+// Bounds-checked cursor over one encoded region
+class Cursor {
+public:
+    Cursor(const uint8_t* begin, const uint8_t* end) : pos_(begin), end_(end) {}
+
+    uint64_t varint() {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ == end_) {
+                throw std::runtime_error("Corrupt tick archive: truncated varint");
+            }
+            uint8_t byte = *pos_++;
+            result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return result;
+            }
+        }
+        throw std::runtime_error("Corrupt tick archive: varint too long");
+    }
+
+    int64_t signedVarint() { return zigzagDecode(varint()); }
+
+    uint8_t byte() {
+        if (pos_ == end_) {
+            throw std::runtime_error("Corrupt tick archive: truncated block");
+        }
+        return *pos_++;
+    }
+
+    template <typename T>
+    T fixed() {
+        if (static_cast<size_t>(end_ - pos_) < sizeof(T)) {
+            throw std::runtime_error("Corrupt tick archive: truncated index");
+        }
+        T value;
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::string bytes(size_t length) {
+        if (static_cast<size_t>(end_ - pos_) < length) {
+            throw std::runtime_error("Corrupt tick archive: truncated index");
+        }
+        std::string result(reinterpret_cast<const char*>(pos_), length);
+        pos_ += length;
+        return result;
+    }
+
+    const uint8_t* position() const { return pos_; }
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+};
+
+void putLevels(std::string& out, const std::vector<Level>& levels) {
+    putVarint(out, levels.size());
+    int64_t previous = 0;
+    for (const auto& level : levels) {
+        putSigned(out, level.price_ticks - previous);
+        putSigned(out, level.size);
+        previous = level.price_ticks;
+    }
+}
+
+void readLevels(Cursor& cursor, std::vector<Level>& levels) {
+    uint64_t count = cursor.varint();
+    levels.clear();
+    levels.reserve(static_cast<size_t>(std::min<uint64_t>(count, 1u << 20)));
+    int64_t previous = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        Level level;
+        level.price_ticks = previous + cursor.signedVarint();
+        level.size = cursor.signedVarint();
+        previous = level.price_ticks;
+        levels.push_back(level);
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// TickArchiveWriter
+// ---------------------------------------------------------------------------
+
+TickArchiveWriter::TickArchiveWriter(const std::string& filename)
+    : TickArchiveWriter(filename, Config{}) {}
+
+TickArchiveWriter::TickArchiveWriter(const std::string& filename, const Config& config)
+    : file_(filename, std::ios::binary | std::ios::trunc),
+      config_(config) {
+    if (!file_.is_open()) {
+        throw std::runtime_error("Failed to open tick archive for writing: " + filename);
+    }
+    if (config_.ticks_per_block == 0) {
+        config_.ticks_per_block = 1;
+    }
+
+    std::string header(FILE_MAGIC, sizeof(FILE_MAGIC));
+    putFixed<uint32_t>(header, FORMAT_VERSION);
+    putFixed<uint32_t>(header, 0);
+    file_.write(header.data(), header.size());
+    offset_ = HEADER_SIZE;
+
+    pending_.reserve(config_.ticks_per_block);
+}
+
+TickArchiveWriter::~TickArchiveWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; an unclosed archive has no index
+    }
+}
+
+uint32_t TickArchiveWriter::addInstrument(const std::string& name, double tick_size, double size_unit) {
+    if (closed_) {
+        throw std::runtime_error("Tick archive already closed");
+    }
+    instruments_.push_back({name, tick_size, size_unit});
+    books_.emplace_back();
+    last_price_.push_back(0);
+    return static_cast<uint32_t>(instruments_.size() - 1);
+}
+
+void TickArchiveWriter::append(const Tick& tick) {
+    if (closed_) {
+        throw std::runtime_error("Tick archive already closed");
+    }
+    if (tick.instrument_id >= instruments_.size()) {
+        throw std::invalid_argument("Unknown instrument id in tick: " + std::to_string(tick.instrument_id));
+    }
+    if (tick_count_ > 0 && tick.timestamp_ns < last_timestamp_ns_) {
+        throw std::invalid_argument("Ticks must be appended in timestamp order");
+    }
+
+    pending_.push_back(tick);
+    applyToBook(tick);
+    last_timestamp_ns_ = tick.timestamp_ns;
+    tick_count_++;
+
+    if (pending_.size() >= config_.ticks_per_block) {
+        flushBlock();
+        if (config_.checkpoint_interval_blocks > 0 &&
+            ++blocks_since_checkpoint_ >= config_.checkpoint_interval_blocks) {
+            writeCheckpoints();
+        }
+    }
+}
+
+void TickArchiveWriter::applyToBook(const Tick& tick) {
+    auto& book = books_[tick.instrument_id];
+    if (tick.type == TickType::BID) {
+        if (tick.size == 0) {
+            book.bids.erase(tick.price_ticks);
+        } else {
+            book.bids[tick.price_ticks] = tick.size;
+        }
+        book.changed = true;
+    } else if (tick.type == TickType::ASK) {
+        if (tick.size == 0) {
+            book.asks.erase(tick.price_ticks);
+        } else {
+            book.asks[tick.price_ticks] = tick.size;
+        }
+        book.changed = true;
+    }
+}
+
+void TickArchiveWriter::flushBlock() {
+    if (pending_.empty()) {
+        return;
+    }
+
+    const size_t count = pending_.size();
+    std::string payload;
+    payload.reserve(count * 8 + 16);
+    putVarint(payload, count);
+
+    BlockInfo info{};
+    info.kind = BlockKind::TICKS;
+    info.tick_count = static_cast<uint32_t>(count);
+    info.first_timestamp_ns = pending_.front().timestamp_ns;
+    info.last_timestamp_ns = pending_.back().timestamp_ns;
+
+    int64_t previous_ts = 0;
+    for (const auto& tick : pending_) {
+        putSigned(payload, tick.timestamp_ns - previous_ts);
+        previous_ts = tick.timestamp_ns;
+    }
+
+    for (const auto& tick : pending_) {
+        putVarint(payload, tick.instrument_id);
+        info.instrument_mask |= uint64_t{1} << (tick.instrument_id % 64);
+    }
+
+    for (size_t i = 0; i < count; i += 4) {
+        uint8_t packed = 0;
+        for (size_t j = 0; j < 4 && i + j < count; ++j) {
+            packed |= static_cast<uint8_t>(static_cast<uint8_t>(pending_[i + j].type) & 0x3) << (j * 2);
+        }
+        payload.push_back(static_cast<char>(packed));
+    }
+
+    // Price deltas restart from zero in every block so blocks decode alone
+    std::fill(last_price_.begin(), last_price_.end(), 0);
+    for (const auto& tick : pending_) {
+        auto& last = last_price_[tick.instrument_id];
+        putSigned(payload, tick.price_ticks - last);
+        last = tick.price_ticks;
+    }
+
+    for (const auto& tick : pending_) {
+        putSigned(payload, tick.size);
+    }
+
+    writeBlock(payload, info);
+    pending_.clear();
+}
+
+void TickArchiveWriter::writeCheckpoints() {
+    flushBlock();
+
+    for (size_t id = 0; id < books_.size(); ++id) {
+        auto& book = books_[id];
+        if (!book.changed) {
+            continue;
+        }
+
+        BookSnapshot snapshot;
+        snapshot.instrument_id = static_cast<uint32_t>(id);
+        snapshot.timestamp_ns = last_timestamp_ns_;
+        for (const auto& [price, size] : book.bids) snapshot.bids.push_back({price, size});
+        for (const auto& [price, size] : book.asks) snapshot.asks.push_back({price, size});
+
+        std::string payload;
+        putVarint(payload, snapshot.instrument_id);
+        putSigned(payload, snapshot.timestamp_ns);
+        putLevels(payload, snapshot.bids);
+        putLevels(payload, snapshot.asks);
+
+        BlockInfo info{};
+        info.kind = BlockKind::CHECKPOINT;
+        info.instrument_id = snapshot.instrument_id;
+        info.first_timestamp_ns = snapshot.timestamp_ns;
+        info.last_timestamp_ns = snapshot.timestamp_ns;
+        info.instrument_mask = uint64_t{1} << (snapshot.instrument_id % 64);
+        writeBlock(payload, info);
+
+        book.changed = false;
+    }
+
+    blocks_since_checkpoint_ = 0;
+}
+
+void TickArchiveWriter::writeBlock(const std::string& payload, BlockInfo info) {
+    info.offset = offset_;
+    info.length = payload.size();
+    file_.write(payload.data(), payload.size());
+    if (!file_) {
+        throw std::runtime_error("Failed to write tick archive block");
+    }
+    offset_ += payload.size();
+    index_.push_back(info);
+}
+
+void TickArchiveWriter::close() {
+    if (closed_) {
+        return;
+    }
+    flushBlock();
+
+    std::string index;
+    putFixed<uint32_t>(index, static_cast<uint32_t>(instruments_.size()));
+    for (const auto& instrument : instruments_) {
+        putFixed<uint32_t>(index, static_cast<uint32_t>(instrument.name.size()));
+        index.append(instrument.name);
+        putFixed<double>(index, instrument.tick_size);
+        putFixed<double>(index, instrument.size_unit);
+    }
+
+    putFixed<uint64_t>(index, index_.size());
+    for (const auto& block : index_) {
+        putFixed<uint64_t>(index, block.offset);
+        putFixed<uint64_t>(index, block.length);
+        putFixed<uint8_t>(index, static_cast<uint8_t>(block.kind));
+        putFixed<uint32_t>(index, block.tick_count);
+        putFixed<uint32_t>(index, block.instrument_id);
+        putFixed<int64_t>(index, block.first_timestamp_ns);
+        putFixed<int64_t>(index, block.last_timestamp_ns);
+        putFixed<uint64_t>(index, block.instrument_mask);
+    }
+
+    putFixed<uint64_t>(index, offset_);
+    putFixed<uint64_t>(index, index.size() - sizeof(uint64_t));
+    index.append(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+
+    file_.write(index.data(), index.size());
+    file_.close();
+    closed_ = true;
+    if (file_.fail()) {
+        throw std::runtime_error("Failed to write tick archive index");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TickArchiveReader
+// ---------------------------------------------------------------------------
+
+TickArchiveReader::TickArchiveReader(const std::string& filename)
+    : filename_(filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open tick archive: " + filename);
+    }
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    data_.resize(static_cast<size_t>(size));
+    if (size > 0 && !file.read(reinterpret_cast<char*>(data_.data()), size)) {
+        throw std::runtime_error("Failed to read tick archive: " + filename);
+    }
+
+    loadIndex();
+}
+
+void TickArchiveReader::loadIndex() {
+    if (data_.size() < HEADER_SIZE + FOOTER_SIZE ||
+        std::memcmp(data_.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        throw std::runtime_error("Not a tick archive: " + filename_);
+    }
+
+    Cursor header(data_.data() + sizeof(FILE_MAGIC), data_.data() + HEADER_SIZE);
+    uint32_t version = header.fixed<uint32_t>();
+    if (version != FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported tick archive version " + std::to_string(version) + ": " + filename_);
+    }
+
+    const uint8_t* footer_begin = data_.data() + data_.size() - FOOTER_SIZE;
+    if (std::memcmp(footer_begin + 16, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        throw std::runtime_error("Tick archive has no index (not closed?): " + filename_);
+    }
+    Cursor footer(footer_begin, footer_begin + 16);
+    uint64_t index_offset = footer.fixed<uint64_t>();
+    uint64_t index_length = footer.fixed<uint64_t>();
+    if (index_offset < HEADER_SIZE || index_offset + index_length > data_.size() - FOOTER_SIZE) {
+        throw std::runtime_error("Corrupt tick archive index: " + filename_);
+    }
+
+    Cursor index(data_.data() + index_offset, data_.data() + index_offset + index_length);
+    uint32_t instrument_count = index.fixed<uint32_t>();
+    instruments_.reserve(instrument_count);
+    for (uint32_t i = 0; i < instrument_count; ++i) {
+        InstrumentInfo info;
+        info.name = index.bytes(index.fixed<uint32_t>());
+        info.tick_size = index.fixed<double>();
+        info.size_unit = index.fixed<double>();
+        instruments_.push_back(std::move(info));
+    }
+
+    uint64_t block_count = index.fixed<uint64_t>();
+    blocks_.reserve(static_cast<size_t>(std::min<uint64_t>(block_count, index_length / 45 + 1)));
+    for (uint64_t i = 0; i < block_count; ++i) {
+        BlockInfo block;
+        block.offset = index.fixed<uint64_t>();
+        block.length = index.fixed<uint64_t>();
+        block.kind = static_cast<BlockKind>(index.fixed<uint8_t>());
+        block.tick_count = index.fixed<uint32_t>();
+        block.instrument_id = index.fixed<uint32_t>();
+        block.first_timestamp_ns = index.fixed<int64_t>();
+        block.last_timestamp_ns = index.fixed<int64_t>();
+        block.instrument_mask = index.fixed<uint64_t>();
+        if (block.offset + block.length > index_offset) {
+            throw std::runtime_error("Corrupt tick archive block index: " + filename_);
+        }
+        blocks_.push_back(block);
+    }
+}
+
+uint32_t TickArchiveReader::findInstrument(const std::string& name) const {
+    for (size_t i = 0; i < instruments_.size(); ++i) {
+        if (instruments_[i].name == name) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    throw std::runtime_error("Instrument not in tick archive: " + name);
+}
+
+void TickArchiveReader::decodeTicks(size_t block, std::vector<Tick>& ticks) const {
+    const auto& info = blocks_.at(block);
+    if (info.kind != BlockKind::TICKS) {
+        throw std::invalid_argument("Block is not a tick block");
+    }
+
+    const uint8_t* begin = data_.data() + info.offset;
+    Cursor cursor(begin, begin + info.length);
+
+    const size_t count = static_cast<size_t>(cursor.varint());
+    if (count != info.tick_count) {
+        throw std::runtime_error("Corrupt tick archive: tick count mismatch");
+    }
+
+    const size_t base = ticks.size();
+    ticks.resize(base + count);
+    Tick* out = ticks.data() + base;
+
+    int64_t timestamp = 0;
+    for (size_t i = 0; i < count; ++i) {
+        timestamp += cursor.signedVarint();
+        out[i].timestamp_ns = timestamp;
+    }
+
+    const uint32_t instrument_count = static_cast<uint32_t>(instruments_.size());
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t id = cursor.varint();
+        if (id >= instrument_count) {
+            throw std::runtime_error("Corrupt tick archive: unknown instrument id");
+        }
+        out[i].instrument_id = static_cast<uint32_t>(id);
+    }
+
+    for (size_t i = 0; i < count; i += 4) {
+        uint8_t packed = cursor.byte();
+        for (size_t j = 0; j < 4 && i + j < count; ++j) {
+            out[i + j].type = static_cast<TickType>((packed >> (j * 2)) & 0x3);
+        }
+    }
+
+    std::vector<int64_t> last_price(instrument_count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        auto& last = last_price[out[i].instrument_id];
+        last += cursor.signedVarint();
+        out[i].price_ticks = last;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        out[i].size = cursor.signedVarint();
+    }
+}
+
+BookSnapshot TickArchiveReader::decodeCheckpoint(size_t block) const {
+    const auto& info = blocks_.at(block);
+    if (info.kind != BlockKind::CHECKPOINT) {
+        throw std::invalid_argument("Block is not a checkpoint block");
+    }
+
+    const uint8_t* begin = data_.data() + info.offset;
+    Cursor cursor(begin, begin + info.length);
+
+    BookSnapshot snapshot;
+    snapshot.instrument_id = static_cast<uint32_t>(cursor.varint());
+    snapshot.timestamp_ns = cursor.signedVarint();
+    readLevels(cursor, snapshot.bids);
+    readLevels(cursor, snapshot.asks);
+    return snapshot;
+}
+
+void TickArchiveReader::scan(int64_t from_ns, int64_t to_ns,
+                             const std::function<void(const Tick&)>& callback) const {
+    std::vector<Tick> ticks;
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        const auto& block = blocks_[i];
+        if (block.kind != BlockKind::TICKS || block.last_timestamp_ns < from_ns) {
+            continue;
+        }
+        if (block.first_timestamp_ns > to_ns) {
+            break;
+        }
+
+        ticks.clear();
+        decodeTicks(i, ticks);
+        for (const auto& tick : ticks) {
+            if (tick.timestamp_ns >= from_ns && tick.timestamp_ns <= to_ns) {
+                callback(tick);
+            }
+        }
+    }
+}
+
+std::vector<Tick> TickArchiveReader::readRange(int64_t from_ns, int64_t to_ns, size_t threads) const {
+    std::vector<size_t> selected;
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        const auto& block = blocks_[i];
+        if (block.kind == BlockKind::TICKS &&
+            block.last_timestamp_ns >= from_ns && block.first_timestamp_ns <= to_ns) {
+            selected.push_back(i);
+        }
+    }
+
+    std::vector<std::vector<Tick>> decoded(selected.size());
+    parallelFor(selected.size(), threads, [&](size_t task) {
+        decodeTicks(selected[task], decoded[task]);
+    });
+
+    std::vector<Tick> result;
+    size_t total = 0;
+    for (const auto& ticks : decoded) total += ticks.size();
+    result.reserve(total);
+    for (const auto& ticks : decoded) {
+        for (const auto& tick : ticks) {
+            if (tick.timestamp_ns >= from_ns && tick.timestamp_ns <= to_ns) {
+                result.push_back(tick);
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,160 @@
+#ifndef TICK_ARCHIVE_H
+#define TICK_ARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+
+// Compressed archival format for market data ticks.
+//
+// File layout:
+//   header   "HFTTICK1", u32 version, u32 reserved
+//   blocks   tick blocks and full-book checkpoint blocks, back to back
+//   index    instrument table followed by one entry per block
+//   footer   u64 index offset, u64 index length, "HFTTIDX1"
+//
+// Tick blocks are columnar: timestamps are delta encoded, prices are delta
+// encoded against the previous tick of the same instrument, and every signed
+// value is zig-zag varint encoded. Each block is self-contained so blocks can
+// be decoded independently and in parallel.
+namespace tick_archive {
+
+enum class TickType : uint8_t {
+    BID = 0,         // Book level update, size 0 removes the level
+    ASK = 1,
+    TRADE_BUY = 2,
+    TRADE_SELL = 3
+};
+
+struct Tick {
+    int64_t timestamp_ns;
+    uint32_t instrument_id;
+    TickType type;
+    int64_t price_ticks;
+    int64_t size;
+};
+
+struct Level {
+    int64_t price_ticks;
+    int64_t size;
+};
+
+struct BookSnapshot {
+    uint32_t instrument_id;
+    int64_t timestamp_ns;
+    std::vector<Level> bids;  // Best (highest) first
+    std::vector<Level> asks;  // Best (lowest) first
+};
+
+struct InstrumentInfo {
+    std::string name;
+    double tick_size;   // Price of one price tick
+    double size_unit;   // Quantity of one size unit
+};
+
+enum class BlockKind : uint8_t {
+    TICKS = 1,
+    CHECKPOINT = 2
+};
+
+struct BlockInfo {
+    uint64_t offset;
+    uint64_t length;
+    BlockKind kind;
+    uint32_t tick_count;
+    uint32_t instrument_id;     // Checkpoint blocks only
+    int64_t first_timestamp_ns;
+    int64_t last_timestamp_ns;
+    uint64_t instrument_mask;   // Bit (id % 64) set for every instrument in the block
+
+    bool mayContain(uint32_t id) const { return (instrument_mask >> (id % 64)) & 1u; }
+};
+
+constexpr uint32_t FORMAT_VERSION = 1;
+
+} // namespace tick_archive
+
+class TickArchiveWriter {
+public:
+    struct Config {
+        size_t ticks_per_block{4096};
+        size_t checkpoint_interval_blocks{16};  // 0 disables periodic checkpoints
+    };
+
+    explicit TickArchiveWriter(const std::string& filename);
+    TickArchiveWriter(const std::string& filename, const Config& config);
+    ~TickArchiveWriter();
+
+    TickArchiveWriter(const TickArchiveWriter&) = delete;
+    TickArchiveWriter& operator=(const TickArchiveWriter&) = delete;
+
+    uint32_t addInstrument(const std::string& name, double tick_size, double size_unit);
+
+    // Ticks must be appended in non-decreasing timestamp order
+    void append(const tick_archive::Tick& tick);
+    void writeCheckpoints();
+    void close();
+
+    uint64_t getTickCount() const { return tick_count_; }
+    uint64_t getEncodedBytes() const { return offset_; }
+
+private:
+    struct BookState {
+        std::map<int64_t, int64_t, std::greater<int64_t>> bids;
+        std::map<int64_t, int64_t> asks;
+        bool changed{false};
+    };
+
+    void flushBlock();
+    void writeBlock(const std::string& payload, tick_archive::BlockInfo info);
+    void applyToBook(const tick_archive::Tick& tick);
+
+    std::ofstream file_;
+    Config config_;
+    bool closed_{false};
+    std::vector<tick_archive::Tick> pending_;
+    std::vector<tick_archive::InstrumentInfo> instruments_;
+    std::vector<BookState> books_;
+    std::vector<tick_archive::BlockInfo> index_;
+    std::vector<int64_t> last_price_;
+    uint64_t offset_{0};
+    uint64_t tick_count_{0};
+    int64_t last_timestamp_ns_{0};
+    size_t blocks_since_checkpoint_{0};
+};
+
+class TickArchiveReader {
+public:
+    explicit TickArchiveReader(const std::string& filename);
+
+    const std::string& getFilename() const { return filename_; }
+    const std::vector<tick_archive::InstrumentInfo>& getInstruments() const { return instruments_; }
+    const std::vector<tick_archive::BlockInfo>& getBlocks() const { return blocks_; }
+    uint32_t findInstrument(const std::string& name) const;
+
+    // All decode functions are const and safe to call from several threads
+    void decodeTicks(size_t block, std::vector<tick_archive::Tick>& ticks) const;
+    tick_archive::BookSnapshot decodeCheckpoint(size_t block) const;
+
+    // Streams ticks in [from_ns, to_ns] in file order, skipping blocks by index
+    void scan(int64_t from_ns, int64_t to_ns,
+              const std::function<void(const tick_archive::Tick&)>& callback) const;
+
+    // Decodes all matching blocks in parallel and returns the ticks in order
+    std::vector<tick_archive::Tick> readRange(int64_t from_ns, int64_t to_ns, size_t threads = 0) const;
+
+    uint64_t getFileSize() const { return data_.size(); }
+
+private:
+    void loadIndex();
+
+    std::string filename_;
+    std::vector<uint8_t> data_;
+    std::vector<tick_archive::InstrumentInfo> instruments_;
+    std::vector<tick_archive::BlockInfo> blocks_;
+};
+
+#endif // TICK_ARCHIVE_H
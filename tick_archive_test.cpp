@@ -0,0 +1,200 @@
+#include "tick_archive.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <random>
+
+using tick_archive::Tick;
+using tick_archive::TickType;
+using tick_archive::BlockKind;
+
+class TickArchiveTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::remove(filename_.c_str());
+    }
+
+    // Random walk over a few instruments with realistic clustering
+    std::vector<Tick> generateTicks(size_t count, uint32_t instruments) {
+        std::mt19937_64 rng(12345);
+        std::vector<int64_t> mids(instruments, 500000);
+        std::vector<Tick> ticks;
+        ticks.reserve(count);
+
+        int64_t timestamp = 1700000000000000000LL;
+        for (size_t i = 0; i < count; ++i) {
+            timestamp += 1000 + static_cast<int64_t>(rng() % 50000);
+            uint32_t id = static_cast<uint32_t>(rng() % instruments);
+            mids[id] += static_cast<int64_t>(rng() % 5) - 2;
+
+            Tick tick;
+            tick.timestamp_ns = timestamp;
+            tick.instrument_id = id;
+            tick.type = static_cast<TickType>(rng() % 4);
+            int64_t offset = 1 + static_cast<int64_t>(rng() % 10);
+            tick.price_ticks = tick.type == TickType::BID ? mids[id] - offset : mids[id] + offset;
+            tick.size = (rng() % 4 == 0) ? 0 : static_cast<int64_t>(1 + rng() % 1000);
+            ticks.push_back(tick);
+        }
+        return ticks;
+    }
+
+    void writeArchive(const std::vector<Tick>& ticks, uint32_t instruments,
+                      const TickArchiveWriter::Config& config = {}) {
+        TickArchiveWriter writer(filename_, config);
+        for (uint32_t i = 0; i < instruments; ++i) {
+            writer.addInstrument("INST-" + std::to_string(i), 0.5, 1.0);
+        }
+        for (const auto& tick : ticks) {
+            writer.append(tick);
+        }
+        writer.close();
+    }
+
+    static void expectSameTick(const Tick& a, const Tick& b) {
+        EXPECT_EQ(a.timestamp_ns, b.timestamp_ns);
+        EXPECT_EQ(a.instrument_id, b.instrument_id);
+        EXPECT_EQ(a.type, b.type);
+        EXPECT_EQ(a.price_ticks, b.price_ticks);
+        EXPECT_EQ(a.size, b.size);
+    }
+
+    std::string filename_{"tick_archive_test.bin"};
+};
+
+TEST_F(TickArchiveTest, RoundTripPreservesTicks) {
+    auto ticks = generateTicks(10000, 3);
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 1000;
+    writeArchive(ticks, 3, config);
+
+    TickArchiveReader reader(filename_);
+    ASSERT_EQ(reader.getInstruments().size(), 3u);
+    EXPECT_EQ(reader.getInstruments()[2].name, "INST-2");
+    EXPECT_DOUBLE_EQ(reader.getInstruments()[2].tick_size, 0.5);
+    EXPECT_EQ(reader.findInstrument("INST-1"), 1u);
+
+    std::vector<Tick> decoded;
+    reader.scan(INT64_MIN, INT64_MAX, [&](const Tick& tick) { decoded.push_back(tick); });
+    ASSERT_EQ(decoded.size(), ticks.size());
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        expectSameTick(decoded[i], ticks[i]);
+    }
+}
+
+TEST_F(TickArchiveTest, ScanHonoursTimeRange) {
+    auto ticks = generateTicks(5000, 2);
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 256;
+    writeArchive(ticks, 2, config);
+
+    int64_t from = ticks[1234].timestamp_ns;
+    int64_t to = ticks[3456].timestamp_ns;
+
+    TickArchiveReader reader(filename_);
+    size_t count = 0;
+    reader.scan(from, to, [&](const Tick& tick) {
+        EXPECT_GE(tick.timestamp_ns, from);
+        EXPECT_LE(tick.timestamp_ns, to);
+        count++;
+    });
+    EXPECT_EQ(count, 3456u - 1234u + 1u);
+}
+
+TEST_F(TickArchiveTest, CheckpointsMatchBookState) {
+    auto ticks = generateTicks(4096, 2);
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 512;
+    config.checkpoint_interval_blocks = 2;
+    writeArchive(ticks, 2, config);
+
+    TickArchiveReader reader(filename_);
+    const auto& blocks = reader.getBlocks();
+
+    size_t checkpoints = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (blocks[i].kind != BlockKind::CHECKPOINT) {
+            continue;
+        }
+        checkpoints++;
+        auto snapshot = reader.decodeCheckpoint(i);
+
+        // Rebuild the book from the raw ticks up to the checkpoint time
+        std::map<int64_t, int64_t, std::greater<int64_t>> bids;
+        std::map<int64_t, int64_t> asks;
+        for (const auto& tick : ticks) {
+            if (tick.timestamp_ns > snapshot.timestamp_ns) break;
+            if (tick.instrument_id != snapshot.instrument_id) continue;
+            if (tick.type == TickType::BID) {
+                if (tick.size == 0) bids.erase(tick.price_ticks); else bids[tick.price_ticks] = tick.size;
+            } else if (tick.type == TickType::ASK) {
+                if (tick.size == 0) asks.erase(tick.price_ticks); else asks[tick.price_ticks] = tick.size;
+            }
+        }
+
+        ASSERT_EQ(snapshot.bids.size(), bids.size());
+        ASSERT_EQ(snapshot.asks.size(), asks.size());
+        size_t level = 0;
+        for (const auto& [price, size] : bids) {
+            EXPECT_EQ(snapshot.bids[level].price_ticks, price);
+            EXPECT_EQ(snapshot.bids[level].size, size);
+            level++;
+        }
+        level = 0;
+        for (const auto& [price, size] : asks) {
+            EXPECT_EQ(snapshot.asks[level].price_ticks, price);
+            EXPECT_EQ(snapshot.asks[level].size, size);
+            level++;
+        }
+    }
+    EXPECT_EQ(checkpoints, 8u);  // 4 checkpoint rounds x 2 instruments
+}
+
+TEST_F(TickArchiveTest, ParallelReadMatchesSequentialScan) {
+    auto ticks = generateTicks(20000, 4);
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 700;
+    writeArchive(ticks, 4, config);
+
+    TickArchiveReader reader(filename_);
+    int64_t from = ticks[2500].timestamp_ns;
+    int64_t to = ticks[17500].timestamp_ns;
+
+    std::vector<Tick> sequential;
+    reader.scan(from, to, [&](const Tick& tick) { sequential.push_back(tick); });
+    auto parallel = reader.readRange(from, to, 4);
+
+    ASSERT_EQ(parallel.size(), sequential.size());
+    for (size_t i = 0; i < parallel.size(); ++i) {
+        expectSameTick(parallel[i], sequential[i]);
+    }
+}
+
+TEST_F(TickArchiveTest, CompressesWellBelowRawSize) {
+    auto ticks = generateTicks(50000, 4);
+    writeArchive(ticks, 4);
+
+    TickArchiveReader reader(filename_);
+    double raw = static_cast<double>(ticks.size() * sizeof(Tick));
+    EXPECT_LT(static_cast<double>(reader.getFileSize()), raw / 3.0);
+}
+
+TEST_F(TickArchiveTest, RejectsOutOfOrderAndUnknownInstrument) {
+    TickArchiveWriter writer(filename_);
+    uint32_t id = writer.addInstrument("BTC-PERPETUAL", 0.5, 10.0);
+
+    writer.append({1000, id, TickType::BID, 100, 5});
+    EXPECT_THROW(writer.append({999, id, TickType::BID, 100, 5}), std::invalid_argument);
+    EXPECT_THROW(writer.append({2000, id + 1, TickType::BID, 100, 5}), std::invalid_argument);
+}
+
+TEST_F(TickArchiveTest, RejectsTruncatedFile) {
+    auto ticks = generateTicks(1000, 1);
+    writeArchive(ticks, 1);
+
+    {
+        std::ofstream file(filename_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-4, std::ios::end);
+        file.write("XXXX", 4);
+    }
+    EXPECT_THROW(TickArchiveReader reader(filename_), std::runtime_error);
+}
@@ -0,0 +1,334 @@
+#include "tick_query_engine.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <stdexcept>
+
+using namespace tick_archive;
+
+namespace {
+
+int64_t bucketStart(int64_t ts_ns, int64_t bucket_ns) {
+    int64_t remainder = ts_ns % bucket_ns;
+    if (remainder < 0) remainder += bucket_ns;
+    return ts_ns - remainder;
+}
+
+void mergeInto(TickQueryEngine::BucketStats& into, const TickQueryEngine::BucketStats& from) {
+    if (from.quote_count > 0) {
+        if (into.quote_count == 0) {
+            into.mid_open = from.mid_open;
+            into.mid_high = from.mid_high;
+            into.mid_low = from.mid_low;
+            into.spread_min = from.spread_min;
+            into.spread_max = from.spread_max;
+        } else {
+            into.mid_high = std::max(into.mid_high, from.mid_high);
+            into.mid_low = std::min(into.mid_low, from.mid_low);
+            into.spread_min = std::min(into.spread_min, from.spread_min);
+            into.spread_max = std::max(into.spread_max, from.spread_max);
+        }
+        into.mid_close = from.mid_close;
+        into.spread_sum += from.spread_sum;
+        into.quote_count += from.quote_count;
+    }
+    into.trade_count += from.trade_count;
+    into.buy_volume += from.buy_volume;
+    into.sell_volume += from.sell_volume;
+    into.notional += from.notional;
+}
+
+struct BookSides {
+    std::map<int64_t, int64_t, std::greater<int64_t>> bids;
+    std::map<int64_t, int64_t> asks;
+};
+
+} // namespace
+
+TickQueryEngine::TickQueryEngine(size_t threads)
+    : threads_(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads) {
+}
+
+void TickQueryEngine::addFile(const std::string& filename) {
+    ArchiveFile file;
+    file.reader = std::make_unique<TickArchiveReader>(filename);
+    file.checkpoints.resize(file.reader->getInstruments().size());
+
+    const size_t file_index = files_.size();
+    const auto& blocks = file.reader->getBlocks();
+
+    Segment current{file_index, 0, {}, 0, 0};
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        const auto& block = blocks[i];
+        if (block.kind == BlockKind::TICKS) {
+            if (current.blocks.empty()) {
+                current.first_block = i;
+                current.first_timestamp_ns = block.first_timestamp_ns;
+            }
+            current.blocks.push_back(i);
+            current.last_timestamp_ns = block.last_timestamp_ns;
+        } else if (block.kind == BlockKind::CHECKPOINT) {
+            if (block.instrument_id < file.checkpoints.size()) {
+                file.checkpoints[block.instrument_id].push_back(i);
+            }
+            // A checkpoint round closes the segment: the next one can be
+            // seeded from these snapshots without replaying earlier blocks
+            if (!current.blocks.empty()) {
+                segments_.push_back(std::move(current));
+                current = Segment{file_index, 0, {}, 0, 0};
+            }
+        }
+    }
+    if (!current.blocks.empty()) {
+        segments_.push_back(std::move(current));
+    }
+
+    files_.push_back(std::move(file));
+}
+
+void TickQueryEngine::run(const Query& query, const ResultCallback& callback) const {
+    if (query.bucket_ns <= 0) {
+        throw std::invalid_argument("Query bucket width must be positive");
+    }
+
+    // Resolve instrument names to result slots, then slots to per-file ids
+    std::vector<std::string> slot_names = query.instruments;
+    std::unordered_map<std::string, int32_t> slot_by_name;
+    if (slot_names.empty()) {
+        for (const auto& file : files_) {
+            for (const auto& instrument : file.reader->getInstruments()) {
+                if (slot_by_name.emplace(instrument.name, static_cast<int32_t>(slot_names.size())).second) {
+                    slot_names.push_back(instrument.name);
+                }
+            }
+        }
+    } else {
+        for (size_t i = 0; i < slot_names.size(); ++i) {
+            slot_by_name.emplace(slot_names[i], static_cast<int32_t>(i));
+        }
+    }
+
+    std::vector<FileSelection> selections(files_.size());
+    for (size_t f = 0; f < files_.size(); ++f) {
+        const auto& instruments = files_[f].reader->getInstruments();
+        auto& selection = selections[f];
+        selection.slot_by_id.assign(instruments.size(), -1);
+        for (size_t id = 0; id < instruments.size(); ++id) {
+            auto it = slot_by_name.find(instruments[id].name);
+            if (it != slot_by_name.end()) {
+                selection.slot_by_id[id] = it->second;
+                selection.mask |= uint64_t{1} << (id % 64);
+            }
+        }
+    }
+
+    // Predicate pushdown at segment level
+    std::vector<const Segment*> selected;
+    for (const auto& segment : segments_) {
+        if (selections[segment.file].mask != 0 &&
+            segment.last_timestamp_ns >= query.from_ns &&
+            segment.first_timestamp_ns <= query.to_ns) {
+            selected.push_back(&segment);
+        }
+    }
+
+    const size_t slot_count = slot_names.size();
+    std::vector<bool> has_pending(slot_count, false);
+    std::vector<BucketStats> pending(slot_count);
+    std::vector<std::pair<size_t, BucketStats>> finished;
+
+    auto emit = [&]() {
+        std::stable_sort(finished.begin(), finished.end(), [](const auto& a, const auto& b) {
+            return a.second.bucket_start_ns < b.second.bucket_start_ns;
+        });
+        for (auto& [slot, stats] : finished) {
+            stats.instrument = slot_names[slot];
+            callback(stats);
+        }
+        finished.clear();
+    };
+
+    // Segments are scanned a wave at a time so memory stays bounded by the
+    // wave size rather than the query range
+    const size_t wave_size = threads_ * 2;
+    for (size_t wave_begin = 0; wave_begin < selected.size(); wave_begin += wave_size) {
+        const size_t wave_count = std::min(wave_size, selected.size() - wave_begin);
+        std::vector<std::vector<std::vector<BucketStats>>> partials(wave_count);
+
+        parallelFor(wave_count, threads_, [&](size_t task) {
+            const Segment& segment = *selected[wave_begin + task];
+            partials[task].resize(slot_count);
+            scanSegment(segment, query, selections[segment.file], slot_count, partials[task]);
+        });
+
+        // Stitch buckets that straddle segment boundaries, in segment order
+        for (const auto& segment_partials : partials) {
+            for (size_t slot = 0; slot < slot_count; ++slot) {
+                for (const auto& stats : segment_partials[slot]) {
+                    if (has_pending[slot] && pending[slot].bucket_start_ns == stats.bucket_start_ns) {
+                        mergeInto(pending[slot], stats);
+                        continue;
+                    }
+                    if (has_pending[slot]) {
+                        finished.emplace_back(slot, std::move(pending[slot]));
+                    }
+                    pending[slot] = stats;
+                    has_pending[slot] = true;
+                }
+            }
+        }
+        emit();
+    }
+
+    for (size_t slot = 0; slot < slot_count; ++slot) {
+        if (has_pending[slot]) {
+            finished.emplace_back(slot, std::move(pending[slot]));
+        }
+    }
+    emit();
+}
+
+void TickQueryEngine::scanSegment(const Segment& segment, const Query& query, const FileSelection& selection,
+                                  size_t slot_count, std::vector<std::vector<BucketStats>>& partials) const {
+    const auto& file = files_[segment.file];
+    const auto& reader = *file.reader;
+    const auto& instruments = reader.getInstruments();
+    const auto& blocks = reader.getBlocks();
+
+    std::vector<BookSides> books;
+    if (query.include_book) {
+        books.resize(slot_count);
+        for (size_t id = 0; id < selection.slot_by_id.size(); ++id) {
+            int32_t slot = selection.slot_by_id[id];
+            if (slot < 0) {
+                continue;
+            }
+            // Latest checkpoint written before this segment starts
+            const auto& checkpoints = file.checkpoints[id];
+            auto it = std::lower_bound(checkpoints.begin(), checkpoints.end(), segment.first_block);
+            if (it == checkpoints.begin()) {
+                continue;
+            }
+            auto snapshot = reader.decodeCheckpoint(*std::prev(it));
+            for (const auto& level : snapshot.bids) books[slot].bids.emplace(level.price_ticks, level.size);
+            for (const auto& level : snapshot.asks) books[slot].asks.emplace(level.price_ticks, level.size);
+        }
+    }
+
+    auto bucketFor = [&](int32_t slot, int64_t ts_ns) -> BucketStats& {
+        auto& buckets = partials[slot];
+        const int64_t start = bucketStart(ts_ns, query.bucket_ns);
+        if (buckets.empty() || buckets.back().bucket_start_ns != start) {
+            buckets.emplace_back();
+            buckets.back().bucket_start_ns = start;
+        }
+        return buckets.back();
+    };
+
+    std::vector<Tick> ticks;
+    for (size_t block_index : segment.blocks) {
+        const auto& block = blocks[block_index];
+        if (block.first_timestamp_ns > query.to_ns) {
+            break;
+        }
+        // Without book replay, blocks before the range carry nothing useful
+        if (!query.include_book && block.last_timestamp_ns < query.from_ns) {
+            continue;
+        }
+        if ((block.instrument_mask & selection.mask) == 0) {
+            continue;
+        }
+
+        ticks.clear();
+        reader.decodeTicks(block_index, ticks);
+
+        for (const auto& tick : ticks) {
+            const int32_t slot = selection.slot_by_id[tick.instrument_id];
+            if (slot < 0) {
+                continue;
+            }
+            if (tick.timestamp_ns > query.to_ns) {
+                break;
+            }
+            const bool in_range = tick.timestamp_ns >= query.from_ns;
+            const auto& info = instruments[tick.instrument_id];
+
+            switch (tick.type) {
+                case TickType::BID:
+                case TickType::ASK: {
+                    if (!query.include_book) {
+                        break;
+                    }
+                    auto& book = books[slot];
+                    if (tick.type == TickType::BID) {
+                        if (tick.size == 0) book.bids.erase(tick.price_ticks); else book.bids[tick.price_ticks] = tick.size;
+                    } else {
+                        if (tick.size == 0) book.asks.erase(tick.price_ticks); else book.asks[tick.price_ticks] = tick.size;
+                    }
+                    if (!in_range || book.bids.empty() || book.asks.empty()) {
+                        break;
+                    }
+
+                    const int64_t best_bid = book.bids.begin()->first;
+                    const int64_t best_ask = book.asks.begin()->first;
+                    const double mid = 0.5 * static_cast<double>(best_bid + best_ask) * info.tick_size;
+                    const double spread = static_cast<double>(best_ask - best_bid) * info.tick_size;
+
+                    auto& stats = bucketFor(slot, tick.timestamp_ns);
+                    if (stats.quote_count == 0) {
+                        stats.mid_open = stats.mid_high = stats.mid_low = mid;
+                        stats.spread_min = stats.spread_max = spread;
+                    } else {
+                        stats.mid_high = std::max(stats.mid_high, mid);
+                        stats.mid_low = std::min(stats.mid_low, mid);
+                        stats.spread_min = std::min(stats.spread_min, spread);
+                        stats.spread_max = std::max(stats.spread_max, spread);
+                    }
+                    stats.mid_close = mid;
+                    stats.spread_sum += spread;
+                    stats.quote_count++;
+                    break;
+                }
+                case TickType::TRADE_BUY:
+                case TickType::TRADE_SELL: {
+                    if (!in_range) {
+                        break;
+                    }
+                    const double price = static_cast<double>(tick.price_ticks) * info.tick_size;
+                    const double size = static_cast<double>(tick.size) * info.size_unit;
+                    auto& stats = bucketFor(slot, tick.timestamp_ns);
+                    const bool buy = tick.type == TickType::TRADE_BUY;
+                    stats.buy_volume += buy ? size : 0.0;
+                    stats.sell_volume += buy ? 0.0 : size;
+                    stats.notional += price * size;
+                    stats.trade_count++;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void TickQueryEngine::midSeries(const Query& query,
+                                const std::function<void(const std::string&, int64_t, double)>& callback) const {
+    Query book_query = query;
+    book_query.include_book = true;
+    run(book_query, [&](const BucketStats& stats) {
+        if (stats.quote_count > 0) {
+            callback(stats.instrument, stats.bucket_start_ns, stats.mid_close);
+        }
+    });
+}
+
+void TickQueryEngine::volumePerBucket(const Query& query,
+                                      const std::function<void(const std::string&, int64_t, double, double)>& callback) const {
+    Query trade_query = query;
+    trade_query.include_book = false;
+    run(trade_query, [&](const BucketStats& stats) {
+        if (stats.trade_count > 0) {
+            callback(stats.instrument, stats.bucket_start_ns, stats.volume(), stats.vwap());
+        }
+    });
+}
@@ -0,0 +1,97 @@
+#ifndef TICK_QUERY_ENGINE_H
+#define TICK_QUERY_ENGINE_H
+
+#include "tick_archive.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <limits>
+#include <cstdint>
+
+// Bucketed analytics over one or more tick archives (typically one file per
+// day, added in chronological order). Each file is split into segments at its
+// checkpoint rounds; a segment can be replayed on its own by seeding the book
+// from the preceding checkpoints, so segments are scanned in parallel and
+// their partial buckets merged in order. Results are emitted through a
+// callback a batch of segments at a time, never as one materialized table.
+class TickQueryEngine {
+public:
+    struct Query {
+        int64_t from_ns{std::numeric_limits<int64_t>::min()};
+        int64_t to_ns{std::numeric_limits<int64_t>::max()};
+        int64_t bucket_ns{60000000000LL};      // Epoch-aligned bucket width
+        std::vector<std::string> instruments;   // Empty selects every instrument
+        bool include_book{true};                // false skips book replay (trade stats only)
+    };
+
+    struct BucketStats {
+        std::string instrument;
+        int64_t bucket_start_ns{0};
+
+        // Top of book, sampled after every book update with both sides present
+        uint64_t quote_count{0};
+        double mid_open{0.0};
+        double mid_high{0.0};
+        double mid_low{0.0};
+        double mid_close{0.0};
+        double spread_min{0.0};
+        double spread_max{0.0};
+        double spread_sum{0.0};
+
+        // Trades
+        uint64_t trade_count{0};
+        double buy_volume{0.0};
+        double sell_volume{0.0};
+        double notional{0.0};
+
+        double spreadMean() const { return quote_count > 0 ? spread_sum / quote_count : 0.0; }
+        double volume() const { return buy_volume + sell_volume; }
+        double vwap() const { return volume() > 0.0 ? notional / volume() : 0.0; }
+    };
+
+    // Buckets arrive in time order for each instrument
+    using ResultCallback = std::function<void(const BucketStats&)>;
+
+    explicit TickQueryEngine(size_t threads = 0);
+
+    void addFile(const std::string& filename);
+    size_t getFileCount() const { return files_.size(); }
+
+    void run(const Query& query, const ResultCallback& callback) const;
+
+    // Convenience wrappers over run()
+    void midSeries(const Query& query,
+                   const std::function<void(const std::string&, int64_t, double)>& callback) const;
+    void volumePerBucket(const Query& query,
+                         const std::function<void(const std::string&, int64_t, double, double)>& callback) const;
+
+private:
+    struct Segment {
+        size_t file;
+        size_t first_block;           // Index of the first tick block in the file
+        std::vector<size_t> blocks;   // Tick blocks in this segment
+        int64_t first_timestamp_ns;
+        int64_t last_timestamp_ns;
+    };
+
+    struct ArchiveFile {
+        std::unique_ptr<TickArchiveReader> reader;
+        std::vector<std::vector<size_t>> checkpoints;  // Checkpoint blocks per instrument
+    };
+
+    // Instrument selection resolved against one file: query slot per local id
+    struct FileSelection {
+        std::vector<int32_t> slot_by_id;  // -1 when not selected
+        uint64_t mask{0};
+    };
+
+    void scanSegment(const Segment& segment, const Query& query, const FileSelection& selection,
+                     size_t slot_count, std::vector<std::vector<BucketStats>>& partials) const;
+
+    size_t threads_;
+    std::vector<ArchiveFile> files_;
+    std::vector<Segment> segments_;
+};
+
+#endif // TICK_QUERY_ENGINE_H
@@ -0,0 +1,245 @@
+#include "tick_query_engine.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <map>
+#include <random>
+
+using tick_archive::Tick;
+using tick_archive::TickType;
+
+class TickQueryEngineTest : public ::testing::Test {
+protected:
+    struct Instrument {
+        std::string name;
+        double tick_size;
+        double size_unit;
+    };
+
+    void TearDown() override {
+        for (const auto& filename : files_) {
+            std::remove(filename.c_str());
+        }
+    }
+
+    std::string writeFile(const std::vector<Instrument>& instruments, const std::vector<Tick>& ticks,
+                          const TickArchiveWriter::Config& config = {}) {
+        files_.push_back("tick_query_engine_test_" + std::to_string(files_.size()) + ".bin");
+        TickArchiveWriter writer(files_.back(), config);
+        for (const auto& instrument : instruments) {
+            writer.addInstrument(instrument.name, instrument.tick_size, instrument.size_unit);
+        }
+        for (const auto& tick : ticks) {
+            writer.append(tick);
+        }
+        writer.close();
+        return files_.back();
+    }
+
+    static std::vector<TickQueryEngine::BucketStats> collect(const TickQueryEngine& engine,
+                                                             const TickQueryEngine::Query& query) {
+        std::vector<TickQueryEngine::BucketStats> results;
+        engine.run(query, [&](const TickQueryEngine::BucketStats& stats) { results.push_back(stats); });
+        return results;
+    }
+
+    static TickQueryEngine::Query query(int64_t bucket_ns) {
+        TickQueryEngine::Query q;
+        q.bucket_ns = bucket_ns;
+        return q;
+    }
+
+    static Tick tick(int64_t timestamp_ns, uint32_t id, TickType type, int64_t price, int64_t size) {
+        return {timestamp_ns, id, type, price, size};
+    }
+
+    std::vector<std::string> files_;
+};
+
+TEST_F(TickQueryEngineTest, AggregatesTradesPerBucketInInstrumentUnits) {
+    TickQueryEngine engine(1);
+    engine.addFile(writeFile({{"BTC", 0.5, 10.0}}, {
+        tick(100, 0, TickType::TRADE_BUY, 200, 1),   // 100.0 x 10
+        tick(150, 0, TickType::TRADE_SELL, 202, 3),  // 101.0 x 30
+        tick(250, 0, TickType::TRADE_BUY, 210, 2),   // 105.0 x 20
+    }));
+
+    auto results = collect(engine, query(100));
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].instrument, "BTC");
+    EXPECT_EQ(results[0].bucket_start_ns, 100);
+    EXPECT_EQ(results[0].trade_count, 2u);
+    EXPECT_DOUBLE_EQ(results[0].buy_volume, 10.0);
+    EXPECT_DOUBLE_EQ(results[0].sell_volume, 30.0);
+    EXPECT_DOUBLE_EQ(results[0].vwap(), (100.0 * 10.0 + 101.0 * 30.0) / 40.0);
+    EXPECT_EQ(results[0].quote_count, 0u);
+    EXPECT_EQ(results[1].bucket_start_ns, 200);
+    EXPECT_DOUBLE_EQ(results[1].notional, 105.0 * 20.0);
+}
+
+TEST_F(TickQueryEngineTest, QuotesNeedBothSidesAndTrackMidAndSpread) {
+    TickQueryEngine engine(1);
+    engine.addFile(writeFile({{"ETH", 1.0, 1.0}}, {
+        tick(10, 0, TickType::BID, 100, 5),  // One-sided: no quote
+        tick(20, 0, TickType::ASK, 104, 5),  // mid 102, spread 4
+        tick(30, 0, TickType::BID, 102, 1),  // mid 103, spread 2
+        tick(40, 0, TickType::ASK, 104, 0),  // Ask side emptied: no quote
+        tick(50, 0, TickType::ASK, 110, 1),  // mid 106, spread 8
+    }));
+
+    auto results = collect(engine, query(1000));
+    ASSERT_EQ(results.size(), 1u);
+    const auto& stats = results[0];
+    EXPECT_EQ(stats.quote_count, 3u);
+    EXPECT_DOUBLE_EQ(stats.mid_open, 102.0);
+    EXPECT_DOUBLE_EQ(stats.mid_high, 106.0);
+    EXPECT_DOUBLE_EQ(stats.mid_low, 102.0);
+    EXPECT_DOUBLE_EQ(stats.mid_close, 106.0);
+    EXPECT_DOUBLE_EQ(stats.spread_min, 2.0);
+    EXPECT_DOUBLE_EQ(stats.spread_max, 8.0);
+    EXPECT_DOUBLE_EQ(stats.spreadMean(), 14.0 / 3.0);
+}
+
+TEST_F(TickQueryEngineTest, TimeRangeIsInclusiveAndBookBeforeItStillCounts) {
+    TickQueryEngine engine(1);
+    engine.addFile(writeFile({{"BTC", 1.0, 1.0}}, {
+        tick(10, 0, TickType::BID, 100, 1),
+        tick(20, 0, TickType::ASK, 102, 1),
+        tick(30, 0, TickType::TRADE_BUY, 101, 1),
+        tick(40, 0, TickType::BID, 101, 1),
+        tick(50, 0, TickType::TRADE_SELL, 101, 2),
+        tick(60, 0, TickType::TRADE_SELL, 101, 4),
+    }));
+
+    auto q = query(1000);
+    q.from_ns = 40;
+    q.to_ns = 50;
+    auto results = collect(engine, q);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].trade_count, 1u);
+    EXPECT_DOUBLE_EQ(results[0].sell_volume, 2.0);
+    // The ask from before the range pairs with the in-range bid
+    EXPECT_EQ(results[0].quote_count, 1u);
+    EXPECT_DOUBLE_EQ(results[0].mid_close, 101.5);
+
+    q.from_ns = 70;
+    q.to_ns = 80;
+    EXPECT_TRUE(collect(engine, q).empty());
+}
+
+TEST_F(TickQueryEngineTest, InstrumentFilterSelectsByName) {
+    TickQueryEngine engine(1);
+    engine.addFile(writeFile({{"BTC", 1.0, 1.0}, {"ETH", 1.0, 1.0}, {"SOL", 1.0, 1.0}}, {
+        tick(10, 0, TickType::TRADE_BUY, 100, 1),
+        tick(20, 1, TickType::TRADE_BUY, 50, 2),
+        tick(30, 2, TickType::TRADE_BUY, 10, 3),
+        tick(40, 1, TickType::TRADE_BUY, 51, 4),
+    }));
+
+    auto q = query(1000);
+    q.instruments = {"ETH", "MISSING"};
+    auto results = collect(engine, q);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].instrument, "ETH");
+    EXPECT_EQ(results[0].trade_count, 2u);
+    EXPECT_DOUBLE_EQ(results[0].volume(), 6.0);
+
+    q.instruments.clear();
+    EXPECT_EQ(collect(engine, q).size(), 3u);
+}
+
+TEST_F(TickQueryEngineTest, MergesSegmentsAndFilesLikeASingleScan) {
+    // Two daily files with the instruments in different id order; small
+    // blocks and frequent checkpoints give many segments and buckets that
+    // straddle segment boundaries
+    std::mt19937_64 rng(99);
+    const std::vector<std::string> names = {"BTC", "ETH"};
+    std::map<std::pair<std::string, int64_t>, std::pair<uint64_t, double>> expected_trades;
+    std::map<std::pair<std::string, int64_t>, uint64_t> expected_quotes;
+    const int64_t bucket = 5000;
+
+    TickArchiveWriter::Config config;
+    config.ticks_per_block = 64;
+    config.checkpoint_interval_blocks = 2;
+
+    TickQueryEngine engine(4);
+    int64_t timestamp = 0;
+    for (int day = 0; day < 2; ++day) {
+        std::vector<Instrument> instruments = day == 0
+            ? std::vector<Instrument>{{"BTC", 1.0, 1.0}, {"ETH", 1.0, 1.0}}
+            : std::vector<Instrument>{{"ETH", 1.0, 1.0}, {"BTC", 1.0, 1.0}};
+        std::map<std::string, std::pair<std::map<int64_t, int64_t>, std::map<int64_t, int64_t>>> books;
+
+        std::vector<Tick> ticks;
+        for (int i = 0; i < 3000; ++i) {
+            timestamp += 1 + static_cast<int64_t>(rng() % 20);
+            uint32_t id = static_cast<uint32_t>(rng() % 2);
+            const std::string& name = instruments[id].name;
+            auto type = static_cast<TickType>(rng() % 4);
+            int64_t price = type == TickType::BID ? 1000 - static_cast<int64_t>(rng() % 5)
+                          : type == TickType::ASK ? 1001 + static_cast<int64_t>(rng() % 5)
+                                                  : 1000 + static_cast<int64_t>(rng() % 3);
+            int64_t size = (type == TickType::BID || type == TickType::ASK) && rng() % 3 == 0
+                               ? 0 : static_cast<int64_t>(1 + rng() % 9);
+            ticks.push_back(tick(timestamp, id, type, price, size));
+
+            const auto key = std::make_pair(name, timestamp - timestamp % bucket);
+            auto& [bids, asks] = books[name];
+            if (type == TickType::BID || type == TickType::ASK) {
+                auto& side = type == TickType::BID ? bids : asks;
+                if (size == 0) side.erase(price); else side[price] = size;
+                if (!bids.empty() && !asks.empty()) expected_quotes[key]++;
+            } else {
+                expected_trades[key].first++;
+                expected_trades[key].second += static_cast<double>(size);
+            }
+        }
+        engine.addFile(writeFile(instruments, ticks, config));
+    }
+
+    std::map<std::pair<std::string, int64_t>, TickQueryEngine::BucketStats> actual;
+    std::map<std::string, int64_t> last_bucket;
+    engine.run(query(bucket), [&](const TickQueryEngine::BucketStats& stats) {
+        EXPECT_LT(last_bucket.count(stats.instrument) ? last_bucket[stats.instrument] : -1, stats.bucket_start_ns)
+            << "Buckets out of order for " << stats.instrument;
+        last_bucket[stats.instrument] = stats.bucket_start_ns;
+        EXPECT_TRUE(actual.emplace(std::make_pair(stats.instrument, stats.bucket_start_ns), stats).second);
+    });
+
+    for (const auto& [key, trades] : expected_trades) {
+        ASSERT_TRUE(actual.count(key)) << key.first << " " << key.second;
+        EXPECT_EQ(actual[key].trade_count, trades.first);
+        EXPECT_DOUBLE_EQ(actual[key].volume(), trades.second);
+    }
+    for (const auto& [key, quotes] : expected_quotes) {
+        ASSERT_TRUE(actual.count(key)) << key.first << " " << key.second;
+        EXPECT_EQ(actual[key].quote_count, quotes) << key.first << " " << key.second;
+    }
+}
+
+TEST_F(TickQueryEngineTest, ConvenienceSeriesAndInvalidBucket) {
+    TickQueryEngine engine(1);
+    engine.addFile(writeFile({{"BTC", 1.0, 1.0}}, {
+        tick(10, 0, TickType::BID, 100, 1),
+        tick(20, 0, TickType::ASK, 102, 1),
+        tick(110, 0, TickType::TRADE_BUY, 101, 2),
+        tick(120, 0, TickType::TRADE_SELL, 103, 2),
+    }));
+
+    std::vector<std::pair<int64_t, double>> mids;
+    engine.midSeries(query(100), [&](const std::string&, int64_t bucket, double mid) {
+        mids.emplace_back(bucket, mid);
+    });
+    ASSERT_EQ(mids.size(), 1u);
+    EXPECT_EQ(mids[0].first, 0);
+    EXPECT_DOUBLE_EQ(mids[0].second, 101.0);
+
+    std::vector<std::pair<double, double>> volumes;
+    engine.volumePerBucket(query(100), [&](const std::string&, int64_t, double volume, double vwap) {
+        volumes.emplace_back(volume, vwap);
+    });
+    ASSERT_EQ(volumes.size(), 1u);
+    EXPECT_DOUBLE_EQ(volumes[0].first, 4.0);
+    EXPECT_DOUBLE_EQ(volumes[0].second, 102.0);
+
+    EXPECT_THROW(collect(engine, query(0)), std::invalid_argument);
+}
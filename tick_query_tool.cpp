@@ -0,0 +1,100 @@
+#include "tick_query_engine.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <archive>...\n"
+              << "Options:\n"
+              << "  --from <ns>          Start of time range (inclusive)\n"
+              << "  --to <ns>            End of time range (inclusive)\n"
+              << "  --bucket <seconds>   Bucket width, default 60\n"
+              << "  --instrument <name>  Restrict to an instrument (repeatable)\n"
+              << "  --threads <n>        Worker threads, default hardware concurrency\n"
+              << "  --trades-only        Skip book replay; mid and spread columns stay empty\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TickQueryEngine::Query query;
+    size_t threads = 0;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        try {
+            if (arg == "--from") {
+                query.from_ns = std::stoll(next());
+            } else if (arg == "--to") {
+                query.to_ns = std::stoll(next());
+            } else if (arg == "--bucket") {
+                query.bucket_ns = static_cast<int64_t>(std::stod(next()) * 1e9);
+            } else if (arg == "--instrument") {
+                query.instruments.push_back(next());
+            } else if (arg == "--threads") {
+                threads = std::stoul(next());
+            } else if (arg == "--trades-only") {
+                query.include_book = false;
+            } else if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (!arg.empty() && arg[0] == '-') {
+                throw std::invalid_argument("Unknown option " + arg);
+            } else {
+                files.push_back(arg);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (files.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        TickQueryEngine engine(threads);
+        for (const auto& file : files) {
+            engine.addFile(file);
+        }
+
+        std::cout << "instrument,bucket_start_ns,quotes,mid_open,mid_high,mid_low,mid_close,"
+                  << "spread_min,spread_mean,spread_max,trades,buy_volume,sell_volume,vwap\n";
+        std::cout << std::setprecision(10);
+
+        engine.run(query, [](const TickQueryEngine::BucketStats& stats) {
+            std::cout << stats.instrument << ',' << stats.bucket_start_ns << ',' << stats.quote_count << ',';
+            if (stats.quote_count > 0) {
+                std::cout << stats.mid_open << ',' << stats.mid_high << ',' << stats.mid_low << ','
+                          << stats.mid_close << ',' << stats.spread_min << ',' << stats.spreadMean() << ','
+                          << stats.spread_max << ',';
+            } else {
+                std::cout << ",,,,,,,";
+            }
+            std::cout << stats.trade_count << ',' << stats.buy_volume << ',' << stats.sell_volume << ',';
+            if (stats.trade_count > 0) {
+                std::cout << stats.vwap();
+            }
+            std::cout << '\n';
+        });
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -37,9 +37,9 @@ void TradeExecution::handleMarketData(const json& data) {
 
 // Method called when new market data is received
 void TradeExecution::onMarketDataReceived(const json& market_data) {
-    auto market_data_start = LatencyModule::start();  // Start the timer
+    auto market_data_start = LatencyModule::getInstance().start("market_data_processing");  // Start the timer
     handleMarketData(market_data);
-    LatencyModule::end(market_data_start, "Market Data Processing Latency");  // Measure latency
+    LatencyModule::getInstance().end("market_data_processing", market_data_start);  // Measure latency
 }
 
 // Method to authenticate
@@ -69,6 +69,32 @@ json TradeExecution::authenticate(const std::string& client_id, const std::strin
     }
 }
 
+// Method to exchange a refresh token for a new access token
+json TradeExecution::refreshToken(const std::string& refresh_token) {
+    try {
+        json refresh_message = {
+            {"jsonrpc", "2.0"},
+            {"id", getNextRequestId()},
+            {"method", "public/auth"},
+            {"params", {
+                {"grant_type", "refresh_token"},
+                {"refresh_token", refresh_token}
+            }}
+        };
+        websocket_.sendMessage(refresh_message);
+        auto response = websocket_.readMessage();
+
+        if (!response.contains("result")) {
+            throw std::runtime_error("Token refresh failed: " + response.dump());
+        }
+        return response["result"];
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error in refreshToken: " << e.what() << std::endl;
+        throw;
+    }
+}
+
 // Method to get available instruments
 json TradeExecution::getInstruments(const std::string& currency, const std::string& kind, bool expired) {
     try {
@@ -110,6 +136,29 @@ json TradeExecution::placeBuyOrder(const std::string& instrument_name, double am
     }
 }
 
+// Method to place a sell order
+json TradeExecution::placeSellOrder(const std::string& instrument_name, double amount, double price) {
+    try {
+        json sell_request = {
+            {"jsonrpc", "2.0"},
+            {"id", getNextRequestId()},
+            {"method", "private/sell"},
+            {"params", {
+                {"instrument_name", instrument_name},
+                {"amount", amount},
+                {"type", "limit"},
+                {"price", price}
+            }}
+        };
+        websocket_.sendMessage(sell_request);
+        return websocket_.readMessage();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error in placeSellOrder: " << e.what() << std::endl;
+        throw;
+    }
+}
+
 // Method to cancel an order
 json TradeExecution::cancelOrder(const std::string& order_id) {
     try {
@@ -187,6 +236,40 @@ json TradeExecution::getPositions() {
     }
 }
 
+// Method to have the exchange cancel this session's orders if the connection drops
+json TradeExecution::enableCancelOnDisconnect(const std::string& scope) {
+    try {
+        json request = {
+            {"jsonrpc", "2.0"},
+            {"id", getNextRequestId()},
+            {"method", "private/enable_cancel_on_disconnect"},
+            {"params", {{"scope", scope}}}
+        };
+        websocket_.sendMessage(request);
+        return websocket_.readMessage();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error in enableCancelOnDisconnect: " << e.what() << std::endl;
+        throw;
+    }
+}
+
+// Method to send a pre-staged buy/sell frame without building JSON
+bool TradeExecution::sendStagedOrder(OrderTemplate& order, double price, double amount) {
+    if (!order.patch(static_cast<uint64_t>(getNextRequestId()), price, amount)) {
+        return false;
+    }
+    return websocket_.sendRaw(order.view());
+}
+
+// Method to send a pre-staged edit frame for an existing order
+bool TradeExecution::sendStagedEdit(OrderTemplate& edit, std::string_view order_id, double price, double amount) {
+    if (!edit.patchEdit(order_id, static_cast<uint64_t>(getNextRequestId()), price, amount)) {
+        return false;
+    }
+    return websocket_.sendRaw(edit.view());
+}
+
 // Add a subscriber for real-time market data updates
 void TradeExecution::addMarketDataSubscriber(const std::string& symbol, std::function<void(const json&)> callback) {
     market_data_subscribers_[symbol] = callback;
@@ -2,8 +2,10 @@
 #define TRADE_EXECUTION_H
 
 #include "websocket_handler.h"
+#include "order_template.h"
 #include <nlohmann/json.hpp>
 #include <string>
+#include <string_view>
 #include <functional>
 #include <map>
 #include <atomic>
@@ -20,12 +22,21 @@ public:
 
     // Order Management Functions
     json authenticate(const std::string& client_id, const std::string& client_secret);
+    json refreshToken(const std::string& refresh_token);
     json getInstruments(const std::string& currency, const std::string& kind, bool expired);
     json placeBuyOrder(const std::string& instrument_name, double amount, double price);
+    json placeSellOrder(const std::string& instrument_name, double amount, double price);
     json cancelOrder(const std::string& order_id);
     json modifyOrder(const std::string& order_id, double new_price, double new_amount);
     json getOrderBook(const std::string& instrument_name);
     json getPositions();
+    json enableCancelOnDisconnect(const std::string& scope = "connection");
+
+    // Pre-staged order path: patch the template in place and write it straight
+    // to the socket. Returns false if the values do not fit the template slots
+    // or the socket write failed.
+    bool sendStagedOrder(OrderTemplate& order, double price, double amount);
+    bool sendStagedEdit(OrderTemplate& edit, std::string_view order_id, double price, double amount);
 
     // Market Data Handling
     void handleMarketData(const json& data);
@@ -54,9 +54,20 @@ void WebSocketHandler::sendMessage(const json& message) {
     }
 }
 
+bool WebSocketHandler::sendRaw(std::string_view frame) {
+    try {
+        websocket_.write(asio::buffer(frame.data(), frame.size()));
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error sending raw frame: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 json WebSocketHandler::readMessage() {
     try {
-        auto read_start = LatencyModule::start();  // Start timer for WebSocket message read
+        auto read_start = LatencyModule::getInstance().start("websocket_read");  // Start timer for WebSocket message read
 
         beast::flat_buffer buffer;
         websocket_.read(buffer);
@@ -66,7 +77,7 @@ json WebSocketHandler::readMessage() {
         std::cout << "Received message: " << message_str << std::endl;
 
         // End the timer and log the latency
-        LatencyModule::end(read_start, "WebSocket Read Latency");
+        LatencyModule::getInstance().end("websocket_read", read_start);
 
         return json::parse(message_str);
     }
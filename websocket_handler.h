@@ -11,6 +11,7 @@
 #include <boost/beast/ssl.hpp>
 #include <boost/beast/core.hpp>
 #include <string>
+#include <string_view>
 #include "trade_execution.h"  // Include the TradeExecution header for access
 
 namespace beast = boost::beast;
@@ -27,6 +28,8 @@ public:
     void connect();
     void onMessage(const std::string& message); // Declare the onMessage function
     void sendMessage(const json& message);
+    // Pre-encoded frame, no serialization or logging; false if the write failed
+    bool sendRaw(std::string_view frame);
     json readMessage();
     void close();
 
@@ -18,7 +18,22 @@ WebSocketServer::WebSocketServer(const std::string& host, const std::string& por
     start_time_ = std::chrono::steady_clock::now();
     
     try {
-        tcp::endpoint endpoint(tcp::v4(), std::stoi(port));
+        // Only the configured interface: the HTTP routes expose positions
+        // and metrics without authentication, so the default is loopback
+        if (host_.empty()) {
+            host_ = "127.0.0.1";
+        }
+        // Prefer IPv4: localhost can resolve to ::1 first, and local tools
+        // dial 127.0.0.1
+        tcp::resolver resolver(ioc_);
+        auto results = resolver.resolve(host_, port_);
+        tcp::endpoint endpoint = results.begin()->endpoint();
+        for (const auto& result : results) {
+            if (result.endpoint().address().is_v4()) {
+                endpoint = result.endpoint();
+                break;
+            }
+        }
         acceptor_.open(endpoint.protocol());
         acceptor_.set_option(asio::socket_base::reuse_address(true));
         acceptor_.bind(endpoint);
@@ -167,13 +182,13 @@ void WebSocketServer::stop() {
 }
 
 void WebSocketServer::accept() {
-    auto ws = std::make_shared<beast::websocket::stream<tcp::socket>>(ioc_);
+    auto socket = std::make_shared<tcp::socket>(ioc_);
     
     acceptor_.async_accept(
-        ws->next_layer(),
-        [this, ws](beast::error_code ec) {
+        *socket,
+        [this, socket](beast::error_code ec) {
             if (!ec) {
-                handle_connection(ws);
+                read_request(socket, std::make_shared<beast::flat_buffer>());
             }
             if (running_) {
                 accept();
@@ -181,29 +196,108 @@ void WebSocketServer::accept() {
         });
 }
 
-void WebSocketServer::handle_connection(std::shared_ptr<beast::websocket::stream<tcp::socket>> ws) {
+void WebSocketServer::read_request(std::shared_ptr<tcp::socket> socket, std::shared_ptr<beast::flat_buffer> buffer) {
+    auto request = std::make_shared<http::request<http::string_body>>();
+    
+    http::async_read(
+        *socket, *buffer, *request,
+        [this, socket, buffer, request](beast::error_code ec, std::size_t) {
+            if (ec) {
+                return;  // Closed by the client or malformed
+            }
+            if (beast::websocket::is_upgrade(*request)) {
+                auto ws = std::make_shared<beast::websocket::stream<tcp::socket>>(std::move(*socket));
+                handle_connection(ws, request);
+                return;
+            }
+            handle_http_request(socket, buffer, request);
+        });
+}
+
+void WebSocketServer::handle_http_request(std::shared_ptr<tcp::socket> socket, std::shared_ptr<beast::flat_buffer> buffer,
+                                          std::shared_ptr<http::request<http::string_body>> request) {
+    // The body is a view of a shared buffer; the write handler keeps it alive
+    auto response = std::make_shared<http::response<http::span_body<const char>>>();
+    response->version(request->version());
+    response->keep_alive(request->keep_alive());
+    response->set(http::field::server, "hft-websocket-server");
+    std::shared_ptr<const std::string> body;
+    
+    if (request->method() != http::verb::get && request->method() != http::verb::head) {
+        static const auto not_allowed = std::make_shared<const std::string>(R"({"error":"only GET is supported"})");
+        response->result(http::status::method_not_allowed);
+        response->set(http::field::allow, "GET, HEAD");
+        response->set(http::field::content_type, "application/json");
+        body = not_allowed;
+    } else {
+        try {
+            // Cached routes hand back the same shared body until their state
+            // changes, so a cache hit is written without copying it
+            HttpResponse routed = http_routes_.handle(std::string(request->target()));
+            response->result(static_cast<http::status>(routed.status));
+            response->set(http::field::content_type, routed.content_type);
+            response->set(http::field::cache_control, "no-cache");
+            body = std::move(routed.body);
+        } catch (const std::exception& e) {
+            static const auto internal_error = std::make_shared<const std::string>(R"({"error":"internal error"})");
+            log_error("HTTP route failed for " + std::string(request->target()) + ": " + e.what(), "handle_http_request");
+            response->result(http::status::internal_server_error);
+            response->set(http::field::content_type, "application/json");
+            body = internal_error;
+        }
+    }
+    const size_t body_length = body ? body->size() : 0;
+    if (body && request->method() != http::verb::head) {
+        response->body() = {body->data(), body->size()};
+    }
+    response->prepare_payload();
+    if (request->method() == http::verb::head) {
+        response->content_length(body_length);
+    }
+    
+    http::async_write(
+        *socket, *response,
+        [this, socket, buffer, response, body](beast::error_code ec, std::size_t) {
+            if (ec || !response->keep_alive()) {
+                beast::error_code ignored;
+                socket->shutdown(tcp::socket::shutdown_send, ignored);
+                return;
+            }
+            read_request(socket, buffer);
+        });
+}
+
+void WebSocketServer::handle_connection(std::shared_ptr<beast::websocket::stream<tcp::socket>> ws,
+                                        std::shared_ptr<http::request<http::string_body>> request) {
     ws->async_accept(
-        [this, ws](beast::error_code ec) {
+        *request,
+        [this, ws, request](beast::error_code ec) {
             if (!ec) {
-                // Start reading messages from this client
-                ws->async_read(
-                    buffer_,
-                    [this, ws](beast::error_code ec, std::size_t bytes_transferred) {
-                        if (!ec) {
-                            std::string message = beast::buffers_to_string(buffer_.data());
-                            buffer_.consume(buffer_.size());
-                            
-                            try {
-                                json json_message = json::parse(message);
-                                handle_subscription(json_message, ws);
-                            } catch (const std::exception& e) {
-                                std::cerr << "Error parsing message: " << e.what() << std::endl;
-                            }
-                            
-                            // Continue reading
-                            handle_connection(ws);
-                        }
-                    });
+                // Each connection owns its buffer; reads on different
+                // connections complete concurrently on the worker threads
+                read_message(ws, std::make_shared<beast::flat_buffer>());
+            }
+        });
+}
+
+void WebSocketServer::read_message(std::shared_ptr<beast::websocket::stream<tcp::socket>> ws,
+                                   std::shared_ptr<beast::flat_buffer> buffer) {
+    ws->async_read(
+        *buffer,
+        [this, ws, buffer](beast::error_code ec, std::size_t bytes_transferred) {
+            if (!ec) {
+                std::string message = beast::buffers_to_string(buffer->data());
+                buffer->consume(buffer->size());
+                
+                try {
+                    json json_message = json::parse(message);
+                    handle_subscription(json_message, ws);
+                } catch (const std::exception& e) {
+                    std::cerr << "Error parsing message: " << e.what() << std::endl;
+                }
+                
+                // Continue reading
+                read_message(ws, buffer);
             }
         });
 }
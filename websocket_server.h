@@ -4,6 +4,7 @@
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
+#include <boost/beast/http.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl.hpp>
 #include <nlohmann/json.hpp>
@@ -17,8 +18,10 @@
 #include <set>
 #include <fstream>
 #include <chrono>
+#include "http_routes.h"
 
 namespace beast = boost::beast;
+namespace http = boost::beast::http;
 namespace asio = boost::asio;
 namespace ssl = boost::asio::ssl;
 using tcp = boost::asio::ip::tcp;
@@ -26,6 +29,7 @@ using json = nlohmann::json;
 
 class WebSocketServer {
 public:
+    // Listens on host only; an empty host means 127.0.0.1
     WebSocketServer(const std::string& host, const std::string& port);
     ~WebSocketServer();
 
@@ -41,9 +45,19 @@ public:
     void subscribe(const std::string& symbol, const std::shared_ptr<beast::websocket::stream<tcp::socket>>& client);
     void unsubscribe(const std::string& symbol, const std::shared_ptr<beast::websocket::stream<tcp::socket>>& client);
 
+    // Plain HTTP GET requests on the listener are answered from these routes;
+    // WebSocket upgrade requests are accepted as before
+    HttpRouteTable& http_routes() { return http_routes_; }
+
 private:
     void accept();
-    void handle_connection(std::shared_ptr<beast::websocket::stream<tcp::socket>> ws);
+    void read_request(std::shared_ptr<tcp::socket> socket, std::shared_ptr<beast::flat_buffer> buffer);
+    void handle_http_request(std::shared_ptr<tcp::socket> socket, std::shared_ptr<beast::flat_buffer> buffer,
+                             std::shared_ptr<http::request<http::string_body>> request);
+    void handle_connection(std::shared_ptr<beast::websocket::stream<tcp::socket>> ws,
+                           std::shared_ptr<http::request<http::string_body>> request);
+    void read_message(std::shared_ptr<beast::websocket::stream<tcp::socket>> ws,
+                      std::shared_ptr<beast::flat_buffer> buffer);
     void handle_subscription(const json& message, std::shared_ptr<beast::websocket::stream<tcp::socket>> ws);
     void process_messages();
     void log_error(const std::string& error_message, const std::string& context);
@@ -64,10 +78,10 @@ private:
     std::queue<json> message_queue_;
     std::mutex subscription_mutex_;
     std::unordered_map<std::string, std::set<std::shared_ptr<beast::websocket::stream<tcp::socket>>>> subscriptions_;
-    beast::flat_buffer buffer_;
     std::ofstream error_log_;
     std::ofstream info_log_;
     std::chrono::steady_clock::time_point start_time_;
+    HttpRouteTable http_routes_;
 };
 
 #endif // WEBSOCKET_SERVER_H 
\ No newline at end of file